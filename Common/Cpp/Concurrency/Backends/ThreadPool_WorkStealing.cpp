@@ -0,0 +1,434 @@
+/*  Thread Pool (Work Stealing)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <thread>
+#include <algorithm>
+#include <exception>
+#include "Common/Cpp/PanicDump.h"
+#include "Common/Cpp/Hardware/Hardware.h"
+#include "Common/Cpp/Concurrency/SpinPause.h"
+#include "AsyncTask_Default.h"
+#include "ThreadPool_WorkStealing.h"
+
+//#include <iostream>
+//using std::cout;
+//using std::endl;
+
+namespace PokemonAutomation{
+
+
+
+namespace{
+
+//  Compute-heavy tasks don't gain much from a core's second hardware thread.
+size_t default_thread_count(){
+    size_t threads = get_processor_specs().cores;
+    if (threads == 0){
+        threads = std::thread::hardware_concurrency();
+    }
+    return threads == 0 ? 1 : threads;
+}
+
+//  The worker on this thread. Its "pool" says which pool it belongs to.
+thread_local void* t_worker = nullptr;
+
+//  Where a non-worker thread starts looking for tasks to steal.
+thread_local size_t t_steal_start = 0;
+
+}
+
+
+
+ThreadPool_WorkStealing::ThreadPool_WorkStealing(
+    std::function<void()>&& new_thread_callback,
+    size_t starting_threads,
+    size_t max_threads
+)
+    : m_new_thread_callback(std::move(new_thread_callback))
+    , m_max_threads(max_threads == 0 ? default_thread_count() : max_threads)
+    , m_workers(m_max_threads)
+    , m_worker_count(0)
+    , m_pending(0)
+    , m_awake(0)
+    , m_sleeping(0)
+    , m_stopping(false)
+{
+    ensure_threads(starting_threads);
+}
+ThreadPool_WorkStealing::~ThreadPool_WorkStealing(){
+    stop();
+}
+void ThreadPool_WorkStealing::stop(){
+    {
+        std::lock_guard<Mutex> lg(m_lock);
+        if (m_stopping.load(std::memory_order_relaxed)) return;
+        m_stopping.store(true, std::memory_order_release);
+        m_thread_cv.notify_all();
+    }
+
+    size_t workers = m_worker_count.load(std::memory_order_acquire);
+    for (size_t c = 0; c < workers; c++){
+        Thread& thread = m_workers[c]->thread;
+        if (thread.joinable()){
+            thread.join();
+        }
+    }
+
+    //  Nothing is running anymore. Cancel everything that didn't get to run.
+    for (size_t c = 0; c < workers; c++){
+        Worker& worker = *m_workers[c];
+        std::lock_guard<Mutex> lg(worker.lock);
+        for (AsyncTaskCore* task : worker.queue){
+            task->report_cancelled();
+        }
+        worker.queue.clear();
+        worker.queued.store(0, std::memory_order_release);
+    }
+    {
+        std::lock_guard<Mutex> lg(m_shared_lock);
+        for (AsyncTaskCore* task : m_shared_queue){
+            task->report_cancelled();
+        }
+        m_shared_queue.clear();
+    }
+}
+
+
+void ThreadPool_WorkStealing::ensure_threads(size_t threads){
+    std::lock_guard<Mutex> lg(m_lock);
+    threads = std::min(threads, m_max_threads);
+    while (m_worker_count.load(std::memory_order_relaxed) < threads){
+        spawn_thread();
+    }
+}
+
+
+
+WallDuration ThreadPool_WorkStealing::cpu_time() const{
+    WallDuration ret = WallDuration::zero();
+    size_t workers = m_worker_count.load(std::memory_order_acquire);
+    for (size_t c = 0; c < workers; c++){
+        const Worker& worker = *m_workers[c];
+        std::lock_guard<Mutex> lg(worker.lock);
+        ret += worker.runtime.total();
+    }
+    return ret;
+}
+
+
+
+ThreadPool_WorkStealing::Worker* ThreadPool_WorkStealing::current_worker() const{
+    Worker* worker = (Worker*)t_worker;
+    return worker != nullptr && worker->pool == this ? worker : nullptr;
+}
+
+void ThreadPool_WorkStealing::enqueue_local(Worker& worker, AsyncTask* tasks, size_t count){
+    m_pending.fetch_add(count);
+    std::lock_guard<Mutex> lg(worker.lock);
+    for (size_t c = 0; c < count; c++){
+        worker.queue.emplace_back(tasks[c].core());
+    }
+    worker.queued.store(worker.queue.size(), std::memory_order_release);
+}
+void ThreadPool_WorkStealing::enqueue_shared(AsyncTask* tasks, size_t count){
+    m_pending.fetch_add(count);
+    std::lock_guard<Mutex> lg(m_shared_lock);
+    for (size_t c = 0; c < count; c++){
+        m_shared_queue.emplace_back(tasks[c].core());
+    }
+}
+void ThreadPool_WorkStealing::wake_workers(size_t count){
+    if (m_worker_count.load(std::memory_order_acquire) < m_max_threads){
+        std::lock_guard<Mutex> lg(m_lock);
+        spawn_threads();
+    }
+
+    //  Pairs with the sleeping check in thread_loop(). Both sides are
+    //  sequentially consistent so at least one of them sees the other.
+    size_t sleeping = m_sleeping.load();
+    if (sleeping == 0){
+        return;
+    }
+
+    std::lock_guard<Mutex> lg(m_lock);
+    if (count >= sleeping){
+        m_thread_cv.notify_all();
+    }else{
+        for (size_t c = 0; c < count; c++){
+            m_thread_cv.notify_one();
+        }
+    }
+}
+
+
+
+AsyncTaskCore* ThreadPool_WorkStealing::try_pop(Worker* self){
+    AsyncTaskCore* task;
+
+    //  Newest task from our own queue. It's most likely still in cache.
+    if (self != nullptr && self->queued.load(std::memory_order_acquire) != 0){
+        std::lock_guard<Mutex> lg(self->lock);
+        if (!self->queue.empty()){
+            task = self->queue.back();
+            self->queue.pop_back();
+            self->queued.store(self->queue.size(), std::memory_order_release);
+            return task;
+        }
+    }
+
+    //  Oldest task from the shared queue.
+    {
+        std::lock_guard<Mutex> lg(m_shared_lock);
+        if (!m_shared_queue.empty()){
+            task = m_shared_queue.front();
+            m_shared_queue.pop_front();
+            return task;
+        }
+    }
+
+    //  Oldest task from someone else's queue.
+    size_t workers = m_worker_count.load(std::memory_order_acquire);
+    if (workers == 0){
+        return nullptr;
+    }
+    size_t start = self != nullptr ? self->index + 1 : t_steal_start++;
+    for (size_t c = 0; c < workers; c++){
+        Worker* victim = m_workers[(start + c) % workers].get();
+        if (victim == self || victim->queued.load(std::memory_order_acquire) == 0){
+            continue;
+        }
+        std::lock_guard<Mutex> lg(victim->lock);
+        if (!victim->queue.empty()){
+            task = victim->queue.front();
+            victim->queue.pop_front();
+            victim->queued.store(victim->queue.size(), std::memory_order_release);
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+bool ThreadPool_WorkStealing::run_one(Worker* self){
+    AsyncTaskCore* task = try_pop(self);
+    if (task == nullptr){
+        return false;
+    }
+    m_pending.fetch_sub(1, std::memory_order_acq_rel);
+    task->run();
+    return true;
+}
+
+
+
+AsyncTask ThreadPool_WorkStealing::dispatch(std::function<void()>&& func){
+    AsyncTask task(std::make_unique<AsyncTask_Cpp>(std::move(func)));
+    task.report_started();
+    enqueue_shared(&task, 1);
+    wake_workers(1);
+    return task;
+}
+AsyncTask ThreadPool_WorkStealing::dispatch_now_blocking(std::function<void()>&& func){
+    AsyncTask task(std::make_unique<AsyncTask_Cpp>(std::move(func)));
+    {
+        std::unique_lock<Mutex> lg(m_lock);
+
+        m_dispatch_cv.wait(lg, [this]{
+            return m_pending.load() + m_awake.load() < m_max_threads;
+        });
+
+        task.report_started();
+        enqueue_shared(&task, 1);
+        spawn_threads();
+        m_thread_cv.notify_one();
+    }
+    return task;
+}
+AsyncTask ThreadPool_WorkStealing::try_dispatch_now(std::function<void()>& func){
+    AsyncTask task;
+    {
+        std::lock_guard<Mutex> lg(m_lock);
+
+        if (m_pending.load() + m_awake.load() >= m_max_threads){
+            return AsyncTask();
+        }
+
+        task = AsyncTask(std::make_unique<AsyncTask_Cpp>(std::move(func)));
+        task.report_started();
+        enqueue_shared(&task, 1);
+        spawn_threads();
+        m_thread_cv.notify_one();
+    }
+    return task;
+}
+
+
+void ThreadPool_WorkStealing::run_in_parallel(
+    const std::function<void(size_t index)>& func,
+    size_t start, size_t end,
+    size_t block_size
+){
+    if (start >= end){
+        return;
+    }
+    size_t total = end - start;
+
+    if (block_size == 0){
+        block_size = total / m_max_threads / 16;
+        if (block_size == 0){
+            block_size = 1;
+        }
+    }
+    block_size = std::min(block_size, total);
+
+    size_t blocks = (total + block_size - 1) / block_size;
+
+    //  Must outlive the tasks.
+    std::atomic<size_t> remaining(blocks);
+
+    //  Prepare all the tasks.
+    std::vector<AsyncTask> tasks;
+    for (size_t c = 0; c < blocks; c++){
+        tasks.emplace_back(
+            std::make_unique<AsyncTask_Cpp>([=, &func, &remaining]{
+                struct Done{
+                    std::atomic<size_t>& remaining;
+                    ~Done(){ remaining.fetch_sub(1, std::memory_order_release); }
+                } done{remaining};
+                size_t s = start + c * block_size;
+                size_t e = std::min(s + block_size, end);
+                for (; s < e; s++){
+                    func(s);
+                }
+            })
+        );
+        tasks.back().report_started();
+    }
+
+    //  Push them in reverse so that our own thread, which takes from the back,
+    //  runs them in order while thieves take from the other end.
+    Worker* self = current_worker();
+    if (self != nullptr){
+        std::reverse(tasks.begin(), tasks.end());
+        enqueue_local(*self, tasks.data(), tasks.size());
+    }else{
+        enqueue_shared(tasks.data(), tasks.size());
+    }
+    wake_workers(blocks);
+
+    //  Run tasks until all of ours have finished or there is nothing left to
+    //  pop. Anything of ours that isn't finished after this is already
+    //  running on another thread, so it's safe to block on it.
+    //
+    //  This doesn't only run our own tasks. Once our queue is empty it takes
+    //  whatever is next on the shared queue or steals from another worker,
+    //  so the caller may end up running unrelated tasks (including long ones)
+    //  before it returns.
+    while (remaining.load(std::memory_order_acquire) != 0){
+        if (!run_one(self)){
+            break;
+        }
+    }
+
+    //  Wait for everything to finish before rethrowing since the tasks
+    //  reference this stack frame.
+    std::exception_ptr exception;
+    for (AsyncTask& task : tasks){
+        try{
+            task.wait_and_rethrow_exceptions();
+        }catch (...){
+            if (!exception){
+                exception = std::current_exception();
+            }
+        }
+    }
+    if (exception){
+        std::rethrow_exception(exception);
+    }
+}
+
+
+
+void ThreadPool_WorkStealing::spawn_thread(){
+    //  Must call under lock.
+    size_t index = m_worker_count.load(std::memory_order_relaxed);
+    std::unique_ptr<Worker> worker(new Worker());
+    worker->pool = this;
+    worker->index = index;
+
+    Worker& ref = *worker;
+    m_awake++;
+    try{
+        ref.thread = Thread([&ref, this]{
+            run_with_catch(
+                "ThreadPool_WorkStealing::thread_loop()",
+                [&ref, this]{ thread_loop(ref); }
+            );
+        });
+    }catch (...){
+        m_awake--;
+        throw;
+    }
+
+    m_workers[index] = std::move(worker);
+    m_worker_count.store(index + 1, std::memory_order_release);
+}
+void ThreadPool_WorkStealing::spawn_threads(){
+    //  Must call under lock.
+    size_t target = std::min(m_pending.load() + m_awake.load(), m_max_threads);
+    while (m_worker_count.load(std::memory_order_relaxed) < target){
+        spawn_thread();
+    }
+}
+void ThreadPool_WorkStealing::thread_loop(Worker& worker){
+    t_worker = &worker;
+    worker.handle = current_thread_handle();
+
+    if (m_new_thread_callback){
+        m_new_thread_callback();
+    }
+
+    {
+        std::lock_guard<Mutex> lg(worker.lock);
+        worker.runtime.start();
+    }
+
+    while (!m_stopping.load(std::memory_order_acquire)){
+        if (run_one(&worker)){
+            continue;
+        }
+
+        //  Something was counted before it was pushed. It will show up shortly.
+        if (m_pending.load(std::memory_order_acquire) != 0){
+            pause();
+            continue;
+        }
+
+        std::unique_lock<Mutex> lg(m_lock);
+        m_sleeping++;
+        if (m_pending.load() == 0 && !m_stopping.load(std::memory_order_relaxed)){
+            {
+                std::lock_guard<Mutex> lg0(worker.lock);
+                worker.runtime.stop();
+            }
+            m_awake--;
+            m_dispatch_cv.notify_all();
+            m_thread_cv.wait(lg);
+            m_awake++;
+            {
+                std::lock_guard<Mutex> lg0(worker.lock);
+                worker.runtime.start();
+            }
+        }
+        m_sleeping--;
+    }
+
+    t_worker = nullptr;
+}
+
+
+
+
+}
@@ -0,0 +1,147 @@
+/*  Thread Pool (Work Stealing)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  Thread pool where each worker has its own task queue.
+ *
+ *  The blocks of a run_in_parallel() called from a worker of this pool go on
+ *  the back of that worker's queue. Everything else goes on a shared queue in
+ *  dispatch order. A worker runs from the back of its own queue first, then
+ *  from the shared queue, and then steals from the front of the other workers'
+ *  queues. So nested parallel work stays on the thread that made it unless
+ *  another thread is idle, and there is no single lock that every dispatch
+ *  and every worker contends on.
+ *
+ *  A thread that calls run_in_parallel() runs tasks while it waits for its
+ *  own to finish instead of just blocking. So run_in_parallel() can be
+ *  nested inside tasks of the same pool without deadlocking even when every
+ *  worker is busy. The tasks it runs while waiting are not only its own. It
+ *  can pick up anything from the shared queue or from other workers, so a
+ *  run_in_parallel() call can take as long as an unrelated task in the pool.
+ *
+ */
+
+#ifndef PokemonAutomation_ThreadPool_WorkStealing_H
+#define PokemonAutomation_ThreadPool_WorkStealing_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include "Common/Cpp/Stopwatch.h"
+#include "Common/Cpp/Concurrency/Mutex.h"
+#include "Common/Cpp/Concurrency/ConditionVariable.h"
+#include "Common/Cpp/Concurrency/Thread.h"
+#include "Common/Cpp/CpuUtilization/CpuUtilization.h"
+#include "Common/Cpp/Concurrency/AsyncTask.h"
+#include "Common/Cpp/Concurrency/ThreadPool.h"
+
+namespace PokemonAutomation{
+
+
+
+class ThreadPool_WorkStealing final : public ThreadPool{
+public:
+    //  If "max_threads" is zero, it defaults to the number of physical cores.
+    //  Space for "max_threads" workers is allocated up front so it must be
+    //  an actual limit.
+    ThreadPool_WorkStealing(
+        std::function<void()>&& new_thread_callback,
+        size_t starting_threads,
+        size_t max_threads = 0
+    );
+    ~ThreadPool_WorkStealing();
+
+    virtual void stop() override;
+    virtual void ensure_threads(size_t threads) override;
+
+
+public:
+    virtual size_t current_threads() const override{
+        return m_worker_count.load(std::memory_order_acquire);
+    }
+    virtual size_t max_threads() const override{
+        return m_max_threads;
+    }
+    virtual WallDuration cpu_time() const override;
+
+
+public:
+    [[nodiscard]] virtual AsyncTask dispatch(std::function<void()>&& func) override;
+    [[nodiscard]] virtual AsyncTask dispatch_now_blocking(std::function<void()>&& func) override;
+    [[nodiscard]] virtual AsyncTask try_dispatch_now(std::function<void()>& func) override;
+
+    virtual void run_in_parallel(
+        const std::function<void(size_t index)>& func,
+        size_t start, size_t end,
+        size_t block_size = 0
+    ) override;
+
+
+private:
+    struct Worker{
+        ThreadPool_WorkStealing* pool;
+        size_t index;
+        Thread thread;
+        ThreadHandle handle;
+
+        //  Protects "queue" and "runtime".
+        mutable Mutex lock;
+        std::deque<AsyncTaskCore*> queue;
+        Stopwatch runtime;
+
+        //  Size of "queue" so that thieves can skip empty queues without locking.
+        std::atomic<size_t> queued{0};
+    };
+
+    //  The worker of this pool that is running on the current thread.
+    //  Returns null if this thread does not belong to this pool.
+    Worker* current_worker() const;
+
+    //  The tasks must already be reported as started.
+    void enqueue_local(Worker& worker, AsyncTask* tasks, size_t count);
+    void enqueue_shared(AsyncTask* tasks, size_t count);
+
+    //  Make sure there are enough threads awake for "count" new tasks.
+    void wake_workers(size_t count);
+
+    AsyncTaskCore* try_pop(Worker* self);
+    bool run_one(Worker* self);
+
+    void spawn_thread();
+    void spawn_threads();
+    void thread_loop(Worker& worker);
+
+
+private:
+    std::function<void()> m_new_thread_callback;
+    const size_t m_max_threads;
+
+    //  Sized to "m_max_threads" up front and only ever appended to so that
+    //  other threads can read the first "m_worker_count" entries without
+    //  a lock when stealing.
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_worker_count;
+
+    Mutex m_shared_lock;
+    std::deque<AsyncTaskCore*> m_shared_queue;
+
+    //  Number of tasks sitting in any of the queues.
+    std::atomic<size_t> m_pending;
+    //  Number of workers that are not asleep.
+    std::atomic<size_t> m_awake;
+    std::atomic<size_t> m_sleeping;
+    std::atomic<bool> m_stopping;
+
+    //  Protects thread creation, sleeping and waking.
+    mutable Mutex m_lock;
+    ConditionVariable m_thread_cv;
+    ConditionVariable m_dispatch_cv;
+};
+
+
+
+
+}
+#endif
@@ -4,6 +4,7 @@
  *
  */
 
+#include <algorithm>
 #include "BusyPeriodicRunner.h"
 
 #include <iostream>
@@ -45,6 +46,30 @@ WallClock PeriodicScheduler::next_event() const{
     }
     return iter->first;
 }
+void* PeriodicScheduler::peek_next_event(WallClock timestamp){
+    while (true){
+        auto iter0 = m_schedule.begin();
+
+        //  Schedule is empty.
+        if (iter0 == m_schedule.end()){
+            return nullptr;
+        }
+
+        //  Next event isn't due.
+        if (timestamp < iter0->first){
+            return nullptr;
+        }
+
+        //  Current SingleEvent refers to a no longer existing PeriodicEvent.
+        auto iter1 = m_events.find(iter0->second.event);
+        if (iter1 == m_events.end() || iter0->second.id != iter1->second.id){
+            m_schedule.erase(iter0);
+            continue;
+        }
+
+        return iter0->second.event;
+    }
+}
 void* PeriodicScheduler::request_next_event(WallClock timestamp){
     while (true){
         auto iter0 = m_schedule.begin();
@@ -169,11 +194,21 @@ void BusyPeriodicRunner::thread_loop(){
         idle_since_last_check = WallDuration(0);
 //        cout << m_utilization.utilization() << endl;
 
-        void* event = m_scheduler.request_next_event(now);
+        //  Grab everything that is due now. Stop if we see the same event
+        //  again (zero period events are always due). That occurrence is left
+        //  in the schedule for the next batch so no periods are lost.
+        m_due_events.clear();
+        while (void* event = m_scheduler.peek_next_event(now)){
+            if (std::find(m_due_events.begin(), m_due_events.end(), event) != m_due_events.end()){
+                break;
+            }
+            m_scheduler.request_next_event(now);
+            m_due_events.emplace_back(event);
+        }
 
-        //  Event is available now. Run it.
-        if (event != nullptr){
-            run(event, is_back_to_back);
+        //  Events are available now. Run them.
+        if (!m_due_events.empty()){
+            run_batch(m_due_events, is_back_to_back);
             is_back_to_back = true;
             continue;
         }
@@ -196,6 +231,12 @@ void BusyPeriodicRunner::thread_loop(){
         idle_since_last_check += end - start;
     }
 }
+void BusyPeriodicRunner::run_batch(const std::vector<void*>& events, bool is_back_to_back) noexcept{
+    for (void* event : events){
+        run(event, is_back_to_back);
+        is_back_to_back = true;
+    }
+}
 void BusyPeriodicRunner::stop_thread() noexcept{
     BusyPeriodicRunner::cancel(nullptr);
     m_runner.wait_and_ignore_exceptions();
@@ -11,6 +11,7 @@
 
 #include <chrono>
 #include <map>
+#include <vector>
 #include "Common/Cpp/Time.h"
 #include "Common/Cpp/EventRateTracker.h"
 #include "Common/Cpp/CancellableScope.h"
@@ -42,6 +43,9 @@ public:
     //  If nothing is before the current timestamp, return nullptr.
     void* request_next_event(WallClock timestamp = current_time());
 
+    //  Same as "request_next_event()", but does not reschedule the event.
+    void* peek_next_event(WallClock timestamp = current_time());
+
 private:
     //  "id" is needed to solve the ABA problem if the same pointer is removed/re-added.
     struct PeriodicEvent{
@@ -85,6 +89,11 @@ protected:
     //  is too slow to keep up.
     virtual void run(void* event, bool is_back_to_back) noexcept = 0;
 
+    //  Run all the events that are due at the same time.
+    //  The default implementation runs them one-by-one using "run()".
+    //  Child classes can override this to run them concurrently.
+    virtual void run_batch(const std::vector<void*>& events, bool is_back_to_back) noexcept;
+
 private:
     void thread_loop();
 protected:
@@ -101,6 +110,7 @@ private:
     UtilizationTracker m_utilization;
 
     PeriodicScheduler m_scheduler;
+    std::vector<void*> m_due_events;
 
     AsyncTask m_runner;
 };
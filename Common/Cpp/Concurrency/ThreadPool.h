@@ -37,6 +37,8 @@ public:
 public:
     //  As of this writing, tasks dispatched earlier are not allowed to block
     //  on tasks that are dispatched later as it may cause a deadlock.
+    //  The exception is run_in_parallel() on ThreadPool_WorkStealing which
+    //  may be nested inside tasks of the same pool.
 
     //  Dispatch the function and return immediately.
     //  The function is not guaranteed to begin running immediately.
@@ -221,11 +221,9 @@ bool JsonObject::read_string(std::string& value, const std::string& key) const{
 
 
 std::string JsonObject::dump(int indent) const{
-    nlohmann::json ret;
-    for (const auto& item : *this){
-        ret[item.first] = to_nlohmann(item.second);
-    }
-    return nlohmann::json(ret).dump(indent);
+    std::string ret;
+    json_dump(ret, *this, indent);
+    return ret;
 }
 void JsonObject::dump(const std::string& filename, int indent) const{
     string_to_file(filename, dump(indent));
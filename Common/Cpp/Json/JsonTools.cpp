@@ -4,6 +4,11 @@
  *
  */
 
+#include <string.h>
+#include <errno.h>
+#include <clocale>
+#include <cmath>
+#include <charconv>
 #include "Common/Cpp/Exceptions.h"
 #include "Common/Cpp/Filesystem/FileIO.h"
 #include "JsonTools.h"
@@ -97,5 +102,646 @@ nlohmann::json to_nlohmann(const JsonValue& json){
 
 
 
+namespace{
+
+
+//  Single-pass recursive descent parser. Follows the rules of the nlohmann
+//  lexer so that the same documents are accepted with the same values.
+class JsonReader{
+public:
+    JsonReader(const char* data, size_t size)
+        : m_ptr(data)
+        , m_end(data + size)
+    {}
+
+    bool parse(JsonValue& value){
+        //  Skip the UTF-8 byte order mark.
+        if (m_end - m_ptr >= 3 && memcmp(m_ptr, "\xEF\xBB\xBF", 3) == 0){
+            m_ptr += 3;
+        }
+        skip_whitespace();
+        if (!parse_value(value, 0)){
+            return false;
+        }
+        skip_whitespace();
+        return m_ptr == m_end;
+    }
+
+private:
+    //  nlohmann doesn't limit the depth. We recurse, so we do. Nothing real
+    //  comes close to this.
+    static constexpr size_t MAX_DEPTH = 1000;
+
+    void skip_whitespace(){
+        while (m_ptr < m_end){
+            char ch = *m_ptr;
+            if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r'){
+                return;
+            }
+            m_ptr++;
+        }
+    }
+    bool match(const char* literal, size_t length){
+        if ((size_t)(m_end - m_ptr) < length || memcmp(m_ptr, literal, length) != 0){
+            return false;
+        }
+        m_ptr += length;
+        return true;
+    }
+
+    bool parse_value(JsonValue& value, size_t depth){
+        if (m_ptr == m_end){
+            return false;
+        }
+        switch (*m_ptr){
+        case 'n':
+            value = JsonValue();
+            return match("null", 4);
+        case 't':
+            value = JsonValue(true);
+            return match("true", 4);
+        case 'f':
+            value = JsonValue(false);
+            return match("false", 5);
+        case '"':{
+            m_ptr++;
+            std::string str;
+            if (!parse_string(str)){
+                return false;
+            }
+            value = JsonValue(std::move(str));
+            return true;
+        }
+        case '[':
+            return depth < MAX_DEPTH && parse_array(value, depth + 1);
+        case '{':
+            return depth < MAX_DEPTH && parse_object(value, depth + 1);
+        default:
+            return parse_number(value);
+        }
+    }
+
+    bool parse_array(JsonValue& value, size_t depth){
+        m_ptr++;
+        JsonArray array;
+        skip_whitespace();
+        if (m_ptr < m_end && *m_ptr == ']'){
+            m_ptr++;
+            value = std::move(array);
+            return true;
+        }
+        while (true){
+            JsonValue item;
+            skip_whitespace();
+            if (!parse_value(item, depth)){
+                return false;
+            }
+            array.push_back(std::move(item));
+            skip_whitespace();
+            if (m_ptr == m_end){
+                return false;
+            }
+            char ch = *m_ptr++;
+            if (ch == ']'){
+                break;
+            }
+            if (ch != ','){
+                return false;
+            }
+        }
+        value = std::move(array);
+        return true;
+    }
+    bool parse_object(JsonValue& value, size_t depth){
+        m_ptr++;
+        JsonObject object;
+        skip_whitespace();
+        if (m_ptr < m_end && *m_ptr == '}'){
+            m_ptr++;
+            value = std::move(object);
+            return true;
+        }
+        while (true){
+            skip_whitespace();
+            if (m_ptr == m_end || *m_ptr != '"'){
+                return false;
+            }
+            m_ptr++;
+            std::string key;
+            if (!parse_string(key)){
+                return false;
+            }
+            skip_whitespace();
+            if (m_ptr == m_end || *m_ptr != ':'){
+                return false;
+            }
+            m_ptr++;
+            skip_whitespace();
+
+            //  Duplicate keys: the last one wins, same as nlohmann.
+            JsonValue item;
+            if (!parse_value(item, depth)){
+                return false;
+            }
+            object[std::move(key)] = std::move(item);
+
+            skip_whitespace();
+            if (m_ptr == m_end){
+                return false;
+            }
+            char ch = *m_ptr++;
+            if (ch == '}'){
+                break;
+            }
+            if (ch != ','){
+                return false;
+            }
+        }
+        value = std::move(object);
+        return true;
+    }
+
+    bool parse_hex4(uint32_t& codepoint){
+        if (m_end - m_ptr < 4){
+            return false;
+        }
+        codepoint = 0;
+        for (size_t c = 0; c < 4; c++){
+            char ch = *m_ptr++;
+            codepoint <<= 4;
+            if ('0' <= ch && ch <= '9'){
+                codepoint |= ch - '0';
+            }else if ('a' <= ch && ch <= 'f'){
+                codepoint |= ch - 'a' + 10;
+            }else if ('A' <= ch && ch <= 'F'){
+                codepoint |= ch - 'A' + 10;
+            }else{
+                return false;
+            }
+        }
+        return true;
+    }
+    static void append_utf8(std::string& str, uint32_t codepoint){
+        if (codepoint < 0x80){
+            str += (char)codepoint;
+        }else if (codepoint < 0x800){
+            str += (char)(0xc0 | (codepoint >> 6));
+            str += (char)(0x80 | (codepoint & 0x3f));
+        }else if (codepoint < 0x10000){
+            str += (char)(0xe0 | (codepoint >> 12));
+            str += (char)(0x80 | ((codepoint >> 6) & 0x3f));
+            str += (char)(0x80 | (codepoint & 0x3f));
+        }else{
+            str += (char)(0xf0 | (codepoint >> 18));
+            str += (char)(0x80 | ((codepoint >> 12) & 0x3f));
+            str += (char)(0x80 | ((codepoint >> 6) & 0x3f));
+            str += (char)(0x80 | (codepoint & 0x3f));
+        }
+    }
+    bool parse_escape(std::string& str){
+        if (m_ptr == m_end){
+            return false;
+        }
+        switch (*m_ptr++){
+        case '"':   str += '"'; return true;
+        case '\\':  str += '\\'; return true;
+        case '/':   str += '/'; return true;
+        case 'b':   str += '\b'; return true;
+        case 'f':   str += '\f'; return true;
+        case 'n':   str += '\n'; return true;
+        case 'r':   str += '\r'; return true;
+        case 't':   str += '\t'; return true;
+        case 'u':   break;
+        default:    return false;
+        }
+
+        uint32_t codepoint;
+        if (!parse_hex4(codepoint)){
+            return false;
+        }
+        if (0xdc00 <= codepoint && codepoint <= 0xdfff){
+            return false;
+        }
+        if (0xd800 <= codepoint && codepoint <= 0xdbff){
+            //  Must be followed by the low surrogate.
+            uint32_t low;
+            if (!match("\\u", 2) || !parse_hex4(low) || low < 0xdc00 || low > 0xdfff){
+                return false;
+            }
+            codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+        }
+        append_utf8(str, codepoint);
+        return true;
+    }
+
+    //  Validate one multi-byte UTF-8 character and copy it.
+    bool parse_utf8(std::string& str){
+        const uint8_t* ptr = (const uint8_t*)m_ptr;
+        size_t available = m_end - m_ptr;
+        uint8_t lead = ptr[0];
+        size_t length;
+        uint8_t min = 0x80;
+        uint8_t max = 0xbf;
+        if (0xc2 <= lead && lead <= 0xdf){
+            length = 2;
+        }else if (lead == 0xe0){
+            length = 3;
+            min = 0xa0;
+        }else if ((0xe1 <= lead && lead <= 0xec) || lead == 0xee || lead == 0xef){
+            length = 3;
+        }else if (lead == 0xed){
+            length = 3;
+            max = 0x9f;
+        }else if (lead == 0xf0){
+            length = 4;
+            min = 0x90;
+        }else if (0xf1 <= lead && lead <= 0xf3){
+            length = 4;
+        }else if (lead == 0xf4){
+            length = 4;
+            max = 0x8f;
+        }else{
+            return false;
+        }
+        if (available < length){
+            return false;
+        }
+        if (ptr[1] < min || ptr[1] > max){
+            return false;
+        }
+        for (size_t c = 2; c < length; c++){
+            if (ptr[c] < 0x80 || ptr[c] > 0xbf){
+                return false;
+            }
+        }
+        str.append(m_ptr, length);
+        m_ptr += length;
+        return true;
+    }
+
+    //  The opening quote has already been consumed.
+    bool parse_string(std::string& str){
+        while (true){
+            //  Copy runs of plain ASCII in one go.
+            const char* start = m_ptr;
+            while (m_ptr < m_end){
+                uint8_t ch = *m_ptr;
+                if (ch < 0x20 || ch >= 0x80 || ch == '"' || ch == '\\'){
+                    break;
+                }
+                m_ptr++;
+            }
+            str.append(start, m_ptr);
+
+            if (m_ptr == m_end){
+                return false;
+            }
+            uint8_t ch = *m_ptr;
+            if (ch == '"'){
+                m_ptr++;
+                return true;
+            }
+            if (ch == '\\'){
+                m_ptr++;
+                if (!parse_escape(str)){
+                    return false;
+                }
+                continue;
+            }
+            if (ch < 0x20){
+                //  Control characters must be escaped.
+                return false;
+            }
+            if (!parse_utf8(str)){
+                return false;
+            }
+        }
+    }
+
+    bool parse_number(JsonValue& value){
+        const char* start = m_ptr;
+        bool negative = false;
+        if (m_ptr < m_end && *m_ptr == '-'){
+            negative = true;
+            m_ptr++;
+        }
+
+        //  Integer part. Accumulate it in case this turns out to be an integer.
+        if (m_ptr == m_end || *m_ptr < '0' || *m_ptr > '9'){
+            return false;
+        }
+        uint64_t magnitude = 0;
+        bool overflow = false;
+        if (*m_ptr == '0'){
+            m_ptr++;
+        }else{
+            while (m_ptr < m_end && '0' <= *m_ptr && *m_ptr <= '9'){
+                uint64_t digit = *m_ptr++ - '0';
+                if (magnitude > (UINT64_MAX - digit) / 10){
+                    overflow = true;
+                }
+                magnitude = magnitude * 10 + digit;
+            }
+        }
+
+        bool is_float = false;
+        if (m_ptr < m_end && *m_ptr == '.'){
+            is_float = true;
+            m_ptr++;
+            if (m_ptr == m_end || *m_ptr < '0' || *m_ptr > '9'){
+                return false;
+            }
+            while (m_ptr < m_end && '0' <= *m_ptr && *m_ptr <= '9'){
+                m_ptr++;
+            }
+        }
+        if (m_ptr < m_end && (*m_ptr == 'e' || *m_ptr == 'E')){
+            is_float = true;
+            m_ptr++;
+            if (m_ptr < m_end && (*m_ptr == '+' || *m_ptr == '-')){
+                m_ptr++;
+            }
+            if (m_ptr == m_end || *m_ptr < '0' || *m_ptr > '9'){
+                return false;
+            }
+            while (m_ptr < m_end && '0' <= *m_ptr && *m_ptr <= '9'){
+                m_ptr++;
+            }
+        }
+
+        if (!is_float && !overflow){
+            if (!negative){
+                //  nlohmann keeps these as unsigned. Reading them back as
+                //  int64_t wraps the ones past INT64_MAX.
+                value = JsonValue((int64_t)magnitude);
+                return true;
+            }
+            if (magnitude <= (uint64_t)1 << 63){
+                value = JsonValue((int64_t)(0 - magnitude));
+                return true;
+            }
+        }
+
+        //  Same conversion as nlohmann: strtod() with the decimal point
+        //  swapped to whatever the current locale uses.
+        char buffer[64];
+        std::string long_buffer;
+        size_t length = m_ptr - start;
+        char* token = buffer;
+        if (length >= sizeof(buffer)){
+            long_buffer.resize(length + 1);
+            token = &long_buffer[0];
+        }
+        memcpy(token, start, length);
+        token[length] = '\0';
+        char decimal_point = std::localeconv()->decimal_point[0];
+        if (decimal_point != '.'){
+            for (size_t c = 0; c < length; c++){
+                if (token[c] == '.'){
+                    token[c] = decimal_point;
+                }
+            }
+        }
+        double x = std::strtod(token, nullptr);
+        if (!std::isfinite(x)){
+            return false;
+        }
+        value = JsonValue(x);
+        return true;
+    }
+
+private:
+    const char* m_ptr;
+    const char* m_end;
+};
+
+
+
+//  Serializer that writes the same text as nlohmann::json::dump().
+class JsonWriter{
+public:
+    JsonWriter(std::string& out, int indent)
+        : m_out(out)
+        , m_pretty(indent >= 0)
+        , m_indent_step(indent >= 0 ? indent : 0)
+    {}
+
+    void write(const JsonValue& value, size_t current_indent){
+        switch (value.type()){
+        case JsonType::EMPTY:
+            m_out += "null";
+            return;
+        case JsonType::BOOLEAN:
+            m_out += value.to_boolean_default() ? "true" : "false";
+            return;
+        case JsonType::INTEGER:
+            m_out += std::to_string(value.to_integer_default());
+            return;
+        case JsonType::FLOAT:
+            write_float(value.to_double_default());
+            return;
+        case JsonType::STRING:
+            m_out += '"';
+            write_escaped(*value.to_string());
+            m_out += '"';
+            return;
+        case JsonType::ARRAY:
+            write(*value.to_array(), current_indent);
+            return;
+        case JsonType::OBJECT:
+            write(*value.to_object(), current_indent);
+            return;
+        }
+    }
+    void write(const JsonArray& array, size_t current_indent){
+        if (array.size() == 0){
+            m_out += "[]";
+            return;
+        }
+        size_t new_indent = current_indent + m_indent_step;
+        m_out += m_pretty ? "[\n" : "[";
+        bool first = true;
+        for (const JsonValue& item : array){
+            if (!first){
+                m_out += m_pretty ? ",\n" : ",";
+            }
+            first = false;
+            m_out.append(m_pretty ? new_indent : 0, ' ');
+            write(item, new_indent);
+        }
+        if (m_pretty){
+            m_out += '\n';
+            m_out.append(current_indent, ' ');
+        }
+        m_out += ']';
+    }
+    void write(const JsonObject& object, size_t current_indent){
+        if (object.empty()){
+            //  to_nlohmann() leaves an empty object as null. Keep writing the
+            //  same thing so the files don't change.
+            m_out += "null";
+            return;
+        }
+        size_t new_indent = current_indent + m_indent_step;
+        m_out += m_pretty ? "{\n" : "{";
+        bool first = true;
+        for (const auto& item : object){
+            if (!first){
+                m_out += m_pretty ? ",\n" : ",";
+            }
+            first = false;
+            m_out.append(m_pretty ? new_indent : 0, ' ');
+            m_out += '"';
+            write_escaped(item.first);
+            m_out += m_pretty ? "\": " : "\":";
+            write(item.second, new_indent);
+        }
+        if (m_pretty){
+            m_out += '\n';
+            m_out.append(current_indent, ' ');
+        }
+        m_out += '}';
+    }
+
+private:
+    //  nlohmann throws on invalid UTF-8. We copy it through as is.
+    void write_escaped(const std::string& str){
+        static const char HEX[] = "0123456789abcdef";
+        const char* ptr = str.data();
+        const char* end = ptr + str.size();
+        while (ptr < end){
+            const char* start = ptr;
+            while (ptr < end){
+                uint8_t ch = *ptr;
+                if (ch < 0x20 || ch == '"' || ch == '\\'){
+                    break;
+                }
+                ptr++;
+            }
+            m_out.append(start, ptr);
+            if (ptr == end){
+                return;
+            }
+            uint8_t ch = *ptr++;
+            switch (ch){
+            case '"':   m_out += "\\\""; break;
+            case '\\':  m_out += "\\\\"; break;
+            case '\b':  m_out += "\\b"; break;
+            case '\f':  m_out += "\\f"; break;
+            case '\n':  m_out += "\\n"; break;
+            case '\r':  m_out += "\\r"; break;
+            case '\t':  m_out += "\\t"; break;
+            default:
+                m_out += "\\u00";
+                m_out += HEX[ch >> 4];
+                m_out += HEX[ch & 0xf];
+            }
+        }
+    }
+
+    //  Shortest round-trip digits, laid out the way nlohmann does it.
+    void write_float(double value){
+        if (!std::isfinite(value)){
+            m_out += "null";
+            return;
+        }
+        if (std::signbit(value)){
+            m_out += '-';
+            value = -value;
+        }
+        if (value == 0){
+            m_out += "0.0";
+            return;
+        }
+
+        //  "d.dddde+xx"
+        char buffer[32];
+        char* end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific).ptr;
+        char digits[24];
+        int k = 0;
+        const char* ptr = buffer;
+        for (; *ptr != 'e'; ptr++){
+            if (*ptr != '.'){
+                digits[k++] = *ptr;
+            }
+        }
+        int exponent = 0;
+        std::from_chars(ptr + (ptr[1] == '+' ? 2 : 1), end, exponent);
+
+        //  The value is 0.digits * 10^n.
+        const int MIN_EXP = -4;
+        const int MAX_EXP = 15;
+        int n = exponent + 1;
+        if (k <= n && n <= MAX_EXP){
+            m_out.append(digits, k);
+            m_out.append(n - k, '0');
+            m_out += ".0";
+            return;
+        }
+        if (0 < n && n <= MAX_EXP){
+            m_out.append(digits, n);
+            m_out += '.';
+            m_out.append(digits + n, k - n);
+            return;
+        }
+        if (MIN_EXP < n && n <= 0){
+            m_out += "0.";
+            m_out.append(-n, '0');
+            m_out.append(digits, k);
+            return;
+        }
+
+        m_out += digits[0];
+        if (k > 1){
+            m_out += '.';
+            m_out.append(digits + 1, k - 1);
+        }
+        m_out += 'e';
+        int e = n - 1;
+        m_out += e < 0 ? '-' : '+';
+        e = std::abs(e);
+        if (e >= 100){
+            m_out += (char)('0' + e / 100);
+            e %= 100;
+            m_out += (char)('0' + e / 10);
+        }else{
+            m_out += (char)('0' + e / 10);
+        }
+        m_out += (char)('0' + e % 10);
+    }
+
+private:
+    std::string& m_out;
+    bool m_pretty;
+    size_t m_indent_step;
+};
+
+
+}
+
+
+
+JsonValue json_parse(const char* data, size_t size){
+    JsonValue value;
+    JsonReader reader(data, size);
+    if (!reader.parse(value)){
+        return JsonValue();
+    }
+    return value;
+}
+
+void json_dump(std::string& out, const JsonValue& value, int indent){
+    JsonWriter(out, indent).write(value, 0);
+}
+void json_dump(std::string& out, const JsonArray& value, int indent){
+    JsonWriter(out, indent).write(value, 0);
+}
+void json_dump(std::string& out, const JsonObject& value, int indent){
+    JsonWriter(out, indent).write(value, 0);
+}
+
+
+
+
 
 }
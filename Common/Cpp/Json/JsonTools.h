@@ -17,5 +17,19 @@ JsonValue from_nlohmann(const nlohmann::json& json);
 nlohmann::json to_nlohmann(const JsonValue& json);
 
 
+//  Parse JSON straight into a JsonValue without building a nlohmann::json
+//  first. Accepts exactly what nlohmann::json::parse() accepts and gives the
+//  same values. Malformed JSON returns an empty value.
+JsonValue json_parse(const char* data, size_t size);
+
+//  Append the JSON text of "value" to "out". The output is the same as
+//  nlohmann::json::dump(indent). A negative indent gives compact output.
+//  Floats use the shortest digits that read back exactly. Once in a while
+//  that differs from nlohmann in the last digit, but never in value.
+void json_dump(std::string& out, const JsonValue& value, int indent);
+void json_dump(std::string& out, const JsonArray& value, int indent);
+void json_dump(std::string& out, const JsonObject& value, int indent);
+
+
 }
 #endif
@@ -368,14 +368,16 @@ bool JsonValue::read_string(std::string& value) const{
 
 
 JsonValue parse_json(const std::string& str){
-    return from_nlohmann(nlohmann::json::parse(str, nullptr, false));
+    return json_parse(str.data(), str.size());
 }
 JsonValue load_json_file(const std::string& filename){
     std::string str = file_to_string(filename);
     return parse_json(str);
 }
 std::string JsonValue::dump(int indent) const{
-    return to_nlohmann(*this).dump(indent);
+    std::string ret;
+    json_dump(ret, *this, indent);
+    return ret;
 }
 void JsonValue::dump(const std::string& filename, int indent) const{
     string_to_file(filename, dump(indent));
@@ -7,19 +7,32 @@
 #ifndef PokemonAutomation_SerialConnectionPOSIX_H
 #define PokemonAutomation_SerialConnectionPOSIX_H
 
+#include <string.h>
 #include <string>
+#include <vector>
+#include <deque>
 #include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
 #include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
 #include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
 #include "Common/Cpp/Exceptions.h"
 #include "Common/Cpp/PanicDump.h"
 #include "Common/Cpp/Concurrency/SpinLock.h"
+#include "Common/Cpp/Concurrency/Mutex.h"
+#include "Common/Cpp/Concurrency/ConditionVariable.h"
 #include "Common/Cpp/Concurrency/AsyncTask.h"
 #include "Common/Cpp/Concurrency/ThreadPool.h"
 #include "Common/Cpp/StreamConnections/PushingStreamConnections.h"
+#include "SerialLatencyHistogram.h"
 
 namespace PokemonAutomation{
 
@@ -27,22 +40,61 @@ void serial_debug_log(const std::string& msg);
 
 
 
+struct SerialConnectionOptions{
+    //  Sleep in poll() until there is data instead of waking every 100ms from
+    //  a blocking read(), and queue outgoing data in a buffer that is written
+    //  without blocking. macOS can't poll() serial devices, so it stays on
+    //  the blocking mode by default.
+#ifdef __APPLE__
+    bool event_driven = false;
+#else
+    bool event_driven = true;
+#endif
+
+    //  Ask the driver to hand received bytes over right away instead of
+    //  batching them. (Linux only. Not every USB-serial driver supports it.)
+    bool low_latency = true;
+
+    //  Size of the outgoing buffer in event-driven mode.
+    size_t send_buffer_size = 4096;
+
+    //  How often to log the RX/TX latency histograms. Zero turns them off.
+    std::chrono::seconds latency_report_interval = std::chrono::seconds(60);
+};
+
+
+
 class SerialConnection : public UnreliableStreamConnectionPushing{
 public:
     //  UTF-8
     SerialConnection(
         ThreadPool& thread_pool,
         const std::string& name,
-        uint32_t baud_rate
+        uint32_t baud_rate,
+        const SerialConnectionOptions& options = SerialConnectionOptions()
     )
-        : m_exit(false)
+        : m_event_driven(options.event_driven)
+        , m_exit(false)
+        , m_consecutive_errors(0)
+        , m_send_buffer(m_event_driven ? std::max<size_t>(options.send_buffer_size, 1) : 0)
+        , m_send_head(0)
+        , m_send_buffered(0)
+        , m_send_queued_total(0)
+        , m_send_written_total(0)
+        , m_send_pending(false)
+        , m_latency_report_interval(options.latency_report_interval)
+        , m_last_latency_report(std::chrono::steady_clock::now())
     {
 //        std::cout << "desired baud = " << baud << std::endl;
 
+        int flags = O_RDWR | O_NOCTTY;
+        if (m_event_driven){
+            flags |= O_NONBLOCK;
+        }
         if (name.starts_with("/dev/")){
-            m_fd = open(name.c_str(), O_RDWR | O_NOCTTY);
+            m_fd = open(name.c_str(), flags);
         }else{
-            m_fd = open(("/dev/"+name).c_str(), O_RDWR | O_NOCTTY);
+            m_fd = open(("/dev/"+name).c_str(), flags);
         }
         if (m_fd == -1){
             int error = errno;
@@ -53,7 +105,28 @@ public:
             throw ConnectionException(nullptr, std::move(str));
         }
 
-        set_baud_rate(baud_rate);
+        try{
+            set_baud_rate(baud_rate);
+        }catch (...){
+            close(m_fd);
+            throw;
+        }
+
+        if (options.low_latency){
+            set_low_latency();
+        }
+
+        //  The receiver thread sleeps in poll() on this pipe as well as the
+        //  device so that it can be woken up to write or to exit.
+        if (m_event_driven){
+            if (pipe(m_wake_pipe) == -1){
+                int error = errno;
+                close(m_fd);
+                throw ConnectionException(nullptr, "pipe() failed. Error = " + std::to_string(error));
+            }
+            fcntl(m_wake_pipe[0], F_SETFL, fcntl(m_wake_pipe[0], F_GETFL) | O_NONBLOCK);
+            fcntl(m_wake_pipe[1], F_SETFL, fcntl(m_wake_pipe[1], F_GETFL) | O_NONBLOCK);
+        }
 
 #if 0
         int flags;
@@ -70,11 +143,17 @@ public:
             m_listener = thread_pool.dispatch_now_blocking([this]{
                 run_with_catch(
                     "SerialConnection::SerialConnection()",
-                    [this]{ recv_loop(); }
+                    [this]{
+                        if (m_event_driven){
+                            event_loop();
+                        }else{
+                            recv_loop();
+                        }
+                    }
                 );
             });
         }catch (...){
-            close(m_fd);
+            close_fds();
             throw;
         }
     }
@@ -87,8 +166,23 @@ public:
 
     virtual void stop() noexcept final{
         m_exit.store(true, std::memory_order_release);
-        close(m_fd);
+        if (!m_event_driven){
+            close(m_fd);
+            m_listener.wait_and_ignore_exceptions();
+            report_latency();
+            return;
+        }
+
+        //  Closing a file descriptor that another thread is polling is not
+        //  reliable. So wake it up and let it exit before closing anything.
+        wake_event_loop();
+        {
+            std::lock_guard<Mutex> lg(m_send_buffer_lock);
+            m_send_cv.notify_all();
+        }
         m_listener.wait_and_ignore_exceptions();
+        report_latency();
+        close_fds();
     }
 
     void set_baud_rate(uint32_t baud_rate){
@@ -246,6 +340,30 @@ public:
         }
     }
 
+    //  Set ASYNC_LOW_LATENCY on the port. This is best effort since many
+    //  drivers don't support it.
+    void set_low_latency(){
+#ifdef __linux__
+        struct serial_struct serial;
+        if (ioctl(m_fd, TIOCGSERIAL, &serial) < 0){
+            int error = errno;
+            if (error == ENOTTY || error == EINVAL){
+                return;
+            }
+            serial_debug_log("Unable to read serial settings for low latency mode. Error = " + std::to_string(error));
+            return;
+        }
+        if (serial.flags & ASYNC_LOW_LATENCY){
+            return;
+        }
+        serial.flags |= ASYNC_LOW_LATENCY;
+        if (ioctl(m_fd, TIOCSSERIAL, &serial) < 0){
+            int error = errno;
+            serial_debug_log("Unable to enable low latency mode. Error = " + std::to_string(error));
+        }
+#endif
+    }
+
 
 private:
     // Send data, retrying until all bytes are sent or connection is closed.
@@ -256,9 +374,18 @@ private:
     // 2. There is an error. (returns less than bytes)
     // 3. The SerialConnection instance is getting destructed from a different thread.
     // If consecutive connection errors reache 100, throw ConnectionException.
+    //
+    // In event-driven mode, the data is queued instead and this only blocks
+    // while the outgoing buffer is full. (see send_buffered())
     virtual size_t unreliable_send(const void* data, size_t bytes) noexcept override{
         WriteSpinLock lg(m_send_lock, "SerialConnection::send()");
 
+        if (m_event_driven){
+            return send_buffered((const char*)data, bytes);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
         const char* ptr = (const char*)data;
         size_t remaining = bytes;
 
@@ -291,6 +418,7 @@ private:
 
         if (remaining == 0){
             m_consecutive_errors.store(0, std::memory_order_release);
+            m_tx_latency.record(std::chrono::steady_clock::now() - start);
         }
 
         return bytes - remaining;
@@ -311,8 +439,10 @@ private:
         while (!m_exit.load(std::memory_order_acquire)){
             ssize_t actual = read(m_fd, buffer, sizeof(buffer));
             if (actual > 0){
+                auto received = std::chrono::steady_clock::now();
                 m_consecutive_errors.store(0, std::memory_order_release);
                 on_unreliable_recv(buffer, actual);
+                m_rx_latency.record(std::chrono::steady_clock::now() - received);
             } else if (actual < 0){
                 // Read error occurred
                 int error = errno;
@@ -320,9 +450,272 @@ private:
                 usleep(1000);
             }
             // actual == 0: timeout, no data received - just loop again to check m_exit
+            report_latency_if_due();
         }
     }
-    
+
+
+private:
+    //  Event-driven mode.
+
+    //  Append the data to the outgoing buffer and write as much of it as the
+    //  device will take right now. Whatever is left gets written by the event
+    //  loop as soon as the device is writable. This only blocks if the buffer
+    //  is full. Returns the # of bytes accepted.
+    //
+    //  Listeners can send from the event loop itself. (e.g. acks from the
+    //  reliable layer) The event loop can't drain the buffer for them, so
+    //  they wait on the device directly instead.
+    size_t send_buffered(const char* data, size_t bytes){
+        auto start = std::chrono::steady_clock::now();
+
+        std::unique_lock<Mutex> lg(m_send_buffer_lock);
+        size_t accepted = 0;
+        while (accepted < bytes && !m_exit.load(std::memory_order_acquire)){
+            size_t space = m_send_buffer.size() - m_send_buffered;
+            if (space == 0){
+                flush_send_buffer();
+                if (m_send_buffered != m_send_buffer.size()){
+                    continue;
+                }
+                if (std::this_thread::get_id() == m_event_loop_thread.load(std::memory_order_acquire)){
+                    wait_until_writable(lg);
+                }else{
+                    m_send_pending.store(true, std::memory_order_release);
+                    wake_event_loop();
+                    m_send_cv.wait(lg);
+                }
+                continue;
+            }
+
+            size_t block = std::min(space, bytes - accepted);
+            size_t tail = (m_send_head + m_send_buffered) % m_send_buffer.size();
+            size_t first = std::min(block, m_send_buffer.size() - tail);
+            memcpy(m_send_buffer.data() + tail, data + accepted, first);
+            memcpy(m_send_buffer.data(), data + accepted + first, block - first);
+            m_send_buffered += block;
+            m_send_queued_total += block;
+            accepted += block;
+        }
+        if (accepted > 0){
+            m_send_marks.emplace_back(SendMark{m_send_queued_total, start});
+        }
+
+        flush_send_buffer();
+        if (m_send_buffered != 0){
+            m_send_pending.store(true, std::memory_order_release);
+            wake_event_loop();
+        }
+        return accepted;
+    }
+
+    //  Must call under "m_send_buffer_lock".
+    void flush_send_buffer(){
+        while (m_send_buffered != 0){
+            size_t block = std::min(m_send_buffered, m_send_buffer.size() - m_send_head);
+            ssize_t sent = write(m_fd, m_send_buffer.data() + m_send_head, block);
+            if (sent > 0){
+                m_send_head = (m_send_head + sent) % m_send_buffer.size();
+                m_send_buffered -= sent;
+                m_send_written_total += sent;
+                continue;
+            }
+
+            int error = errno;
+            if (sent < 0 && error == EINTR){
+                continue;
+            }
+            if (sent == 0 || error == EAGAIN || error == EWOULDBLOCK){
+                break;
+            }
+
+            //  The connection is unreliable anyway. Drop what's queued so a
+            //  broken device doesn't keep the event loop spinning.
+            process_error(
+                "Failed to write: " + std::to_string(m_send_buffered) +
+                " bytes dropped, error = " + std::to_string(error)
+            );
+            m_send_head = 0;
+            m_send_buffered = 0;
+            m_send_written_total = m_send_queued_total;
+            m_send_marks.clear();
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        while (!m_send_marks.empty() && m_send_marks.front().end <= m_send_written_total){
+            m_consecutive_errors.store(0, std::memory_order_release);
+            m_tx_latency.record(now - m_send_marks.front().time);
+            m_send_marks.pop_front();
+        }
+
+        m_send_pending.store(m_send_buffered != 0, std::memory_order_release);
+        if (m_send_buffered < m_send_buffer.size()){
+            m_send_cv.notify_all();
+        }
+    }
+
+    //  Event loop only. Sleep until the device can take more data or someone
+    //  wakes up the event loop.
+    void wait_until_writable(std::unique_lock<Mutex>& lg){
+        pollfd fds[2];
+        fds[0].fd = m_fd;
+        fds[0].events = POLLOUT;
+        fds[0].revents = 0;
+        fds[1].fd = m_wake_pipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        lg.unlock();
+        int ret = poll(fds, 2, -1);
+        if (ret < 0){
+            int error = errno;
+            if (error != EINTR){
+                process_error("poll() failed. Error = " + std::to_string(error));
+                usleep(1000);
+            }
+        }else if (fds[1].revents & POLLIN){
+            //  The event loop polls everything again once we return.
+            char buffer[64];
+            while (read(m_wake_pipe[0], buffer, sizeof(buffer)) > 0);
+        }
+        lg.lock();
+    }
+
+    void wake_event_loop(){
+        char ch = 0;
+        //  If the pipe is full, there's already a wake-up pending.
+        (void)!write(m_wake_pipe[1], &ch, 1);
+    }
+
+    //  Runs on the receiver thread. Sleeps until the device has data, the
+    //  device can take more of the outgoing buffer, or someone wakes it up.
+    void event_loop(){
+        m_event_loop_thread.store(std::this_thread::get_id(), std::memory_order_release);
+        while (!m_exit.load(std::memory_order_acquire)){
+            pollfd fds[2];
+            fds[0].fd = m_fd;
+            fds[0].events = POLLIN;
+            if (m_send_pending.load(std::memory_order_acquire)){
+                fds[0].events |= POLLOUT;
+            }
+            fds[0].revents = 0;
+            fds[1].fd = m_wake_pipe[0];
+            fds[1].events = POLLIN;
+            fds[1].revents = 0;
+
+            int timeout = m_latency_report_interval.count() == 0 ? -1 : 1000;
+            int ret = poll(fds, 2, timeout);
+            auto woken = std::chrono::steady_clock::now();
+            if (ret < 0){
+                int error = errno;
+                if (error != EINTR){
+                    process_error("poll() failed. Error = " + std::to_string(error));
+                    usleep(1000);
+                }
+                continue;
+            }
+
+            if (fds[1].revents & POLLIN){
+                char buffer[64];
+                while (read(m_wake_pipe[0], buffer, sizeof(buffer)) > 0);
+            }
+            if (m_exit.load(std::memory_order_acquire)){
+                break;
+            }
+
+            if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)){
+                read_available(woken, fds[0].revents);
+            }
+            if (fds[0].revents & POLLNVAL){
+                process_error("poll() reports an invalid serial handle.");
+                usleep(1000);
+            }
+            if (fds[0].revents & POLLOUT){
+                std::lock_guard<Mutex> lg(m_send_buffer_lock);
+                flush_send_buffer();
+            }
+
+            report_latency_if_due();
+        }
+    }
+    void read_available(std::chrono::steady_clock::time_point woken, short revents){
+        char buffer[256];
+        bool received = false;
+        while (true){
+            ssize_t actual = read(m_fd, buffer, sizeof(buffer));
+            if (actual > 0){
+                received = true;
+                m_consecutive_errors.store(0, std::memory_order_release);
+                on_unreliable_recv(buffer, actual);
+                m_rx_latency.record(std::chrono::steady_clock::now() - woken);
+                if ((size_t)actual < sizeof(buffer)){
+                    return;
+                }
+                continue;
+            }
+
+            int error = errno;
+            if (actual < 0 && error == EINTR){
+                continue;
+            }
+            if (actual < 0 && error != EAGAIN && error != EWOULDBLOCK){
+                process_error("read serial POSIX() failed. Error = " + std::to_string(error));
+                usleep(1000);
+                return;
+            }
+
+            //  Nothing more to read. If the device hung up, don't spin on it.
+            if (!received && (revents & (POLLHUP | POLLERR))){
+                process_error("Serial device hung up.");
+                usleep(1000);
+            }
+            return;
+        }
+    }
+
+    void close_fds(){
+        close(m_fd);
+        if (m_wake_pipe[0] != -1){
+            close(m_wake_pipe[0]);
+            close(m_wake_pipe[1]);
+            m_wake_pipe[0] = -1;
+            m_wake_pipe[1] = -1;
+        }
+    }
+
+
+private:
+    //  Both modes.
+    //
+    //  RX latency is from the moment data is available until the listeners
+    //  have finished with it. TX latency is from unreliable_send() until the
+    //  last byte has been handed to the driver.
+
+    void report_latency_if_due(){
+        if (m_latency_report_interval.count() == 0){
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_last_latency_report < m_latency_report_interval){
+            return;
+        }
+        m_last_latency_report = now;
+        report_latency();
+    }
+    void report_latency(){
+        if (m_latency_report_interval.count() == 0){
+            return;
+        }
+        SerialLatencyHistogram::Snapshot rx = m_rx_latency.take();
+        SerialLatencyHistogram::Snapshot tx = m_tx_latency.take();
+        if (rx.samples == 0 && tx.samples == 0){
+            return;
+        }
+        serial_debug_log("Serial RX latency: " + rx.to_str());
+        serial_debug_log("Serial TX latency: " + tx.to_str());
+    }
+
 
 private:
     void process_error(const std::string& message){
@@ -340,11 +733,36 @@ private:
 
 
 private:
+    struct SendMark{
+        uint64_t end;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    const bool m_event_driven;
     int m_fd;
+    int m_wake_pipe[2] = {-1, -1};
     std::atomic<bool> m_exit;
     std::atomic<size_t> m_consecutive_errors;
     SpinLock m_send_lock;
     SpinLock m_error_lock;
+
+    //  Outgoing ring buffer for the event-driven mode.
+    Mutex m_send_buffer_lock;
+    ConditionVariable m_send_cv;
+    std::vector<char> m_send_buffer;
+    size_t m_send_head;
+    size_t m_send_buffered;
+    uint64_t m_send_queued_total;
+    uint64_t m_send_written_total;
+    std::deque<SendMark> m_send_marks;
+    std::atomic<bool> m_send_pending;
+    std::atomic<std::thread::id> m_event_loop_thread;
+
+    SerialLatencyHistogram m_rx_latency;
+    SerialLatencyHistogram m_tx_latency;
+    const std::chrono::seconds m_latency_report_interval;
+    std::chrono::steady_clock::time_point m_last_latency_report;
+
     AsyncTask m_listener;
 };
 
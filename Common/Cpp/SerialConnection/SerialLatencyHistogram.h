@@ -0,0 +1,119 @@
+/*  Serial Latency Histogram
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  Lock-free latency histogram with power-of-two microsecond buckets.
+ *
+ *  Bucket 0 counts everything under 1 us. Bucket i counts [2^(i-1), 2^i) us.
+ *  The last bucket counts everything above that.
+ *
+ */
+
+#ifndef PokemonAutomation_SerialLatencyHistogram_H
+#define PokemonAutomation_SerialLatencyHistogram_H
+
+#include <stdint.h>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace PokemonAutomation{
+
+
+
+class SerialLatencyHistogram{
+public:
+    static constexpr size_t BUCKETS = 24;
+
+    struct Snapshot{
+        uint64_t counts[BUCKETS] = {};
+        uint64_t samples = 0;
+        uint64_t total_us = 0;
+        uint64_t max_us = 0;
+
+        //  Upper bound of the bucket that holds the nearest-rank percentile.
+        //  (the ceil(p * samples)-th smallest sample)
+        uint64_t percentile_us(double p) const{
+            if (samples == 0){
+                return 0;
+            }
+            uint64_t target = (uint64_t)std::ceil(p * samples);
+            target = std::max<uint64_t>(target, 1);
+            target = std::min<uint64_t>(target, samples);
+            uint64_t seen = 0;
+            for (size_t c = 0; c < BUCKETS; c++){
+                seen += counts[c];
+                if (seen >= target){
+                    return c + 1 < BUCKETS ? (uint64_t)1 << c : max_us;
+                }
+            }
+            return max_us;
+        }
+
+        std::string to_str() const{
+            if (samples == 0){
+                return "no samples";
+            }
+            std::string str;
+            str += std::to_string(samples) + " samples";
+            str += ", mean = " + std::to_string(total_us / samples) + " us";
+            str += ", p50 < " + std::to_string(percentile_us(0.50)) + " us";
+            str += ", p99 < " + std::to_string(percentile_us(0.99)) + " us";
+            str += ", max = " + std::to_string(max_us) + " us";
+            str += " |";
+            for (size_t c = 0; c < BUCKETS; c++){
+                if (counts[c] == 0){
+                    continue;
+                }
+                str += " <";
+                str += c + 1 < BUCKETS ? std::to_string((uint64_t)1 << c) : "inf";
+                str += "us:" + std::to_string(counts[c]);
+            }
+            return str;
+        }
+    };
+
+
+public:
+    void record(std::chrono::steady_clock::duration latency){
+        int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        uint64_t x = us < 0 ? 0 : (uint64_t)us;
+
+        size_t bucket = 0;
+        while (bucket + 1 < BUCKETS && x >= ((uint64_t)1 << bucket)){
+            bucket++;
+        }
+
+        m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_samples.fetch_add(1, std::memory_order_relaxed);
+        m_total_us.fetch_add(x, std::memory_order_relaxed);
+        uint64_t max = m_max_us.load(std::memory_order_relaxed);
+        while (x > max && !m_max_us.compare_exchange_weak(max, x, std::memory_order_relaxed));
+    }
+
+    //  Return everything recorded since the last call and start over.
+    Snapshot take(){
+        Snapshot ret;
+        for (size_t c = 0; c < BUCKETS; c++){
+            ret.counts[c] = m_counts[c].exchange(0, std::memory_order_relaxed);
+        }
+        ret.samples = m_samples.exchange(0, std::memory_order_relaxed);
+        ret.total_us = m_total_us.exchange(0, std::memory_order_relaxed);
+        ret.max_us = m_max_us.exchange(0, std::memory_order_relaxed);
+        return ret;
+    }
+
+
+private:
+    std::atomic<uint64_t> m_counts[BUCKETS] = {};
+    std::atomic<uint64_t> m_samples{0};
+    std::atomic<uint64_t> m_total_us{0};
+    std::atomic<uint64_t> m_max_us{0};
+};
+
+
+
+}
+#endif
@@ -0,0 +1,576 @@
+/*  Pseudo-Terminal Device
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef _WIN32
+
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <algorithm>
+#include "Common/Cpp/Exceptions.h"
+#include "Common/SerialPABotBase/SerialPABotBase_Protocol_IDs.h"
+#include "PtyDevice.h"
+
+//#include <iostream>
+//using std::cout;
+//using std::endl;
+
+namespace PokemonAutomation{
+
+using namespace PABotBase2;
+
+
+//  Opcodes at or above this are controller commands that go into the command
+//  queue. They all start with a 16-bit duration in milliseconds.
+static constexpr uint8_t PTY_DEVICE_FIRST_COMMAND_OPCODE = 0x80;
+
+//  How long a held-back packet waits for another packet to overtake it.
+static constexpr WallDuration PTY_DEVICE_REORDER_HOLD = Milliseconds(10);
+
+//  Longest the device thread sleeps so that the firmware retransmits still run.
+static constexpr WallDuration PTY_DEVICE_POLL = Milliseconds(10);
+
+
+
+PtyDevice::Lane::Lane(const PtyDeviceOptions& options, std::mt19937& rng)
+    : m_options(options)
+    , m_rng(rng)
+    , m_dist(0, 1)
+    , m_held_until(WallClock::max())
+    , m_free_at(WallClock::min())
+{}
+void PtyDevice::Lane::push_bytes(const void* data, size_t bytes, WallClock now){
+    m_partial.insert(m_partial.end(), (const uint8_t*)data, (const uint8_t*)data + bytes);
+
+    size_t offset = 0;
+    while (offset < m_partial.size()){
+        const uint8_t* ptr = m_partial.data() + offset;
+        size_t remaining = m_partial.size() - offset;
+
+        //  Not a packet. Pass the garbage through as-is and let the parser on
+        //  the other side resync.
+        if (ptr[0] != PABB2_CONNECTION_MAGIC_NUMBER){
+            size_t garbage = 1;
+            while (garbage < remaining && ptr[garbage] != PABB2_CONNECTION_MAGIC_NUMBER){
+                garbage++;
+            }
+            schedule(std::vector<uint8_t>(ptr, ptr + garbage), now);
+            offset += garbage;
+            continue;
+        }
+
+        if (remaining < sizeof(PacketHeader)){
+            break;
+        }
+        size_t packet_bytes = ((const PacketHeader*)ptr)->packet_bytes;
+        if (packet_bytes == 0){
+            packet_bytes = 256;
+        }
+        if (packet_bytes < sizeof(PacketHeader)){
+            schedule(std::vector<uint8_t>(ptr, ptr + 1), now);
+            offset += 1;
+            continue;
+        }
+        if (remaining < packet_bytes){
+            break;
+        }
+
+        on_packet(std::vector<uint8_t>(ptr, ptr + packet_bytes), now);
+        offset += packet_bytes;
+    }
+    m_partial.erase(m_partial.begin(), m_partial.begin() + offset);
+}
+void PtyDevice::Lane::on_packet(std::vector<uint8_t>&& packet, WallClock now){
+    packets++;
+
+    if (m_options.drop_rate > 0 && m_dist(m_rng) < m_options.drop_rate){
+        dropped++;
+        return;
+    }
+
+    //  This packet overtakes the one being held back.
+    if (!m_held.empty()){
+        schedule(std::move(packet), now);
+        schedule(std::move(m_held), now);
+        m_held.clear();
+        m_held_until = WallClock::max();
+        return;
+    }
+
+    if (m_options.reorder_rate > 0 && m_dist(m_rng) < m_options.reorder_rate){
+        reordered++;
+        m_held = std::move(packet);
+        m_held_until = now + PTY_DEVICE_REORDER_HOLD;
+        return;
+    }
+
+    schedule(std::move(packet), now);
+}
+void PtyDevice::Lane::schedule(std::vector<uint8_t>&& packet, WallClock now){
+    WallClock arrival = std::max(m_free_at, now);
+    if (m_options.baud_rate != 0){
+        //  8N1: 10 bits on the wire per byte.
+        arrival += std::chrono::microseconds(
+            (uint64_t)packet.size() * 10 * 1000000 / m_options.baud_rate
+        );
+    }
+    m_free_at = arrival;
+    m_in_flight.emplace_back(InFlight{arrival, std::move(packet)});
+}
+void PtyDevice::Lane::pop_arrived(std::vector<uint8_t>& out, WallClock now){
+    while (!m_in_flight.empty() && m_in_flight.front().arrival <= now){
+        const std::vector<uint8_t>& data = m_in_flight.front().data;
+        out.insert(out.end(), data.begin(), data.end());
+        m_in_flight.pop_front();
+    }
+}
+void PtyDevice::Lane::flush_held(WallClock now){
+    if (m_held.empty() || now < m_held_until){
+        return;
+    }
+    schedule(std::move(m_held), now);
+    m_held.clear();
+    m_held_until = WallClock::max();
+}
+WallClock PtyDevice::Lane::next_event() const{
+    WallClock ret = m_held_until;
+    if (!m_in_flight.empty()){
+        ret = std::min(ret, m_in_flight.front().arrival);
+    }
+    return ret;
+}
+
+
+
+PtyDevice::PtyDevice(ThreadPool& thread_pool, const PtyDeviceOptions& options)
+    : m_options(options)
+    , m_master_fd(-1)
+    , m_slave_fd(-1)
+    , m_wake_pipe{-1, -1}
+    , m_device_side_connection(*this)
+    , m_connection(m_device_side_connection)
+    , m_rng(options.seed)
+    , m_host_to_device(m_options, m_rng)
+    , m_device_to_host(m_options, m_rng)
+    , m_start(current_time())
+    , m_controller_id(PABB_CID_NintendoSwitch_WiredProController)
+    , m_commands_received(0)
+    , m_commands_finished(0)
+    , m_commands_dropped(0)
+    , m_device_retransmits(0)
+    , m_stopping(false)
+{
+    m_master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (m_master_fd == -1){
+        throw ConnectionException(nullptr, "posix_openpt() failed. Error = " + std::to_string(errno));
+    }
+
+    const char* name = nullptr;
+    if (grantpt(m_master_fd) == 0 && unlockpt(m_master_fd) == 0){
+        name = ptsname(m_master_fd);
+    }
+    if (name == nullptr){
+        int error = errno;
+        close(m_master_fd);
+        throw ConnectionException(nullptr, "Unable to set up pseudo-terminal. Error = " + std::to_string(error));
+    }
+    m_port_name = name;
+
+    //  Keep the slave side open so the master doesn't hang up whenever the
+    //  host closes it. Put it in raw mode so nothing is echoed back before
+    //  the host configures it.
+    m_slave_fd = open(m_port_name.c_str(), O_RDWR | O_NOCTTY);
+    if (m_slave_fd == -1 || pipe(m_wake_pipe) == -1){
+        int error = errno;
+        if (m_slave_fd != -1){
+            close(m_slave_fd);
+        }
+        close(m_master_fd);
+        throw ConnectionException(nullptr, "Unable to open pseudo-terminal. Error = " + std::to_string(error));
+    }
+    struct termios tty;
+    if (tcgetattr(m_slave_fd, &tty) == 0){
+        cfmakeraw(&tty);
+        tcsetattr(m_slave_fd, TCSANOW, &tty);
+    }
+
+    fcntl(m_master_fd, F_SETFL, fcntl(m_master_fd, F_GETFL) | O_NONBLOCK);
+    fcntl(m_wake_pipe[0], F_SETFL, fcntl(m_wake_pipe[0], F_GETFL) | O_NONBLOCK);
+    fcntl(m_wake_pipe[1], F_SETFL, fcntl(m_wake_pipe[1], F_GETFL) | O_NONBLOCK);
+
+    m_device_thread = thread_pool.dispatch_now_blocking([this]{ device_thread(); });
+    m_wire_thread = thread_pool.dispatch_now_blocking([this]{ wire_thread(); });
+}
+PtyDevice::~PtyDevice(){
+    m_stopping.store(true, std::memory_order_release);
+    wake_wire_thread();
+    {
+        std::lock_guard<Mutex> lg(m_device_lock);
+        m_device_wake = true;
+    }
+    m_device_cv.notify_all();
+    m_device_thread.wait_and_ignore_exceptions();
+    m_wire_thread.wait_and_ignore_exceptions();
+
+    close(m_wake_pipe[0]);
+    close(m_wake_pipe[1]);
+    close(m_slave_fd);
+    close(m_master_fd);
+}
+
+PtyDeviceStats PtyDevice::stats() const{
+    PtyDeviceStats ret;
+    {
+        std::lock_guard<Mutex> lg(m_wire_lock);
+        ret.host_to_device_packets = m_host_to_device.packets;
+        ret.host_to_device_dropped = m_host_to_device.dropped;
+        ret.host_to_device_reordered = m_host_to_device.reordered;
+        ret.device_to_host_packets = m_device_to_host.packets;
+        ret.device_to_host_dropped = m_device_to_host.dropped;
+        ret.device_to_host_reordered = m_device_to_host.reordered;
+    }
+    ret.device_retransmits = m_device_retransmits.load(std::memory_order_relaxed);
+    ret.commands_received = m_commands_received.load(std::memory_order_relaxed);
+    ret.commands_finished = m_commands_finished.load(std::memory_order_relaxed);
+    ret.commands_dropped = m_commands_dropped.load(std::memory_order_relaxed);
+    return ret;
+}
+
+
+
+size_t PtyDevice::DeviceSideConnection::unreliable_send(const void* data, size_t bytes) noexcept{
+    PtyDevice& parent = m_parent;
+    try{
+        std::lock_guard<Mutex> lg(parent.m_wire_lock);
+        parent.m_device_to_host.push_bytes(data, bytes, current_time());
+    }catch (...){
+        return 0;
+    }
+    parent.wake_wire_thread();
+    return bytes;
+}
+size_t PtyDevice::DeviceSideConnection::unreliable_recv(void* data, size_t max_bytes, const WallDuration& timeout) noexcept{
+    PtyDevice& parent = m_parent;
+    std::lock_guard<Mutex> lg(parent.m_wire_lock);
+
+    std::vector<uint8_t>& arrived = parent.m_host_to_device_arrived;
+    try{
+        parent.m_host_to_device.pop_arrived(arrived, current_time());
+    }catch (...){}
+
+    size_t bytes = std::min(max_bytes, arrived.size() - parent.m_host_to_device_read);
+    memcpy(data, arrived.data() + parent.m_host_to_device_read, bytes);
+    parent.m_host_to_device_read += bytes;
+    if (parent.m_host_to_device_read == arrived.size()){
+        arrived.clear();
+        parent.m_host_to_device_read = 0;
+    }
+    return bytes;
+}
+
+
+
+void PtyDevice::wake_wire_thread(){
+    char ch = 0;
+    if (write(m_wake_pipe[1], &ch, 1) < 0){
+        //  Pipe is full. The wire thread is already going to wake up.
+    }
+}
+void PtyDevice::wire_thread(){
+    std::vector<uint8_t> to_host;
+    size_t to_host_written = 0;
+    uint8_t buffer[4096];
+
+    while (!m_stopping.load(std::memory_order_acquire)){
+        WallClock now = current_time();
+        WallClock next_event;
+        {
+            std::lock_guard<Mutex> lg(m_wire_lock);
+            m_host_to_device.flush_held(now);
+            m_device_to_host.flush_held(now);
+            m_device_to_host.pop_arrived(to_host, now);
+            next_event = std::min(m_device_to_host.next_event(), m_host_to_device.next_event());
+        }
+
+        //  Write out whatever has reached the host.
+        while (to_host_written < to_host.size()){
+            ssize_t written = write(
+                m_master_fd,
+                to_host.data() + to_host_written,
+                to_host.size() - to_host_written
+            );
+            if (written <= 0){
+                break;
+            }
+            to_host_written += written;
+        }
+        if (to_host_written == to_host.size()){
+            to_host.clear();
+            to_host_written = 0;
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = m_master_fd;
+        fds[0].events = POLLIN;
+        if (!to_host.empty()){
+            fds[0].events |= POLLOUT;
+        }
+        fds[0].revents = 0;
+        fds[1].fd = m_wake_pipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        //  Packets only take a few hundred microseconds at high baud rates so
+        //  the millisecond timeout of poll() is too coarse where we can avoid it.
+#ifdef __linux__
+        struct timespec timeout;
+        struct timespec* timeout_ptr = nullptr;
+        if (next_event != WallClock::max()){
+            auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(next_event - current_time());
+            int64_t ns = std::max<int64_t>(wait.count(), 0);
+            timeout.tv_sec = (time_t)(ns / 1000000000);
+            timeout.tv_nsec = (long)(ns % 1000000000);
+            timeout_ptr = &timeout;
+        }
+        int ret = ppoll(fds, 2, timeout_ptr, nullptr);
+#else
+        int timeout_ms = -1;
+        if (next_event != WallClock::max()){
+            //  Round up so we don't spin until the next event arrives.
+            auto wait = std::chrono::duration_cast<std::chrono::microseconds>(next_event - current_time());
+            timeout_ms = wait.count() <= 0 ? 0 : (int)((wait.count() + 999) / 1000);
+        }
+        int ret = poll(fds, 2, timeout_ms);
+#endif
+        if (ret < 0){
+            if (errno == EINTR){
+                continue;
+            }
+            break;
+        }
+
+        if (fds[1].revents & POLLIN){
+            while (read(m_wake_pipe[0], buffer, sizeof(buffer)) > 0);
+        }
+
+        if (fds[0].revents & POLLIN){
+            ssize_t bytes = read(m_master_fd, buffer, sizeof(buffer));
+            if (bytes > 0){
+                {
+                    std::lock_guard<Mutex> lg(m_wire_lock);
+                    m_host_to_device.push_bytes(buffer, bytes, current_time());
+                }
+                {
+                    std::lock_guard<Mutex> lg(m_device_lock);
+                    m_device_wake = true;
+                }
+                m_device_cv.notify_all();
+            }
+        }
+    }
+}
+
+
+
+void PtyDevice::device_thread(){
+    while (!m_stopping.load(std::memory_order_acquire)){
+        while (m_connection.run_recv_events(Milliseconds(0)));
+
+        process_messages();
+
+        WallClock now = current_time();
+        run_command_queue(now);
+        flush_outbox();
+
+        m_connection.run_send_events(Milliseconds(0));
+        m_device_retransmits.store(m_connection.retransmits(), std::memory_order_relaxed);
+
+        WallClock deadline = now + PTY_DEVICE_POLL;
+        if (!m_command_queue.empty() && m_command_started != WallClock::max()){
+            deadline = std::min(deadline, m_command_started + m_command_queue.front().duration);
+        }
+        {
+            std::lock_guard<Mutex> lg(m_wire_lock);
+            deadline = std::min(deadline, m_host_to_device.next_event());
+        }
+
+        std::unique_lock<Mutex> lg(m_device_lock);
+        m_device_cv.wait_until(lg, deadline, [this]{ return m_device_wake; });
+        m_device_wake = false;
+    }
+}
+
+
+void PtyDevice::process_messages(){
+    char buffer[256];
+    while (true){
+        size_t bytes = m_connection.reliable_recv(buffer, sizeof(buffer));
+        if (bytes == 0){
+            break;
+        }
+        m_recv_buffer.insert(m_recv_buffer.end(), buffer, buffer + bytes);
+    }
+
+    size_t offset = 0;
+    while (m_recv_buffer.size() - offset >= sizeof(MessageHeader)){
+        const MessageHeader* header = (const MessageHeader*)(m_recv_buffer.data() + offset);
+        uint16_t message_bytes;
+        memcpy(&message_bytes, &header->message_bytes, sizeof(uint16_t));
+        if (message_bytes < sizeof(MessageHeader)){
+            //  Stream is corrupted. There's no way to resync.
+            offset = m_recv_buffer.size();
+            break;
+        }
+        if (m_recv_buffer.size() - offset < message_bytes){
+            break;
+        }
+        process_message(header);
+        offset += message_bytes;
+    }
+    m_recv_buffer.erase(m_recv_buffer.begin(), m_recv_buffer.begin() + offset);
+}
+void PtyDevice::process_message(const MessageHeader* message){
+    uint8_t id = message->id;
+    switch (message->opcode){
+    case PABB2_MESSAGE_OPCODE_PROTOCOL_VERSION:
+        send_u32(PABB2_MESSAGE_OPCODE_RET_U32, id, PABB2_MESSAGE_PROTOCOL_VERSION);
+        return;
+    case PABB2_MESSAGE_OPCODE_FIRMWARE_VERSION:
+        send_u32(PABB2_MESSAGE_OPCODE_RET_U32, id, PABB2_MESSAGE_PROTOCOL_VERSION);
+        return;
+    case PABB2_MESSAGE_OPCODE_DEVICE_IDENTIFIER:
+        send_u32(PABB2_MESSAGE_OPCODE_RET_U32, id, PABB_PID_UNSPECIFIED);
+        return;
+    case PABB2_MESSAGE_OPCODE_DEVICE_NAME:{
+        const char NAME[] = "PTY Loopback";
+        send_data(PABB2_MESSAGE_OPCODE_RET_DATA, id, NAME, sizeof(NAME) - 1);
+        return;
+    }
+    case PABB2_MESSAGE_OPCODE_CONTROLLER_LIST:{
+        const pabb_ControllerID LIST[] = {
+            PABB_CID_NintendoSwitch_WiredProController,
+        };
+        send_data(PABB2_MESSAGE_OPCODE_RET_DATA, id, LIST, sizeof(LIST));
+        return;
+    }
+    case PABB2_MESSAGE_OPCODE_CQ_CAPACITY:
+        send_u32(PABB2_MESSAGE_OPCODE_RET_U32, id, m_options.command_queue_capacity);
+        return;
+    case PABB2_MESSAGE_OPCODE_REQUEST_SESSION_NUM:
+        send_u32(PABB2_MESSAGE_OPCODE_RET_U32, id, 0);
+        return;
+    case PABB2_MESSAGE_OPCODE_READ_CONTROLLER_MODE:
+        send_u32(PABB2_MESSAGE_OPCODE_RET_U32, id, m_controller_id);
+        return;
+    case PABB2_MESSAGE_OPCODE_CHANGE_CONTROLLER_MODE:
+    case PABB2_MESSAGE_OPCODE_RESET_TO_CONTROLLER:
+        if (message->message_bytes >= sizeof(Message_u32)){
+            memcpy(&m_controller_id, &((const Message_u32*)message)->data, sizeof(uint32_t));
+        }
+        return;
+    case PABB2_MESSAGE_OPCODE_SET_LOGGING_FLAG:
+        return;
+    case PABB2_MESSAGE_OPCODE_CQ_CANCEL:
+        m_command_queue.clear();
+        m_command_started = WallClock::max();
+        m_replace_on_next = false;
+        return;
+    case PABB2_MESSAGE_OPCODE_CQ_REPLACE_ON_NEXT:
+        m_replace_on_next = true;
+        return;
+    }
+
+    if (message->opcode < PTY_DEVICE_FIRST_COMMAND_OPCODE ||
+        message->message_bytes < sizeof(MessageHeader) + sizeof(uint16_t)
+    ){
+        return;
+    }
+
+    m_commands_received.fetch_add(1, std::memory_order_relaxed);
+
+    if (m_replace_on_next){
+        m_command_queue.clear();
+        m_command_started = WallClock::max();
+        m_replace_on_next = false;
+    }
+
+    if (m_command_queue.size() >= m_options.command_queue_capacity){
+        m_commands_dropped.fetch_add(1, std::memory_order_relaxed);
+        MessageHeader dropped;
+        dropped.message_bytes = sizeof(MessageHeader);
+        dropped.opcode = PABB2_MESSAGE_OPCODE_CQ_COMMAND_DROPPED;
+        dropped.id = id;
+        send_message(&dropped, sizeof(dropped));
+        return;
+    }
+
+    uint16_t milliseconds;
+    memcpy(&milliseconds, message + 1, sizeof(uint16_t));
+    m_command_queue.emplace_back(Command{id, Milliseconds(milliseconds)});
+}
+void PtyDevice::run_command_queue(WallClock now){
+    while (!m_command_queue.empty()){
+        if (m_command_started == WallClock::max()){
+            m_command_started = now;
+        }
+        WallClock end = m_command_started + m_command_queue.front().duration;
+        if (now < end){
+            return;
+        }
+
+        uint32_t timestamp = (uint32_t)std::chrono::duration_cast<Milliseconds>(end - m_start).count();
+        send_u32(PABB2_MESSAGE_OPCODE_CQ_COMMAND_FINISHED, m_command_queue.front().id, timestamp);
+        m_commands_finished.fetch_add(1, std::memory_order_relaxed);
+
+        //  Back-to-back commands start when the previous one ends, not when we
+        //  get around to it.
+        m_command_queue.pop_front();
+        m_command_started = m_command_queue.empty() ? WallClock::max() : end;
+    }
+}
+
+
+void PtyDevice::send_message(const void* data, size_t bytes){
+    m_outbox.emplace_back((const char*)data, bytes);
+    flush_outbox();
+}
+void PtyDevice::send_u32(uint8_t opcode, uint8_t id, uint32_t data){
+    Message_u32 message;
+    message.message_bytes = sizeof(Message_u32);
+    message.opcode = opcode;
+    message.id = id;
+    message.data = data;
+    send_message(&message, sizeof(message));
+}
+void PtyDevice::send_data(uint8_t opcode, uint8_t id, const void* data, size_t bytes){
+    MessageHeader header;
+    header.message_bytes = (uint16_t)(sizeof(MessageHeader) + bytes);
+    header.opcode = opcode;
+    header.id = id;
+    std::string message((const char*)&header, sizeof(header));
+    message.append((const char*)data, bytes);
+    send_message(message.data(), message.size());
+}
+void PtyDevice::flush_outbox(){
+    //  Keep them in order. If the send buffer is full, the rest waits for the
+    //  next round.
+    while (!m_outbox.empty()){
+        const std::string& message = m_outbox.front();
+        if (!m_connection.reliable_send_all_or_nothing(message.data(), message.size())){
+            return;
+        }
+        m_outbox.pop_front();
+    }
+}
+
+
+
+}
+#endif
@@ -0,0 +1,212 @@
+/*  Pseudo-Terminal Device
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  A stand-in for a PABotBase2 microcontroller that sits on the other end of
+ *  a pseudo-terminal. Open "port_name()" with a normal SerialConnection and
+ *  the whole host stack (SerialConnection -> ReliableStreamConnection ->
+ *  DeviceHandle -> CommandQueueManager) runs against it as if it were real
+ *  hardware.
+ *
+ *  The device side runs the firmware's ReliableStreamConnectionFW and answers
+ *  the device queries. Controller commands go into a simulated command queue
+ *  that finishes each one after its duration.
+ *
+ *  The wire between them is simulated per packet in both directions:
+ *    - Packets take (10 bits per byte / baud rate) to go across.
+ *    - Each packet is dropped with probability "drop_rate".
+ *    - Each packet is held back and sent after the next one with probability
+ *      "reorder_rate".
+ *
+ *  POSIX only.
+ *
+ */
+
+#ifndef PokemonAutomation_PtyDevice_H
+#define PokemonAutomation_PtyDevice_H
+
+#ifndef _WIN32
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <random>
+#include "Common/Cpp/Time.h"
+#include "Common/Cpp/Concurrency/Mutex.h"
+#include "Common/Cpp/Concurrency/ConditionVariable.h"
+#include "Common/Cpp/Concurrency/AsyncTask.h"
+#include "Common/Cpp/Concurrency/ThreadPool.h"
+#include "Common/Cpp/StreamConnections/PollingStreamConnections.h"
+#include "Common/PABotBase2/PABotBase2_MessageProtocol.h"
+#include "Common/PABotBase2/ReliableConnectionLayer/PABotBase2FW_ReliableStreamConnection.h"
+
+namespace PokemonAutomation{
+
+
+
+struct PtyDeviceOptions{
+    //  Zero means the wire has no speed limit.
+    uint32_t baud_rate = 921600;
+
+    double drop_rate = 0;
+    double reorder_rate = 0;
+
+    //  Capacity reported by the command queue.
+    uint32_t command_queue_capacity = 32;
+
+    uint32_t seed = 0;
+};
+
+struct PtyDeviceStats{
+    uint64_t host_to_device_packets = 0;
+    uint64_t host_to_device_dropped = 0;
+    uint64_t host_to_device_reordered = 0;
+
+    uint64_t device_to_host_packets = 0;
+    uint64_t device_to_host_dropped = 0;
+    uint64_t device_to_host_reordered = 0;
+
+    uint32_t device_retransmits = 0;
+
+    uint64_t commands_received = 0;
+    uint64_t commands_finished = 0;
+    uint64_t commands_dropped = 0;
+};
+
+
+
+class PtyDevice{
+public:
+    PtyDevice(ThreadPool& thread_pool, const PtyDeviceOptions& options = PtyDeviceOptions());
+    ~PtyDevice();
+
+    //  Path of the pseudo-terminal for the host to open.
+    const std::string& port_name() const{
+        return m_port_name;
+    }
+
+    PtyDeviceStats stats() const;
+
+
+private:
+    //  One direction of the simulated wire.
+    class Lane{
+    public:
+        Lane(const PtyDeviceOptions& options, std::mt19937& rng);
+
+        //  Push raw bytes into the wire. They are split into packets and each
+        //  packet is scheduled for delivery.
+        void push_bytes(const void* data, size_t bytes, WallClock now);
+
+        //  Pop everything that has arrived by "now".
+        void pop_arrived(std::vector<uint8_t>& out, WallClock now);
+
+        //  Release the held-back packet if nothing came to overtake it.
+        void flush_held(WallClock now);
+
+        //  The next time something will arrive. Or WallClock::max() if none.
+        WallClock next_event() const;
+
+        uint64_t packets = 0;
+        uint64_t dropped = 0;
+        uint64_t reordered = 0;
+
+    private:
+        void on_packet(std::vector<uint8_t>&& packet, WallClock now);
+        void schedule(std::vector<uint8_t>&& packet, WallClock now);
+
+    private:
+        struct InFlight{
+            WallClock arrival;
+            std::vector<uint8_t> data;
+        };
+
+        const PtyDeviceOptions& m_options;
+        std::mt19937& m_rng;
+        std::uniform_real_distribution<double> m_dist;
+
+        std::vector<uint8_t> m_partial;
+        std::vector<uint8_t> m_held;
+        WallClock m_held_until;
+        WallClock m_free_at;
+        std::deque<InFlight> m_in_flight;
+    };
+
+    class DeviceSideConnection : public UnreliableStreamConnectionPolling{
+    public:
+        DeviceSideConnection(PtyDevice& parent) : m_parent(parent) {}
+        virtual size_t unreliable_send(const void* data, size_t bytes) noexcept override;
+        virtual size_t unreliable_recv(void* data, size_t max_bytes, const WallDuration& timeout) noexcept override;
+    private:
+        PtyDevice& m_parent;
+    };
+
+    struct Command{
+        uint8_t id;
+        WallDuration duration;
+    };
+
+
+private:
+    void wake_wire_thread();
+    void wire_thread();
+    void device_thread();
+
+    //  Device thread only.
+    void process_messages();
+    void process_message(const PABotBase2::MessageHeader* message);
+    void run_command_queue(WallClock now);
+    void send_message(const void* data, size_t bytes);
+    void send_u32(uint8_t opcode, uint8_t id, uint32_t data);
+    void send_data(uint8_t opcode, uint8_t id, const void* data, size_t bytes);
+    void flush_outbox();
+
+
+private:
+    const PtyDeviceOptions m_options;
+    std::string m_port_name;
+    int m_master_fd;
+    int m_slave_fd;
+    int m_wake_pipe[2];
+
+    DeviceSideConnection m_device_side_connection;
+    PABotBase2::ReliableStreamConnectionFW m_connection;
+
+    //  Protects everything on the wire.
+    mutable Mutex m_wire_lock;
+    std::mt19937 m_rng;
+    Lane m_host_to_device;
+    Lane m_device_to_host;
+    std::vector<uint8_t> m_host_to_device_arrived;
+    size_t m_host_to_device_read = 0;
+
+    //  Device thread only.
+    const WallClock m_start;
+    std::vector<char> m_recv_buffer;
+    std::deque<std::string> m_outbox;
+    std::deque<Command> m_command_queue;
+    WallClock m_command_started = WallClock::max();
+    bool m_replace_on_next = false;
+    uint32_t m_controller_id;
+
+    std::atomic<uint64_t> m_commands_received;
+    std::atomic<uint64_t> m_commands_finished;
+    std::atomic<uint64_t> m_commands_dropped;
+    std::atomic<uint32_t> m_device_retransmits;
+
+    std::atomic<bool> m_stopping;
+
+    Mutex m_device_lock;
+    ConditionVariable m_device_cv;
+    bool m_device_wake = false;
+    AsyncTask m_device_thread;
+    AsyncTask m_wire_thread;
+};
+
+
+
+}
+#endif
+#endif
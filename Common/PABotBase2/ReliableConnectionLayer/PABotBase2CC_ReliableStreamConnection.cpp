@@ -83,6 +83,10 @@ size_t ReliableStreamConnection::pending() const{
     std::unique_lock<Mutex> lg(m_lock);
     return m_reliable_sender.slots_used();
 }
+uint32_t ReliableStreamConnection::retransmits() const{
+    std::unique_lock<Mutex> lg(m_lock);
+    return m_reliable_sender.retransmits();
+}
 bool ReliableStreamConnection::wait_for_pending(WallDuration timeout){
     std::unique_lock<Mutex> lg(m_lock);
     if (timeout == WallDuration::max()){
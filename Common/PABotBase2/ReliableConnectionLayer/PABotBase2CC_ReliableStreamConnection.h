@@ -59,6 +59,7 @@ public:
     }
 
     size_t pending() const;
+    uint32_t retransmits() const;
     bool wait_for_pending(WallDuration timeout = WallDuration::max());
 
 
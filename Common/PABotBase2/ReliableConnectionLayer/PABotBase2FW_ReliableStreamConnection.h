@@ -49,6 +49,9 @@ public:
     bool has_unacked_sends() const{
         return m_reliable_sender.slots_used() != 0;
     }
+    uint32_t retransmits() const{
+        return m_reliable_sender.retransmits();
+    }
 
 
 public:
@@ -26,6 +26,7 @@ PacketSender::PacketSender(
 )
     : m_connection(connection)
     , m_max_packet_size(max_packet_size)
+    , m_retransmits(0)
 {
     reset(0);
 }
@@ -36,6 +37,7 @@ PacketSender::PacketSender(
 )
     : m_connection(connection)
     , m_max_packet_size(max_packet_size)
+    , m_retransmits(0)
 {
     reset(session_id);
 }
@@ -331,6 +333,7 @@ bool PacketSender::iterate_retransmits() noexcept{
             packet_bytes == 0 ? (size_t)256 : (size_t)packet_bytes
         );
         packet->magic_number = seqnum;
+        m_retransmits++;
         return true;
     }
 
@@ -72,6 +72,11 @@ public:
         return m_slot_tail - m_slot_head;
     }
 
+    //  Total number of packets retransmitted. This is not cleared by "reset()".
+    uint32_t retransmits() const{
+        return m_retransmits;
+    }
+
     void print(bool ascii) const;
 
 
@@ -185,6 +190,8 @@ private:
 
     bool m_stream_corrupted;
 
+    uint32_t m_retransmits;
+
     //  If non-zero, it indicates we are in the middle of sending stream bytes.
     //  The current packet must be finished before sending anything else.
 //    uint8_t m_pending_stream;
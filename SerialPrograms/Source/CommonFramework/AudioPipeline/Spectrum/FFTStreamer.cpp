@@ -4,15 +4,27 @@
  *
  */
 
+#include <atomic>
+#include <set>
 #include "Common/Cpp/Exceptions.h"
 #include "Common/Cpp/Containers/AlignedVector.tpp"
 #include "Kernels/AbsFFT/Kernels_AbsFFT.h"
 #include "CommonFramework/AudioPipeline/AudioConstants.h"
+#include "Tests/TestUtils.h"
 #include "FFTStreamer.h"
 
 namespace PokemonAutomation{
 
 
+//  Most windows to transform in one batch.
+const size_t FFT_MAX_BATCH = 8;
+
+//  Most output buffers to keep for reuse. The audio session holds onto a
+//  history of spectrums. Beyond this, buffers are allocated and freed as
+//  before.
+const size_t FFT_OUTPUT_POOL_LIMIT = 512;
+
+
 
 std::unique_ptr<AudioFloatToFFT> make_FFT_streamer(AudioChannelFormat format){
     switch (format){
@@ -44,20 +56,27 @@ void AudioFloatToFFT::remove_listener(FFTListener& listener){
 
 AudioFloatToFFT::AudioFloatToFFT(
     size_t sample_rate,
-    size_t samples_per_frame, bool average_pairs
+    size_t samples_per_frame, bool average_pairs,
+    size_t hop
 )
     : AudioFloatStreamListener(samples_per_frame)
     , m_sample_rate(sample_rate)
     , m_average(average_pairs)
     , m_fft_sample_size(average_pairs ? 2 : 1)
-    , m_buffer(NUM_FFT_SAMPLES)
+    , m_hop(hop)
+    , m_buffer(NUM_FFT_SAMPLES + (FFT_MAX_BATCH - 1) * hop)
     , m_buffered(NUM_FFT_SAMPLES)
+    , m_end(NUM_FFT_SAMPLES)
     , m_fft_input(NUM_FFT_SAMPLES)
 {
     if (samples_per_frame == 0 || samples_per_frame > 2){
         throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Channels must be 1 or 2.");
     }
+    if (hop == 0 || hop > NUM_FFT_SAMPLES){
+        throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Invalid FFT hop size: " + std::to_string(hop));
+    }
     memset(m_buffer.data(), 0, m_buffer.size() * sizeof(float));
+    m_batch.reserve(FFT_MAX_BATCH);
 }
 AudioFloatToFFT::~AudioFloatToFFT(){}
 void AudioFloatToFFT::on_samples(const float* data, size_t frames){
@@ -65,7 +84,7 @@ void AudioFloatToFFT::on_samples(const float* data, size_t frames){
     const float* ptr = data;
     while (frames > 0){
         //  Figure out how much space we can write contiguously.
-        size_t block = m_buffer.size() - std::max(m_buffered, m_end);
+        size_t block = std::min(m_buffer.size() - m_buffered, m_buffer.size() - m_end);
 
         //  Don't write more than we have.
         block = std::min(block, frames);
@@ -82,13 +101,14 @@ void AudioFloatToFFT::on_samples(const float* data, size_t frames){
         ptr += block * m_fft_sample_size;
         frames -= block;
 
-        //  Buffer is full. Time to run FFT!
+        //  Buffer is full. Run all the windows in it before taking more.
         if (m_buffered == m_buffer.size()){
-//            cout << "run_fft()" << endl;
-            run_fft();
-            drop_from_front(FFT_SLIDING_WINDOW_STEP);
+            run_ffts();
         }
     }
+
+    //  Don't hold onto completed windows until the next call.
+    run_ffts();
 }
 void AudioFloatToFFT::convert(float* fft_input, const float* audio_stream, size_t frames){
     if (!m_average){
@@ -99,26 +119,62 @@ void AudioFloatToFFT::convert(float* fft_input, const float* audio_stream, size_
         fft_input[c] = (audio_stream[2*c + 0] + audio_stream[2*c + 1]) * 0.5f;
     }
 }
-void AudioFloatToFFT::run_fft(){
-    float* ptr = m_fft_input.data();
-    size_t remaining = NUM_FFT_SAMPLES;
-    size_t index = m_start;
-    while (remaining > 0){
-        size_t block = std::min(remaining, m_buffer.size() - index);
-        memcpy(ptr, &m_buffer[index], block * sizeof(float));
-        ptr += block;
-        remaining -= block;
-        index += block;
-        if (index == m_buffer.size()){
-            index = 0;
+std::shared_ptr<AlignedVector<float>> AudioFloatToFFT::get_output_buffer(){
+    //  Buffers are released in roughly the order they were handed out. So
+    //  start looking after the last one that was reused.
+    size_t size = m_pool.size();
+    for (size_t c = 0; c < size; c++){
+        size_t index = m_pool_next + c;
+        if (index >= size){
+            index -= size;
         }
+        std::shared_ptr<AlignedVector<float>>& item = m_pool[index];
+        if (item.use_count() == 1){
+            //  Pair with the release by whichever thread dropped the last
+            //  other reference before we write into the buffer.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            m_pool_next = index + 1 == size ? 0 : index + 1;
+            return item;
+        }
+    }
+
+    std::shared_ptr<AlignedVector<float>> out = std::make_shared<AlignedVector<float>>(NUM_FFT_SAMPLES / 2);
+    if (size < FFT_OUTPUT_POOL_LIMIT){
+        m_pool.emplace_back(out);
     }
-    std::shared_ptr<AlignedVector<float>> out = std::make_unique<AlignedVector<float>>(NUM_FFT_SAMPLES / 2);
-    Kernels::AbsFFT::fft_abs(FFT_LENGTH_POWER_OF_TWO, out->data(), m_fft_input.data());
-    m_listeners.run_method(
-        &FFTListener::on_fft,
-        m_sample_rate, out
-    );
+    return out;
+}
+void AudioFloatToFFT::run_ffts(){
+    while (m_buffered >= NUM_FFT_SAMPLES){
+        float* ptr = m_fft_input.data();
+        size_t remaining = NUM_FFT_SAMPLES;
+        size_t index = m_start;
+        while (remaining > 0){
+            size_t block = std::min(remaining, m_buffer.size() - index);
+            memcpy(ptr, &m_buffer[index], block * sizeof(float));
+            ptr += block;
+            remaining -= block;
+            index += block;
+            if (index == m_buffer.size()){
+                index = 0;
+            }
+        }
+        std::shared_ptr<AlignedVector<float>> out = get_output_buffer();
+        Kernels::AbsFFT::fft_abs(FFT_LENGTH_POWER_OF_TWO, out->data(), m_fft_input.data());
+        m_batch.emplace_back(std::move(out));
+        drop_from_front(m_hop);
+    }
+    if (m_batch.empty()){
+        return;
+    }
+
+    m_listeners.run_on_all([&](FFTListener& listener){
+        for (const std::shared_ptr<const AlignedVector<float>>& spectrum : m_batch){
+            listener.on_fft(m_sample_rate, spectrum);
+        }
+        return false;
+    });
+    m_batch.clear();
 }
 void AudioFloatToFFT::drop_from_front(size_t frames){
     if (frames >= m_buffered){
@@ -136,5 +192,105 @@ void AudioFloatToFFT::drop_from_front(size_t frames){
 
 
 
+//  Transform every window of a random stream directly and compare against
+//  the streamer. Random block sizes wrap the ring buffer at every offset.
+//  Some spectrums are held until the end to check that a buffer that is
+//  still in use is never recycled.
+class Test_AudioFloatToFFT : public UnitTest{
+public:
+    Test_AudioFloatToFFT()
+        : UnitTest("CommonFramework::AudioFloatToFFT")
+    {}
+
+    struct Collector : public FFTListener{
+        std::vector<std::vector<float>> spectrums;
+        std::vector<std::shared_ptr<const AlignedVector<float>>> held;
+        std::set<const float*> buffers;
+
+        virtual void on_fft(size_t sample_rate, std::shared_ptr<const AlignedVector<float>> fft_output) override{
+            buffers.insert(fft_output->data());
+            spectrums.emplace_back(fft_output->data(), fft_output->data() + NUM_FFT_SAMPLES / 2);
+            if (spectrums.size() % 16 == 0){
+                held.emplace_back(std::move(fft_output));
+            }
+        }
+    };
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        TestRandom random;
+
+        for (size_t trial = 0; trial < 6; trial++){
+            const bool stereo = trial % 2 == 1;
+            const size_t channels = stereo ? 2 : 1;
+            const size_t hop = trial < 2
+                ? FFT_SLIDING_WINDOW_STEP
+                : trial < 4 ? NUM_FFT_SAMPLES : 1 + random() % NUM_FFT_SAMPLES;
+
+            AudioFloatToFFT streamer(48000, channels, stereo, hop);
+            Collector collector;
+            streamer.add_listener(collector);
+
+            //  The streamer starts with a window of silence.
+            std::vector<float> stream(NUM_FFT_SAMPLES, 0.0f);
+            for (size_t block = 0; block < 100; block++){
+                size_t frames = random() % (3 * NUM_FFT_SAMPLES);
+                std::vector<float> samples(frames * channels);
+                for (float& sample : samples){
+                    sample = (float)((int)(random() % 2001) - 1000) / 1000;
+                }
+                for (size_t c = 0; c < frames; c++){
+                    stream.emplace_back(stereo
+                        ? (samples[2*c + 0] + samples[2*c + 1]) * 0.5f
+                        : samples[c]
+                    );
+                }
+                streamer.on_samples(samples.data(), frames);
+            }
+            streamer.remove_listener(collector);
+
+            std::string name = "hop " + std::to_string(hop) + (stereo ? " stereo" : " mono");
+            size_t expected = (stream.size() - NUM_FFT_SAMPLES) / hop + 1;
+            TEST_RESULT_COMPONENT_EQUAL_STR(collector.spectrums.size(), expected, name + " spectrums");
+
+            AlignedVector<float> input(NUM_FFT_SAMPLES);
+            AlignedVector<float> output(NUM_FFT_SAMPLES / 2);
+            for (size_t index = 0; index < expected; index++){
+                memcpy(input.data(), stream.data() + index * hop, NUM_FFT_SAMPLES * sizeof(float));
+                Kernels::AbsFFT::fft_abs(FFT_LENGTH_POWER_OF_TWO, output.data(), input.data());
+                const std::vector<float>& spectrum = collector.spectrums[index];
+                for (size_t c = 0; c < NUM_FFT_SAMPLES / 2; c++){
+                    TEST_RESULT_COMPONENT_EQUAL_STR(
+                        spectrum[c], output[c],
+                        name + " spectrum " + std::to_string(index) + " bin " + std::to_string(c)
+                    );
+                }
+                if ((index + 1) % 16 == 0){
+                    const AlignedVector<float>& held = *collector.held[index / 16];
+                    TEST_RESULT_COMPONENT_EQUAL_STR(
+                        memcmp(held.data(), spectrum.data(), NUM_FFT_SAMPLES / 2 * sizeof(float)) == 0, true,
+                        name + " held spectrum " + std::to_string(index)
+                    );
+                }
+            }
+
+            //  Everything that wasn't held was released right away, so
+            //  buffers must have been reused.
+            TEST_RESULT_COMPONENT_EQUAL_STR(
+                collector.buffers.size() <= collector.held.size() + FFT_MAX_BATCH, true,
+                name + " buffers reused"
+            );
+        }
+
+        return true;
+    }
+};
+
+
+void add_tests_FFTStreamer(UnitTestDatabase& database){
+    database.add<Test_AudioFloatToFFT>();
+}
+
+
+
 
 }
@@ -8,7 +8,10 @@
 #define PokemonAutomation_AudioPipeline_FFTStreamer_H
 
 #include <memory>
+#include <vector>
 #include "Common/Cpp/ListenerSet.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "CommonFramework/AudioPipeline/AudioConstants.h"
 #include "CommonFramework/AudioPipeline/AudioStream.h"
 
 namespace PokemonAutomation{
@@ -22,6 +25,16 @@ struct FFTListener{
 
 
 //  Listen to an audio stream and compute FFTs on it.
+//
+//  Samples go into a ring buffer. A new window of NUM_FFT_SAMPLES is
+//  transformed every "hop" samples. A hop smaller than the window gives
+//  overlapping windows and more spectrums per second.
+//
+//  All the windows that complete during one on_samples() call are transformed
+//  together and then handed to the listeners in one pass.
+//
+//  The spectrum buffers are recycled. Once every listener has released a
+//  spectrum, its buffer is reused for a later one.
 class AudioFloatToFFT : public AudioFloatStreamListener{
 public:
     void add_listener(FFTListener& listener);
@@ -30,22 +43,29 @@ public:
 public:
     AudioFloatToFFT(
         size_t sample_rate,
-        size_t samples_per_frame, bool average_pairs
+        size_t samples_per_frame, bool average_pairs,
+        size_t hop = FFT_SLIDING_WINDOW_STEP
     );
     virtual ~AudioFloatToFFT();
     virtual void on_samples(const float* data, size_t frames) override;
 
+    size_t hop() const{ return m_hop; }
+
 private:
     void convert(float* fft_input, const float* audio_stream, size_t frames);
-    void run_fft();
+    void run_ffts();
     void drop_from_front(size_t frames);
+    std::shared_ptr<AlignedVector<float>> get_output_buffer();
 
 private:
     size_t m_sample_rate;
 
     bool m_average;
     size_t m_fft_sample_size;
+    size_t m_hop;
 
+    //  Ring buffer of samples. It holds enough for several windows so that
+    //  a large block of audio is transformed in batches.
     AlignedVector<float> m_buffer;
     size_t m_buffered = 0;
     size_t m_start = 0;
@@ -53,6 +73,14 @@ private:
 
     AlignedVector<float> m_fft_input;
 
+    //  Spectrums from the current batch that are waiting to be sent out.
+    std::vector<std::shared_ptr<const AlignedVector<float>>> m_batch;
+
+    //  Recycled output buffers. A buffer is free when the pool holds the only
+    //  reference to it.
+    std::vector<std::shared_ptr<AlignedVector<float>>> m_pool;
+    size_t m_pool_next = 0;
+
     ListenerSet<FFTListener> m_listeners;
 };
 
@@ -60,6 +88,9 @@ private:
 std::unique_ptr<AudioFloatToFFT> make_FFT_streamer(AudioChannelFormat format);
 
 
+void add_tests_FFTStreamer(UnitTestDatabase& database);
+
+
 
 
 }
@@ -130,6 +130,10 @@ const std::string& DOWNLOADED_RESOURCE_PATH(){
     static std::string path = RUNTIME_BASE_PATH() + "DownloadedResources/";
     return path;
 }
+const std::string& RESOURCE_CACHE_PATH(){
+    static std::string path = RUNTIME_BASE_PATH() + "ResourceCache/";
+    return path;
+}
 const std::string& UNIT_TEST_RESOURCE_PATH(){
     static std::string path = get_unittest_resource_path();
     return path;
@@ -40,6 +40,10 @@ const std::string& RESOURCE_PATH();
 // Folder path that holds Downloaded resources
 const std::string& DOWNLOADED_RESOURCE_PATH();
 
+// Folder path (end with "/") to hold binary caches of decoded resources. See ResourceCache.h.
+// This is separate from RESOURCE_PATH() since that may not be writable.
+const std::string& RESOURCE_CACHE_PATH();
+
 // Folder path that holds the unit test resources.
 const std::string& UNIT_TEST_RESOURCE_PATH();
 
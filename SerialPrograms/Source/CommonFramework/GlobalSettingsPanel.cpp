@@ -327,6 +327,13 @@ void GlobalSettings::load_json(const JsonValue& json){
                 }
             }
         }
+        const JsonObject* benchmark = command_line_tests_setting->get_object("BENCHMARK");
+        if (benchmark){
+            benchmark->read_integer(COMMAND_LINE_BENCHMARK_ITERATIONS, "ITERATIONS", 0, 1000000);
+            benchmark->read_string(COMMAND_LINE_BENCHMARK_OUTPUT, "OUTPUT");
+            benchmark->read_string(COMMAND_LINE_BENCHMARK_BASELINE, "BASELINE");
+            benchmark->read_float(COMMAND_LINE_BENCHMARK_TOLERANCE, "TOLERANCE");
+        }
 
         if (COMMAND_LINE_TEST_MODE){
             std::cout << "Enter command line test mode:" << std::endl;
@@ -375,6 +382,15 @@ JsonValue GlobalSettings::to_json() const{
         command_line_test_obj["IGNORE_LIST"] = std::move(ignore_list);
     }
 
+    {
+        JsonObject benchmark;
+        benchmark["ITERATIONS"] = (int64_t)COMMAND_LINE_BENCHMARK_ITERATIONS;
+        benchmark["OUTPUT"] = COMMAND_LINE_BENCHMARK_OUTPUT;
+        benchmark["BASELINE"] = COMMAND_LINE_BENCHMARK_BASELINE;
+        benchmark["TOLERANCE"] = COMMAND_LINE_BENCHMARK_TOLERANCE;
+        command_line_test_obj["BENCHMARK"] = std::move(benchmark);
+    }
+
     obj["COMMAND_LINE_TESTS"] = std::move(command_line_test_obj);
     obj["DEBUG"] = STATIC_GLOBALS.to_json_debug();
 
@@ -129,6 +129,15 @@ public:
     // Which tests to ignore running under the command line test mode.
     // If a test path appears in both COMMAND_LINE_TEST_LIST and COMMAND_LINE_IGNORE_LIST, it's still ignored.
     std::vector<std::string> COMMAND_LINE_IGNORE_LIST;
+    // If > 0, run each passing test this many more times and record the times.
+    // See Tests/CommandLineBenchmark.h.
+    size_t COMMAND_LINE_BENCHMARK_ITERATIONS = 0;
+    // Where to save the benchmark results.
+    std::string COMMAND_LINE_BENCHMARK_OUTPUT;
+    // If not empty, fail on regressions against the benchmark results saved here.
+    std::string COMMAND_LINE_BENCHMARK_BASELINE;
+    // How much slower (as a fraction) than the baseline counts as a regression.
+    double COMMAND_LINE_BENCHMARK_TOLERANCE = 0.10;
 };
 
 
@@ -0,0 +1,95 @@
+/*  Image Derived Cache
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <tuple>
+#include "ImageDerivedCache.h"
+
+namespace PokemonAutomation{
+
+
+
+static thread_local ImageDerivedCache* t_current_image_cache = nullptr;
+
+ImageDerivedCache* ImageDerivedCache::current(){
+    return t_current_image_cache;
+}
+ImageDerivedCache::Binding::Binding(ImageDerivedCache* cache)
+    : m_previous(t_current_image_cache)
+{
+    t_current_image_cache = cache;
+}
+ImageDerivedCache::Binding::~Binding(){
+    t_current_image_cache = m_previous;
+}
+
+
+
+bool ImageDerivedCache::Key::operator<(const Key& x) const{
+    return std::tie(operation, min_x, min_y, width, height, parameters)
+         < std::tie(x.operation, x.min_x, x.min_y, x.width, x.height, x.parameters);
+}
+
+bool ImageDerivedCache::make_key(
+    Key& key,
+    const ImageViewRGB32& image,
+    ImageDerivedOperation operation, uint64_t parameters
+) const{
+    if (!m_frame || !image){
+        return false;
+    }
+    if (image.bytes_per_row() != m_frame.bytes_per_row()){
+        return false;
+    }
+
+    const char* base = (const char*)m_frame.data();
+    const char* ptr = (const char*)image.data();
+    if (ptr < base){
+        return false;
+    }
+
+    size_t offset = ptr - base;
+    size_t bytes_per_row = m_frame.bytes_per_row();
+    if (offset % sizeof(uint32_t) != 0){
+        return false;
+    }
+    size_t min_y = offset / bytes_per_row;
+    size_t min_x = (offset % bytes_per_row) / sizeof(uint32_t);
+    if (min_x + image.width() > m_frame.width() || min_y + image.height() > m_frame.height()){
+        return false;
+    }
+
+    key.operation = operation;
+    key.min_x = (uint32_t)min_x;
+    key.min_y = (uint32_t)min_y;
+    key.width = (uint32_t)image.width();
+    key.height = (uint32_t)image.height();
+    key.parameters = parameters;
+    return true;
+}
+
+std::shared_ptr<const void> ImageDerivedCache::get(const Key& key){
+    std::shared_ptr<const void> ret;
+    {
+        ReadSpinLock lg(m_lock, PA_CURRENT_FUNCTION);
+        auto iter = m_map.find(key);
+        if (iter != m_map.end()){
+            ret = iter->second;
+        }
+    }
+    if (m_stats){
+        (ret ? m_stats->hits : m_stats->misses).fetch_add(1, std::memory_order_relaxed);
+    }
+    return ret;
+}
+std::shared_ptr<const void> ImageDerivedCache::put(const Key& key, std::shared_ptr<const void> value){
+    WriteSpinLock lg(m_lock, PA_CURRENT_FUNCTION);
+    return m_map.emplace(key, std::move(value)).first->second;
+}
+
+
+
+
+}
@@ -0,0 +1,138 @@
+/*  Image Derived Cache
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *      Per-frame memoization of products derived from a video frame.
+ *
+ *  Many detectors that poll the same frame compute the same stats and color
+ *  conversions on the same boxes. This cache is attached to the
+ *  frame by the inference pivot so that each product is computed once per
+ *  frame regardless of how many callbacks ask for it.
+ *
+ *  Lookups are keyed by (operation, pixel box, parameters). The box is
+ *  recovered from the address of the image view relative to the frame so
+ *  that existing code which does:
+ *
+ *      image_stats(extract_box_reference(frame, box));
+ *
+ *  picks up the cache automatically without any changes.
+ *
+ */
+
+#ifndef PokemonAutomation_CommonFramework_ImageDerivedCache_H
+#define PokemonAutomation_CommonFramework_ImageDerivedCache_H
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <map>
+#include "Common/Cpp/Concurrency/SpinLock.h"
+#include "CommonFramework/ImageTypes/ImageViewRGB32.h"
+
+namespace PokemonAutomation{
+
+
+enum class ImageDerivedOperation : uint32_t{
+    IMAGE_STATS,
+    HSV32,
+};
+
+
+//  Hit/miss counters. Shared by all the frame caches of a video feed.
+struct ImageDerivedCacheStats{
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+
+class ImageDerivedCache{
+public:
+    ImageDerivedCache(const ImageDerivedCache&) = delete;
+    void operator=(const ImageDerivedCache&) = delete;
+
+    ImageDerivedCache(ImageViewRGB32 frame, ImageDerivedCacheStats* stats = nullptr)
+        : m_frame(frame)
+        , m_stats(stats)
+    {}
+
+    const ImageViewRGB32& frame() const{ return m_frame; }
+
+
+public:
+    //  Returns the cache that is bound to the current thread. (null if none)
+    static ImageDerivedCache* current();
+
+    //  Bind a cache to the current thread for the lifetime of this object.
+    class Binding{
+    public:
+        Binding(const Binding&) = delete;
+        void operator=(const Binding&) = delete;
+        Binding(ImageDerivedCache* cache);
+        ~Binding();
+    private:
+        ImageDerivedCache* m_previous;
+    };
+
+
+public:
+    //  Look up the derived product for "image" using the cache bound to this
+    //  thread. If there is no bound cache or "image" does not lie within the
+    //  bound frame, "compute" is run directly without caching.
+    template <typename Type, typename Lambda>
+    static std::shared_ptr<const Type> lookup(
+        const ImageViewRGB32& image,
+        ImageDerivedOperation operation, uint64_t parameters,
+        Lambda&& compute
+    ){
+        ImageDerivedCache* cache = current();
+        Key key;
+        if (cache == nullptr || !cache->make_key(key, image, operation, parameters)){
+            return std::make_shared<const Type>(compute());
+        }
+        std::shared_ptr<const void> ret = cache->get(key);
+        if (ret){
+            return std::static_pointer_cast<const Type>(ret);
+        }
+        std::shared_ptr<const Type> value = std::make_shared<const Type>(compute());
+        return std::static_pointer_cast<const Type>(cache->put(key, value));
+    }
+
+
+private:
+    struct Key{
+        ImageDerivedOperation operation;
+        uint32_t min_x;
+        uint32_t min_y;
+        uint32_t width;
+        uint32_t height;
+        uint64_t parameters;
+
+        bool operator<(const Key& x) const;
+    };
+
+    //  Returns false if "image" is not a sub-image of the frame.
+    bool make_key(
+        Key& key,
+        const ImageViewRGB32& image,
+        ImageDerivedOperation operation, uint64_t parameters
+    ) const;
+
+    std::shared_ptr<const void> get(const Key& key);
+
+    //  If another thread beat us to it, returns the existing value instead.
+    std::shared_ptr<const void> put(const Key& key, std::shared_ptr<const void> value);
+
+
+private:
+    ImageViewRGB32 m_frame;
+    ImageDerivedCacheStats* m_stats;
+
+    SpinLock m_lock;
+    std::map<Key, std::shared_ptr<const void>> m_map;
+};
+
+
+
+
+}
+#endif
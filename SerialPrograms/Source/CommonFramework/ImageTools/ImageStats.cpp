@@ -9,6 +9,7 @@
 #include "CommonFramework/StaticGlobals.h"
 #include "CommonFramework/ImageTypes/ImageViewRGB32.h"
 #include "ImageBoxes.h"
+#include "ImageDerivedCache.h"
 #include "ImageStats.h"
 
 #include <iostream>
@@ -50,7 +51,7 @@ FloatPixel image_stddev(const ImageViewRGB32& image){
         std::sqrt(variance.b)
     );
 }
-ImageStats image_stats(const ImageViewRGB32& image){
+ImageStats image_stats_uncached(const ImageViewRGB32& image){
     Kernels::PixelSums sums;
     Kernels::pixel_sum_sqr(
         sums, image.width(), image.height(),
@@ -81,6 +82,15 @@ ImageStats image_stats(const ImageViewRGB32& image){
 
     return stats;
 }
+ImageStats image_stats(const ImageViewRGB32& image){
+    if (ImageDerivedCache::current() == nullptr){
+        return image_stats_uncached(image);
+    }
+    return *ImageDerivedCache::lookup<ImageStats>(
+        image, ImageDerivedOperation::IMAGE_STATS, 0,
+        [&]{ return image_stats_uncached(image); }
+    );
+}
 
 
 
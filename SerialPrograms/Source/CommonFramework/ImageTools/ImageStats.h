@@ -31,6 +31,9 @@ FloatPixel image_average(const ImageViewRGB32& image);
 FloatPixel image_stddev(const ImageViewRGB32& image);
 ImageStats image_stats(const ImageViewRGB32& image);
 
+//  Same as above, but bypasses the per-frame cache. (see ImageDerivedCache.h)
+ImageStats image_stats_uncached(const ImageViewRGB32& image);
+
 // Get stats on the one-pixel-wide border of the image
 ImageStats image_border_stats(const ImageViewRGB32& image);
 
@@ -8,6 +8,7 @@
 #define PokemonAutomation_CommonFramework_ImageHSV32_H
 
 #include <string>
+#include <memory>
 #include "Common/Cpp/Containers/Pimpl.h"
 #include "ImageViewHSV32.h"
 
@@ -64,6 +65,10 @@ public:
 
     explicit ImageHSV32(const ImageViewRGB32& image);
 
+    //  Same as above, but if "image" is part of a frame with a per-frame cache,
+    //  the conversion is shared with everyone else who converts the same region.
+    static std::shared_ptr<const ImageHSV32> cached_from(const ImageViewRGB32& image);
+
 
 private:
     struct Data;
@@ -0,0 +1,95 @@
+/*  Image (RGB32) Pool
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <vector>
+#include "Common/Cpp/Concurrency/SpinLock.h"
+#include "Common/Cpp/Containers/AlignedVector.tpp"
+#include "ImageRGB32Pool.h"
+
+namespace PokemonAutomation{
+
+
+
+struct ImageRGB32Pool::Core{
+    size_t max_free_buffers;
+
+    SpinLock lock;
+    std::vector<AlignedVector<uint32_t>> free_buffers;
+
+    Core(size_t p_max_free_buffers)
+        : max_free_buffers(p_max_free_buffers)
+    {}
+
+    AlignedVector<uint32_t> take(size_t words){
+        {
+            WriteSpinLock lg(lock);
+            for (auto iter = free_buffers.rbegin(); iter != free_buffers.rend(); ++iter){
+                if (iter->size() == words){
+                    AlignedVector<uint32_t> ret = std::move(*iter);
+                    free_buffers.erase(std::next(iter).base());
+                    return ret;
+                }
+            }
+        }
+        return AlignedVector<uint32_t>(words);
+    }
+    void give_back(AlignedVector<uint32_t>&& buffer){
+        AlignedVector<uint32_t> evicted;
+        WriteSpinLock lg(lock);
+        if (free_buffers.size() >= max_free_buffers){
+            //  Free the oldest buffer outside the lock.
+            evicted = std::move(free_buffers.front());
+            free_buffers.erase(free_buffers.begin());
+        }
+        free_buffers.emplace_back(std::move(buffer));
+    }
+};
+
+
+class PooledImageRGB32 : public CustomImageRGB32Owner{
+public:
+    PooledImageRGB32(
+        std::shared_ptr<ImageRGB32Pool::Core> core,
+        size_t width, size_t height
+    )
+        : m_core(std::move(core))
+        , m_view(width, height)
+    {
+        m_buffer = m_core->take(m_view.bytes_per_row() / sizeof(uint32_t) * height);
+    }
+    virtual ~PooledImageRGB32(){
+        m_core->give_back(std::move(m_buffer));
+    }
+
+    virtual ImageViewRGB32 get_view() const override{
+        return ImageViewRGB32(
+            const_cast<uint32_t*>(m_buffer.data()),
+            m_view.bytes_per_row(),
+            m_view.width(),
+            m_view.height()
+        );
+    }
+
+private:
+    std::shared_ptr<ImageRGB32Pool::Core> m_core;
+    ImageViewPlanar32 m_view;
+    AlignedVector<uint32_t> m_buffer;
+};
+
+
+
+ImageRGB32Pool::~ImageRGB32Pool() = default;
+ImageRGB32Pool::ImageRGB32Pool(size_t max_free_buffers)
+    : m_core(std::make_shared<Core>(max_free_buffers))
+{}
+
+ImageRGB32 ImageRGB32Pool::get(size_t width, size_t height){
+    return ImageRGB32(std::make_unique<PooledImageRGB32>(m_core, width, height));
+}
+
+
+
+}
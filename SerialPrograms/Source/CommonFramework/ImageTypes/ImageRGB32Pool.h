@@ -0,0 +1,40 @@
+/*  Image (RGB32) Pool
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *      A pool of recycled image buffers for producers that repeatedly make
+ *  images of the same size. (such as video frame conversion)
+ *
+ *  Images handed out by the pool return their buffer to it when they are
+ *  destroyed. They may safely outlive the pool itself.
+ *
+ */
+
+#ifndef PokemonAutomation_CommonFramework_ImageRGB32Pool_H
+#define PokemonAutomation_CommonFramework_ImageRGB32Pool_H
+
+#include <memory>
+#include "ImageRGB32.h"
+
+namespace PokemonAutomation{
+
+
+
+class ImageRGB32Pool{
+public:
+    ~ImageRGB32Pool();
+    ImageRGB32Pool(size_t max_free_buffers = 8);
+
+    //  Return an image of shape width x height with uninitialized pixels.
+    ImageRGB32 get(size_t width, size_t height);
+
+private:
+    friend class PooledImageRGB32;
+    struct Core;
+    std::shared_ptr<Core> m_core;
+};
+
+
+
+}
+#endif
@@ -60,21 +60,40 @@ bool ImageViewRGB32::save(const std::string& path) const{
 }
 
 
-ImageRGB32 ImageViewRGB32::scale_to(size_t width, size_t height) const{
+ImageRGB32 ImageViewRGB32::scale_to(size_t width, size_t height, Kernels::ResampleFilter filter) const{
+    ImageRGB32 ret;
+    scale_to(ret, width, height, filter);
+    return ret;
+}
+void ImageViewRGB32::scale_to(
+    ImageRGB32& output, size_t width, size_t height,
+    Kernels::ResampleFilter filter,
+    Kernels::ImageResampler* resampler
+) const{
+    if (width * height == 0){
+        output = ImageRGB32();
+        return;
+    }
+    if (output.width() != width || output.height() != height){
+        output = ImageRGB32(width, height);
+    }
     if (this->total_pixels() == 0){
-        ImageRGB32 ret(width, height);
-        ret.fill(0);
-        return ret;
+        output.fill(0);
+        return;
     }
-    if (width * height == 0){
-        return ImageRGB32();
+    if (resampler == nullptr){
+        Kernels::resample(
+            filter,
+            m_ptr, m_bytes_per_row, m_width, m_height,
+            output.data(), output.bytes_per_row(), width, height
+        );
+    }else{
+        resampler->resample(
+            filter,
+            m_ptr, m_bytes_per_row, m_width, m_height,
+            output.data(), output.bytes_per_row(), width, height
+        );
     }
-#ifdef PA_IMAGE_BACKEND_Qt
-    return QImage_to_ImageRGB32(scaled_to_QImage(*this, width, height));
-#endif
-#ifdef PA_IMAGE_BACKEND_OpenCV
-    return OpenCV_scale_image(*this, width, height);
-#endif
 }
 
 
@@ -8,6 +8,7 @@
 #define PokemonAutomation_CommonFramework_ImageViewRGB32_H
 
 #include <string>
+#include "Kernels/ImageResample/Kernels_ImageResample.h"
 #include "ImageViewPlanar32.h"
 
 namespace PokemonAutomation{
@@ -44,7 +45,21 @@ public:
     // Call QImage::save() to save image to file. Return whether the save is successful.
     // If the path includes nonexistent folders, save() will create it first.
     bool save(const std::string& path) const;
-    ImageRGB32 scale_to(size_t width, size_t height) const;
+    //  Resize the image to "width" x "height".
+    ImageRGB32 scale_to(
+        size_t width, size_t height,
+        Kernels::ResampleFilter filter = Kernels::ResampleFilter::BILINEAR
+    ) const;
+
+    //  Same as above, but write into "output". Its buffer is reused if it
+    //  already has the requested dimensions. Pass the same "resampler" to
+    //  repeated calls to reuse its filter tables and scratch space.
+    //  "output" must not be this image.
+    void scale_to(
+        ImageRGB32& output, size_t width, size_t height,
+        Kernels::ResampleFilter filter = Kernels::ResampleFilter::BILINEAR,
+        Kernels::ImageResampler* resampler = nullptr
+    ) const;
 
 private:
     PA_FORCE_INLINE ImageViewRGB32(const ImageViewPlanar32& x)
@@ -21,6 +21,7 @@
 #include "StaticRegistration.h"
 #include "CommonFramework/GlobalAutoPaths.h"
 #include "CommonFramework/Tools/GlobalThreadPools.h"
+#include "CommonFramework/Options/Environment/PerformanceOptions.h"
 #include "VideoPipeline/Backends/MediaServicesQt6.h"
 #include "Globals.h"
 #include "GlobalSettingsPanel.h"
@@ -43,6 +44,7 @@
 #include "CommonTools/OCR/OCR_Routines.h"
 #include "ControllerInput/ControllerInput.h"
 #include "Controllers/SerialPortPollerQt.h"
+#include "Controllers/PABotBase2/PABotBase2_LoopbackBenchmark.h"
 #include "Integrations/DiscordWebhook.h"
 #include "Windows/MainWindow.h"
 
@@ -178,9 +180,13 @@ int run_program(int argc, char *argv[]){
         logger.log(error.message(), COLOR_RED);
     }
 
+    PABotBase2::LoopbackBenchmarkOptions loopback_benchmark;
     for (size_t i = 0; i < argc; i++){
         constexpr const char* force_run_tests = "--command-line-test-mode";
         constexpr const char* command_line_test_folder = "--command-line-test-folder";
+        constexpr const char* benchmark_iterations = "--benchmark";
+        constexpr const char* benchmark_output = "--benchmark-output";
+        constexpr const char* benchmark_baseline = "--benchmark-baseline";
 
         if (strcmp(argv[i], force_run_tests) == 0){
             GlobalSettings::instance().COMMAND_LINE_TEST_MODE = true;
@@ -188,6 +194,45 @@ int run_program(int argc, char *argv[]){
         if (strcmp(argv[i], command_line_test_folder) == 0 && (i + 1 < argc)){
             GlobalSettings::instance().COMMAND_LINE_TEST_FOLDER = argv[i + 1];
         }
+        if (strcmp(argv[i], benchmark_iterations) == 0 && (i + 1 < argc)){
+            GlobalSettings::instance().COMMAND_LINE_BENCHMARK_ITERATIONS = strtoull(argv[i + 1], nullptr, 10);
+        }
+        if (strcmp(argv[i], benchmark_output) == 0 && (i + 1 < argc)){
+            GlobalSettings::instance().COMMAND_LINE_BENCHMARK_OUTPUT = argv[i + 1];
+        }
+        if (strcmp(argv[i], benchmark_baseline) == 0 && (i + 1 < argc)){
+            GlobalSettings::instance().COMMAND_LINE_BENCHMARK_BASELINE = argv[i + 1];
+        }
+
+        //  See PABotBase2_LoopbackBenchmark.h
+        if (i + 1 >= argc){
+            continue;
+        }
+        if (strcmp(argv[i], "--pabb2-loopback-benchmark") == 0){
+            loopback_benchmark.commands = strtoull(argv[i + 1], nullptr, 10);
+        }
+        if (strcmp(argv[i], "--pabb2-loopback-baud") == 0){
+            loopback_benchmark.baud_rate = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+        }
+        if (strcmp(argv[i], "--pabb2-loopback-drop") == 0){
+            loopback_benchmark.drop_rate = strtod(argv[i + 1], nullptr);
+        }
+        if (strcmp(argv[i], "--pabb2-loopback-reorder") == 0){
+            loopback_benchmark.reorder_rate = strtod(argv[i + 1], nullptr);
+        }
+        if (strcmp(argv[i], "--pabb2-loopback-queue") == 0){
+            loopback_benchmark.queue_depth = (uint8_t)std::min<unsigned long>(strtoul(argv[i + 1], nullptr, 10), 255);
+        }
+        if (strcmp(argv[i], "--pabb2-loopback-batch") == 0){
+            loopback_benchmark.batch_size = std::max<size_t>(strtoull(argv[i + 1], nullptr, 10), 1);
+        }
+        if (strcmp(argv[i], "--pabb2-loopback-output") == 0){
+            loopback_benchmark.output_path = argv[i + 1];
+        }
+    }
+
+    if (loopback_benchmark.commands != 0){
+        return PABotBase2::run_loopback_benchmark(loopback_benchmark);
     }
 
     if (GlobalSettings::instance().COMMAND_LINE_TEST_MODE){
@@ -206,6 +251,22 @@ int run_program(int argc, char *argv[]){
     //  Run this asynchronously to we don't block startup.
     AsyncTask task = send_all_unsent_reports(logger, true);
 
+    //  Create the OCR instances in the background so the first program that
+    //  reads text doesn't stall on initializing them.
+    AsyncTask ocr_warmup;
+    size_t ocr_instances = PerformanceOptions::instance().OCR_WARM_INSTANCES;
+    if (ocr_instances > 0){
+        ocr_warmup = GlobalThreadPools::unlimited_normal().dispatch_now_blocking([&logger, ocr_instances]{
+            try{
+                OCR::ensure_ocr_instances(Language::English, ocr_instances);
+            }catch (Exception& e){
+                logger.log("Unable to warm up OCR: " + e.message(), COLOR_RED);
+            }catch (std::exception& e){
+                logger.log(std::string("Unable to warm up OCR: ") + e.what(), COLOR_RED);
+            }
+        });
+    }
+
 
 
     Integration::DiscordIntegrationSettingsOption& discord_settings = GlobalSettings::instance().DISCORD->integration;
@@ -62,6 +62,15 @@ public:
             LockMode::UNLOCK_WHILE_RUNNING,
             0
         )
+        , YOLO_INPUT_SIZE(
+            "<b>YOLO Input Size:</b><br>"
+            "Side length in pixels that frames are shrunk to before running YOLO models. "
+            "Smaller is faster on the CPU but misses small objects. "
+            "Only applies to models exported with a dynamic input size. Rounded down to a multiple of 32.",
+            LockMode::UNLOCK_WHILE_RUNNING,
+            640,
+            160, 640
+        )
     {
         PA_ADD_OPTION(HARDWARE_THREADS);
         PA_ADD_STATIC(m_description);
@@ -69,6 +78,7 @@ public:
 //        PA_ADD_OPTION(PRIORITY);  //  Not used yet.
         PA_ADD_OPTION(MAX_INTRA_OP_THREADS);
         PA_ADD_OPTION(MAX_INTER_OP_THREADS);
+        PA_ADD_OPTION(YOLO_INPUT_SIZE);
 
         HARDWARE_THREADS.set_visibility(ConfigOptionState::HIDDEN);
         USE_GPU.set_visibility(ConfigOptionState::HIDDEN);
@@ -93,6 +103,7 @@ public:
     ThreadPriorityOption PRIORITY;
     SimpleIntegerOption<int> MAX_INTRA_OP_THREADS;
     SimpleIntegerOption<int> MAX_INTER_OP_THREADS;
+    SimpleIntegerOption<int> YOLO_INPUT_SIZE;
 };
 
 
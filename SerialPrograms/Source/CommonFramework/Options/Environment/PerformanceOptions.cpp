@@ -56,6 +56,25 @@ PerformanceOptions::PerformanceOptions()
         DEFAULT_PRIORITY_NORMAL_INFERENCE,
         1.0
     )
+    , PARALLEL_VISUAL_INFERENCE(
+        "<b>Parallel Visual Inference:</b><br>"
+        "When multiple expensive visual detectors are due on the same frame, run "
+        "them in parallel on the real-time thread pool instead of one after another. "
+        "This reduces detection latency for programs that watch many things "
+        "at once if you have enough CPU cores.",
+        LockMode::UNLOCK_WHILE_RUNNING,
+        false
+    )
+    , OCR_WARM_INSTANCES(
+        "<b>OCR Warm Instances:</b><br>"
+        "Number of OCR instances to create in the background when the program "
+        "starts. This avoids a stall the first time a program reads text. "
+        "Programs that read several things at once (such as stat screens) "
+        "can use up to one instance per item. Zero disables this.<br>"
+        "Restart the program for this to take effect.",
+        LockMode::LOCK_WHILE_RUNNING,
+        2, 0, 64
+    )
     , PRECISE_WAKE_MARGIN(
         "<b>Precise Wake Time Margin:</b><br>"
         "Some operations require a thread to wake up at a very precise time - "
@@ -81,6 +100,9 @@ PerformanceOptions::PerformanceOptions()
     PA_ADD_OPTION(REALTIME_THREAD_POOL0);
     PA_ADD_OPTION(NORMAL_THREAD_POOL);
 
+    PA_ADD_OPTION(PARALLEL_VISUAL_INFERENCE);
+    PA_ADD_OPTION(OCR_WARM_INSTANCES);
+
     //  Used only by sys-botbase 2 which has been removed.
 //    PA_ADD_OPTION(PRECISE_WAKE_MARGIN);
 
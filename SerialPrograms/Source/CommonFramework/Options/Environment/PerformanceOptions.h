@@ -8,6 +8,7 @@
 #define PokemonAutomation_PerformanceOptions_H
 
 #include "Common/Cpp/Options/GroupOption.h"
+#include "Common/Cpp/Options/BooleanCheckBoxOption.h"
 #include "Common/Cpp/Options/TimeDurationOption.h"
 #include "CommonFramework/Options/ThreadPoolOption.h"
 #include "ProcessPriorityOption.h"
@@ -42,6 +43,9 @@ public:
     ThreadPoolOption REALTIME_THREAD_POOL0;
     ThreadPoolOption NORMAL_THREAD_POOL;
 
+    BooleanCheckBoxOption PARALLEL_VISUAL_INFERENCE;
+    SimpleIntegerOption<uint8_t> OCR_WARM_INSTANCES;
+
     MicrosecondsOption PRECISE_WAKE_MARGIN;
 
     OnnxOptions ONNX_OPTIONS;
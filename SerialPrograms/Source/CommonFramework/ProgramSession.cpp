@@ -141,13 +141,11 @@ void ProgramSession::load_historical_stats(){
     if (stats){
         m_logger.log("Loading historical stats...");
 //        m_current_stats = m_descriptor.make_stats();
-        StatSet set;
-        set.open_from_file(GlobalSettings::instance().STATS_FILE);
-        const std::string& identifier = m_descriptor.identifier();
-        StatList& list = set[identifier];
-        if (list.size() != 0){
-            list.aggregate(*stats);
-        }
+        StatsFileIndex::instance().aggregate(
+            GlobalSettings::instance().STATS_FILE,
+            m_descriptor.identifier(),
+            *stats
+        );
         m_historical_stats = std::move(stats);
     }
 }
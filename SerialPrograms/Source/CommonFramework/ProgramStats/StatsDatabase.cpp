@@ -5,6 +5,8 @@
  */
 
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QSaveFile>
 #include "Common/Cpp/Time.h"
 #include "StatsDatabase.h"
@@ -39,6 +41,12 @@ const std::map<std::string, std::string> STATS_DATABASE_ALIASES{
     {"PokemonLZA:BerryBuyer", "PokemonLZA:StallBuyer"},
 };
 
+const char STATS_SECTION_DIVIDER[] = "================================================================================\r\n";
+
+//  Rewrite the stats file in sorted order once this many sections have been
+//  appended to it.
+const size_t STATS_COMPACTION_THRESHOLD = 32;
+
 
 
 StatLine::StatLine(StatsTracker& tracker)
@@ -123,7 +131,7 @@ std::string StatSet::to_str() const{
         if (item.second.size() == 0){
             continue;
         }
-        str += "================================================================================\r\n";
+        str += STATS_SECTION_DIVIDER;
         str += item.first;
         str += "\r\n";
         str += "\r\n";
@@ -155,23 +163,7 @@ bool StatSet::update_file(
     const std::string& identifier,
     StatsTracker& tracker
 ){
-    QFile file(QString::fromStdString(filepath));
-    while (!file.open(QIODevice::ReadWrite)){
-        return false;
-    }
-    std::string data = file.readAll().data();
-
-    StatSet set;
-    set.load_from_string(data.c_str());
-
-    set[identifier] += tracker;
-
-    data = set.to_str();
-    file.seek(0);
-    file.write(data.c_str(), data.size());
-    file.resize(data.size());
-
-    return true;
+    return StatsFileIndex::instance().append(filepath, identifier, tracker);
 }
 
 
@@ -241,8 +233,160 @@ void StatSet::load_from_string(const char* ptr){
 
 
 
+StatsFileIndex& StatsFileIndex::instance(){
+    static StatsFileIndex index;
+    return index;
+}
+
+StatsFileIndex::File& StatsFileIndex::refresh(const std::string& filepath){
+    File& file = m_files[filepath];
+
+    QFileInfo info(QString::fromStdString(filepath));
+    int64_t size = info.exists() ? info.size() : 0;
+    int64_t modified = info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+    if (file.size == size && file.modified == modified){
+        return file;
+    }
+
+    file.size = size;
+    file.modified = modified;
+    file.ends_with_newline = true;
+    file.extra_sections = 0;
+    file.totals.clear();
+
+    QFile qfile(QString::fromStdString(filepath));
+    if (!qfile.open(QIODevice::ReadOnly)){
+        return file;
+    }
+    std::string data = qfile.readAll().data();
+    if (!data.empty()){
+        file.ends_with_newline = data.back() == '\n';
+    }
+
+    StatSet set;
+    set.load_from_string(data.c_str());
+
+    size_t sections = 0;
+    size_t programs = 0;
+    for (size_t c = 0; c < data.size(); c++){
+        if (data[c] == '=' && (c == 0 || data[c - 1] == '\n')){
+            sections++;
+        }
+    }
+    for (const auto& item : set.m_data){
+        if (item.second.size() == 0){
+            continue;
+        }
+        programs++;
+        std::map<std::string, uint64_t>& totals = file.totals[item.first];
+        for (const StatLine& line : item.second.list()){
+            StatsTracker::parse_line(totals, line.stats());
+        }
+    }
+    file.extra_sections = sections > programs ? sections - programs : 0;
+
+    return file;
+}
+void StatsFileIndex::compact(const std::string& filepath, File& file){
+    std::string data;
+    {
+        QFile qfile(QString::fromStdString(filepath));
+        if (!qfile.open(QIODevice::ReadOnly)){
+            return;
+        }
+        data = qfile.readAll().data();
+    }
+
+    StatSet set;
+    set.load_from_string(data.c_str());
+    data = set.to_str();
+
+    QSaveFile qfile(QString::fromStdString(filepath));
+    if (!qfile.open(QIODevice::WriteOnly)){
+        return;
+    }
+    qfile.write(data.c_str(), data.size());
+    if (!qfile.commit()){
+        return;
+    }
+
+    //  The totals are unchanged.
+    QFileInfo info(QString::fromStdString(filepath));
+    file.size = info.size();
+    file.modified = info.lastModified().toMSecsSinceEpoch();
+    file.ends_with_newline = true;
+    file.extra_sections = 0;
+}
+
+bool StatsFileIndex::append(
+    const std::string& filepath,
+    const std::string& identifier,
+    StatsTracker& tracker
+){
+    std::lock_guard<Mutex> lg(m_lock);
+    File& file = refresh(filepath);
+
+    StatLine line(tracker);
+
+    std::string section;
+    if (!file.ends_with_newline){
+        section += "\r\n";
+    }
+    section += STATS_SECTION_DIVIDER;
+    section += identifier;
+    section += "\r\n";
+    section += "\r\n";
+    section += line.to_str();
+    section += "\r\n";
+    section += "\r\n";
+
+    {
+        QFile qfile(QString::fromStdString(filepath));
+        if (!qfile.open(QIODevice::WriteOnly | QIODevice::Append)){
+            return false;
+        }
+        if (qfile.write(section.c_str(), section.size()) != (qint64)section.size()){
+            //  Don't know what made it in. Read it again next time.
+            file.size = -1;
+            return false;
+        }
+    }
+
+    if (!file.ends_with_newline){
+        //  The last line of the file was not terminated, so it wasn't parsed.
+        //  Now it is. Read the whole file again next time.
+        file.size = -1;
+        return true;
+    }
+
+    bool new_program = file.totals.find(identifier) == file.totals.end();
+    StatsTracker::parse_line(file.totals[identifier], line.stats());
+    if (!new_program){
+        file.extra_sections++;
+    }
+
+    QFileInfo info(QString::fromStdString(filepath));
+    file.size = info.size();
+    file.modified = info.lastModified().toMSecsSinceEpoch();
 
+    if (file.extra_sections >= STATS_COMPACTION_THRESHOLD){
+        compact(filepath, file);
+    }
 
+    return true;
+}
+void StatsFileIndex::aggregate(
+    const std::string& filepath,
+    const std::string& identifier,
+    StatsTracker& tracker
+){
+    std::lock_guard<Mutex> lg(m_lock);
+    File& file = refresh(filepath);
+    auto iter = file.totals.find(identifier);
+    if (iter != file.totals.end()){
+        tracker.add_counts(iter->second);
+    }
+}
 
 
 
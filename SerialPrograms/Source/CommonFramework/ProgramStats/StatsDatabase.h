@@ -7,6 +7,7 @@
 #ifndef PokemonAutomation_StatsDatabase_H
 #define PokemonAutomation_StatsDatabase_H
 
+#include "Common/Cpp/Concurrency/Mutex.h"
 #include "StatsTracking.h"
 
 namespace PokemonAutomation{
@@ -56,6 +57,7 @@ public:
     void save_to_file(const std::string& filepath);
     void open_from_file(const std::string& filepath);
 
+    //  Append the stats to the file. See StatsFileIndex.
     static bool update_file(
         const std::string& filepath,
         const std::string& identifier,
@@ -63,6 +65,8 @@ public:
     );
 
 private:
+    friend class StatsFileIndex;
+
     bool get_line(std::string& line, const char*& ptr);
     void load_from_string(const char* ptr);
 
@@ -72,5 +76,55 @@ private:
 
 
 
+//  Keeps the totals of every program in a stats file in memory.
+//
+//  New stats are appended to the end of the file as their own section
+//  instead of rewriting the whole file. The file format already allows the
+//  same program to appear in more than one section. Once enough sections
+//  have been appended, the file is rewritten in sorted order.
+//
+//  The file is only parsed again if its size or modification time changes
+//  behind our back.
+class StatsFileIndex{
+public:
+    static StatsFileIndex& instance();
+
+    //  Append the current stats of "identifier" to the file.
+    bool append(
+        const std::string& filepath,
+        const std::string& identifier,
+        StatsTracker& tracker
+    );
+
+    //  Add all the saved stats of "identifier" into "tracker".
+    void aggregate(
+        const std::string& filepath,
+        const std::string& identifier,
+        StatsTracker& tracker
+    );
+
+private:
+    struct File{
+        //  Size and modification time as of our last read or write.
+        int64_t size = -1;
+        int64_t modified = 0;
+        bool ends_with_newline = true;
+
+        //  Sections in the file beyond one per program.
+        size_t extra_sections = 0;
+
+        std::map<std::string, std::map<std::string, uint64_t>> totals;
+    };
+
+    File& refresh(const std::string& filepath);
+    void compact(const std::string& filepath, File& file);
+
+private:
+    Mutex m_lock;
+    std::map<std::string, File> m_files;
+};
+
+
+
 }
 #endif
@@ -79,6 +79,16 @@ std::string StatsTracker::to_str(PrintMode mode) const{
 
 
 void StatsTracker::parse_and_append_line(const std::string& line){
+    std::map<std::string, uint64_t> counts;
+    parse_line(counts, line);
+    add_counts(counts);
+}
+void StatsTracker::add_counts(const std::map<std::string, uint64_t>& counts){
+    for (const auto& item : counts){
+        m_stats[item.first] += item.second;
+    }
+}
+void StatsTracker::parse_line(std::map<std::string, uint64_t>& counts, const std::string& line){
     const char* ptr = line.c_str();
     while (true){
         //  Parse label.
@@ -103,7 +113,7 @@ void StatsTracker::parse_and_append_line(const std::string& line){
         while (true){
             char ch = *ptr++;
             if (ch < 32){
-                m_stats[label] += count;
+                counts[label] += count;
                 return;
             }
             if (ch == ',') continue;
@@ -113,7 +123,7 @@ void StatsTracker::parse_and_append_line(const std::string& line){
         }
 
 //        cout << label << " = " << count << endl;
-        m_stats[label] += count;
+        counts[label] += count;
 
         //  Skip to next;
         while (true){
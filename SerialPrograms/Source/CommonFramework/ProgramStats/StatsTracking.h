@@ -36,6 +36,11 @@ public:
 
     void parse_and_append_line(const std::string& line);
 
+    //  Parse a line from the stats file and add its counts to "counts".
+    //  Adding those counts to a tracker is the same as parsing the line into it.
+    static void parse_line(std::map<std::string, uint64_t>& counts, const std::string& line);
+    void add_counts(const std::map<std::string, uint64_t>& counts);
+
 
 protected:
 //    static constexpr bool HIDDEN_IF_ZERO = true;
@@ -5,6 +5,7 @@
  */
 
 #include "Common/Cpp/Concurrency/Backends/ThreadPool_Default.h"
+#include "Common/Cpp/Concurrency/Backends/ThreadPool_WorkStealing.h"
 #include "CommonFramework/Logging/Logger.h"
 #include "CommonFramework/Options/Environment/PerformanceOptions.h"
 #include "GlobalThreadPools.h"
@@ -15,7 +16,7 @@ namespace GlobalThreadPools{
 
 
 ThreadPool& computation_realtime(){
-    static ThreadPool_Default runner(
+    static ThreadPool_WorkStealing runner(
         [](){
             PerformanceOptions::instance().REALTIME_THREAD_POOL0.PRIORITY.set_on_this_thread(global_logger_tagged());
         },
@@ -24,7 +25,7 @@ ThreadPool& computation_realtime(){
     return runner;
 }
 ThreadPool& computation_normal(){
-    static ThreadPool_Default runner(
+    static ThreadPool_WorkStealing runner(
         [](){
             PerformanceOptions::instance().NORMAL_THREAD_POOL.PRIORITY.set_on_this_thread(global_logger_tagged());
         },
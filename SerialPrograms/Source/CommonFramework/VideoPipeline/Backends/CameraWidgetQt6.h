@@ -77,6 +77,9 @@ public:
     virtual VideoSnapshot snapshot_recent_nonblocking(WallClock min_time) override{
         return m_snapshot_manager.snapshot_recent_nonblocking(min_time);
     }
+    virtual VideoSnapshot snapshot_regions_nonblocking(WallClock min_time, SnapshotRegions regions) override{
+        return m_snapshot_manager.snapshot_regions_nonblocking(min_time, std::move(regions));
+    }
 
     virtual QWidget* make_display_QtWidget(QWidget* parent) override;
 
@@ -5,9 +5,14 @@
  */
 
 //#include "Common/Cpp/Concurrency/ReverseLockGuard.h"
+#include <string.h>
+#include <algorithm>
+#include <QScopeGuard>
 #include "Common/Cpp/Concurrency/AsyncTask.h"
+#include "Kernels/ImageConvert/Kernels_ImageConvert_YUV.h"
 #include "CommonFramework/ImageTypes/ImageRGB32_Qt.h"
 #include "CommonFramework/Tools/GlobalThreadPools.h"
+#include "SnapshotRegionRectangles.h"
 #include "SnapshotManager.h"
 
 //#include <iostream>
@@ -33,22 +38,111 @@ SnapshotManager::SnapshotManager(Logger& logger, QVideoFrameCache& cache)
 {}
 
 
-QImage SnapshotManager::frame_to_image(const QVideoFrame& frame){
-    QImage image = frame.toImage();
-    QImage::Format format = image.format();
-    if (format != QImage::Format_ARGB32 && format != QImage::Format_RGB32){
-        image = image.convertToFormat(QImage::Format_ARGB32);
+ImageRGB32 SnapshotManager::convert_mapped_frame(QVideoFrame frame, const SnapshotRegions& regions){
+    QVideoFrameFormat::PixelFormat pixel_format = frame.pixelFormat();
+    if (pixel_format != QVideoFrameFormat::Format_NV12 &&
+        pixel_format != QVideoFrameFormat::Format_YUYV
+    ){
+        return ImageRGB32();
+    }
+
+    //  Leave anything that needs to be flipped to Qt.
+    QVideoFrameFormat surface_format = frame.surfaceFormat();
+    if (surface_format.isMirrored() ||
+        surface_format.scanLineDirection() != QVideoFrameFormat::TopToBottom
+    ){
+        return ImageRGB32();
+    }
+
+    //  Match Qt's choice of matrix. If the frame doesn't say, Qt assumes
+    //  BT.709 for HD and BT.601 for SD. Leave other color spaces to Qt.
+    Kernels::YuvColorMatrix matrix;
+    switch (surface_format.colorSpace()){
+    case QVideoFrameFormat::ColorSpace_BT601:
+        matrix = Kernels::YuvColorMatrix::BT601;
+        break;
+    case QVideoFrameFormat::ColorSpace_BT709:
+        matrix = Kernels::YuvColorMatrix::BT709;
+        break;
+    case QVideoFrameFormat::ColorSpace_Undefined:
+        matrix = surface_format.frameHeight() > 576
+            ? Kernels::YuvColorMatrix::BT709
+            : Kernels::YuvColorMatrix::BT601;
+        break;
+    default:
+        return ImageRGB32();
+    }
+    Kernels::YuvToRgbCoefficients coefficients = Kernels::YuvToRgbCoefficients::make(
+        matrix,
+        surface_format.colorRange() == QVideoFrameFormat::ColorRange_Full
+    );
+
+    if (!frame.map(QVideoFrame::ReadOnly)){
+        return ImageRGB32();
     }
+    auto guard = qScopeGuard([&frame]{ frame.unmap(); });
+
+    size_t width = frame.width();
+    size_t height = frame.height();
+    ImageRGB32 image = m_frame_pool.get(width, height);
+    auto convert_rectangle = [&](size_t min_x, size_t min_y, size_t max_x, size_t max_y){
+        uint32_t* out = (uint32_t*)((char*)image.data() + min_y * image.bytes_per_row()) + min_x;
+        if (pixel_format == QVideoFrameFormat::Format_NV12){
+            Kernels::convert_NV12_to_RGB32(
+                out, image.bytes_per_row(),
+                frame.bits(0) + min_y * frame.bytesPerLine(0) + min_x, frame.bytesPerLine(0),
+                frame.bits(1) + min_y / 2 * frame.bytesPerLine(1) + min_x, frame.bytesPerLine(1),
+                max_x - min_x, max_y - min_y, coefficients
+            );
+        }else{
+            Kernels::convert_YUY2_to_RGB32(
+                out, image.bytes_per_row(),
+                frame.bits(0) + min_y * frame.bytesPerLine(0) + 2 * min_x, frame.bytesPerLine(0),
+                max_x - min_x, max_y - min_y, coefficients
+            );
+        }
+    };
+
+    if (regions){
+        //  The pool hands back old frames. Blank everything we don't convert
+        //  so that nothing from a previous frame leaks through.
+        auto clear_rectangle = [&](size_t min_x, size_t min_y, size_t max_x, size_t max_y){
+            char* out = (char*)image.data() + min_y * image.bytes_per_row() + min_x * sizeof(uint32_t);
+            for (size_t r = min_y; r < max_y; r++){
+                memset(out, 0, (max_x - min_x) * sizeof(uint32_t));
+                out += image.bytes_per_row();
+            }
+        };
+        for_each_region_rectangle(width, height, *regions, convert_rectangle, clear_rectangle);
+    }else{
+        convert_rectangle(0, 0, width, height);
+    }
+
     return image;
 }
-VideoSnapshot SnapshotManager::convert(QVideoFrame frame, WallClock timestamp) noexcept{
+ImageRGB32 SnapshotManager::frame_to_image(const QVideoFrame& frame, SnapshotRegions& regions){
+    ImageRGB32 image = convert_mapped_frame(frame, regions);
+    if (image){
+        return image;
+    }
+
+    //  Qt can only convert the whole frame.
+    regions.reset();
+
+    QImage qimage = frame.toImage();
+    QImage::Format format = qimage.format();
+    if (format != QImage::Format_ARGB32 && format != QImage::Format_RGB32){
+        qimage = qimage.convertToFormat(QImage::Format_ARGB32);
+    }
+    return QImage_to_ImageRGB32(std::move(qimage));
+}
+VideoSnapshot SnapshotManager::convert(QVideoFrame frame, WallClock timestamp, SnapshotRegions regions) noexcept{
     VideoSnapshot snapshot;
     snapshot.timestamp = timestamp;
     try{
         WallClock time0 = current_time();
-        snapshot.frame = std::make_shared<const ImageRGB32>(
-            QImage_to_ImageRGB32(frame_to_image(frame))
-        );
+        snapshot.frame = std::make_shared<const ImageRGB32>(frame_to_image(frame, regions));
+        snapshot.regions = std::move(regions);
         WallClock time1 = current_time();
         WriteSpinLock lg(m_stats_lock);
         m_stats_conversion.report_data(
@@ -62,8 +156,8 @@ VideoSnapshot SnapshotManager::convert(QVideoFrame frame, WallClock timestamp) n
     }
     return snapshot;
 }
-void SnapshotManager::convert(uint64_t seqnum, QVideoFrame frame, WallClock timestamp) noexcept{
-    VideoSnapshot snapshot = convert(std::move(frame), timestamp);
+void SnapshotManager::convert(uint64_t seqnum, QVideoFrame frame, WallClock timestamp, SnapshotRegions regions) noexcept{
+    VideoSnapshot snapshot = convert(std::move(frame), timestamp, std::move(regions));
 
     ObjectsToGC objects_to_gc;
     {
@@ -75,7 +169,7 @@ void SnapshotManager::convert(uint64_t seqnum, QVideoFrame frame, WallClock time
         if (m_queued_convert){
             m_queued_convert = false;
             seqnum = m_cache.get_latest(frame, timestamp);
-            dispatch_conversion(seqnum, std::move(frame), timestamp);
+            dispatch_conversion(seqnum, std::move(frame), timestamp, std::move(m_queued_regions));
         }
 
         objects_to_gc = cleanup();
@@ -84,7 +178,9 @@ void SnapshotManager::convert(uint64_t seqnum, QVideoFrame frame, WallClock time
 
     m_cv.notify_all();
 }
-bool SnapshotManager::try_dispatch_conversion(uint64_t seqnum, QVideoFrame frame, WallClock timestamp) noexcept{
+bool SnapshotManager::try_dispatch_conversion(
+    uint64_t seqnum, QVideoFrame frame, WallClock timestamp, SnapshotRegions regions
+) noexcept{
     //  Must call under the lock.
 
     AsyncTask* task;
@@ -101,7 +197,7 @@ bool SnapshotManager::try_dispatch_conversion(uint64_t seqnum, QVideoFrame frame
 
     try{
         std::function<void()> lambda = [=, this, frame = std::move(frame)](){
-            convert(seqnum, std::move(frame), timestamp);
+            convert(seqnum, std::move(frame), timestamp, std::move(regions));
         };
 
         *task = GlobalThreadPools::computation_realtime().try_dispatch_now(lambda);
@@ -113,6 +209,7 @@ bool SnapshotManager::try_dispatch_conversion(uint64_t seqnum, QVideoFrame frame
 
         //  Dispatch failed. Queue it for later.
         m_queued_convert = true;
+        m_queued_regions = std::move(regions);
     }catch (...){}
 
     m_pending_conversions.erase(seqnum);
@@ -120,14 +217,23 @@ bool SnapshotManager::try_dispatch_conversion(uint64_t seqnum, QVideoFrame frame
 
     return false;
 }
-void SnapshotManager::dispatch_conversion(uint64_t seqnum, QVideoFrame frame, WallClock timestamp) noexcept{
+void SnapshotManager::dispatch_conversion(
+    uint64_t seqnum, QVideoFrame frame, WallClock timestamp, SnapshotRegions regions
+) noexcept{
     //  Must call under the lock.
-    try_dispatch_conversion(seqnum, std::move(frame), timestamp);
+    try_dispatch_conversion(seqnum, std::move(frame), timestamp, std::move(regions));
 }
 
 bool SnapshotManager::push_new_screenshot(uint64_t seqnum, VideoSnapshot snapshot){
-    if (!m_converted_snapshot_archive.empty() && m_converted_snapshot_archive.rbegin()->first > seqnum){
-        return false;
+    if (!m_converted_snapshot_archive.empty()){
+        auto iter = m_converted_snapshot_archive.rbegin();
+        if (iter->first > seqnum){
+            return false;
+        }
+        //  Never replace a full frame with a partial one.
+        if (iter->first == seqnum && !iter->second.regions && snapshot.regions){
+            return false;
+        }
     }
     m_converted_snapshot_archive[seqnum] = snapshot;
     return true;
@@ -197,7 +303,7 @@ VideoSnapshot SnapshotManager::snapshot_latest_blocking(){
         uint64_t seqnum = m_cache.seqnum();
         if (!m_converted_snapshot_archive.empty()){
             auto iter = m_converted_snapshot_archive.rbegin();
-            if (seqnum <= iter->first){
+            if (seqnum <= iter->first && !iter->second.regions){
 //                cout << "snapshot_latest_blocking(): Cached" << endl;
                 return iter->second;
             }
@@ -209,7 +315,11 @@ VideoSnapshot SnapshotManager::snapshot_latest_blocking(){
             while (true){
                 std::map<uint64_t, VideoSnapshot>::reverse_iterator iter = m_converted_snapshot_archive.rbegin();
                 if (iter->first >= seqnum){
-                    return iter->second;
+                    if (!iter->second.regions){
+                        return iter->second;
+                    }
+                    //  Only part of it was converted. Redo the whole thing.
+                    break;
                 }
                 m_cv.wait(lg);
             }
@@ -223,9 +333,8 @@ VideoSnapshot SnapshotManager::snapshot_latest_blocking(){
         WallClock timestamp;
         seqnum = m_cache.get_latest(frame, timestamp);
 
-        notify = push_new_screenshot(seqnum, convert(std::move(frame), timestamp));
-
-        snapshot = m_converted_snapshot_archive.rbegin()->second;
+        snapshot = convert(std::move(frame), timestamp, nullptr);
+        notify = push_new_screenshot(seqnum, snapshot);
     }
 
     if (notify){
@@ -237,6 +346,9 @@ VideoSnapshot SnapshotManager::snapshot_latest_blocking(){
 }
 
 VideoSnapshot SnapshotManager::snapshot_recent_nonblocking(WallClock min_time){
+    return snapshot_regions_nonblocking(min_time, nullptr);
+}
+VideoSnapshot SnapshotManager::snapshot_regions_nonblocking(WallClock min_time, SnapshotRegions regions){
 //    WallClock now = current_time();
 
     std::lock_guard<Mutex> lg(m_lock);
@@ -245,7 +357,7 @@ VideoSnapshot SnapshotManager::snapshot_recent_nonblocking(WallClock min_time){
     uint64_t seqnum = m_cache.seqnum();
     if (!m_converted_snapshot_archive.empty()){
         auto iter = m_converted_snapshot_archive.rbegin();
-        if (seqnum <= iter->first){
+        if (seqnum <= iter->first && iter->second.covers(regions)){
 //            cout << "snapshot_latest_blocking(): Cached" << endl;
             return iter->second;
         }
@@ -256,16 +368,16 @@ VideoSnapshot SnapshotManager::snapshot_recent_nonblocking(WallClock min_time){
     seqnum = m_cache.get_latest(frame, timestamp);
 
     //  Dispatch this frame for conversion.
-    dispatch_conversion(seqnum, std::move(frame), timestamp);
+    dispatch_conversion(seqnum, std::move(frame), timestamp, regions);
 
     //  No cached snapshot.
     if (m_converted_snapshot_archive.empty()){
         return VideoSnapshot();
     }
 
-    //  Cached snapshot is too old.
+    //  Cached snapshot is too old or is missing some of the regions.
     auto iter = m_converted_snapshot_archive.rbegin();
-    if (min_time > iter->second.timestamp){
+    if (min_time > iter->second.timestamp || !iter->second.covers(regions)){
         return VideoSnapshot();
     }
 
@@ -11,6 +11,7 @@
 #include "Common/Cpp/Concurrency/Mutex.h"
 #include "Common/Cpp/Concurrency/ConditionVariable.h"
 #include "Common/Cpp/Logging/AbstractLogger.h"
+#include "CommonFramework/ImageTypes/ImageRGB32Pool.h"
 #include "CommonFramework/Tools/StatAccumulator.h"
 #include "CommonFramework/VideoPipeline/VideoFeed.h"
 #include "QVideoFrameCache.h"
@@ -27,13 +28,21 @@ public:
 public:
     VideoSnapshot snapshot_latest_blocking();
     VideoSnapshot snapshot_recent_nonblocking(WallClock min_time);
+    VideoSnapshot snapshot_regions_nonblocking(WallClock min_time, SnapshotRegions regions);
 
 private:
-    static QImage frame_to_image(const QVideoFrame& frame);
-    VideoSnapshot convert(QVideoFrame frame, WallClock timestamp) noexcept;
-    void convert(uint64_t seqnum, QVideoFrame frame, WallClock timestamp) noexcept;
-    bool try_dispatch_conversion(uint64_t seqnum, QVideoFrame frame, WallClock timestamp) noexcept;
-    void dispatch_conversion(uint64_t seqnum, QVideoFrame frame, WallClock timestamp) noexcept;
+    //  Convert NV12 and YUY2 frames straight from the mapped planes into a
+    //  pooled buffer. Returns a null image if the frame needs Qt's converter.
+    //  If "regions" is non-null, only those parts of the frame are converted.
+    ImageRGB32 convert_mapped_frame(QVideoFrame frame, const SnapshotRegions& regions);
+
+    //  Convert the frame. Clears "regions" if the entire frame was converted.
+    ImageRGB32 frame_to_image(const QVideoFrame& frame, SnapshotRegions& regions);
+
+    VideoSnapshot convert(QVideoFrame frame, WallClock timestamp, SnapshotRegions regions) noexcept;
+    void convert(uint64_t seqnum, QVideoFrame frame, WallClock timestamp, SnapshotRegions regions) noexcept;
+    bool try_dispatch_conversion(uint64_t seqnum, QVideoFrame frame, WallClock timestamp, SnapshotRegions regions) noexcept;
+    void dispatch_conversion(uint64_t seqnum, QVideoFrame frame, WallClock timestamp, SnapshotRegions regions) noexcept;
 
     bool push_new_screenshot(uint64_t seqnum, VideoSnapshot snapshot);
 
@@ -54,6 +63,7 @@ private:
 
     std::map<uint64_t, AsyncTask> m_pending_conversions;
     bool m_queued_convert = false;
+    SnapshotRegions m_queued_regions;
 
     //  Keep an archive of older snapshots. The idea here is that we don't want
     //  snapshots to be destroyed in other places (such as the video pivot)
@@ -61,6 +71,9 @@ private:
     //  will periodically clear out on the conversion threads.
     std::map<uint64_t, VideoSnapshot> m_converted_snapshot_archive;
 
+    //  Recycled frame buffers. Snapshots return theirs when destroyed.
+    ImageRGB32Pool m_frame_pool;
+
     SpinLock m_stats_lock;
     PeriodicStatsReporterI32 m_stats_conversion;
 };
@@ -0,0 +1,88 @@
+/*  Snapshot Region Rectangles
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *      Split a frame into the rectangles that a region snapshot converts and
+ *      the ones it blanks. (see VideoFeed::snapshot_regions_nonblocking())
+ *
+ */
+
+#ifndef PokemonAutomation_VideoPipeline_SnapshotRegionRectangles_H
+#define PokemonAutomation_VideoPipeline_SnapshotRegionRectangles_H
+
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "CommonFramework/ImageTools/ImageBoxes.h"
+
+namespace PokemonAutomation{
+
+
+
+//  Split the frame into disjoint pixel rectangles. Call "inside" on the ones
+//  covered by "regions" and "outside" on the rest.
+//  Edges are rounded out to even pixels so that chroma pairs are never split.
+template <typename InsideFunction, typename OutsideFunction>
+void for_each_region_rectangle(
+    size_t width, size_t height,
+    const std::vector<ImageFloatBox>& regions,
+    InsideFunction&& inside,
+    OutsideFunction&& outside
+){
+    std::vector<ImagePixelBox> boxes;
+    std::vector<size_t> rows;
+    for (const ImageFloatBox& region : regions){
+        //  Pad by a pixel to absorb rounding differences with extract_box_reference().
+        ImagePixelBox box = floatbox_to_pixelbox(width, height, region).expand_as(1);
+        box.min_x &= ~(size_t)1;
+        box.min_y &= ~(size_t)1;
+        box.max_x = std::min(box.max_x + (box.max_x & 1), width);
+        box.max_y = std::min(box.max_y + (box.max_y & 1), height);
+        if (box.min_x >= box.max_x || box.min_y >= box.max_y){
+            continue;
+        }
+        boxes.emplace_back(box);
+        rows.emplace_back(box.min_y);
+        rows.emplace_back(box.max_y);
+    }
+    rows.emplace_back(0);
+    rows.emplace_back(height);
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    //  Within each band of rows, merge the overlapping column ranges.
+    std::vector<std::pair<size_t, size_t>> columns;
+    for (size_t r = 1; r < rows.size(); r++){
+        size_t min_y = rows[r - 1];
+        size_t max_y = rows[r];
+        columns.clear();
+        for (const ImagePixelBox& box : boxes){
+            if (box.min_y <= min_y && max_y <= box.max_y){
+                columns.emplace_back(box.min_x, box.max_x);
+            }
+        }
+        std::sort(columns.begin(), columns.end());
+        size_t c = 0;
+        size_t last_x = 0;
+        while (c < columns.size()){
+            size_t min_x = columns[c].first;
+            size_t max_x = columns[c].second;
+            for (c++; c < columns.size() && columns[c].first <= max_x; c++){
+                max_x = std::max(max_x, columns[c].second);
+            }
+            if (last_x < min_x){
+                outside(last_x, min_y, min_x, max_y);
+            }
+            inside(min_x, min_y, max_x, max_y);
+            last_x = max_x;
+        }
+        if (last_x < width){
+            outside(last_x, min_y, width, max_y);
+        }
+    }
+}
+
+
+
+}
+#endif
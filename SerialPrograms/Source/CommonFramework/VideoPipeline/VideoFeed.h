@@ -7,12 +7,21 @@
 #ifndef PokemonAutomation_VideoFeedInterface_H
 #define PokemonAutomation_VideoFeedInterface_H
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 #include "Common/Cpp/Time.h"
+#include "CommonFramework/ImageTools/ImageBoxes.h"
 #include "CommonFramework/ImageTypes/ImageRGB32.h"
 
 namespace PokemonAutomation{
 
+class ImageDerivedCache;
+
+
+//  A list of regions within a frame. Null means the entire frame.
+using SnapshotRegions = std::shared_ptr<const std::vector<ImageFloatBox>>;
+
 
 struct VideoSnapshot{
     //  The frame itself. Null means no snapshot was available.
@@ -22,6 +31,15 @@ struct VideoSnapshot{
     //  This will be as close as possible to when the frame was taken.
     WallClock timestamp = WallClock::min();
 
+    //  Optional per-frame cache of derived images and stats.
+    //  Attached by the inference pivot. (see ImageDerivedCache.h)
+    std::shared_ptr<ImageDerivedCache> cache;
+
+    //  If non-null, only the pixels inside these regions were converted.
+    //  Everything else in the frame is black.
+    //  (see VideoFeed::snapshot_regions_nonblocking())
+    SnapshotRegions regions;
+
     VideoSnapshot()
          : frame(std::make_shared<const ImageRGB32>())
          , timestamp(WallClock::min())
@@ -34,6 +52,40 @@ struct VideoSnapshot{
     //  Returns true if the snapshot is valid.
     explicit operator bool() const{ return frame && *frame; }
 
+    //  Returns true if every pixel in "requested" is valid in this snapshot.
+    //  This compares pixels rather than floats so that a box that shares an
+    //  edge with a converted region counts as covered.
+    bool covers(const SnapshotRegions& requested) const{
+        if (!regions || regions == requested){
+            return true;
+        }
+        if (!requested || !frame){
+            return false;
+        }
+        size_t width = frame->width();
+        size_t height = frame->height();
+        for (const ImageFloatBox& box : *requested){
+            ImagePixelBox pixels = floatbox_to_pixelbox(width, height, box);
+            pixels.max_x = std::min(pixels.max_x, width);
+            pixels.max_y = std::min(pixels.max_y, height);
+            bool found = false;
+            for (const ImageFloatBox& region : *regions){
+                //  Conversion pads every region by at least a pixel.
+                ImagePixelBox converted = floatbox_to_pixelbox(width, height, region).expand_as(1);
+                if (converted.min_x <= pixels.min_x && pixels.max_x <= converted.max_x &&
+                    converted.min_y <= pixels.min_y && pixels.max_y <= converted.max_y
+                ){
+                    found = true;
+                    break;
+                }
+            }
+            if (!found){
+                return false;
+            }
+        }
+        return true;
+    }
+
     const ImageRGB32* operator->() const{ return frame.get(); }
 
     operator std::shared_ptr<const ImageRGB32>() const{ return frame; }
@@ -42,6 +94,8 @@ struct VideoSnapshot{
     void clear(){
         frame.reset();
         timestamp = WallClock::min();
+        cache.reset();
+        regions.reset();
     }
 };
 
@@ -105,6 +159,18 @@ public:
     //  on future calls.
     virtual VideoSnapshot snapshot_recent_nonblocking(WallClock min_time) = 0;
 
+    //  Same as snapshot_recent_nonblocking(), but the caller only needs the
+    //  pixels inside "regions". Implementations may skip converting the rest
+    //  of the frame. Check "VideoSnapshot::regions" to see what was converted.
+    //
+    //  Do not use these snapshots for screenshots or error reports. Use
+    //  snapshot_latest_blocking() for those. It always returns a full frame.
+    //
+    //  The default implementation ignores "regions" and converts everything.
+    virtual VideoSnapshot snapshot_regions_nonblocking(WallClock min_time, SnapshotRegions regions){
+        return snapshot_recent_nonblocking(min_time);
+    }
+
 
 public:
     //  Returns the currently measured frames/second for the video source.
@@ -447,6 +447,14 @@ VideoSnapshot VideoSession::snapshot_recent_nonblocking(WallClock min_time){
         return VideoSnapshot();
     }
 }
+VideoSnapshot VideoSession::snapshot_regions_nonblocking(WallClock min_time, SnapshotRegions regions){
+    ReadSpinLock lg(m_state_lock, PA_CURRENT_FUNCTION);
+    if (m_video_source){
+        return m_video_source->snapshot_regions_nonblocking(min_time, std::move(regions));
+    }else{
+        return VideoSnapshot();
+    }
+}
 
 double VideoSession::fps_source() const{
     ReadSpinLock lg(m_fps_lock, PA_CURRENT_FUNCTION);
@@ -69,6 +69,9 @@ public:
 
     virtual VideoSnapshot snapshot_latest_blocking() = 0;
     virtual VideoSnapshot snapshot_recent_nonblocking(WallClock min_time) = 0;
+    virtual VideoSnapshot snapshot_regions_nonblocking(WallClock min_time, SnapshotRegions regions){
+        return snapshot_recent_nonblocking(min_time);
+    }
 
 
 protected:
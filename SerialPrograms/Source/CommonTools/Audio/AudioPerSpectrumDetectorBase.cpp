@@ -106,6 +106,8 @@ bool AudioPerSpectrumDetectorBase::process_spectrums(
     if (m_matcher == nullptr || m_matcher->sample_rate() != sample_rate){
         m_logger.log("Loading spectrogram...");
         m_matcher = build_spectrogram_matcher(sample_rate);
+        // Share spectrum filtering with the other detectors on this feed.
+        m_matcher->attach_to_feed(audio_feed);
     }
 
     // Feed spectrum one by one to the matcher:
@@ -7,9 +7,9 @@
 //#include "Common/Cpp/Exceptions.h"
 #include "Common/Cpp/Containers/AlignedVector.tpp"
 #include "Kernels/ScaleInvariantMatrixMatch/Kernels_ScaleInvariantMatrixMatch.h"
-#include "Kernels/SpikeConvolution/Kernels_SpikeConvolution.h"
 #include "CommonFramework/AudioPipeline/AudioFeed.h"
 #include "CommonFramework/AudioPipeline/AudioTemplate.h"
+#include "SpectrogramMatchingEngine.h"
 #include "SpectrogramMatcher.h"
 
 //#include <iostream>
@@ -19,33 +19,6 @@
 namespace PokemonAutomation{
 
 
-std::vector<float> buildSpikeKernel(size_t numFrequencies, size_t halfSampleRate){
-    std::vector<float> kernel;
-    // We find a good kernel when sample rate is 48K and numFrequencies is 2048:
-    // [-4.f, -3.f, -2.f, -1.f, 0.f, 1.f, 2.f, 3.f, 4.f, 4.f, 3.f, 2.f, 1.f, 0.f, -1.f, -2.f, -3.f, -4.f]
-    // This spans frenquency range of 17 * halfSampleRate / numFrequencies = 199.21875Hz, where 17 is the number of intervals in the above series.
-    // For another sample rate and numFrequencies combination, the number of intervals is
-    // 199.21875 * numFrequencies / halfSampleRate
-    size_t numKernelIntervals = int(199.21875 * numFrequencies / halfSampleRate + 0.5);
-    size_t slopeLen = numKernelIntervals / 2;
-    for (size_t i = 0; i <= slopeLen; i++){
-        kernel.push_back(-4.0f + 8.f * i / (float)slopeLen);
-    }
-    for (size_t i = ((numKernelIntervals+1) % 2); i <= slopeLen; i++){
-        kernel.push_back(-4.0f + 8.f * (slopeLen-i)/(float)slopeLen);
-    }
-    return kernel;
-}
-
-// std::vector<float> buildSmoothKernel(size_t numFrequencies, size_t halfSampleRate){
-//     std::vector<float> kernel;
-//     // We find a good kernel when sample rate is 48K and numFrequencies is 2048:
-//     // [0.0111, 0.135, 0.606, 1.0, 0.606, 0.135, 0.0111], built as Gaussian distribution with sigma(stddev) as 1.0
-//     // The equation for Gaussian is exp(-x^2/(2 sigma^2))
-//     // We can think sigma value as 1.0 * frequency_gap = 1.0 * halfSampleRate / numFrequencies = 11.71875 Hz
-// }
-
-
 SpectrogramMatcher::SpectrogramMatcher(
     std::string name,
     AudioTemplate audioTemplate, Mode mode, size_t sample_rate,
@@ -58,9 +31,12 @@ SpectrogramMatcher::SpectrogramMatcher(
 {
     const size_t numTemplateWindows = m_template.numWindows();
 //    cout << "numTemplateWindows = " << numTemplateWindows << endl;
-    m_numOriginalFrequencies = m_template.numFrequencies();
+    const size_t numOriginalFrequencies = m_template.numFrequencies();
     if (m_template.numFrequencies() == 0){  // Error case, failed to load template
         std::cout << "Error: load audio template failed" << std::endl;
+        //  Every spectrum will fail the size check so match() always returns FLT_MAX.
+        m_stream = std::make_shared<SpectrogramStream>(SpectrogramStream::Format{m_mode, sample_rate, 0, 0, 0});
+        m_stream->attach(*this);
         return;
 //        throw FileException(nullptr, PA_CURRENT_FUNCTION, "Unable to load audio template file.", templateFilename.toStdString());
     }
@@ -76,43 +52,23 @@ SpectrogramMatcher::SpectrogramMatcher(
     // So 5.0 24K / 2048 = 58.59375Hz. For other sample rate and numFrequencies combinations,
     // j * halfSampleRate/numFrequencies >= 58.59375 -> j >= 58.59375 * numFrequnecies / halfSampleRate
 
-    m_originalFreqStart = int(low_frequency_filter * m_numOriginalFrequencies / halfSampleRate + 0.5);
-    m_originalFreqEnd = 20000 * m_numOriginalFrequencies / halfSampleRate + 1;
+    m_originalFreqStart = int(low_frequency_filter * numOriginalFrequencies / halfSampleRate + 0.5);
+    m_originalFreqEnd = 20000 * numOriginalFrequencies / halfSampleRate + 1;
 
-    // Initialize the spike convolution kernel:
-    m_convKernel = buildSpikeKernel(m_numOriginalFrequencies, halfSampleRate);
+    m_stream = std::make_shared<SpectrogramStream>(SpectrogramStream::Format{
+        m_mode, sample_rate, numOriginalFrequencies, m_originalFreqStart, m_originalFreqEnd
+    });
 
     switch(m_mode){
     case Mode::SPIKE_CONV:
-    {
-        // Do convolution on audio template
-        const size_t numConvedFrequencies = (m_originalFreqEnd - m_originalFreqStart) - m_convKernel.size() + 1;
-
-        AudioTemplate audio_template(numConvedFrequencies, numTemplateWindows);
-        for (size_t i = 0; i < numTemplateWindows; i++){
-            conv(
-                m_template.getWindow(i) + m_originalFreqStart, m_originalFreqEnd - m_originalFreqStart,
-                audio_template.getWindow(i)
-            );
-        }
-
-        m_template = std::move(audio_template);
-        m_freqStart = 0;
-        m_freqEnd = numConvedFrequencies;
-        break;
-    }
     case Mode::AVERAGE_5:
     {
-        // Avereage every 5 frequencies
-        const size_t numNewFreq = (m_originalFreqEnd - m_originalFreqStart) / 5;
+        // Filter the audio template the same way as the incoming spectrums.
+        const size_t numNewFreq = m_stream->num_filtered_frequencies();
 
         AudioTemplate audio_template(numNewFreq, numTemplateWindows);
         for (size_t i = 0; i < numTemplateWindows; i++){
-            for (size_t j = 0; j < numNewFreq; j++){
-                const float * rawFreqMag = m_template.getWindow(i) + m_originalFreqStart + j*5;
-                const float newMag = (rawFreqMag[0] + rawFreqMag[1] + rawFreqMag[2] + rawFreqMag[3] + rawFreqMag[4]) / 5.0f;
-                audio_template.getWindow(i)[j] = newMag;
-            }
+            m_stream->filter(m_template.getWindow(i), audio_template.getWindow(i));
         }
 
         m_template = std::move(audio_template);
@@ -145,36 +101,29 @@ SpectrogramMatcher::SpectrogramMatcher(
 //    cout << "m_numSpectrumsNeeded = " << m_numSpectrumsNeeded << endl;
 
     m_templateNorm = buildTemplateNorm();
-}
 
-uint64_t SpectrogramMatcher::latestTimestamp() const{
-    if (m_spectrums.size() == 0){
-        return SIZE_MAX;
-    }
-    return m_spectrums.front().stamp;
+    m_stream->attach(*this);
+}
+SpectrogramMatcher::~SpectrogramMatcher(){
+    m_stream->detach(*this);
 }
 
-void SpectrogramMatcher::conv(const float* src, size_t num, float* dst){
-//    cout << (size_t)dst % 64 << endl;
-
-    const size_t numConvedFrequencies = num - m_convKernel.size() + 1;
-    if (num < m_convKernel.size()){
-        memset(dst, 0, numConvedFrequencies * sizeof(float));
+void SpectrogramMatcher::attach_to_feed(const AudioFeed& feed){
+    std::shared_ptr<SpectrogramStream> stream = SpectrogramMatchingEngine::instance().get_stream(feed, m_stream->format());
+    if (stream == m_stream){
         return;
     }
+    m_stream->detach(*this);
+    m_stream = std::move(stream);
+    m_shared = true;
+    m_stream->attach(*this);
+    m_lastStampTested = UINT64_MAX;
+    m_lastScale = 0.0;
+}
 
-#if 0
-    for (size_t i = 0; i < num-m_convKernel.size()+1; i++){
-        dst[i] = 0.0f;
-        for (size_t j = 0; j < m_convKernel.size(); j++){
-            dst[i] += src[i+j] * m_convKernel[j];
-        }
-    }
-#else
-    Kernels::SpikeConvolution::compute_spike_kernel(
-        dst, src, num, m_convKernel.data(), m_convKernel.size()
-    );
-#endif
+uint64_t SpectrogramMatcher::latestTimestamp() const{
+    std::lock_guard<Mutex> lg(m_stream->m_lock);
+    return m_latestStamp;
 }
 
 std::vector<float> SpectrogramMatcher::buildTemplateNorm() const{
@@ -194,118 +143,81 @@ std::vector<float> SpectrogramMatcher::buildTemplateNorm() const{
     return ret;
 }
 
-bool SpectrogramMatcher::update_to_new_spectrum(AudioSpectrum spectrum){
-    if (m_numOriginalFrequencies != spectrum.magnitudes->size()){
-        std::cout << "Error: number of frequencies don't match in SpectrogramMatcher::match() " << 
-            m_numOriginalFrequencies << " " << spectrum.magnitudes->size() << std::endl;
-        return false;
-    }
+void SpectrogramMatcher::reset_history(){
+    //  The next spectrum passed in sets "m_minStamp".
+    m_latestStamp = UINT64_MAX;
+    m_cache.fill(CachedScore());
+}
 
-    switch(m_mode){
-    case Mode::SPIKE_CONV:
-    {
-        // Do the conv on new spectrum too.
-        AlignedVector<float> convedSpectrum(m_template.bufferSize());
-        conv(spectrum.magnitudes->data() + m_originalFreqStart,
-            m_originalFreqEnd - m_originalFreqStart, convedSpectrum.data());
-        
-        spectrum.magnitudes = std::make_unique<AlignedVector<float>>(std::move(convedSpectrum));
-        break;
-    }
-    case Mode::AVERAGE_5:
-    {
-        AlignedVector<float> avgedSpectrum(m_template.bufferSize());
-        for (size_t j = 0; j < m_template.numFrequencies(); j++){
-            const float * rawFreqMag = spectrum.magnitudes->data() + m_originalFreqStart + j*5;
-            const float newMag = (rawFreqMag[0] + rawFreqMag[1] + rawFreqMag[2] + rawFreqMag[3] + rawFreqMag[4]) / 5.0f;
-            avgedSpectrum[j] = newMag;
+bool SpectrogramMatcher::update_to_new_spectrums(const std::vector<AudioSpectrum>& new_spectrums){
+    for (auto it = new_spectrums.rbegin(); it != new_spectrums.rend(); it++){
+        if (!m_stream->add(*this, *it)){
+            return false;
         }
-        spectrum.magnitudes = std::make_unique<AlignedVector<float>>(std::move(avgedSpectrum));
-        break;
-    }
-    case Mode::RAW:
-        break;
     }
+    return true;
+}
 
-    // Compute the norm square (= sum squares) of the spectrum, used for matching:
-    // TODO: if there will be multiple SpectrogramMatcher running on the same audio stream, can
-    // move this per-spectrum computation to a shared struct for those matchers to save computation.
-    float spectrumNormSqr = 0.0f;
-    for (size_t i = m_freqStart; i < m_freqEnd; i++){
-        float mag = (*spectrum.magnitudes)[i];
-        spectrumNormSqr += mag * mag;
+bool SpectrogramMatcher::score_window(const SpectrogramStream& stream, uint64_t stamp){
+    CachedScore& cached = m_cache[stamp % m_cache.size()];
+    if (cached.stamp == stamp){
+        return true;
     }
-    m_spectrumNormSqrs.push_front(spectrumNormSqr);
-
-    m_spectrums.emplace_front(std::move(spectrum));
 
-    return true;
-}
+    if (m_numSpectrumsNeeded == 0 || stamp + 1 < m_numSpectrumsNeeded){
+        return false;
+    }
+    if (stamp + 1 - m_numSpectrumsNeeded < m_minStamp){
+        return false;
+    }
 
-bool SpectrogramMatcher::update_to_new_spectrums(const std::vector<AudioSpectrum>& new_spectrums){
-    for (auto it = new_spectrums.rbegin(); it != new_spectrums.rend(); it++){
-        if(!update_to_new_spectrum(*it)){
+    //  Newest to oldest.
+    std::vector<const float*> rows(m_numSpectrumsNeeded);
+    for (size_t i = 0; i < m_numSpectrumsNeeded; i++){
+        rows[i] = stream.row(stamp - i);
+        if (rows[i] == nullptr){
             return false;
         }
     }
 
-    // pop out too old spectrums
-    while (m_spectrums.size() > m_numSpectrumsNeeded){
-        m_spectrums.pop_back();
-        m_spectrumNormSqrs.pop_back();
+    float score = FLT_MAX; // the lower the score, the better the match
+    float scale = 0.0f;
+    if (m_templateRange.size() == 1){
+        // Match the full template
+        std::tie(score, scale) = match_sub_template(0, rows.data());
+    }else{
+        // Match each individual sub-template
+        for (size_t sub_template = 0; sub_template < m_templateRange.size(); sub_template++){
+            float sub_template_score = FLT_MAX;
+            float sub_template_scale = 1.0f;
+            std::tie(sub_template_score, sub_template_scale) = match_sub_template(sub_template, rows.data());
+            if (sub_template_score < score){
+                score = sub_template_score;
+                scale = sub_template_scale;
+            }
+        }
     }
 
+    cached.stamp = stamp;
+    cached.score = score;
+    cached.scale = scale;
     return true;
 }
 
-std::pair<float, float> SpectrogramMatcher::match_sub_template(size_t sub_index) const{
-#if 0
-    auto iter = m_spectrums.begin();
-    auto iter2 = m_spectrumNormSqrs.begin();
-    float streamSumSqr = 0.0f;
-    float sumMulti = 0.0f;
-
-    const size_t template_start = m_templateRange[sub_index].first;
-    const size_t template_end = m_templateRange[sub_index].second;
-    for (size_t i = template_start; i < template_end; i++, iter++, iter2++){
-        // match in order from latest window to oldest
-        const float* templateData = m_template.getWindow(template_end-1-i);
-        const float* streamData = iter->magnitudes->data();
-        streamSumSqr += *iter2;
-        for (size_t j = m_freqStart; j < m_freqEnd; j++){
-            sumMulti += templateData[j] * streamData[j];
-        }
-    }
-//    cout << "sumMulti = " << sumMulti << ", streamSumSqr = " << streamSumSqr << endl;
-    const float scale = (streamSumSqr < 1e-6f ? 1.0f : sumMulti / streamSumSqr);
-
-    iter = m_spectrums.begin();
-    float sum = 0.0f;
-    for (size_t i = template_start; i < template_end; i++, iter++){
-        // match in order from latest window to oldest
-        const float* templateData = m_template.getWindow(template_end-1-i);
-        const float* streamData = iter->magnitudes->data();
-        for (size_t j = m_freqStart; j < m_freqEnd; j++){
-            float d = templateData[j] - scale * streamData[j];
-            sum += d * d;
-        }
-    }
-#else
+std::pair<float, float> SpectrogramMatcher::match_sub_template(size_t sub_index, const float* const* rows) const{
     //  Build matrix.
-    auto iter = m_spectrums.begin();
     const size_t template_start = m_templateRange[sub_index].first;
     const size_t template_end = m_templateRange[sub_index].second;
     size_t windows = template_end - template_start;
 //    cout << windows << endl;
-//    cout << m_spectrums.size() << " / " << windows << endl;
     size_t freqs = m_freqEnd - m_freqStart;
     std::vector<const float*> matrixA(windows);
     std::vector<const float*> matrixT(windows);
-    for (size_t i = 0; i < windows; i++, iter++){
+    for (size_t i = 0; i < windows; i++){
 //        cout << "Template: " << ((size_t)m_template.getWindow(template_end - 1 - i) % 64) << endl;
-//        cout << "Samples:  " << ((size_t)iter->magnitudes->data() % 64) << endl;
+//        cout << "Samples:  " << ((size_t)rows[i] % 64) << endl;
         matrixT[i] = m_freqStart + m_template.getWindow(windows - 1 - i);
-        matrixA[i] = m_freqStart + iter->magnitudes->data();
+        matrixA[i] = m_freqStart + rows[i];
 //        cout << matrixT[i] << " : " << matrixA[i] << endl;
     }
 
@@ -322,7 +234,6 @@ std::pair<float, float> SpectrogramMatcher::match_sub_template(size_t sub_index)
         scale,
         matrixA.data(), matrixT.data()
     );
-#endif
 
 
     float score = sqrt(sum) / m_templateNorm[0];
@@ -337,68 +248,46 @@ float SpectrogramMatcher::match(const std::vector<AudioSpectrum>& new_spectrums)
         return FLT_MAX;
     }
 
-    if (m_spectrums.size() < m_numSpectrumsNeeded){
+    const uint64_t curStamp = latestTimestamp();
+    if (curStamp == UINT64_MAX){
         return FLT_MAX;
     }
 
-    // Check whether the stored spectrums' timestamps are continuous:
-    size_t curStamp = m_spectrums.front().stamp;
-    size_t lastStamp = curStamp + 1;
-    for (const auto& s : m_spectrums){
-        if (s.stamp != lastStamp - 1){
-            std::cout << "Error: SpectrogramMatcher (" + m_name + ") spectrum timestamps are not continuous:" << std::endl;
-            for (const auto& sp : m_spectrums){
-                std::cout << sp.stamp << ", ";
-            }
-            std::cout << std::endl;
-            return FLT_MAX;
-        }
-        lastStamp--;
+    if (m_lastStampTested != UINT64_MAX && curStamp <= m_lastStampTested){
+        return FLT_MAX;
     }
 
-    if (m_lastStampTested != SIZE_MAX && curStamp <= m_lastStampTested){
+    // Do the match. If the stream lost any of the spectrums in the window
+    // (not enough history yet or a gap in the stamps), there is nothing to match.
+    float score = FLT_MAX; // the lower the score, the better the match
+    float scale = 0.0f;
+    if (!m_stream->score(*this, curStamp, score, scale)){
         return FLT_MAX;
     }
     m_lastStampTested = curStamp;
-    
-    // Do the match:
-    float score = FLT_MAX; // the lower the score, the better the match
-    if (m_templateRange.size() == 1){
-        // Match the full template
-        std::tie(score, m_lastScale) = match_sub_template(0);
-    }else{
-        // Match each individual sub-template
-        for (size_t sub_template = 0; sub_template < m_templateRange.size(); sub_template++){
-            float sub_template_score = FLT_MAX;
-            float sub_template_scale = 1.0f;
-            std::tie(sub_template_score, sub_template_scale) = match_sub_template(sub_template);
-            if (sub_template_score < score){
-                score = sub_template_score;
-                m_lastScale = sub_template_scale;
-            }
-        }
-    }
+    m_lastScale = scale;
 
     return score;
 }
 
 bool SpectrogramMatcher::skip(const std::vector<AudioSpectrum>& new_spectrums){
-    // Note: ideally we don't want to have any computation while skipping.
-    // But update_to_new_spectrums() may still do some filtering and vector norm computation.
-    // Since the computation is relatively small and we won't be skipping lots of frames anyway,
-    // this should be fine for now.
-    // We can improve this later.
+    // Note: this still filters any spectrums that no other matcher on the
+    // stream has filtered yet, since the next match() needs them as history.
     return update_to_new_spectrums(new_spectrums);
 }
 
 void SpectrogramMatcher::clear(){
-    m_spectrums.clear();
-    m_spectrumNormSqrs.clear();
-    m_lastStampTested = SIZE_MAX;
+    if (!m_shared){
+        m_stream->clear();
+    }
+    {
+        std::lock_guard<Mutex> lg(m_stream->m_lock);
+        reset_history();
+    }
+    m_lastStampTested = UINT64_MAX;
     m_lastScale = 0.0;
 }
 
 
 
-
 }
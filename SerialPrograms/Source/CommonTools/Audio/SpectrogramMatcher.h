@@ -7,20 +7,25 @@
 #ifndef PokemonAutomation_CommonTools_SpectrogramMatcher_H
 #define PokemonAutomation_CommonTools_SpectrogramMatcher_H
 
+#include <stdint.h>
 #include <cstddef>
 #include <array>
 #include <memory>
 #include <vector>
-#include <list>
 #include "CommonFramework/AudioPipeline/AudioFeed.h"
 #include "CommonFramework/AudioPipeline/AudioTemplate.h"
 
 namespace PokemonAutomation{
 
 class AudioSpectrum;
+class SpectrogramStream;
 
 // Load an audio template from disk and use its spectrogram to match the
 // spectrogram of the incoming audio stream.
+//
+// The filtered incoming spectrums are kept in a SpectrogramStream. By default
+// each matcher has its own. Call attach_to_feed() to share one with every other
+// matcher on the same audio feed that filters spectrums the same way.
 class SpectrogramMatcher{
 public:
     enum class Mode{
@@ -46,9 +51,18 @@ public:
         AudioTemplate audioTemplate, Mode mode, size_t sample_rate,
         double low_frequency_filter, size_t templateSubdivision = 0
     );
+    ~SpectrogramMatcher();
+    SpectrogramMatcher(const SpectrogramMatcher&) = delete;
+    void operator=(const SpectrogramMatcher&) = delete;
 
     size_t sample_rate() const{ return m_sample_rate; }
 
+    // Share spectrum filtering and history with all other matchers attached
+    // to `feed` that use the same mode, sample rate and frequency range.
+    // This drops the spectrums seen so far, the same as clear().
+    // See SpectrogramMatchingEngine.
+    void attach_to_feed(const AudioFeed& feed);
+
     // Match the newest spectrums and return a match score.
     // Newer (larger timestamp) spectrums at beginning of `new_spectrums` while older (smaller
     // timestamp) spectrums at the end.
@@ -69,7 +83,7 @@ public:
     size_t numMatchedWindows() const { return m_numSpectrumsNeeded; }
 
     // Return latest timestamp from the stored audio spectrum stream.
-    // Return SIZE_MAX if there is no stored spectrum yet.
+    // Return UINT64_MAX if there is no stored spectrum yet.
     uint64_t latestTimestamp() const;
 
     // Return the scale found by the matcher to scale the input audio stream to best
@@ -78,17 +92,28 @@ public:
     float lastMatchedScale() const { return m_lastScale; }
 
 private:
-    void conv(const float* src, size_t num, float* dst);
-    
+    friend class SpectrogramStream;
+
+    struct CachedScore{
+        uint64_t stamp = UINT64_MAX;
+        float score = 0.0f;
+        float scale = 0.0f;
+    };
+
     // The function to build `m_templateNorm`
     std::vector<float> buildTemplateNorm() const;
 
-    // For a given sub-template, return its match score and scaling factor
-    std::pair<float, float> match_sub_template(size_t sub_index) const;
+    // For a given sub-template, return its match score and scaling factor.
+    // `rows[i]` is the filtered spectrum `i` windows before the newest.
+    std::pair<float, float> match_sub_template(size_t sub_index, const float* const* rows) const;
 
-    // Update internal data for the next new spectrum. Called by `update_to_new_spectrums()`.
-    // Return true if there is no error.
-    bool update_to_new_spectrum(AudioSpectrum newSpectrum);
+    // Score the window of spectrums ending at `stamp` and cache the result.
+    // Return false if the window is not all in the stream history.
+    // Called by SpectrogramStream with its lock held.
+    bool score_window(const SpectrogramStream& stream, uint64_t stamp);
+
+    // Forget the history and cached scores. Called with the stream lock held.
+    void reset_history();
 
     // Update internal data for the new specttrums.
     // Return true if there is no error.
@@ -102,7 +127,6 @@ private:
 
     size_t m_sample_rate;
 
-    size_t m_numOriginalFrequencies = 0;
     size_t m_originalFreqStart = 0;
     size_t m_originalFreqEnd = 0;
 
@@ -116,16 +140,25 @@ private:
 
     Mode m_mode = Mode::RAW;
 
-    std::vector<float> m_convKernel;
-
-    // Spectrums from audio feed. They will be matched against the template.
-    std::list<AudioSpectrum> m_spectrums;
-    // Norm squares of each spectrum in `m_spectrums`.
-    std::list<float> m_spectrumNormSqrs;
-    // How many spectrums needed to store.
+    // Filtered spectrums from audio feed. They will be matched against the template.
+    std::shared_ptr<SpectrogramStream> m_stream;
+    bool m_shared = false;
+    // How many spectrums needed to match.
     size_t m_numSpectrumsNeeded = 0;
 
-    size_t m_lastStampTested = SIZE_MAX;
+    // The fields below are guarded by the stream lock.
+
+    // Windows starting before this stamp are not matched. Set to the first
+    // spectrum passed in after attaching or clear(), so a shared history
+    // never matches sounds from before this matcher was listening.
+    uint64_t m_minStamp = 0;
+    // Stamp of the newest spectrum passed in. UINT64_MAX if none yet.
+    uint64_t m_latestStamp = UINT64_MAX;
+    // Scores of recent windows, indexed by stamp. The stream may score this
+    // matcher on behalf of other matchers before this one asks.
+    std::array<CachedScore, 64> m_cache;
+
+    uint64_t m_lastStampTested = UINT64_MAX;
     float m_lastScale = 0.0f;
 };
 
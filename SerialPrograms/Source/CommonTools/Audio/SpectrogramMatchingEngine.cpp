@@ -0,0 +1,371 @@
+/*  Spectrogram Matching Engine
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <string.h>
+#include <cfloat>
+#include <tuple>
+#include <iostream>
+#include "Common/Cpp/Containers/AlignedVector.tpp"
+#include "Kernels/Kernels_Alignment.h"
+#include "Kernels/SpikeConvolution/Kernels_SpikeConvolution.h"
+#include "CommonFramework/AudioPipeline/AudioFeed.h"
+#include "Tests/TestUtils.h"
+#include "SpectrogramMatchingEngine.h"
+
+//#include <iostream>
+//using std::cout;
+//using std::endl;
+
+namespace PokemonAutomation{
+
+
+//  How many spectrums to keep beyond the longest template. This lets a
+//  matcher that polls less often than the others catch up without losing
+//  its window.
+const size_t SPECTROGRAM_HISTORY_SLACK = 128;
+
+
+std::vector<float> buildSpikeKernel(size_t numFrequencies, size_t halfSampleRate){
+    std::vector<float> kernel;
+    // We find a good kernel when sample rate is 48K and numFrequencies is 2048:
+    // [-4.f, -3.f, -2.f, -1.f, 0.f, 1.f, 2.f, 3.f, 4.f, 4.f, 3.f, 2.f, 1.f, 0.f, -1.f, -2.f, -3.f, -4.f]
+    // This spans frenquency range of 17 * halfSampleRate / numFrequencies = 199.21875Hz, where 17 is the number of intervals in the above series.
+    // For another sample rate and numFrequencies combination, the number of intervals is
+    // 199.21875 * numFrequencies / halfSampleRate
+    size_t numKernelIntervals = int(199.21875 * numFrequencies / halfSampleRate + 0.5);
+    size_t slopeLen = numKernelIntervals / 2;
+    for (size_t i = 0; i <= slopeLen; i++){
+        kernel.push_back(-4.0f + 8.f * i / (float)slopeLen);
+    }
+    for (size_t i = ((numKernelIntervals+1) % 2); i <= slopeLen; i++){
+        kernel.push_back(-4.0f + 8.f * (slopeLen-i)/(float)slopeLen);
+    }
+    return kernel;
+}
+
+// std::vector<float> buildSmoothKernel(size_t numFrequencies, size_t halfSampleRate){
+//     std::vector<float> kernel;
+//     // We find a good kernel when sample rate is 48K and numFrequencies is 2048:
+//     // [0.0111, 0.135, 0.606, 1.0, 0.606, 0.135, 0.0111], built as Gaussian distribution with sigma(stddev) as 1.0
+//     // The equation for Gaussian is exp(-x^2/(2 sigma^2))
+//     // We can think sigma value as 1.0 * frequency_gap = 1.0 * halfSampleRate / numFrequencies = 11.71875 Hz
+// }
+
+
+
+bool SpectrogramStream::Format::operator<(const Format& x) const{
+    return std::tie(mode, sample_rate, num_frequencies, freq_start, freq_end)
+         < std::tie(x.mode, x.sample_rate, x.num_frequencies, x.freq_start, x.freq_end);
+}
+
+SpectrogramStream::SpectrogramStream(const Format& format)
+    : m_format(format)
+{
+    const size_t range = m_format.freq_end > m_format.freq_start
+        ? m_format.freq_end - m_format.freq_start
+        : 0;
+
+    switch (m_format.mode){
+    case SpectrogramMatcher::Mode::SPIKE_CONV:
+        m_kernel = buildSpikeKernel(m_format.num_frequencies, m_format.sample_rate / 2);
+        m_num_filtered = range >= m_kernel.size() ? range - m_kernel.size() + 1 : 0;
+        break;
+    case SpectrogramMatcher::Mode::AVERAGE_5:
+        m_num_filtered = range / 5;
+        break;
+    case SpectrogramMatcher::Mode::RAW:
+        m_num_filtered = m_format.num_frequencies;
+        break;
+    }
+
+    m_buffer_size = Kernels::align_int_up<PA_ALIGNMENT>(m_num_filtered * sizeof(float)) / sizeof(float);
+}
+
+void SpectrogramStream::filter(const float* raw, float* out) const{
+    switch (m_format.mode){
+    case SpectrogramMatcher::Mode::SPIKE_CONV:
+        if (m_num_filtered == 0){
+            return;
+        }
+        Kernels::SpikeConvolution::compute_spike_kernel(
+            out, raw + m_format.freq_start, m_format.freq_end - m_format.freq_start,
+            m_kernel.data(), m_kernel.size()
+        );
+        break;
+    case SpectrogramMatcher::Mode::AVERAGE_5:
+        // Avereage every 5 frequencies
+        for (size_t j = 0; j < m_num_filtered; j++){
+            const float * rawFreqMag = raw + m_format.freq_start + j*5;
+            out[j] = (rawFreqMag[0] + rawFreqMag[1] + rawFreqMag[2] + rawFreqMag[3] + rawFreqMag[4]) / 5.0f;
+        }
+        break;
+    case SpectrogramMatcher::Mode::RAW:
+        break;
+    }
+}
+
+
+
+void SpectrogramStream::attach(SpectrogramMatcher& matcher){
+    std::lock_guard<Mutex> lg(m_lock);
+    m_matchers.emplace_back(&matcher);
+    matcher.reset_history();
+    reserve(matcher.m_numSpectrumsNeeded);
+}
+void SpectrogramStream::detach(SpectrogramMatcher& matcher){
+    std::lock_guard<Mutex> lg(m_lock);
+    for (auto iter = m_matchers.begin(); iter != m_matchers.end(); ++iter){
+        if (*iter == &matcher){
+            m_matchers.erase(iter);
+            return;
+        }
+    }
+}
+void SpectrogramStream::clear(){
+    std::lock_guard<Mutex> lg(m_lock);
+    for (Slot& slot : m_slots){
+        slot.stamp = UINT64_MAX;
+        slot.source.reset();
+        slot.raw.reset();
+    }
+    m_shared_stamp = UINT64_MAX;
+}
+
+void SpectrogramStream::reserve(size_t windows){
+    size_t capacity = 1;
+    while (capacity < windows + SPECTROGRAM_HISTORY_SLACK){
+        capacity *= 2;
+    }
+    if (capacity <= m_slots.size()){
+        return;
+    }
+
+    //  Distinct stamps in the old ring are still distinct modulo the larger
+    //  power of two, so nothing collides when moving them over.
+    std::vector<Slot> slots(capacity);
+    for (Slot& slot : m_slots){
+        if (slot.stamp != UINT64_MAX){
+            slots[slot.stamp & (capacity - 1)] = std::move(slot);
+        }
+    }
+    m_slots = std::move(slots);
+}
+
+bool SpectrogramStream::add(SpectrogramMatcher& matcher, const AudioSpectrum& spectrum){
+    if (m_format.num_frequencies != spectrum.magnitudes->size()){
+        std::cout << "Error: number of frequencies don't match in SpectrogramMatcher::match() " <<
+            m_format.num_frequencies << " " << spectrum.magnitudes->size() << std::endl;
+        return false;
+    }
+
+    std::lock_guard<Mutex> lg(m_lock);
+
+    //  The history may already hold spectrums from before this matcher was
+    //  listening. Only match windows from its first spectrum onwards.
+    if (matcher.m_latestStamp == UINT64_MAX){
+        matcher.m_minStamp = spectrum.stamp;
+    }
+
+    //  A stamp older than where the matcher started means the feed has
+    //  been reset.
+    if (spectrum.stamp < matcher.m_minStamp){
+        matcher.m_minStamp = spectrum.stamp;
+        m_shared_stamp = UINT64_MAX;
+    }
+    matcher.m_latestStamp = spectrum.stamp;
+
+    Slot& slot = m_slots[spectrum.stamp & (m_slots.size() - 1)];
+    if (slot.stamp == spectrum.stamp &&
+        !slot.source.owner_before(spectrum.magnitudes) &&
+        !spectrum.magnitudes.owner_before(slot.source)
+    ){
+        //  Another matcher already added this one.
+        return true;
+    }
+
+    slot.stamp = spectrum.stamp;
+    slot.source = spectrum.magnitudes;
+    if (m_format.mode == SpectrogramMatcher::Mode::RAW){
+        slot.raw = spectrum.magnitudes;
+    }else{
+        if (slot.filtered.size() != m_buffer_size){
+            slot.filtered = AlignedVector<float>(m_buffer_size);
+        }
+        filter(spectrum.magnitudes->data(), slot.filtered.data());
+    }
+    return true;
+}
+
+const float* SpectrogramStream::row(uint64_t stamp) const{
+    const Slot& slot = m_slots[stamp & (m_slots.size() - 1)];
+    if (slot.stamp != stamp){
+        return nullptr;
+    }
+    return m_format.mode == SpectrogramMatcher::Mode::RAW
+        ? slot.raw->data()
+        : slot.filtered.data();
+}
+
+bool SpectrogramStream::score(SpectrogramMatcher& matcher, uint64_t stamp, float& score, float& scale){
+    std::lock_guard<Mutex> lg(m_lock);
+
+    if (!matcher.score_window(*this, stamp)){
+        return false;
+    }
+
+    //  The first matcher to reach a new window scores everyone else on it
+    //  while it is still in cache. Later callers find their score cached, so
+    //  each window is only walked once no matter how many matchers ask.
+    //  Skip matchers that haven't been fed recently. They are not running.
+    if (m_shared_stamp == UINT64_MAX || stamp > m_shared_stamp){
+        m_shared_stamp = stamp;
+        for (SpectrogramMatcher* other : m_matchers){
+            if (other == &matcher || other->m_latestStamp == UINT64_MAX){
+                continue;
+            }
+            if (other->m_latestStamp + m_slots.size() < stamp){
+                continue;
+            }
+            other->score_window(*this, stamp);
+        }
+    }
+
+    const SpectrogramMatcher::CachedScore& cached = matcher.m_cache[stamp % matcher.m_cache.size()];
+    score = cached.score;
+    scale = cached.scale;
+    return true;
+}
+
+
+
+SpectrogramMatchingEngine& SpectrogramMatchingEngine::instance(){
+    static SpectrogramMatchingEngine engine;
+    return engine;
+}
+
+std::shared_ptr<SpectrogramStream> SpectrogramMatchingEngine::get_stream(
+    const AudioFeed& feed,
+    const SpectrogramStream::Format& format
+){
+    WriteSpinLock lg(m_lock, PA_CURRENT_FUNCTION);
+
+    //  Drop streams that nobody is using anymore.
+    for (auto iter = m_streams.begin(); iter != m_streams.end();){
+        if (iter->second.expired()){
+            iter = m_streams.erase(iter);
+        }else{
+            ++iter;
+        }
+    }
+
+    std::weak_ptr<SpectrogramStream>& entry = m_streams[{&feed, format}];
+    std::shared_ptr<SpectrogramStream> stream = entry.lock();
+    if (!stream){
+        stream = std::make_shared<SpectrogramStream>(format);
+        entry = stream;
+    }
+    return stream;
+}
+
+
+
+//  Only the address of the feed matters to SpectrogramMatchingEngine.
+class SpectrogramTestFeed : public AudioFeed{
+public:
+    virtual void reset() override{}
+    virtual std::vector<AudioSpectrum> spectrums_since(uint64_t starting_seqnum) override{ return {}; }
+    virtual std::vector<AudioSpectrum> spectrums_latest(size_t num_last_spectrums) override{ return {}; }
+    virtual void add_overlay(uint64_t starting_seqnum, size_t end_seqnum, Color color) override{}
+};
+
+//  A detector that starts after the sound has already played must not find
+//  it in the history that the other detectors on the feed left behind.
+class Test_SpectrogramMatchingEngine_LateAttach : public UnitTest{
+public:
+    Test_SpectrogramMatchingEngine_LateAttach()
+        : UnitTest("CommonTools::SpectrogramMatchingEngine - Late Attach")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const size_t SAMPLE_RATE = 48000;
+        const size_t FREQUENCIES = 64;
+        const size_t WINDOWS = 4;
+        const float THRESHOLD = 0.1f;
+
+        TestRandom random;
+        std::vector<std::shared_ptr<const AlignedVector<float>>> noise;
+        std::vector<std::shared_ptr<const AlignedVector<float>>> sound;
+        auto random_spectrum = [&]{
+            std::shared_ptr<AlignedVector<float>> magnitudes = std::make_shared<AlignedVector<float>>(FREQUENCIES);
+            for (size_t c = 0; c < FREQUENCIES; c++){
+                (*magnitudes)[c] = (float)(1 + random() % 1000);
+            }
+            return magnitudes;
+        };
+        for (size_t c = 0; c < 2 * WINDOWS; c++){
+            noise.emplace_back(random_spectrum());
+        }
+        AudioTemplate sound_template(FREQUENCIES, WINDOWS);
+        for (size_t c = 0; c < WINDOWS; c++){
+            sound.emplace_back(random_spectrum());
+            memcpy(sound_template.getWindow(c), sound.back()->data(), FREQUENCIES * sizeof(float));
+        }
+
+        SpectrogramTestFeed feed;
+        SpectrogramMatcher early("early", sound_template, SpectrogramMatcher::Mode::RAW, SAMPLE_RATE, 0);
+        early.attach_to_feed(feed);
+
+        //  The feed plays noise, then the sound. Only "early" is listening.
+        std::vector<AudioSpectrum> history;
+        for (const auto& magnitudes : noise){
+            history.emplace_back(history.size(), SAMPLE_RATE, magnitudes);
+        }
+        for (const auto& magnitudes : sound){
+            history.emplace_back(history.size(), SAMPLE_RATE, magnitudes);
+        }
+        float score = FLT_MAX;
+        for (const AudioSpectrum& spectrum : history){
+            score = early.match({spectrum});
+        }
+        TEST_RESULT_COMPONENT_EQUAL_STR(score <= THRESHOLD, true, "early match on the sound");
+
+        //  "late" starts now. Its first spectrum is the end of the sound.
+        SpectrogramMatcher late("late", sound_template, SpectrogramMatcher::Mode::RAW, SAMPLE_RATE, 0);
+        late.attach_to_feed(feed);
+        score = late.match({history.back()});
+        TEST_RESULT_COMPONENT_EQUAL_STR(score > THRESHOLD, true, "late match on the end of the sound");
+
+        //  More noise, then the sound again. Now both must hear it, and
+        //  neither may fire before the sound has finished.
+        std::vector<AudioSpectrum> next;
+        for (size_t c = 0; c < WINDOWS; c++){
+            next.emplace_back(history.size() + next.size(), SAMPLE_RATE, noise[c]);
+        }
+        for (const auto& magnitudes : sound){
+            next.emplace_back(history.size() + next.size(), SAMPLE_RATE, magnitudes);
+        }
+        for (size_t c = 0; c < next.size(); c++){
+            float early_score = early.match({next[c]});
+            float late_score = late.match({next[c]});
+            bool expected = c + 1 == next.size();
+            std::string name = "at stamp " + std::to_string(next[c].stamp);
+            TEST_RESULT_COMPONENT_EQUAL_STR(early_score <= THRESHOLD, expected, "early match " + name);
+            TEST_RESULT_COMPONENT_EQUAL_STR(late_score <= THRESHOLD, expected, "late match " + name);
+        }
+
+        return true;
+    }
+};
+
+
+void add_tests_SpectrogramMatchingEngine(UnitTestDatabase& database){
+    database.add<Test_SpectrogramMatchingEngine_LateAttach>();
+}
+
+
+
+
+}
@@ -0,0 +1,155 @@
+/*  Spectrogram Matching Engine
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  Share spectrum filtering and history between SpectrogramMatchers.
+ *
+ *  Every SpectrogramMatcher filters each incoming spectrum (SPIKE_CONV,
+ *  AVERAGE_5) before matching it against its template. When several audio
+ *  detectors listen to the same feed, they all filter the same spectrums the
+ *  same way and keep their own copies of the history.
+ *
+ *  A SpectrogramStream does the filtering once per spectrum and keeps the
+ *  results in a ring buffer indexed by stamp. The first time any attached
+ *  matcher asks for a window newer than any scored so far, the stream scores
+ *  that window against every attached template in one pass and caches the
+ *  scores in each matcher. The others then pick up their cached score.
+ *
+ *  A matcher only matches windows that start at or after the first spectrum
+ *  it was given. So a detector that starts late never matches a sound that
+ *  the others heard before it was running.
+ *
+ *  The history only reaches a fixed number of spectrums past the longest
+ *  attached template. A matcher that falls further behind the others than
+ *  that loses its window until it catches up, the same as a gap in stamps.
+ *
+ *  SpectrogramMatchingEngine hands out one stream per audio feed and filter.
+ *
+ */
+
+#ifndef PokemonAutomation_CommonTools_SpectrogramMatchingEngine_H
+#define PokemonAutomation_CommonTools_SpectrogramMatchingEngine_H
+
+#include <memory>
+#include <vector>
+#include <map>
+#include "Common/Cpp/Concurrency/Mutex.h"
+#include "Common/Cpp/Concurrency/SpinLock.h"
+#include "Common/Cpp/Containers/AlignedVector.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "SpectrogramMatcher.h"
+
+namespace PokemonAutomation{
+
+
+
+class SpectrogramStream{
+public:
+    // Everything that changes how a raw spectrum is filtered.
+    struct Format{
+        SpectrogramMatcher::Mode mode;
+        size_t sample_rate;
+        // Number of frequencies in the raw spectrums.
+        size_t num_frequencies;
+        // Range of raw frequencies that are filtered.
+        size_t freq_start;
+        size_t freq_end;
+
+        bool operator<(const Format& x) const;
+    };
+
+    SpectrogramStream(const Format& format);
+
+    const Format& format() const{ return m_format; }
+
+    // Number of frequencies after filtering.
+    // For RAW, the filtered spectrum is the raw spectrum.
+    size_t num_filtered_frequencies() const{ return m_num_filtered; }
+
+    // Filter one raw spectrum. Not used for RAW.
+    // "out" must be aligned to PA_ALIGNMENT and valid for num_filtered_frequencies()
+    // rounded up to PA_ALIGNMENT / sizeof(float).
+    void filter(const float* raw, float* out) const;
+
+
+private:
+    friend class SpectrogramMatcher;
+
+    void attach(SpectrogramMatcher& matcher);
+    void detach(SpectrogramMatcher& matcher);
+
+    // Forget all spectrums.
+    void clear();
+
+    // Add a spectrum to the history on behalf of "matcher" if it isn't
+    // already there. Return false if the spectrum is the wrong size.
+    bool add(SpectrogramMatcher& matcher, const AudioSpectrum& spectrum);
+
+    // Score the window ending at "stamp" for "matcher". If no newer window
+    // has been scored yet, score it for the other attached matchers too.
+    // Return false if "matcher" does not have the full window in history.
+    bool score(SpectrogramMatcher& matcher, uint64_t stamp, float& score, float& scale);
+
+    // Return the filtered spectrum of "stamp", or nullptr if it is not in
+    // history. Must hold the lock.
+    const float* row(uint64_t stamp) const;
+
+    // Make room for "windows" spectrums of history plus some slack for
+    // matchers that fall behind. Must hold the lock.
+    void reserve(size_t windows);
+
+
+private:
+    struct Slot{
+        uint64_t stamp = UINT64_MAX;
+        //  Identifies the raw spectrum in case the feed restarts its stamps.
+        std::weak_ptr<const AlignedVector<float>> source;
+        //  RAW keeps the raw spectrum. The other modes keep the filtered copy.
+        std::shared_ptr<const AlignedVector<float>> raw;
+        AlignedVector<float> filtered;
+    };
+
+    const Format m_format;
+    std::vector<float> m_kernel;
+    size_t m_num_filtered = 0;
+    size_t m_buffer_size = 0;
+
+    Mutex m_lock;
+    std::vector<SpectrogramMatcher*> m_matchers;
+    std::vector<Slot> m_slots;
+    // Newest window that has been scored for every matcher.
+    // UINT64_MAX if none yet.
+    uint64_t m_shared_stamp = UINT64_MAX;
+};
+
+
+
+class SpectrogramMatchingEngine{
+public:
+    static SpectrogramMatchingEngine& instance();
+
+    // Get the stream shared by all matchers on "feed" with this format.
+    std::shared_ptr<SpectrogramStream> get_stream(
+        const AudioFeed& feed,
+        const SpectrogramStream::Format& format
+    );
+
+private:
+    SpectrogramMatchingEngine() = default;
+
+    SpinLock m_lock;
+    std::map<
+        std::pair<const AudioFeed*, SpectrogramStream::Format>,
+        std::weak_ptr<SpectrogramStream>
+    > m_streams;
+};
+
+
+
+void add_tests_SpectrogramMatchingEngine(UnitTestDatabase& database);
+
+
+
+
+}
+#endif
@@ -6,7 +6,11 @@
 
 #include <cmath>
 #include <vector>
+#include <limits>
+#include <algorithm>
 #include "Common/Cpp/Exceptions.h"
+#include "Kernels/ImageStats/Kernels_ImagePixelSumSqr.h"
+#include "Kernels/ImageStats/Kernels_ImagePixelSumSqrDev.h"
 #include "CommonFramework/ImageTypes/ImageViewRGB32.h"
 #include "CommonFramework/ImageTools/ImageBoxes.h"
 #include "CommonFramework/ImageTools/ImageDiff.h"
@@ -41,16 +45,22 @@ std::vector<ImageRGB32> make_image_set(
     ptrdiff_t scale = (ptrdiff_t)(std::sqrt(num_image_pixels / num_template_pixels) + 0.5);
     scale = std::max<ptrdiff_t>(scale, 1);
 
-    std::vector<ImageRGB32> ret;
     ptrdiff_t limit = (ptrdiff_t)tolerance;
+    std::vector<ImageRGB32> ret((size_t)((2*limit + 1) * (2*limit + 1)));
+
+    //  All the shifted boxes have the same size (except when clipped by the
+    //  screen edge), so share the filter tables across them.
+    Kernels::ImageResampler resampler;
+    size_t index = 0;
     for (ptrdiff_t y = -limit; y <= limit; y++){
         for (ptrdiff_t x = -limit; x <= limit; x++){
 //            if (x != 0 || y != -4){
 //                continue;
 //            }
 
-            ret.emplace_back(
-                extract_box_reference(screen, box, x * scale, y * scale).scale_to(width, height)
+            extract_box_reference(screen, box, x * scale, y * scale).scale_to(
+                ret[index++], width, height,
+                Kernels::ResampleFilter::BILINEAR, &resampler
             );
 //            cout << "make_image_set(): image = " << ret.back().width() << " x " << ret.back().height() << endl;
 //            if (x == 0 && y == 0){
@@ -84,11 +94,56 @@ void ExactImageDictionaryMatcher::add(const std::string& slug, ImageRGB32 image)
         throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Duplicate slug: " + slug);
     }
 
-    m_database.emplace(
+    iter = m_database.emplace(
         std::piecewise_construct,
         std::forward_as_tuple(slug),
         std::forward_as_tuple(std::move(image), m_weight)
+    ).first;
+
+    const ImageRGB32& sprite = iter->second.image_template();
+
+    PackedTemplate packed;
+    packed.slug = &iter->first;
+    packed.matcher = &iter->second;
+    packed.offset = m_packed.size();
+
+    //  Pack the rows without padding.
+    for (size_t r = 0; r < m_height; r++){
+        const uint32_t* row = (const uint32_t*)((const char*)sprite.data() + r * sprite.bytes_per_row());
+        m_packed.insert(m_packed.end(), row, row + m_width);
+    }
+
+    Kernels::PixelSums sums;
+    Kernels::pixel_sum_sqr(
+        sums, m_width, m_height,
+        sprite.data(), sprite.bytes_per_row(),
+        sprite.data(), sprite.bytes_per_row()
     );
+    packed.count = sums.count;
+    packed.sum = FloatPixel((double)sums.sumR, (double)sums.sumG, (double)sums.sumB);
+    packed.sqr = FloatPixel((double)sums.sqrR, (double)sums.sqrG, (double)sums.sqrB);
+
+    //  Scaling by at most 1.15 then rounding (or truncating) is off by less
+    //  than 1 per channel, plus whatever gets clamped off at 255. Pad it a
+    //  bit for float error.
+    const double ROUNDING = 1.01;
+    FloatPixel slack;
+    for (size_t c = 0; c < m_width * m_height; c++){
+        uint32_t pixel = m_packed[packed.offset + c];
+        if ((int32_t)pixel >= 0){
+            continue;
+        }
+        FloatPixel error(
+            ROUNDING + std::max(((pixel >> 16) & 0xff) * 1.15 - 255, 0.),
+            ROUNDING + std::max(((pixel >>  8) & 0xff) * 1.15 - 255, 0.),
+            ROUNDING + std::max(((pixel >>  0) & 0xff) * 1.15 - 255, 0.)
+        );
+        slack += error * error;
+    }
+    packed.rounding_slack = FloatPixel(std::sqrt(slack.r), std::sqrt(slack.g), std::sqrt(slack.b));
+
+    m_template_index[slug] = m_templates.size();
+    m_templates.emplace_back(packed);
 //    if (slug == "linoone-galar" || slug == "coalossal"){
 //        cout << slug << " = " << m_database.find(slug)->second.stats().stddev.sum() << endl;
 //    }
@@ -105,26 +160,100 @@ void ExactImageDictionaryMatcher::scale_to_dimensions(ImageRGB32& image) const{
 #endif
 
 
+//  Produces the same value as "sprite.matcher->diff(image)" for the best
+//  image. But instead of materializing a brightness-scaled copy of the
+//  template for every candidate, it reads the packed template directly.
+//
+//  For each candidate, the average over the opaque pixels of the template is
+//  needed anyway to get the brightness scale. The same pass also gives the
+//  candidate's stddev over those pixels. Since for any two vectors:
+//
+//      |x - y|^2 / n >= (mean(x) - mean(y))^2 + (stddev(x) - stddev(y))^2
+//
+//  this lower bounds the RMSD without touching the template pixels. When that
+//  bound can't beat the best alpha so far, the full RMSD is skipped.
 double ExactImageDictionaryMatcher::compare(
-    const WeightedExactImageMatcher& sprite,
-    const std::vector<ImageRGB32>& images
-){
-//    sprite.m_image.save("sprite.png");
-//    images[0].save("image.png");
+    const PackedTemplate& sprite,
+    const std::vector<ImageRGB32>& images,
+    double threshold
+) const{
+    const WeightedExactImageMatcher& matcher = *sprite.matcher;
+    const uint32_t* packed = m_packed.data() + sprite.offset;
+    double n = (double)sprite.count;
+    FloatPixel template_average = sprite.sum / n;
+    FloatPixel template_variance = sprite.sqr / n - template_average * template_average;
 
     double best = 10000;
     for (const ImageRGB32& image : images){
-        double rmsd_alpha = sprite.diff(image);
-//        cout << rmsd_alpha << endl;
-//        if (rmsd_alpha < 0.38){
-//            sprite.m_image.save("sprite.png");
-//            image.save("image.png");
-//        }
+        if (!image){
+            best = std::min(best, 1000.);
+            continue;
+        }
+
+        Kernels::PixelSums sums;
+        Kernels::pixel_sum_sqr(
+            sums, m_width, m_height,
+            image.data(), image.bytes_per_row(),
+            packed, m_width * sizeof(uint32_t)
+        );
+
+        //  Same as pixel_average(image, template).
+        FloatPixel image_brightness((double)sums.sumR, (double)sums.sumG, (double)sums.sumB);
+        image_brightness /= (double)sums.count;
+        FloatPixel scale = matcher.brightness_scale(image_brightness);
+
+        if (sums.count != 0){
+            FloatPixel image_sqr((double)sums.sqrR, (double)sums.sqrG, (double)sums.sqrB);
+            FloatPixel image_variance = image_sqr / n - image_brightness * image_brightness;
+            auto channel_bound = [&](double s, double t_avg, double t_var, double i_avg, double i_var, double slack){
+                double mean = s * t_avg - i_avg;
+                double stddev = s * std::sqrt(std::max(t_var, 0.)) - std::sqrt(std::max(i_var, 0.));
+                double distance = std::sqrt(n * (mean * mean + stddev * stddev)) - slack;
+                return distance > 0 ? distance * distance : 0;
+            };
+            double sumsqrs_bound =
+                channel_bound(scale.r, template_average.r, template_variance.r, image_brightness.r, image_variance.r, sprite.rounding_slack.r) +
+                channel_bound(scale.g, template_average.g, template_variance.g, image_brightness.g, image_variance.g, sprite.rounding_slack.g) +
+                channel_bound(scale.b, template_average.b, template_variance.b, image_brightness.b, image_variance.b, sprite.rounding_slack.b);
+            double alpha_bound = std::sqrt(sumsqrs_bound / n) * matcher.m_multiplier;
+            if (alpha_bound > std::min(best, threshold)){
+                continue;
+            }
+        }
+
+        uint64_t count = 0;
+        uint64_t sumsqrs = 0;
+        Kernels::sum_sqr_deviation_scaled(
+            count, sumsqrs,
+            m_width, m_height,
+            packed, m_width * sizeof(uint32_t),
+            image.data(), image.bytes_per_row(),
+            (float)scale.r, (float)scale.g, (float)scale.b
+        );
+        double rmsd_alpha = std::sqrt((double)sumsqrs / (double)count) * matcher.m_multiplier;
         best = std::min(best, rmsd_alpha);
     }
-//    cout << best << endl;
     return best;
 }
+void ExactImageDictionaryMatcher::match_template(
+    ImageMatchResult& results,
+    const PackedTemplate& sprite,
+    const std::vector<ImageRGB32>& images,
+    double alpha_spread
+) const{
+    //  Anything worse than this is going to be removed by clear_beyond_spread()
+    //  right away. So it doesn't need an exact alpha.
+    double threshold = results.results.empty()
+        ? std::numeric_limits<double>::infinity()
+        : results.results.begin()->first + alpha_spread;
+
+    double alpha = compare(sprite, images, threshold);
+    if (alpha > threshold){
+        return;
+    }
+    results.add(alpha, *sprite.slug);
+    results.clear_beyond_spread(alpha_spread);
+}
 
 ImageMatchResult ExactImageDictionaryMatcher::match(
     const ImageViewRGB32& image, const ImageFloatBox& box,
@@ -138,13 +267,8 @@ ImageMatchResult ExactImageDictionaryMatcher::match(
 
     // Translate the input image area a bit to careate matching candidates.
     std::vector<ImageRGB32> image_set = make_image_set(image, box, m_width, m_height, tolerance);
-    for (const auto& item : m_database){
-//        if (item.first != "linoone-galar"){
-//            continue;
-//        }
-        double alpha = compare(item.second, image_set);
-        results.add(alpha, item.first);
-        results.clear_beyond_spread(alpha_spread);
+    for (const PackedTemplate& sprite : m_templates){
+        match_template(results, sprite, image_set, alpha_spread);
     }
 
     return results;
@@ -164,10 +288,11 @@ ImageMatchResult ExactImageDictionaryMatcher::subset_match(
     // Translate the input image area a bit to careate matching candidates.
     std::vector<ImageRGB32> image_set = make_image_set(image, box,  m_width, m_height, tolerance);
     for (const auto& slug : subset){
-        const auto& matcher = image_matcher(slug);
-        double alpha = compare(matcher, image_set);
-        results.add(alpha, slug);
-        results.clear_beyond_spread(alpha_spread);
+        auto it = m_template_index.find(slug);
+        if (it == m_template_index.end()){
+            throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Unknown slug: " + slug);
+        }
+        match_template(results, m_templates[it->second], image_set, alpha_spread);
     }
 
     return results;
@@ -66,10 +66,39 @@ public:
 
 
 private:
-    static double compare(
-        const WeightedExactImageMatcher& sprite,
-        const std::vector<ImageRGB32>& images
-    );
+    //  All templates are packed back-to-back in "m_packed" so that matching
+    //  streams through one contiguous buffer. Each template also keeps the
+    //  sums needed to lower bound its RMSD against a candidate image from the
+    //  candidate's mean and stddev alone.
+    struct PackedTemplate{
+        const std::string* slug;
+        const WeightedExactImageMatcher* matcher;
+        size_t offset;
+
+        //  Sums over the opaque pixels of the template.
+        uint64_t count;
+        FloatPixel sum;
+        FloatPixel sqr;
+
+        //  Upper bound of the L2 distance between the brightness-scaled
+        //  template (after rounding and clamping) and the unrounded one.
+        FloatPixel rounding_slack;
+    };
+
+    //  Returns the best alpha of "sprite" across "images".
+    //  Candidates whose lower bound exceeds "threshold" are skipped. If every
+    //  candidate is skipped, returns a value greater than "threshold".
+    double compare(
+        const PackedTemplate& sprite,
+        const std::vector<ImageRGB32>& images,
+        double threshold
+    ) const;
+    void match_template(
+        ImageMatchResult& results,
+        const PackedTemplate& sprite,
+        const std::vector<ImageRGB32>& images,
+        double alpha_spread
+    ) const;
 
 
 private:
@@ -80,6 +109,10 @@ private:
     size_t m_width = 0;
     size_t m_height = 0;
     std::map<std::string, WeightedExactImageMatcher> m_database;
+
+    std::vector<uint32_t> m_packed;
+    std::vector<PackedTemplate> m_templates;
+    std::map<std::string, size_t> m_template_index;
 };
 
 
@@ -27,8 +27,7 @@ ExactImageMatcher::ExactImageMatcher(ImageRGB32 image)
 //    cout << m_stats.stddev.sum() << endl;
 }
 
-ImageRGB32 ExactImageMatcher::scale_template_brightness(const ImageViewRGB32& image) const{
-    FloatPixel image_brightness = pixel_average(image, m_image);
+FloatPixel ExactImageMatcher::brightness_scale(FloatPixel image_brightness) const{
     FloatPixel scale = image_brightness / m_stats.average;
 
     if (std::isnan(scale.r)) scale.r = 1.0;
@@ -36,6 +35,12 @@ ImageRGB32 ExactImageMatcher::scale_template_brightness(const ImageViewRGB32& im
     if (std::isnan(scale.b)) scale.b = 1.0;
     scale.bound(0.85, 1.15);
 
+    return scale;
+}
+
+ImageRGB32 ExactImageMatcher::scale_template_brightness(const ImageViewRGB32& image) const{
+    FloatPixel scale = brightness_scale(pixel_average(image, m_image));
+
     ImageRGB32 ret = m_image.copy();
     scale_brightness(ret, scale);
 //    ret.save("test.png");
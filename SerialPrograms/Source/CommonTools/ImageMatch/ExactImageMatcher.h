@@ -52,6 +52,10 @@ public:
 
     const ImageRGB32& image_template() const { return m_image; }
 
+    // The per-channel multiplier applied to the template to match the brightness of an input image
+    // whose average over the opaque pixels of the template is `image_brightness`.
+    FloatPixel brightness_scale(FloatPixel image_brightness) const;
+
 private:
     // scale stored image template according to the brightness of `image`, assign
     // the scaled template to `reference`.
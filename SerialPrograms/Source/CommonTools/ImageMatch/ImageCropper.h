@@ -20,6 +20,8 @@ namespace ImageMatch{
 //  The alpha channel is used to determine what is object vs. background.
 //  background is defined as alpha < alpha_threshold.
 ImageViewRGB32 trim_image_alpha(const ImageViewRGB32& image, uint8_t alpha_threshold = 128);
+//  Same as above, but return the box of the trimmed image instead.
+ImagePixelBox trim_image_alpha_box(const ImageViewRGB32& image, uint8_t alpha_threshold = 128);
 
 
 //  Find a crop of the object based on background color.
@@ -8,6 +8,7 @@
 #define PokemonAutomation_CommonTools_VisualInferenceCallback_H
 
 #include <string>
+#include <vector>
 #include "Common/Cpp/Time.h"
 #include "InferenceCallback.h"
 
@@ -17,6 +18,7 @@ class ImageViewRGB32;
 class ImageRGB32;
 struct VideoSnapshot;
 class VideoOverlaySet;
+struct ImageFloatBox;
 
 //  Base class for a visual inference object to be called perioridically by
 //  inference routines in InferenceRoutines.h.
@@ -30,6 +32,15 @@ public:
     //  regions of interest of the inference callback.
     virtual void make_overlays(VideoOverlaySet& items) const = 0;
 
+    //  Optional: If process_frame() only ever reads a fixed set of boxes,
+    //  add them to "regions" and return true. When every callback attached to
+    //  a video feed does this, only those parts of each frame are converted.
+    //  Return false (the default) if the callback needs the whole frame.
+    //  This is called once when the callback is attached.
+    virtual bool regions_of_interest(std::vector<ImageFloatBox>& regions) const{
+        return false;
+    }
+
     //  Return true if the inference session should stop.
     //  You must override at least one of the overloaded `process_frame()`.
     //  The base class's implementation is just calling the other overloaded
@@ -5,6 +5,8 @@
  */
 
 #include "Common/Cpp/Exceptions.h"
+#include "Common/Cpp/PrettyPrint.h"
+#include "CommonFramework/Options/Environment/PerformanceOptions.h"
 #include "CommonFramework/Tools/GlobalThreadPools.h"
 #include "CommonFramework/VideoPipeline/VideoFeed.h"
 #include "VisualInferencePivot.h"
@@ -16,6 +18,11 @@
 namespace PokemonAutomation{
 
 
+//  Callbacks that average less than this are cheaper to run inline on the
+//  pivot thread than to hand off to the thread pool.
+const std::chrono::microseconds HEAVY_CALLBACK_THRESHOLD(2000);
+
+
 
 struct VisualInferencePivot::PeriodicCallback{
     Cancellable& scope;
@@ -25,6 +32,9 @@ struct VisualInferencePivot::PeriodicCallback{
     WallClock last_timestamp;
     StatAccumulatorI32 stats;
 
+    //  The regions this callback reads. Empty if it needs the whole frame.
+    std::vector<ImageFloatBox> regions;
+
     PeriodicCallback(
         Cancellable& p_scope,
         std::atomic<InferenceCallback*>* p_set_when_triggered,
@@ -37,7 +47,15 @@ struct VisualInferencePivot::PeriodicCallback{
         , callback(p_callback)
         , period(p_period)
         , last_timestamp(p_start_time)
-    {}
+    {
+        if (!callback.regions_of_interest(regions)){
+            regions.clear();
+        }
+    }
+
+    bool is_heavy() const{
+        return stats.count() != 0 && stats.mean() >= HEAVY_CALLBACK_THRESHOLD.count();
+    }
 };
 
 
@@ -70,9 +88,11 @@ void VisualInferencePivot::add_callback(
         std::forward_as_tuple(scope, set_when_triggered, callback, period, start_time)
     ).first;
     try{
+        update_regions();
         BusyPeriodicRunner::add_event(&iter->second, period);
     }catch (...){
         m_map.erase(iter);
+        update_regions();
         throw;
     }
 }
@@ -85,20 +105,144 @@ StatAccumulatorI32 VisualInferencePivot::remove_callback(VisualInferenceCallback
     StatAccumulatorI32 stats = iter->second.stats;
     BusyPeriodicRunner::remove_event(&iter->second);
     m_map.erase(iter);
+    update_regions();
     return stats;
 }
+void VisualInferencePivot::update_regions(){
+    SnapshotRegions regions;
+    if (!m_map.empty()){
+        std::vector<ImageFloatBox> boxes;
+        for (const auto& item : m_map){
+            if (item.second.regions.empty()){
+                boxes.clear();
+                break;
+            }
+            boxes.insert(boxes.end(), item.second.regions.begin(), item.second.regions.end());
+        }
+        if (!boxes.empty()){
+            regions = std::make_shared<const std::vector<ImageFloatBox>>(std::move(boxes));
+        }
+    }
+    WriteSpinLock lg(m_regions_lock);
+    m_regions = std::move(regions);
+}
+bool VisualInferencePivot::snapshot_is_incomplete() const{
+    ReadSpinLock lg(m_regions_lock);
+    return !m_last.covers(m_regions);
+}
 void VisualInferencePivot::run(void* event, bool is_back_to_back) noexcept{
     PeriodicCallback& callback = *(PeriodicCallback*)event;
     try{
         //  Reuse the cached screenshot.
-        if (!is_back_to_back || callback.last_timestamp == m_last.timestamp){
-            m_last = m_feed.snapshot_recent_nonblocking(callback.last_timestamp);
+        if (!is_back_to_back ||
+            callback.last_timestamp == m_last.timestamp ||
+            snapshot_is_incomplete()
+        ){
+            refresh_snapshot(callback.last_timestamp);
+        }
+    }catch (...){
+        callback.scope.cancel(std::current_exception());
+        return;
+    }
+    process_callback(callback);
+}
+void VisualInferencePivot::run_batch(const std::vector<void*>& events, bool is_back_to_back) noexcept{
+    if (events.size() <= 1 || !PerformanceOptions::instance().PARALLEL_VISUAL_INFERENCE){
+        BusyPeriodicRunner::run_batch(events, is_back_to_back);
+        return;
+    }
+
+    //  Only fan out if at least two callbacks are expensive. Detectors may
+    //  already use the real-time pool internally, so handing cheap callbacks
+    //  to it only adds contention.
+    m_light_events.clear();
+    m_heavy_events.clear();
+    for (void* event : events){
+        if (((const PeriodicCallback*)event)->is_heavy()){
+            m_heavy_events.emplace_back(event);
+        }else{
+            m_light_events.emplace_back(event);
+        }
+    }
+    if (m_heavy_events.size() <= 1){
+        BusyPeriodicRunner::run_batch(events, is_back_to_back);
+        return;
+    }
+
+    //  Grab one snapshot that is recent enough for all the callbacks.
+    WallClock min_timestamp = WallClock::max();
+    bool refresh = !is_back_to_back || snapshot_is_incomplete();
+    for (void* event : events){
+        const PeriodicCallback& callback = *(const PeriodicCallback*)event;
+        min_timestamp = std::min(min_timestamp, callback.last_timestamp);
+        refresh |= callback.last_timestamp == m_last.timestamp;
+    }
+    try{
+        if (refresh){
+            refresh_snapshot(min_timestamp);
         }
+    }catch (...){
+        for (void* event : events){
+            ((PeriodicCallback*)event)->scope.cancel(std::current_exception());
+        }
+        return;
+    }
+    if (!m_last){
+        return;
+    }
 
+    //  Run the cheap callbacks here and fan out the expensive ones. Each
+    //  callback must start before its next period is due. Otherwise it is
+    //  skipped for this frame since a newer frame will be available by then.
+    WallClock batch_start = current_time();
+    for (void* event : m_light_events){
+        PeriodicCallback& callback = *(PeriodicCallback*)event;
+        if (!callback.scope.cancelled()){
+            process_callback(callback);
+        }
+    }
+    try{
+        GlobalThreadPools::computation_realtime().run_in_parallel(
+            [&](size_t index){
+                PeriodicCallback& callback = *(PeriodicCallback*)m_heavy_events[index];
+                if (callback.scope.cancelled()){
+                    return;
+                }
+                if (current_time() > batch_start + callback.period){
+                    return;
+                }
+                process_callback(callback);
+            },
+            0, m_heavy_events.size(), 1
+        );
+    }catch (...){
+        for (void* event : events){
+            ((PeriodicCallback*)event)->scope.cancel(std::current_exception());
+        }
+    }
+}
+void VisualInferencePivot::refresh_snapshot(WallClock min_time){
+    SnapshotRegions regions;
+    {
+        ReadSpinLock lg(m_regions_lock);
+        regions = m_regions;
+    }
+    VideoSnapshot snapshot = m_feed.snapshot_regions_nonblocking(min_time, std::move(regions));
+    if (snapshot.frame == m_last.frame){
+        snapshot.cache = std::move(m_last.cache);
+    }else if (snapshot){
+        snapshot.cache = std::make_shared<ImageDerivedCache>(*snapshot.frame, &m_cache_stats.counters);
+    }
+    m_last = std::move(snapshot);
+}
+void VisualInferencePivot::process_callback(PeriodicCallback& callback) noexcept{
+    try{
         if (!m_last){
             return;
         }
 
+        ImageDerivedCache::Binding binding(m_last.cache.get());
+
         WallClock time0 = current_time();
         bool stop = callback.callback.process_frame(m_last);
         WallClock time1 = current_time();
@@ -121,6 +265,26 @@ void VisualInferencePivot::run(void* event, bool is_back_to_back) noexcept{
 OverlayStatSnapshot VisualInferencePivot::get_current(){
     return m_printer.get_snapshot("Video Pivot Utilization:", this->current_utilization());
 }
+OverlayStatSnapshot VisualInferencePivot::CacheStats::get_current(){
+    uint64_t hits = counters.hits.load(std::memory_order_relaxed);
+    uint64_t misses = counters.misses.load(std::memory_order_relaxed);
+    uint64_t new_hits = hits - m_last_hits;
+    uint64_t new_misses = misses - m_last_misses;
+    uint64_t total = new_hits + new_misses;
+
+    //  Nothing new since the last refresh. Keep showing the last rate.
+    if (total == 0){
+        return m_last_snapshot;
+    }
+
+    m_last_hits = hits;
+    m_last_misses = misses;
+    m_last_snapshot = OverlayStatSnapshot{
+        "Frame Cache Hit Rate: " + tostr_fixed(100. * new_hits / total, 2) + " %",
+        COLOR_WHITE
+    };
+    return m_last_snapshot;
+}
 
 
 
@@ -10,6 +10,7 @@
 #include "Common/Cpp/Concurrency/SpinLock.h"
 #include "Common/Cpp/Concurrency/BusyPeriodicRunner.h"
 #include "CommonFramework/Tools/StatAccumulator.h"
+#include "CommonFramework/ImageTools/ImageDerivedCache.h"
 #include "CommonFramework/VideoPipeline/VideoFeed.h"
 #include "CommonFramework/VideoPipeline/VideoOverlayTypes.h"
 #include "CommonTools/InferenceCallbacks/VisualInferenceCallback.h"
@@ -40,17 +41,57 @@ public:
     //  Returns the latency stats for the callback. Units are microseconds.
     StatAccumulatorI32 remove_callback(VisualInferenceCallback& callback);
 
+    //  Hit rate of the per-frame derived image cache.
+    OverlayStat& cache_stats(){ return m_cache_stats; }
+
 private:
     virtual void run(void* event, bool is_back_to_back) noexcept override;
+    virtual void run_batch(const std::vector<void*>& events, bool is_back_to_back) noexcept override;
     virtual OverlayStatSnapshot get_current() override;
 
 private:
     struct PeriodicCallback;
 
+    class CacheStats : public OverlayStat{
+    public:
+        virtual OverlayStatSnapshot get_current() override;
+
+        ImageDerivedCacheStats counters;
+
+    private:
+        uint64_t m_last_hits = 0;
+        uint64_t m_last_misses = 0;
+        OverlayStatSnapshot m_last_snapshot;
+    };
+
+    //  Rebuild "m_regions" from the attached callbacks. Call under "m_lock".
+    void update_regions();
+
+    //  Returns true if "m_last" is missing regions that a callback needs.
+    bool snapshot_is_incomplete() const;
+
+    //  Fetch a new snapshot into "m_last" and attach a fresh cache if the
+    //  frame has changed.
+    void refresh_snapshot(WallClock min_time);
+
+    //  Run the callback on the current snapshot and handle the result.
+    void process_callback(PeriodicCallback& callback) noexcept;
+
     VideoFeed& m_feed;
+
+    //  Scratch space for "run_batch()". Only used by the runner thread.
+    std::vector<void*> m_light_events;
+    std::vector<void*> m_heavy_events;
+
     SpinLock m_lock;
     std::map<VisualInferenceCallback*, PeriodicCallback> m_map;
     VideoSnapshot m_last;
+    CacheStats m_cache_stats;
+
+    //  Union of the regions the callbacks read. Null if any of them needs
+    //  the whole frame.
+    mutable SpinLock m_regions_lock;
+    SnapshotRegions m_regions;
 
     OverlayStatUtilizationPrinter m_printer;
 };
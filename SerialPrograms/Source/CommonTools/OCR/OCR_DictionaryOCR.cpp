@@ -9,6 +9,7 @@
 #include "Common/Cpp/Json/JsonArray.h"
 #include "Common/Cpp/Json/JsonObject.h"
 #include "CommonFramework/Logging/Logger.h"
+#include "CommonTools/Resources/ResourceCache.h"
 #include "OCR_StringNormalization.h"
 #include "OCR_TextMatcher.h"
 #include "OCR_DictionaryOCR.h"
@@ -22,6 +23,99 @@ namespace OCR{
 
 
 
+//  Bump this if the layout written below or normalize_utf32() changes.
+//  (The character reductions it loads are part of the source hash.)
+const uint32_t DICTIONARY_OCR_CACHE_VERSION = 1;
+
+
+namespace{
+
+//  A token with all its candidates and their normalized forms.
+struct DictionaryEntry{
+    std::string token;
+    std::vector<std::pair<std::string, std::u32string>> candidates;
+};
+
+std::vector<DictionaryEntry> read_dictionary_cache(const ResourceCacheFile& file, bool& ok){
+    ResourceCacheReader reader = file.reader();
+
+    std::vector<DictionaryEntry> entries;
+    uint64_t tokens = reader.read<uint64_t>();
+    for (uint64_t c = 0; c < tokens && reader.ok(); c++){
+        DictionaryEntry entry;
+        entry.token = reader.read_string();
+        uint64_t candidates = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < candidates && reader.ok(); i++){
+            std::string candidate = reader.read_string();
+            uint32_t length = reader.read<uint32_t>();
+            const char* ptr = reader.read_bytes((size_t)length * sizeof(char32_t));
+            std::u32string normalized(length, U'\0');
+            if (ptr != nullptr){
+                memcpy(&normalized[0], ptr, (size_t)length * sizeof(char32_t));
+            }
+            entry.candidates.emplace_back(std::move(candidate), std::move(normalized));
+        }
+        entries.emplace_back(std::move(entry));
+    }
+
+    ok = reader.ok() && reader.at_end();
+    return entries;
+}
+void write_dictionary_cache(
+    const std::string& cache_name, uint64_t source_hash,
+    const std::vector<DictionaryEntry>& entries
+){
+    ResourceCacheWriter writer;
+    writer.write<uint64_t>(entries.size());
+    for (const DictionaryEntry& entry : entries){
+        writer.write_string(entry.token);
+        writer.write<uint64_t>(entry.candidates.size());
+        for (const auto& candidate : entry.candidates){
+            writer.write_string(candidate.first);
+            writer.write<uint32_t>((uint32_t)candidate.second.size());
+            writer.write_bytes(candidate.second.data(), candidate.second.size() * sizeof(char32_t));
+        }
+    }
+    ResourceCacheFile::write(cache_name, DICTIONARY_OCR_CACHE_VERSION, source_hash, writer);
+}
+
+std::vector<DictionaryEntry> load_dictionary(const std::string& json_path){
+    std::string cache_name = resource_cache_name(json_path);
+    uint64_t source_hash = hash_resource_files({json_path, CHARACTER_REDUCTIONS_PATH()});
+
+    std::shared_ptr<ResourceCacheFile> file = ResourceCacheFile::open(
+        cache_name, DICTIONARY_OCR_CACHE_VERSION, source_hash
+    );
+    if (file){
+        bool ok;
+        std::vector<DictionaryEntry> entries = read_dictionary_cache(*file, ok);
+        if (ok){
+            return entries;
+        }
+    }
+
+    JsonValue json = load_json_file(json_path);
+    const JsonObject& obj = json.to_object_throw(json_path);
+
+    std::vector<DictionaryEntry> entries;
+    for (const auto& item0 : obj){
+        DictionaryEntry entry;
+        entry.token = item0.first;
+        for (const auto& item1 : item0.second.to_array_throw(json_path)){
+            const std::string& candidate = item1.to_string_throw(json_path);
+            entry.candidates.emplace_back(candidate, normalize_utf32(candidate));
+        }
+        entries.emplace_back(std::move(entry));
+    }
+
+    write_dictionary_cache(cache_name, source_hash, entries);
+    return entries;
+}
+
+}
+
+
+
 DictionaryOCR::DictionaryOCR(
     const JsonObject& json,
     const std::set<std::string>* subset,
@@ -29,6 +123,7 @@ DictionaryOCR::DictionaryOCR(
     bool first_only
 )
     : m_random_match_chance(random_match_chance)
+    , m_index(m_candidate_to_token, random_match_chance)
 {
     for (const auto& item0 : json){
         const std::string& token = item0.first;
@@ -38,26 +133,13 @@ DictionaryOCR::DictionaryOCR(
         std::vector<std::string>& candidates = m_database[token];
         for (const auto& item1 : item0.second.to_array_throw()){
             const std::string& candidate = item1.to_string_throw();
-            std::u32string normalized = normalize_utf32(candidate);
-            std::set<std::string>& set = m_candidate_to_token[normalized];
-            if (!set.empty()){
-                global_logger_tagged().log(
-                    "DictionaryOCR - Duplicate Candidate: " + token + " (" + utf32_to_str(normalized) + ")"
-                );
-//                cout << "Duplicate Candidate: " << candidate << endl;
-            }
-            set.insert(token);
-            candidates.emplace_back(candidate);
+            add_loaded_candidate(token, candidates, candidate, normalize_utf32(candidate));
             if (first_only){
                 break;
             }
         }
     }
-    global_logger_tagged().log(
-        "DictionaryOCR - Tokens: " + std::to_string(m_database.size()) +
-        ", Match Candidates: " + std::to_string(m_candidate_to_token.size())
-    );
-//    cout << "Tokens: " << m_database.size() << ", Match Candidates: " << m_candidate_to_token.size() << endl;
+    finish_loading();
 }
 DictionaryOCR::DictionaryOCR(
     const std::string& json_path,
@@ -65,13 +147,46 @@ DictionaryOCR::DictionaryOCR(
     double random_match_chance,
     bool first_only
 )
-    : DictionaryOCR(
-        load_json_file(json_path).to_object_throw(json_path),
-        subset,
-        random_match_chance,
-        first_only
-    )
-{}
+    : m_random_match_chance(random_match_chance)
+    , m_index(m_candidate_to_token, random_match_chance)
+{
+    for (DictionaryEntry& entry : load_dictionary(json_path)){
+        const std::string& token = entry.token;
+        if (subset != nullptr && subset->find(token) == subset->end()){
+            continue;
+        }
+        std::vector<std::string>& candidates = m_database[token];
+        for (auto& candidate : entry.candidates){
+            add_loaded_candidate(token, candidates, candidate.first, std::move(candidate.second));
+            if (first_only){
+                break;
+            }
+        }
+    }
+    finish_loading();
+}
+void DictionaryOCR::add_loaded_candidate(
+    const std::string& token, std::vector<std::string>& candidates,
+    const std::string& candidate, std::u32string normalized
+){
+    std::set<std::string>& set = m_candidate_to_token[normalized];
+    if (!set.empty()){
+        global_logger_tagged().log(
+            "DictionaryOCR - Duplicate Candidate: " + token + " (" + utf32_to_str(normalized) + ")"
+        );
+//        cout << "Duplicate Candidate: " << candidate << endl;
+    }
+    set.insert(token);
+    candidates.emplace_back(candidate);
+}
+void DictionaryOCR::finish_loading(){
+    m_index.rebuild();
+    global_logger_tagged().log(
+        "DictionaryOCR - Tokens: " + std::to_string(m_database.size()) +
+        ", Match Candidates: " + std::to_string(m_candidate_to_token.size())
+    );
+//    cout << "Tokens: " << m_database.size() << ", Match Candidates: " << m_candidate_to_token.size() << endl;
+}
 
 JsonObject DictionaryOCR::to_json() const{
     JsonObject obj;
@@ -94,10 +209,7 @@ StringMatchResult DictionaryOCR::match_substring(
     const std::string& text,
     double log10p_spread
 ) const{
-    return OCR::match_substring(
-        m_candidate_to_token, m_random_match_chance,
-        text, log10p_spread
-    );
+    return m_index.match_substring(text, log10p_spread);
 }
 void DictionaryOCR::add_candidate(std::string token, const std::u32string& candidate){
     if (candidate.size() < 2){
@@ -111,6 +223,7 @@ void DictionaryOCR::add_candidate(std::string token, const std::u32string& candi
         //  New candidate. Add it to both maps.
         m_database[token].emplace_back(utf32_to_str(candidate));
         m_candidate_to_token[candidate].insert(std::move(token));
+        m_index.add(candidate);
         return;
     }
 
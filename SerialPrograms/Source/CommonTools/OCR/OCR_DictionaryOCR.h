@@ -12,6 +12,7 @@
 #include <map>
 #include "Common/Cpp/Concurrency/SpinLock.h"
 #include "OCR_StringMatchResult.h"
+#include "OCR_SubstringMatchIndex.h"
 
 namespace PokemonAutomation{
     class JsonObject;
@@ -26,6 +27,9 @@ public:
         double random_match_chance,
         bool first_only
     );
+    //  The normalized candidates are kept in a resource cache.
+    //  (see ResourceCache.h) So after the first launch, neither the json
+    //  nor normalize_utf32() need to run.
     DictionaryOCR(
         const std::string& json_path,
         const std::set<std::string>* subset,
@@ -46,11 +50,20 @@ public:
     void add_candidate(std::string token, const std::u32string& candidate);
 
 
+private:
+    void add_loaded_candidate(
+        const std::string& token, std::vector<std::string>& candidates,
+        const std::string& candidate, std::u32string normalized
+    );
+    void finish_loading();
+
+
 private:
     SpinLock m_lock;
     double m_random_match_chance;
     std::map<std::string, std::vector<std::string>> m_database;
     std::map<std::u32string, std::set<std::string>> m_candidate_to_token;
+    SubstringMatchIndex m_index;
 };
 
 
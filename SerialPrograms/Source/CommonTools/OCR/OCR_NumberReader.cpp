@@ -158,7 +158,7 @@ std::string read_number_waterfill_no_normalization(
         }
     }
 
-    std::string ocr_text;
+    std::vector<ImageRGB32> characters;
     for (const auto& item : map){
         const WaterfillObject& object = item.second;
         ImageRGB32 cropped = extract_box_reference(filtered, object).copy();
@@ -171,9 +171,18 @@ std::string read_number_waterfill_no_normalization(
             cropped = cropped.scale_to(cropped.width() * 60 / cropped.height(), 60);
         }
 
-        ImageRGB32 padded = pad_image(cropped, 1 * cropped.width(), 0xffffffff);
-        std::string ocr = OCR::ocr_read(Language::English, padded, OCR::PageSegMode::SINGLE_CHAR);
+        characters.emplace_back(pad_image(cropped, 1 * cropped.width(), 0xffffffff));
+    }
 
+    //  OCR all the characters at once.
+    std::vector<std::string> reads = OCR::ocr_read(
+        Language::English,
+        std::vector<ImageViewRGB32>(characters.begin(), characters.end()),
+        OCR::PageSegMode::SINGLE_CHAR
+    );
+
+    std::string ocr_text;
+    for (const std::string& ocr : reads){
 //        padded.save("zztest-cropped" + std::to_string(c) + "-" + std::to_string(i++) + ".png");
 //        std::cout << ocr[0] << std::endl;
 
@@ -111,6 +111,10 @@ std::string paddle_ocr_read(Language language, const ImageViewRGB32& image){
 
     return ret;
 }
+std::vector<std::string> paddle_ocr_read(Language language, const std::vector<ImageViewRGB32>& images){
+    ML::PaddleOCRPipeline& paddle_instance = ensure_paddle_ocr_instance(language);
+    return paddle_instance.recognize(images);
+}
 
 
 
@@ -12,6 +12,7 @@
 #define PokemonAutomation_CommonTools_OCR_RawPaddleOCR_H
 
 #include <string>
+#include <vector>
 #include "CommonFramework/Language.h"
 
 namespace PokemonAutomation{
@@ -41,6 +42,13 @@ std::string paddle_ocr_read(
     const ImageViewRGB32& image
 );
 
+//  OCR a batch of images in the specified language. Returns one string per
+//  image in the same order. Images are batched through the model together.
+std::vector<std::string> paddle_ocr_read(
+    Language language,
+    const std::vector<ImageViewRGB32>& images
+);
+
 
 
 //  Clear all PaddleOCR instances for all languages. Used for cleanup or
@@ -12,6 +12,7 @@
 #include "Common/Cpp/Concurrency/SpinLock.h"
 #include "CommonFramework/GlobalAutoPaths.h"
 #include "CommonFramework/Logging/Logger.h"
+#include "CommonFramework/Tools/GlobalThreadPools.h"
 #include "CommonFramework/ImageTypes/ImageViewRGB32.h"
 #include "OCR_RawTesseractOCR.h"
 
@@ -129,18 +130,41 @@ public:
     // Useful for warming up the pool before heavy OCR workloads.
     void ensure_instances(size_t instances){
         size_t current_instances;
-        while (true){
-            {
-                ReadSpinLock lg(m_lock, "TesseractPool::run()");
-                current_instances = m_instances.size();
-            }
-            if (current_instances >= instances){
-                break;
-            }
-            add_instance();
+        {
+            ReadSpinLock lg(m_lock, "TesseractPool::ensure_instances()");
+            current_instances = m_instances.size();
+        }
+        if (current_instances < instances){
+            add_instances(instances - current_instances);
+        }
+    }
+
+    // Make sure at least this many instances are idle so that a batch can
+    // check out one each without creating any.
+    void ensure_idle(size_t instances){
+        size_t idle_instances;
+        {
+            ReadSpinLock lg(m_lock, "TesseractPool::ensure_idle()");
+            idle_instances = m_idle.size();
+        }
+        if (idle_instances < instances){
+            add_instances(instances - idle_instances);
         }
     }
 
+private:
+    // Create several instances at once. Initialization is mostly loading the
+    // training data from disk, so do it on the unlimited pool rather than
+    // tying up computation threads.
+    void add_instances(size_t count){
+        GlobalThreadPools::unlimited_normal().run_in_parallel(
+            [this](size_t){ add_instance(); },
+            0, count, 1
+        );
+    }
+
+public:
+
 #ifdef __APPLE__
 #ifdef UNIX_LINK_TESSERACT
     ~TesseractPool(){
@@ -175,6 +199,16 @@ struct OcrGlobals{
         static OcrGlobals globals;
         return globals;
     }
+
+    //  Get or create the pool for this language (lock only during map access).
+    TesseractPool& get_pool(Language language){
+        WriteSpinLock lg(ocr_pool_lock, "OcrGlobals::get_pool()");
+        auto iter = ocr_pool.find(language);
+        if (iter == ocr_pool.end()){
+            iter = ocr_pool.emplace(language, language).first;
+        }
+        return iter->second;
+    }
 };
 
 
@@ -186,25 +220,38 @@ std::string tesseract_ocr_read(Language language, const ImageViewRGB32& image, P
         throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Attempted to call OCR without a language.");
     }
 
-    OcrGlobals& globals = OcrGlobals::instance();
-    std::map<Language, TesseractPool>& ocr_pool = globals.ocr_pool;
-
-    // Get or create the pool for this language (lock only during map access).
-    std::map<Language, TesseractPool>::iterator iter;
-    {
-        WriteSpinLock lg(globals.ocr_pool_lock, "tesseract_ocr_read()");
-        iter = ocr_pool.find(language);
-        if (iter == ocr_pool.end()){
-            iter = ocr_pool.emplace(language, language).first;
-        }
-    }
     // Delegate to pool (which has its own locking for instance management).
-    std::string ret = iter->second.run(image, static_cast<int>(psm));
+    std::string ret = OcrGlobals::instance().get_pool(language).run(image, static_cast<int>(psm));
 
 //    global_logger_tagged().log(ret);
 
     return ret;
 }
+std::vector<std::string> tesseract_ocr_read(
+    Language language,
+    const std::vector<ImageViewRGB32>& images,
+    PageSegMode psm
+){
+    if (language == Language::None){
+        throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Attempted to call OCR without a language.");
+    }
+
+    TesseractPool& pool = OcrGlobals::instance().get_pool(language);
+
+    //  Each image checks out its own instance. Create any that are missing
+    //  up front (in parallel, off the computation pool) so the reads below
+    //  don't stall a computation thread on loading them.
+    pool.ensure_idle(images.size());
+
+    std::vector<std::string> ret(images.size());
+    GlobalThreadPools::computation_normal().run_in_parallel(
+        [&](size_t index){
+            ret[index] = pool.run(images[index], static_cast<int>(psm));
+        },
+        0, images.size(), 1
+    );
+    return ret;
+}
 
 
 void ensure_tesseract_instances(Language language, size_t instances){
@@ -212,20 +259,8 @@ void ensure_tesseract_instances(Language language, size_t instances){
         throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Attempted to call OCR without a language.");
     }
 
-    OcrGlobals& globals = OcrGlobals::instance();
-    std::map<Language, TesseractPool>& ocr_pool = globals.ocr_pool;
-
-    // Get or create the pool for this language.
-    std::map<Language, TesseractPool>::iterator iter;
-    {
-        WriteSpinLock lg(globals.ocr_pool_lock, "tesseract_ocr_read()");
-        iter = ocr_pool.find(language);
-        if (iter == ocr_pool.end()){
-            iter = ocr_pool.emplace(language, language).first;
-        }
-    }
     // Delegate to pool's ensure_instances (which handles its own locking).
-    iter->second.ensure_instances(instances);
+    OcrGlobals::instance().get_pool(language).ensure_instances(instances);
 }
 
 void clear_tesseract_cache(){
@@ -12,6 +12,7 @@
 #define PokemonAutomation_CommonTools_OCR_RawTesseractOCR_H
 
 #include <string>
+#include <vector>
 #include "CommonFramework/Language.h"
 
 namespace PokemonAutomation{
@@ -61,6 +62,16 @@ std::string tesseract_ocr_read(
     PageSegMode psm = PageSegMode::SINGLE_LINE
 );
 
+//  OCR a batch of images in the specified language. Returns one string per
+//  image in the same order.
+//  The images are spread across the instance pool and read in parallel on the
+//  computation thread pool. Missing instances are created in parallel too.
+std::vector<std::string> tesseract_ocr_read(
+    Language language,
+    const std::vector<ImageViewRGB32>& images,
+    PageSegMode psm = PageSegMode::SINGLE_LINE
+);
+
 
 //  Pre-warm the Tesseract API instance pool for a language by ensuring a minimum
 //  number of instances exist.
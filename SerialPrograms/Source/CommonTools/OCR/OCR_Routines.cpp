@@ -47,6 +47,19 @@ std::string ocr_read(Language language, const ImageViewRGB32& image, PageSegMode
     }
     return ocr_text;
 }
+std::vector<std::string> ocr_read(
+    Language language,
+    const std::vector<ImageViewRGB32>& images,
+    PageSegMode psm
+){
+    if (psm == PageSegMode::AUTO || psm == PageSegMode::SINGLE_BLOCK || psm == PageSegMode::SINGLE_COLUMN ||
+        GlobalSettings::instance().OCR_LIBRARY != OcrLibrary::PADDLE_OCR
+    ){
+        return OCR::tesseract_ocr_read(language, images, psm);
+    }
+
+    return OCR::paddle_ocr_read(language, images);
+}
 
 bool allow_parallel_ocr(PageSegMode psm){
     if (psm == PageSegMode::AUTO || psm == PageSegMode::SINGLE_BLOCK || psm == PageSegMode::SINGLE_COLUMN){
@@ -37,6 +37,17 @@ bool ocr_language_available(Language language);
 // an error will be thrown within OCR initialization infra.
 std::string ocr_read(Language language, const ImageViewRGB32& image, PageSegMode psm = PageSegMode::SINGLE_LINE);
 
+//  Same as above, but for a batch of images. Returns one string per image in
+//  the same order. With Tesseract, the images are read in parallel. With
+//  PaddleOCR, they are batched through the model together.
+//  Use this instead of calling ocr_read() in a loop when there are several
+//  crops to read at once.
+std::vector<std::string> ocr_read(
+    Language language,
+    const std::vector<ImageViewRGB32>& images,
+    PageSegMode psm = PageSegMode::SINGLE_LINE
+);
+
 //
 //  Return if we should allow multiple OCRs are run in parallel.
 //  The reason why this may return false is if the OCR backend is already
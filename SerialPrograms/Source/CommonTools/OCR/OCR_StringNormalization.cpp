@@ -42,8 +42,13 @@ std::u32string remove_non_alphanumeric(const std::u32string& text){
 }
 
 
+const std::string& CHARACTER_REDUCTIONS_PATH(){
+    static const std::string path = RESOURCE_PATH() + "Tesseract/CharacterReductions.json";
+    return path;
+}
+
 std::map<char32_t, std::u32string> make_substitution_map32(){
-    std::string path = RESOURCE_PATH() + "Tesseract/CharacterReductions.json";
+    std::string path = CHARACTER_REDUCTIONS_PATH();
     JsonValue json = load_json_file(path);
     JsonObject& obj = json.to_object_throw(path);
 
@@ -18,6 +18,10 @@ namespace OCR{
 // against a dictionary.
 std::u32string remove_non_alphanumeric(const std::u32string& text);
 
+// Path of the character substitution rules used by `run_character_reductions()`.
+// RESOURCE_PATH()/Tesseract/CharacterReductions.json
+const std::string& CHARACTER_REDUCTIONS_PATH();
+
 // Apply character substitution rules loaded from RESOURCE_PATH()/Tesseract/CharacterReductions.json
 // to merge similar-looking characters. This is called by `normalize_utf32()` as a fix for OCR
 // failure on those similar-looking characters.
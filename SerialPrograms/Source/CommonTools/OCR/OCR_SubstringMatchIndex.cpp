@@ -0,0 +1,262 @@
+/*  Substring Match Index
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "OCR_StringNormalization.h"
+#include "OCR_TextMatcher.h"
+#include "OCR_SubstringMatchIndex.h"
+
+//#include <iostream>
+//using std::cout;
+//using std::endl;
+
+namespace PokemonAutomation{
+namespace OCR{
+
+
+
+//  Bit-parallel version of levenshtein_distance_substring(). (Myers 1999)
+//  "substring" must be 1 to 64 characters long.
+//
+//  "alphabet" is the sorted set of characters in the full string and
+//  "fullstring_ids" is the full string with each character replaced by its
+//  index in "alphabet". "peq" is scratch space the size of "alphabet".
+size_t levenshtein_distance_substring_u64(
+    const std::u32string& substring,
+    const std::vector<char32_t>& alphabet,
+    const std::vector<uint32_t>& fullstring_ids,
+    std::vector<uint64_t>& peq
+){
+    size_t length = substring.size();
+
+    std::fill(peq.begin(), peq.end(), 0);
+    for (size_t c = 0; c < length; c++){
+        auto iter = std::lower_bound(alphabet.begin(), alphabet.end(), substring[c]);
+        if (iter != alphabet.end() && *iter == substring[c]){
+            peq[iter - alphabet.begin()] |= (uint64_t)1 << c;
+        }
+    }
+
+    const uint64_t HIGH_BIT = (uint64_t)1 << (length - 1);
+    uint64_t pv = length == 64 ? (uint64_t)-1 : ((uint64_t)1 << length) - 1;
+    uint64_t mv = 0;
+    size_t score = length;
+    size_t min = length;
+
+    for (uint32_t id : fullstring_ids){
+        uint64_t eq = peq[id];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & HIGH_BIT){
+            score++;
+        }else if (mh & HIGH_BIT){
+            score--;
+        }
+
+        //  The match may start anywhere in the full string. So unlike the
+        //  full edit distance, the top row stays zero and nothing is shifted
+        //  into the bottom bit.
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        min = std::min(min, score);
+    }
+
+    return min;
+}
+
+
+
+SubstringMatchIndex::SubstringMatchIndex(const Database& database, double random_match_chance)
+    : m_database(database)
+    , m_random_match_chance(random_match_chance)
+{}
+
+void SubstringMatchIndex::rebuild(){
+    m_candidates.clear();
+    m_postings.clear();
+    for (const auto& item : m_database){
+        add(item);
+    }
+}
+void SubstringMatchIndex::add(const std::u32string& candidate){
+    auto iter = m_database.find(candidate);
+    if (iter != m_database.end()){
+        add(*iter);
+    }
+}
+void SubstringMatchIndex::add(const Database::value_type& entry){
+    const std::u32string& candidate = entry.first;
+    if (candidate.empty()){
+        //  Never matches anything.
+        return;
+    }
+
+    uint32_t index = (uint32_t)m_candidates.size();
+    m_candidates.emplace_back(Candidate{&entry});
+
+    std::map<char32_t, uint32_t> counts;
+    for (char32_t ch : candidate){
+        counts[ch]++;
+    }
+    for (const auto& item : counts){
+        m_postings[item.first].emplace_back(Posting{index, item.second});
+    }
+
+    ensure_length(candidate.size());
+}
+void SubstringMatchIndex::ensure_length(size_t length){
+    while (m_log10p.size() <= length){
+        size_t total = m_log10p.size();
+        std::vector<double> row(total + 1);
+        std::vector<double> min_row(total + 1);
+        double min = 0;
+        for (size_t matched = 1; matched <= total; matched++){
+            row[matched] = std::log10(random_match_probability(total, matched, m_random_match_chance));
+            min = matched == 1 ? row[matched] : std::min(min, row[matched]);
+            min_row[matched] = min;
+        }
+        m_log10p.emplace_back(std::move(row));
+        m_min_log10p.emplace_back(std::move(min_row));
+    }
+}
+
+
+
+StringMatchResult SubstringMatchIndex::match_substring(const std::string& text, double log10p_spread) const{
+    return match_substring(text, normalize_utf32(text), log10p_spread);
+}
+StringMatchResult SubstringMatchIndex::match_substring(
+    const std::string& text, const std::u32string& normalized,
+    double log10p_spread
+) const{
+    StringMatchResult results;
+
+    //  Search for exact match of candidate.
+    auto iter = m_database.find(normalized);
+    if (iter != m_database.end()){
+        results.exact_match = true;
+        double probability = random_match_probability(normalized.size(), normalized.size(), m_random_match_chance);
+        double log10p = std::log10(probability);
+        for (const auto& target : iter->second){
+            results.add(
+                log10p,
+                StringMatchData{text, normalized, normalized, target}
+            );
+        }
+        return results;
+    }
+
+    std::vector<char32_t> alphabet(normalized.begin(), normalized.end());
+    std::sort(alphabet.begin(), alphabet.end());
+    alphabet.erase(std::unique(alphabet.begin(), alphabet.end()), alphabet.end());
+
+    std::vector<uint32_t> text_ids(normalized.size());
+    std::vector<uint32_t> text_counts(alphabet.size());
+    for (size_t c = 0; c < normalized.size(); c++){
+        uint32_t id = (uint32_t)(std::lower_bound(alphabet.begin(), alphabet.end(), normalized[c]) - alphabet.begin());
+        text_ids[c] = id;
+        text_counts[id]++;
+    }
+
+    //  Every character of a candidate that matches must be matched against
+    //  a distinct equal character of the text. So the number of matched
+    //  characters can be no more than the size of the multiset intersection.
+    std::vector<uint32_t> common(m_candidates.size());
+    for (size_t c = 0; c < alphabet.size(); c++){
+        auto postings = m_postings.find(alphabet[c]);
+        if (postings == m_postings.end()){
+            continue;
+        }
+        for (const Posting& posting : postings->second){
+            common[posting.candidate] += std::min(posting.count, text_counts[c]);
+        }
+    }
+
+    //  Best possible score of each candidate. Candidates that cannot match
+    //  anything are skipped just like the brute-force version does.
+    std::vector<std::pair<double, uint32_t>> bounds;
+    for (uint32_t c = 0; c < m_candidates.size(); c++){
+        if (common[c] == 0){
+            continue;
+        }
+        size_t length = m_candidates[c].entry->first.size();
+        bounds.emplace_back(m_min_log10p[length][common[c]], c);
+    }
+    std::sort(bounds.begin(), bounds.end());
+
+    struct Scored{
+        const Database::value_type* entry;
+        double log10p;
+    };
+    std::vector<Scored> scored;
+    std::vector<uint64_t> peq(alphabet.size());
+    double best = 0;
+    for (const auto& bound : bounds){
+        if (!scored.empty() && bound.first > best + log10p_spread){
+            break;
+        }
+
+        const Database::value_type* entry = m_candidates[bound.second].entry;
+        if (entry->second.empty()){
+            continue;
+        }
+
+        const std::u32string& candidate = entry->first;
+        size_t distance = candidate.size() <= 64
+            ? levenshtein_distance_substring_u64(candidate, alphabet, text_ids, peq)
+            : levenshtein_distance_substring(candidate, normalized);
+
+        size_t matched = candidate.size() - distance;
+        if (matched == 0){
+            continue;
+        }
+
+        double log10p = m_log10p[candidate.size()][matched];
+        best = scored.empty() ? log10p : std::min(best, log10p);
+        scored.emplace_back(Scored{entry, log10p});
+    }
+
+    //  The brute-force version reports an exact match if any candidate is a
+    //  substring of the text, even if it is too short to make the spread.
+    for (uint32_t c = 0; c < m_candidates.size(); c++){
+        const std::u32string& candidate = m_candidates[c].entry->first;
+        if (common[c] == candidate.size() && normalized.find(candidate) != std::u32string::npos){
+            results.exact_match = true;
+            break;
+        }
+    }
+
+    //  Add the survivors in dictionary order so that ties come out in the
+    //  same order as the brute-force version.
+    std::sort(
+        scored.begin(), scored.end(),
+        [](const Scored& x, const Scored& y){
+            return x.entry->first < y.entry->first;
+        }
+    );
+    for (const Scored& item : scored){
+        if (item.log10p > best + log10p_spread){
+            continue;
+        }
+        for (const auto& slug : item.entry->second){
+            results.add(item.log10p, StringMatchData{text, normalized, item.entry->first, slug});
+        }
+    }
+
+    return results;
+}
+
+
+
+
+}
+}
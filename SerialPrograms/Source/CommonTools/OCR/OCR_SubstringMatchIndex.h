@@ -0,0 +1,89 @@
+/*  Substring Match Index
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  Prebuilt index over an OCR dictionary for match_substring().
+ *
+ *  The brute-force match_substring() in OCR_TextMatcher.h runs the full
+ *  edit distance against every candidate in the dictionary. This index
+ *  keeps a per-character inverted index of the candidates so that it can
+ *  bound how many characters of each candidate can possibly match the text.
+ *  Candidates are then scored best-bound-first with a bit-parallel edit
+ *  distance and the search stops as soon as no remaining candidate can land
+ *  within the spread.
+ *
+ *  The result is identical to the brute-force match_substring().
+ *
+ */
+
+#ifndef PokemonAutomation_CommonTools_OCR_SubstringMatchIndex_H
+#define PokemonAutomation_CommonTools_OCR_SubstringMatchIndex_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include "OCR_StringMatchResult.h"
+
+namespace PokemonAutomation{
+namespace OCR{
+
+
+class SubstringMatchIndex{
+public:
+    using Database = std::map<std::u32string, std::set<std::string>>;
+
+    //  The index holds onto "database". It must outlive the index.
+    SubstringMatchIndex(const Database& database, double random_match_chance);
+
+    //  Rebuild the index from scratch for everything currently in the database.
+    void rebuild();
+
+    //  Call this after inserting a new candidate into the database.
+    //  Adding more tokens to an existing candidate does not need this.
+    void add(const std::u32string& candidate);
+
+
+public:
+    StringMatchResult match_substring(const std::string& text, double log10p_spread) const;
+
+    //  Same as above, but with "text" already run through normalize_utf32().
+    StringMatchResult match_substring(
+        const std::string& text, const std::u32string& normalized,
+        double log10p_spread
+    ) const;
+
+
+private:
+    void add(const Database::value_type& entry);
+    void ensure_length(size_t length);
+
+
+private:
+    struct Candidate{
+        const Database::value_type* entry;
+    };
+    struct Posting{
+        uint32_t candidate;
+        uint32_t count;
+    };
+
+    const Database& m_database;
+    double m_random_match_chance;
+
+    std::vector<Candidate> m_candidates;
+    std::map<char32_t, std::vector<Posting>> m_postings;
+
+    //  m_log10p[total][matched] = log10(random_match_probability(total, matched)).
+    //  m_min_log10p[total][matched] = the smallest of the above over [1, matched].
+    std::vector<std::vector<double>> m_log10p;
+    std::vector<std::vector<double>> m_min_log10p;
+};
+
+
+
+
+}
+}
+#endif
@@ -10,7 +10,10 @@
 // #include "Common/Cpp/Strings/Unicode.h"
 #include "OCR_Routines.h"
 #include "OCR_StringNormalization.h"
+#include "OCR_TextMatcher.h"
+#include "OCR_SubstringMatchIndex.h"
 #include "OCR_Tests.h"
+#include "Tests/TestUtils.h"
 
 #include <iostream>
 using std::cout;
@@ -23,6 +26,7 @@ namespace OCR{
 
 void add_tests(UnitTestDatabase& database){
     add_tests_raw_OCR(database);
+    add_tests_text_matcher(database);
 }
 
 class Test_RawOCR : public UnitTest{
@@ -72,5 +76,68 @@ void add_tests_raw_OCR(UnitTestDatabase& database){
 
 
 
+//  SubstringMatchIndex must give exactly the same results as the brute-force
+//  match_substring() on random dictionaries.
+class Test_SubstringMatchIndex : public UnitTest{
+public:
+    Test_SubstringMatchIndex()
+        : UnitTest("OCR::SubstringMatchIndex")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        TestRandom random;
+        auto random_string = [&](size_t length, uint32_t letters){
+            std::string str;
+            for (size_t c = 0; c < length; c++){
+                str += (char)('0' + random() % letters);
+            }
+            return str;
+        };
+
+        for (size_t trial = 0; trial < 100; trial++){
+            uint32_t letters = 2 + random() % 10;
+            double random_match_chance = 0.02 + (random() % 100) / 1000.;
+
+            std::map<std::u32string, std::set<std::string>> dictionary;
+            size_t candidates = 1 + random() % 200;
+            for (size_t c = 0; c < candidates; c++){
+                //  Include some candidates too long for the bit-parallel path.
+                size_t length = random() % 8 == 0 ? 1 + random() % 100 : 1 + random() % 12;
+                dictionary[normalize_utf32(random_string(length, letters))].insert("token-" + std::to_string(random() % candidates));
+            }
+            SubstringMatchIndex index(dictionary, random_match_chance);
+            index.rebuild();
+
+            for (size_t c = 0; c < 50; c++){
+                std::string text = random_string(random() % 30, letters + 2);
+                double log10p_spread = (random() % 4) * 0.5;
+                StringMatchResult expected = match_substring(dictionary, random_match_chance, text, log10p_spread);
+                StringMatchResult actual = index.match_substring(text, log10p_spread);
+
+                TEST_RESULT_COMPONENT_EQUAL_STR(actual.exact_match, expected.exact_match, "exact match of \"" + text + "\"");
+                TEST_RESULT_COMPONENT_EQUAL_STR(actual.results.size(), expected.results.size(), "results of \"" + text + "\"");
+                auto iter0 = actual.results.begin();
+                auto iter1 = expected.results.begin();
+                for (; iter0 != actual.results.end(); ++iter0, ++iter1){
+                    TEST_RESULT_COMPONENT_EQUAL_STR(iter0->first, iter1->first, "log10p of \"" + text + "\"");
+                    TEST_RESULT_COMPONENT_EQUAL_STR(iter0->second.token, iter1->second.token, "token of \"" + text + "\"");
+                    TEST_RESULT_COMPONENT_EQUAL_STR(
+                        iter0->second.target == iter1->second.target, true,
+                        "target of \"" + text + "\""
+                    );
+                }
+            }
+        }
+
+        return true;
+    };
+};
+
+void add_tests_text_matcher(UnitTestDatabase& database){
+    database.add<Test_SubstringMatchIndex>();
+}
+
+
+
 }
 }
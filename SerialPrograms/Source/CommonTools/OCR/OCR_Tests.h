@@ -17,6 +17,7 @@ namespace OCR{
 void add_tests(UnitTestDatabase& database);
 
 void add_tests_raw_OCR(UnitTestDatabase& database);
+void add_tests_text_matcher(UnitTestDatabase& database);
 
 
 
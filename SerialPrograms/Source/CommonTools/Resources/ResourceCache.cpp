@@ -0,0 +1,225 @@
+/*  Resource Cache
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include "Common/Cpp/Exceptions.h"
+#include "CommonFramework/GlobalAutoPaths.h"
+#include "CommonFramework/Logging/Logger.h"
+#include "ResourceCache.h"
+
+//#include <iostream>
+//using std::cout;
+//using std::endl;
+
+namespace PokemonAutomation{
+
+
+
+//  Bump this if the layout of the header below changes.
+const uint32_t RESOURCE_CACHE_FORMAT_VERSION = 1;
+
+const size_t RESOURCE_CACHE_HEADER_SIZE = 64;
+const char RESOURCE_CACHE_MAGIC[8] = {'P', 'A', 'R', 'C', 'A', 'C', 'H', 'E'};
+
+struct ResourceCacheHeader{
+    char magic[8];
+    uint32_t format_version;
+    uint32_t version;
+    uint64_t source_hash;
+    uint64_t payload_bytes;
+};
+static_assert(sizeof(ResourceCacheHeader) <= RESOURCE_CACHE_HEADER_SIZE, "Header is too large.");
+
+
+
+//  Not cryptographic. This only needs to notice that a file has changed.
+static uint64_t hash_bytes(uint64_t state, const char* data, size_t bytes){
+    const uint64_t M0 = 0x9e3779b97f4a7c15;
+    const uint64_t M1 = 0xbf58476d1ce4e5b9;
+    while (bytes >= 8){
+        uint64_t x;
+        memcpy(&x, data, 8);
+        state ^= x * M0;
+        state = ((state << 31) | (state >> 33)) * M1;
+        data += 8;
+        bytes -= 8;
+    }
+    uint64_t x = bytes;
+    for (size_t c = 0; c < bytes; c++){
+        x = (x << 8) | (uint8_t)data[c];
+    }
+    state ^= x * M0;
+    state = ((state << 31) | (state >> 33)) * M1;
+    state ^= state >> 29;
+    return state;
+}
+
+uint64_t hash_resource_files(const std::vector<std::string>& paths){
+    uint64_t state = paths.size();
+    for (const std::string& path : paths){
+        QFile file(QString::fromStdString(path));
+        if (!file.open(QIODevice::ReadOnly)){
+            throw FileException(nullptr, PA_CURRENT_FUNCTION, "Unable to open file.", path);
+        }
+        uint64_t bytes = file.size();
+        state = hash_bytes(state, (const char*)&bytes, sizeof(bytes));
+        if (bytes == 0){
+            continue;
+        }
+        const uchar* map = file.map(0, bytes);
+        if (map != nullptr){
+            state = hash_bytes(state, (const char*)map, bytes);
+            file.unmap((uchar*)map);
+            continue;
+        }
+        QByteArray data = file.readAll();
+        if ((uint64_t)data.size() != bytes){
+            throw FileException(nullptr, PA_CURRENT_FUNCTION, "Unable to read file.", path);
+        }
+        state = hash_bytes(state, data.constData(), bytes);
+    }
+    return state;
+}
+
+std::string resource_cache_name(const std::string& path){
+    const std::string& root = RESOURCE_PATH();
+    std::string name = path.compare(0, root.size(), root) == 0
+        ? path.substr(root.size())
+        : path;
+    for (char& ch : name){
+        switch (ch){
+        case '/':
+        case '\\':
+        case ':':
+            ch = '_';
+            break;
+        default:;
+        }
+    }
+    return name + ".bin";
+}
+
+
+
+void ResourceCacheWriter::write_string(const std::string& str){
+    write<uint32_t>((uint32_t)str.size());
+    write_bytes(str.data(), str.size());
+}
+void ResourceCacheWriter::write_bytes(const void* data, size_t bytes){
+    m_payload.append((const char*)data, bytes);
+}
+void ResourceCacheWriter::align(size_t alignment){
+    size_t padding = (alignment - m_payload.size() % alignment) % alignment;
+    m_payload.append(padding, '\0');
+}
+
+
+std::string ResourceCacheReader::read_string(){
+    uint32_t length = read<uint32_t>();
+    const char* ptr = read_bytes(length);
+    return ptr == nullptr ? std::string() : std::string(ptr, length);
+}
+const char* ResourceCacheReader::read_bytes(size_t bytes){
+    if (!m_ok || bytes > m_bytes - m_offset){
+        m_ok = false;
+        return nullptr;
+    }
+    const char* ptr = m_data + m_offset;
+    m_offset += bytes;
+    return ptr;
+}
+void ResourceCacheReader::align(size_t alignment){
+    size_t padding = (alignment - m_offset % alignment) % alignment;
+    read_bytes(padding);
+}
+
+
+
+ResourceCacheFile::~ResourceCacheFile(){
+    if (m_map != nullptr){
+        m_file->unmap(m_map);
+    }
+}
+
+std::shared_ptr<ResourceCacheFile> ResourceCacheFile::open(
+    const std::string& name, uint32_t version, uint64_t source_hash
+){
+    std::unique_ptr<QFile> file(new QFile(QString::fromStdString(RESOURCE_CACHE_PATH() + name)));
+    if (!file->open(QIODevice::ReadOnly)){
+        return nullptr;
+    }
+
+    uint64_t bytes = file->size();
+    if (bytes < RESOURCE_CACHE_HEADER_SIZE){
+        return nullptr;
+    }
+
+    ResourceCacheHeader header;
+    if (file->read((char*)&header, sizeof(header)) != (qint64)sizeof(header)){
+        return nullptr;
+    }
+    if (memcmp(header.magic, RESOURCE_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.format_version != RESOURCE_CACHE_FORMAT_VERSION ||
+        header.version != version ||
+        header.source_hash != source_hash ||
+        header.payload_bytes != bytes - RESOURCE_CACHE_HEADER_SIZE
+    ){
+        return nullptr;
+    }
+
+    //  Copy-on-write so that nothing written by the caller can reach the file.
+    uchar* map = file->map(0, bytes, QFileDevice::MapPrivateOption);
+    if (map == nullptr){
+        return nullptr;
+    }
+
+    std::shared_ptr<ResourceCacheFile> ret(new ResourceCacheFile());
+    ret->m_file = std::move(file);
+    ret->m_map = map;
+    ret->m_data = (char*)map + RESOURCE_CACHE_HEADER_SIZE;
+    ret->m_bytes = header.payload_bytes;
+    return ret;
+}
+
+void ResourceCacheFile::write(
+    const std::string& name, uint32_t version, uint64_t source_hash,
+    const ResourceCacheWriter& payload
+){
+    const std::string& data = payload.payload();
+    std::string path = RESOURCE_CACHE_PATH() + name;
+
+    ResourceCacheHeader header;
+    memcpy(header.magic, RESOURCE_CACHE_MAGIC, sizeof(header.magic));
+    header.format_version = RESOURCE_CACHE_FORMAT_VERSION;
+    header.version = version;
+    header.source_hash = source_hash;
+    header.payload_bytes = data.size();
+
+    char padded_header[RESOURCE_CACHE_HEADER_SIZE] = {};
+    memcpy(padded_header, &header, sizeof(header));
+
+    QDir().mkpath(QString::fromStdString(RESOURCE_CACHE_PATH()));
+
+    //  Write to a temporary and rename so that a crash or another instance
+    //  can never see a partially written cache.
+    QSaveFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(padded_header, sizeof(padded_header)) != (qint64)sizeof(padded_header) ||
+        file.write(data.data(), data.size()) != (qint64)data.size() ||
+        !file.commit()
+    ){
+        global_logger_tagged().log("Unable to write resource cache: " + path, COLOR_RED);
+        return;
+    }
+    global_logger_tagged().log("Wrote resource cache: " + path);
+}
+
+
+
+
+}
@@ -0,0 +1,142 @@
+/*  Resource Cache
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  Binary cache of decoded resources.
+ *
+ *  Decoding resources (PNG sprite sheets, OCR dictionaries, etc...) at
+ *  every launch is slow. Instead, the decoded form is written to a cache
+ *  file under RESOURCE_CACHE_PATH() the first time and memory-mapped on
+ *  every launch after that.
+ *
+ *  Each cache file records the version of its payload layout and a hash of
+ *  the contents of every source file it was built from. If either doesn't
+ *  match, the cache is ignored and the caller rebuilds it from the sources.
+ *  So the cache never needs to be cleared by hand.
+ *
+ *  The payload is memory-mapped copy-on-write. Writing to it is allowed,
+ *  but never goes back to the file.
+ *
+ */
+
+#ifndef PokemonAutomation_CommonTools_Resources_ResourceCache_H
+#define PokemonAutomation_CommonTools_Resources_ResourceCache_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <type_traits>
+
+class QFile;
+
+namespace PokemonAutomation{
+
+
+//  Hash the contents of these files.
+//  Throws FileException if any of them cannot be read.
+uint64_t hash_resource_files(const std::vector<std::string>& paths);
+
+//  Return a cache name for the resource at "path".
+//  Paths under RESOURCE_PATH() are made relative to it first.
+std::string resource_cache_name(const std::string& path);
+
+
+
+class ResourceCacheWriter{
+public:
+    template <typename Type>
+    void write(const Type& x){
+        static_assert(std::is_trivially_copyable<Type>::value, "Type must be trivially copyable.");
+        write_bytes(&x, sizeof(Type));
+    }
+    void write_string(const std::string& str);
+    void write_bytes(const void* data, size_t bytes);
+
+    //  Pad the payload to a multiple of "alignment". (must be <= 64)
+    void align(size_t alignment);
+
+    const std::string& payload() const{ return m_payload; }
+
+private:
+    std::string m_payload;
+};
+
+
+//  Reads back what was written by ResourceCacheWriter in the same order.
+//  Reading past the end returns zeros (or null) and clears ok().
+class ResourceCacheReader{
+public:
+    ResourceCacheReader(const char* data, size_t bytes)
+        : m_data(data)
+        , m_bytes(bytes)
+    {}
+
+    bool ok() const{ return m_ok; }
+    bool at_end() const{ return m_offset == m_bytes; }
+
+    template <typename Type>
+    Type read(){
+        static_assert(std::is_trivially_copyable<Type>::value, "Type must be trivially copyable.");
+        Type x{};
+        const char* ptr = read_bytes(sizeof(Type));
+        if (ptr != nullptr){
+            memcpy(&x, ptr, sizeof(Type));
+        }
+        return x;
+    }
+    std::string read_string();
+
+    //  Returns a pointer into the payload.
+    const char* read_bytes(size_t bytes);
+
+    void align(size_t alignment);
+
+private:
+    const char* m_data;
+    size_t m_bytes;
+    size_t m_offset = 0;
+    bool m_ok = true;
+};
+
+
+
+class ResourceCacheFile{
+public:
+    ~ResourceCacheFile();
+
+    //  Open the cache file "name". Returns null if it doesn't exist, is
+    //  for a different "version" or was built from different sources.
+    static std::shared_ptr<ResourceCacheFile> open(
+        const std::string& name, uint32_t version, uint64_t source_hash
+    );
+
+    //  Write the cache file "name". Failures are logged and otherwise
+    //  ignored since the cache is only an optimization.
+    static void write(
+        const std::string& name, uint32_t version, uint64_t source_hash,
+        const ResourceCacheWriter& payload
+    );
+
+    //  The payload is aligned to 64 bytes.
+    char* data() const{ return m_data; }
+    size_t size() const{ return m_bytes; }
+
+    ResourceCacheReader reader() const{ return ResourceCacheReader(m_data, m_bytes); }
+
+private:
+    ResourceCacheFile() = default;
+
+private:
+    std::unique_ptr<QFile> m_file;
+    unsigned char* m_map = nullptr;
+    char* m_data = nullptr;
+    size_t m_bytes = 0;
+};
+
+
+
+
+}
+#endif
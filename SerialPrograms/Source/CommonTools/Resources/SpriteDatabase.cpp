@@ -9,16 +9,52 @@
 #include "CommonFramework/GlobalAutoPaths.h"
 #include "CommonFramework/ImageTools/ImageBoxes.h"
 #include "CommonTools/ImageMatch/ImageCropper.h"
+#include "ResourceCache.h"
 #include "SpriteDatabase.h"
 
 namespace PokemonAutomation{
 
 
 
-SpriteDatabase::SpriteDatabase(const char* sprite_path, const char* json_path)
-    : m_backing_image(RESOURCE_PATH() + sprite_path)
-{
+//  Bump this if the layout written by save_cache() changes.
+const uint32_t SPRITE_DATABASE_CACHE_VERSION = 1;
+
+
+//  Backing image that points directly into a memory-mapped cache file.
+class SpriteCacheImage : public CustomImageRGB32Owner{
+public:
+    SpriteCacheImage(std::shared_ptr<ResourceCacheFile> file, ImageViewRGB32 view)
+        : m_file(std::move(file))
+        , m_view(view)
+    {}
+    virtual ImageViewRGB32 get_view() const override{
+        return m_view;
+    }
+
+private:
+    std::shared_ptr<ResourceCacheFile> m_file;
+    ImageViewRGB32 m_view;
+};
+
+
+
+SpriteDatabase::SpriteDatabase(const char* sprite_path, const char* json_path){
+    std::string image_path = RESOURCE_PATH() + sprite_path;
     std::string path = RESOURCE_PATH() + json_path;
+
+    std::string cache_name = resource_cache_name(image_path);
+    uint64_t source_hash = hash_resource_files({image_path, path});
+    if (load_cache(cache_name, source_hash)){
+        return;
+    }
+
+    m_backing_image = ImageRGB32(image_path);
+    LocationMap locations = load_locations(path, m_backing_image);
+    save_cache(cache_name, source_hash, locations);
+    build(locations);
+}
+
+SpriteDatabase::LocationMap SpriteDatabase::load_locations(const std::string& path, const ImageViewRGB32& image){
     JsonValue json = load_json_file(path);
     JsonObject& root = json.to_object_throw(path);
 
@@ -31,17 +67,118 @@ SpriteDatabase::SpriteDatabase(const char* sprite_path, const char* json_path)
         throw FileException(nullptr, PA_CURRENT_FUNCTION, "Invalid height.", path);
     }
 
-    JsonObject& locations = root.get_object_throw("spriteLocations", path);
-    for (auto& item : locations){
+    LocationMap locations;
+    JsonObject& sprite_locations = root.get_object_throw("spriteLocations", path);
+    for (auto& item : sprite_locations){
         const std::string& slug = item.first;
         JsonObject& obj = item.second.to_object_throw(path);
         int y = (int)obj.get_integer_throw("top", path);
         int x = (int)obj.get_integer_throw("left", path);
 
-        ImageViewRGB32 sprite = extract_box_reference(m_backing_image, ImagePixelBox(x, y, x + width, y + height));
-        m_database.emplace(
+        ImagePixelBox box(x, y, x + width, y + height);
+        ImageViewRGB32 sprite = extract_box_reference(image, box);
+        locations.emplace(
             slug,
-            Sprite{sprite, ImageMatch::trim_image_alpha(sprite)}
+            Location{box, ImageMatch::trim_image_alpha_box(sprite)}
+        );
+    }
+    return locations;
+}
+
+bool SpriteDatabase::load_cache(const std::string& cache_name, uint64_t source_hash){
+    std::shared_ptr<ResourceCacheFile> file = ResourceCacheFile::open(
+        cache_name, SPRITE_DATABASE_CACHE_VERSION, source_hash
+    );
+    if (!file){
+        return false;
+    }
+
+    ResourceCacheReader reader = file->reader();
+    auto read_box = [&]{
+        ImagePixelBox box;
+        box.min_x = (size_t)reader.read<uint64_t>();
+        box.min_y = (size_t)reader.read<uint64_t>();
+        box.max_x = (size_t)reader.read<uint64_t>();
+        box.max_y = (size_t)reader.read<uint64_t>();
+        return box;
+    };
+
+    uint32_t width = reader.read<uint32_t>();
+    uint32_t height = reader.read<uint32_t>();
+    uint64_t count = reader.read<uint64_t>();
+
+    LocationMap locations;
+    for (uint64_t c = 0; c < count && reader.ok(); c++){
+        std::string slug = reader.read_string();
+        ImagePixelBox sprite = read_box();
+        ImagePixelBox icon = read_box();
+        locations.emplace(std::move(slug), Location{sprite, icon});
+    }
+
+    reader.align(64);
+    size_t bytes_per_row = (size_t)width * sizeof(uint32_t);
+    char* pixels = const_cast<char*>(reader.read_bytes(bytes_per_row * height));
+    if (!reader.ok() || !reader.at_end() || width == 0 || height == 0){
+        return false;
+    }
+
+    //  The header only vouches for the source files. Don't trust a damaged
+    //  cache to hold boxes that stay inside the image.
+    for (const auto& item : locations){
+        const ImagePixelBox& sprite = item.second.sprite;
+        const ImagePixelBox& icon = item.second.icon;
+        if (sprite.min_x > sprite.max_x || sprite.max_x > width ||
+            sprite.min_y > sprite.max_y || sprite.max_y > height ||
+            icon.min_x > icon.max_x || icon.max_x > sprite.width() ||
+            icon.min_y > icon.max_y || icon.max_y > sprite.height()
+        ){
+            return false;
+        }
+    }
+
+    ImageViewRGB32 view((uint32_t*)pixels, bytes_per_row, width, height);
+    m_backing_image = ImageRGB32(std::make_unique<SpriteCacheImage>(std::move(file), view));
+    build(locations);
+    return true;
+}
+
+void SpriteDatabase::save_cache(const std::string& cache_name, uint64_t source_hash, const LocationMap& locations) const{
+    ResourceCacheWriter writer;
+    auto write_box = [&](const ImagePixelBox& box){
+        writer.write<uint64_t>(box.min_x);
+        writer.write<uint64_t>(box.min_y);
+        writer.write<uint64_t>(box.max_x);
+        writer.write<uint64_t>(box.max_y);
+    };
+
+    size_t width = m_backing_image.width();
+    size_t height = m_backing_image.height();
+    writer.write<uint32_t>((uint32_t)width);
+    writer.write<uint32_t>((uint32_t)height);
+    writer.write<uint64_t>(locations.size());
+    for (const auto& item : locations){
+        writer.write_string(item.first);
+        write_box(item.second.sprite);
+        write_box(item.second.icon);
+    }
+
+    writer.align(64);
+    for (size_t r = 0; r < height; r++){
+        writer.write_bytes(
+            (const char*)m_backing_image.data() + r * m_backing_image.bytes_per_row(),
+            width * sizeof(uint32_t)
+        );
+    }
+
+    ResourceCacheFile::write(cache_name, SPRITE_DATABASE_CACHE_VERSION, source_hash, writer);
+}
+
+void SpriteDatabase::build(const LocationMap& locations){
+    for (const auto& item : locations){
+        ImageViewRGB32 sprite = extract_box_reference(m_backing_image, item.second.sprite);
+        m_database.emplace(
+            item.first,
+            Sprite{sprite, extract_box_reference(sprite, item.second.icon)}
         );
     }
 }
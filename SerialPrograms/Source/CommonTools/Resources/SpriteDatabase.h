@@ -9,6 +9,7 @@
 
 #include <map>
 #include "CommonFramework/ImageTypes/ImageRGB32.h"
+#include "CommonFramework/ImageTools/ImageBoxes.h"
 
 namespace PokemonAutomation{
 
@@ -32,6 +33,10 @@ public:
     //          (next pokemon) ...
     //      }
     //  }
+    //
+    //  The decoded image and the sprite locations are kept in a resource
+    //  cache. (see ResourceCache.h) So after the first launch, the image is
+    //  memory-mapped from the cache instead of decoded.
     SpriteDatabase(const char* sprite_path, const char* json_path);
 
 public:
@@ -53,6 +58,18 @@ public:
     const_iterator end    () const{ return m_database.end(); }
           iterator end    (){ return m_database.end(); }
 
+private:
+    struct Location{
+        ImagePixelBox sprite;   //  Relative to the backing image.
+        ImagePixelBox icon;     //  Relative to the sprite.
+    };
+    using LocationMap = std::map<std::string, Location>;
+
+    static LocationMap load_locations(const std::string& json_path, const ImageViewRGB32& image);
+    bool load_cache(const std::string& cache_name, uint64_t source_hash);
+    void save_cache(const std::string& cache_name, uint64_t source_hash, const LocationMap& locations) const;
+    void build(const LocationMap& locations);
+
 private:
     std::map<std::string, Sprite> m_database;
     ImageRGB32 m_backing_image;
@@ -21,6 +21,11 @@ public:
     virtual ~StaticScreenDetector() = default;
     virtual void make_overlays(VideoOverlaySet& items) const = 0;
 
+    //  See VisualInferenceCallback::regions_of_interest().
+    virtual bool regions_of_interest(std::vector<ImageFloatBox>& regions) const{
+        return false;
+    }
+
     //  This is not const so that detectors can save/cache state.
     virtual bool detect(const ImageViewRGB32& screen) = 0;
     //  Called this to lock in the detected state in the detector, if
@@ -90,6 +95,9 @@ public:
     virtual void make_overlays(VideoOverlaySet& items) const override{
         Detector::make_overlays(items);
     }
+    virtual bool regions_of_interest(std::vector<ImageFloatBox>& regions) const override{
+        return Detector::regions_of_interest(regions);
+    }
 
     // Pull the two overloaded functions of process_frame() from base class VisualInferenceCallback
     // So that the user of `DetectorToFinder()` can use process_frame(const VideoSnapshot& frame) along
@@ -32,6 +32,10 @@ BlackScreenDetector::BlackScreenDetector(
 void BlackScreenDetector::make_overlays(VideoOverlaySet& items) const{
     items.add(m_color, m_box);
 }
+bool BlackScreenDetector::regions_of_interest(std::vector<ImageFloatBox>& regions) const{
+    regions.emplace_back(m_box);
+    return true;
+}
 bool BlackScreenDetector::detect(const ImageViewRGB32& screen){
     return is_black(extract_box_reference(screen, m_box), m_max_rgb_sum, m_max_stddev_sum);
 }
@@ -51,6 +55,10 @@ WhiteScreenDetector::WhiteScreenDetector(
 void WhiteScreenDetector::make_overlays(VideoOverlaySet& items) const{
     items.add(m_color, m_box);
 }
+bool WhiteScreenDetector::regions_of_interest(std::vector<ImageFloatBox>& regions) const{
+    regions.emplace_back(m_box);
+    return true;
+}
 bool WhiteScreenDetector::detect(const ImageViewRGB32& screen){
     return is_white(extract_box_reference(screen, m_box), m_min_rgb_sum, m_max_stddev_sum);
 }
@@ -74,6 +82,9 @@ BlackScreenOverWatcher::BlackScreenOverWatcher(
 void BlackScreenOverWatcher::make_overlays(VideoOverlaySet& items) const{
     m_on.make_overlays(items);
 }
+bool BlackScreenOverWatcher::regions_of_interest(std::vector<ImageFloatBox>& regions) const{
+    return m_on.regions_of_interest(regions);
+}
 bool BlackScreenOverWatcher::process_frame(const ImageViewRGB32& frame, WallClock timestamp){
     if (m_black_is_over.load(std::memory_order_acquire)){
         return true;
@@ -109,6 +120,9 @@ WhiteScreenOverWatcher::WhiteScreenOverWatcher(
 void WhiteScreenOverWatcher::make_overlays(VideoOverlaySet& items) const{
     m_detector.make_overlays(items);
 }
+bool WhiteScreenOverWatcher::regions_of_interest(std::vector<ImageFloatBox>& regions) const{
+    return m_detector.regions_of_interest(regions);
+}
 
 bool WhiteScreenOverWatcher::process_frame(const ImageViewRGB32& frame, WallClock timestamp){
     return white_is_over(frame);
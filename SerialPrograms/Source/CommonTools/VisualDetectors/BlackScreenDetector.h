@@ -30,6 +30,7 @@ public:
     );
 
     virtual void make_overlays(VideoOverlaySet& items) const override;
+    virtual bool regions_of_interest(std::vector<ImageFloatBox>& regions) const override;
     virtual bool detect(const ImageViewRGB32& screen) override;
 
 private:
@@ -48,6 +49,7 @@ public:
     );
 
     virtual void make_overlays(VideoOverlaySet& items) const override;
+    virtual bool regions_of_interest(std::vector<ImageFloatBox>& regions) const override;
     virtual bool detect(const ImageViewRGB32& screen) override;
 
 private:
@@ -87,6 +89,7 @@ public:
     bool black_is_over(const ImageViewRGB32& frame);
 
     virtual void make_overlays(VideoOverlaySet& items) const override;
+    virtual bool regions_of_interest(std::vector<ImageFloatBox>& regions) const override;
 
     virtual bool process_frame(const ImageViewRGB32& frame, WallClock timestamp) override;
 
@@ -112,6 +115,7 @@ public:
     bool white_is_over(const ImageViewRGB32& frame);
 
     virtual void make_overlays(VideoOverlaySet& items) const override;
+    virtual bool regions_of_interest(std::vector<ImageFloatBox>& regions) const override;
 
     virtual bool process_frame(const ImageViewRGB32& frame, WallClock timestamp) override;
 
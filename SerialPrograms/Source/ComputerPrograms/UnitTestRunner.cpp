@@ -10,6 +10,8 @@
 #include "CommonFramework/GlobalAutoPaths.h"
 #include "CommonFramework/ProgramStats/StatsTracking.h"
 #include "CommonFramework/Tools/GlobalThreadPools.h"
+#include "CommonFramework/AudioPipeline/Spectrum/FFTStreamer.h"
+#include "CommonTools/Audio/SpectrogramMatchingEngine.h"
 #include "CommonTools/VisualDetectors/BlackBorderDetector.h"
 #include "NintendoSwitch/Inference/NintendoSwitch_CheckOnlineDetector.h"
 #include "NintendoSwitch/Inference/NintendoSwitch_FailedToConnectDetector.h"
@@ -24,6 +26,14 @@
 #include "PokemonLA/PokemonLA_Tests.h"
 #include "PokemonSV/PokemonSV_Tests.h"
 #include "PokemonLZA/PokemonLZA_Tests.h"
+#include "Tests/ImageMatch_Tests.h"
+#include "Tests/Json_Tests.h"
+#include "Tests/PABotBase2_CommandQueue_Tests.h"
+#include "Tests/Pokemon_Rng_Tests.h"
+#include "Tests/SerialConnection_Tests.h"
+#include "Tests/StatsDatabase_Tests.h"
+#include "Tests/ThreadPool_Tests.h"
+#include "Tests/VideoSnapshot_Tests.h"
 
 namespace PokemonAutomation{
 namespace ComputerPrograms{
@@ -37,6 +47,16 @@ UnitTestDatabase make_UNIT_TESTS_ALL(){
     UnitTestDatabase ret;
 
     add_tests_BlackBorderDetector(ret);
+    add_tests_FFTStreamer(ret);
+    add_tests_SpectrogramMatchingEngine(ret);
+    add_tests_ImageMatch(ret);
+    add_tests_Json(ret);
+    add_tests_PABotBase2CommandQueue(ret);
+    add_tests_PokemonRng(ret);
+    add_tests_SerialConnection(ret);
+    add_tests_StatsDatabase(ret);
+    add_tests_ThreadPool(ret);
+    add_tests_VideoSnapshot(ret);
     OCR::add_tests(ret);
     Kernels::add_tests(ret);
     NintendoSwitch::add_tests_CheckOnlineDetector(ret);
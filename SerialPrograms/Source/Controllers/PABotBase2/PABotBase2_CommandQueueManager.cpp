@@ -5,6 +5,9 @@
  */
 
 #include <string.h>
+#include <algorithm>
+#include "Common/Cpp/Color.h"
+#include "Common/Cpp/Exceptions.h"
 #include "Common/PABotBase2/PABotBase2CC_MessageDumper.h"
 #include "Common/Cpp/Options/BooleanCheckBoxOption.h"
 #include "CommonFramework/Logging/Logger.h"
@@ -18,13 +21,97 @@ namespace PokemonAutomation{
 namespace PABotBase2{
 
 
+//  Window tuning. See the header for what these do.
+const uint8_t MIN_WINDOW = 4;
+const WallDuration BACKLOG_LOW = std::chrono::milliseconds(5);
+const WallDuration BACKLOG_HIGH = std::chrono::milliseconds(50);
+const WallDuration BASE_RTT_LIFETIME = std::chrono::seconds(10);
+
+//  Flush a batch once it gets this large even if it hasn't ended. This is
+//  about one full packet.
+const size_t MAX_BATCH_BYTES = 240;
+
+
+
+void CommandWindow::reset(uint8_t capacity){
+    m_capacity = capacity;
+    m_window = std::min(MIN_WINDOW, capacity);
+    m_slow_start = true;
+    m_window_limited = false;
+    m_round_remaining = 0;
+    m_round_min = WallDuration::max();
+    m_base_rtt = WallDuration::max();
+    m_base_rtt_time = WallClock::min();
+}
+void CommandWindow::report_delay(WallDuration delay, WallClock now){
+    if (delay < m_base_rtt || now - m_base_rtt_time > BASE_RTT_LIFETIME){
+        m_base_rtt = delay;
+        m_base_rtt_time = now;
+    }
+    m_round_min = std::min(m_round_min, delay);
+
+    if (m_round_remaining > 1){
+        m_round_remaining--;
+        return;
+    }
+
+    //  End of a round. How much was still buffered on the device at its
+    //  lowest point.
+    WallDuration buffered = WallDuration::zero();
+    if (m_round_min > m_base_rtt){
+        buffered = m_round_min - m_base_rtt;
+    }
+
+    size_t window = m_window;
+    if (buffered < BACKLOG_LOW){
+        if (m_window_limited){
+            window = m_slow_start ? window * 2 : window + 1;
+        }
+    }else{
+        m_slow_start = false;
+        if (buffered > BACKLOG_HIGH){
+            window--;
+        }
+    }
+    window = std::max<size_t>(window, std::min(MIN_WINDOW, m_capacity));
+    window = std::min<size_t>(window, m_capacity);
+    m_window = (uint8_t)window;
+
+    m_round_remaining = m_window;
+    m_round_min = WallDuration::max();
+    m_window_limited = false;
+}
+void CommandWindow::report_dropped(){
+    //  The device's queue is fuller than we thought. Back off.
+    m_window = std::max<uint8_t>(
+        m_window / 2,
+        std::min(MIN_WINDOW, m_capacity)
+    );
+    m_slow_start = false;
+    m_round_remaining = 0;
+    m_round_min = WallDuration::max();
+    m_window_limited = false;
+}
+
+
+
 void CommandQueueManager::set_command_queue_size(uint8_t command_queue_size){
     {
         std::unique_lock<Mutex> lg(m_lock);
-        m_command_queue_size = command_queue_size;
+        m_window.reset(command_queue_size);
     }
     m_cv.notify_all();
 }
+uint8_t CommandQueueManager::command_window() const{
+    std::unique_lock<Mutex> lg(m_lock);
+    return m_window.window();
+}
+void CommandQueueManager::set_command_finished_callback(
+    std::function<void(uint8_t id, WallDuration round_trip)> callback
+){
+    std::unique_lock<Mutex> lg(m_lock);
+    m_command_finished_callback = std::move(callback);
+}
 bool CommandQueueManager::cancel(std::exception_ptr exception) noexcept{
     bool ret = Cancellable::cancel(std::move(exception));
     {
@@ -41,15 +128,35 @@ bool CommandQueueManager::cancel(std::exception_ptr exception) noexcept{
 
 void CommandQueueManager::wait_for_all(Cancellable* cancellable){
     std::unique_lock<Mutex> lg(m_lock);
-    while (!m_pending_commands.empty()){
+    flush_batch(cancellable, lg);
+    while (true){
         throw_if_cancelled(cancellable);
+        if (!m_dropped_commands.empty()){
+            std::string ids;
+            for (uint8_t id : m_dropped_commands){
+                if (!ids.empty()){
+                    ids += ", ";
+                }
+                ids += std::to_string(id);
+            }
+            m_dropped_commands.clear();
+            throw SerialProtocolException(
+                m_logger, PA_CURRENT_FUNCTION,
+                "Device dropped command(s) " + ids + " because its command queue was full."
+            );
+        }
+        if (m_pending_commands.empty()){
+            return;
+        }
         cv_wait(cancellable, lg);
     }
 }
 void CommandQueueManager::wait_for_command_finish(Cancellable* cancellable, uint8_t id){
     std::unique_lock<Mutex> lg(m_lock);
+    flush_batch(cancellable, lg);
     while (true){
         throw_if_cancelled(cancellable);
+        throw_if_dropped(id);
 
         //  Command doesn't exist.
         auto iter = m_pending_commands.find(id);
@@ -87,49 +194,93 @@ void CommandQueueManager::send_replace_on_next() noexcept{
 }
 
 
+void CommandQueueManager::begin_batch(){
+    std::unique_lock<Mutex> lg(m_lock);
+    m_batch_depth++;
+}
+void CommandQueueManager::end_batch(Cancellable* cancellable){
+    std::unique_lock<Mutex> lg(m_lock);
+    if (m_batch_depth > 0){
+        m_batch_depth--;
+    }
+    if (m_batch_depth == 0){
+        m_batch_refill = false;
+        flush_batch(cancellable, lg);
+    }
+}
+void CommandQueueManager::abort_batch() noexcept{
+    {
+        std::unique_lock<Mutex> lg(m_lock);
+        if (m_batch_depth > 0){
+            m_batch_depth--;
+        }
+        if (m_batch_depth == 0){
+            m_batch_refill = false;
+        }
+        drop_batch(std::this_thread::get_id());
+    }
+    m_cv.notify_all();
+}
+
+
 uint8_t CommandQueueManager::send_command(Cancellable* cancellable, MessageHeader& command){
     {
-        bool need_to_wait = false;
         std::unique_lock<Mutex> lg(m_lock);
         try_push_pending_specials();
         while (true){
-            if (need_to_wait){
-                cv_wait(cancellable, lg);
-            }
-            need_to_wait = true;
             throw_if_cancelled(cancellable);
 
-            if (m_pending_commands.size() >= m_command_queue_size){
-                continue;
+            //  Once a batch has filled the window, let a quarter of it free up
+            //  before continuing. Otherwise the rest of the batch goes out one
+            //  command at a time as each slot frees up.
+            size_t window = m_window.window();
+            size_t limit = window;
+            if (m_batch_refill){
+                limit -= std::min<size_t>(window / 4, limit - 1);
             }
 
-//            cout << "Send: " << (unsigned)m_command_seqnum << ", queue size = " << m_pending_commands.size() << endl;
-            command.id = m_command_seqnum;
+            bool window_full = m_pending_commands.size() >= window;
+            if (m_pending_commands.size() < limit &&
+                m_pending_commands.find(m_command_seqnum) == m_pending_commands.end()
+            ){
+                m_batch_refill = false;
+                break;
+            }
+            if (window_full){
+                m_window.report_window_full();
+            }
 
-            //  Wait until the slot is available.
-            bool success = m_pending_commands.emplace(
-                command.id,
-                std::make_shared<CommandHandle>()
-            ).second;
-            if (!success){
+            //  Nothing we're holding back can finish until it's sent.
+            if (!m_batch_buffer.empty()){
+                m_batch_refill = m_batch_depth > 0 && window_full;
+                flush_batch(cancellable, lg);
                 continue;
             }
 
-            m_lock.unlock();
-            try{
-                m_connection.reliable_send_all_or_nothing(
-                    cancellable,
-                    &command, command.message_bytes
-                );
-            }catch (...){
-                m_lock.lock();
-                m_pending_commands.erase(command.id);
-                throw;
-            }
-            m_lock.lock();
+            cv_wait(cancellable, lg);
+        }
+
+//        cout << "Send: " << (unsigned)m_command_seqnum << ", queue size = " << m_pending_commands.size() << endl;
+        command.id = m_command_seqnum++;
+        m_dropped_commands.erase(command.id);
 
-            m_command_seqnum++;
-            break;
+        std::shared_ptr<CommandHandle>& handle = m_pending_commands[command.id];
+        handle = std::make_shared<CommandHandle>();
+
+        //  All commands start with their duration.
+        if (command.message_bytes >= sizeof(MessageHeader) + sizeof(uint16_t)){
+            uint16_t milliseconds;
+            memcpy(&milliseconds, &command + 1, sizeof(uint16_t));
+            handle->duration = std::chrono::milliseconds(milliseconds);
+        }
+
+        m_batch_buffer.append((const char*)&command, command.message_bytes);
+        m_batch.emplace_back(BatchedCommand{
+            command.id, command.message_bytes, std::this_thread::get_id()
+        });
+
+        if (m_batch_depth == 0 || m_batch_buffer.size() >= MAX_BATCH_BYTES){
+            flush_batch(cancellable, lg);
         }
     }
 //    cout << "Post send 0: " << (unsigned)command.id << endl;
@@ -153,11 +304,48 @@ void CommandQueueManager::report_command_finished(const MessageHeader& finished_
             &((const Message_u32&)finished_message).data,
             sizeof(uint32_t)
         );
+
+        WallDuration round_trip = current_time() - iter->second->sent_time;
+        if (m_command_finished_callback){
+            m_command_finished_callback(finished_message.id, round_trip);
+        }
+
+        //  If it finished early, it was cut off by a replace. Then the round
+        //  trip doesn't tell us anything.
+        WallDuration duration = iter->second->duration;
+        if (round_trip >= duration){
+            m_window.report_delay(round_trip - duration, current_time());
+        }
+
         m_pending_commands.erase(iter);
         try_push_pending_specials();
     }
     m_cv.notify_all();
 }
+void CommandQueueManager::report_command_dropped(const MessageHeader& dropped_message){
+    {
+        std::lock_guard<Mutex> lg(m_lock);
+        auto iter = m_pending_commands.find(dropped_message.id);
+        if (iter == m_pending_commands.end()){
+            m_logger.log("[MLC]: Received command drop for unknown ID: " + std::to_string(dropped_message.id));
+            return;
+        }
+        m_pending_commands.erase(iter);
+
+        //  Free the slot, but remember it so whoever waits on it finds out
+        //  it never ran.
+        m_dropped_commands.insert(dropped_message.id);
+
+        m_window.report_dropped();
+
+        m_logger.log(
+            "[MLC]: Device dropped command: " + std::to_string(dropped_message.id) +
+            ", reducing window to: " + std::to_string(m_window.window()),
+            COLOR_RED
+        );
+    }
+    m_cv.notify_all();
+}
 
 
 bool CommandQueueManager::try_push_pending_specials() noexcept{
@@ -190,11 +378,104 @@ bool CommandQueueManager::try_push_pending_specials() noexcept{
 
     m_pending_special = PABB2_MESSAGE_OPCODE_INVALID;
     m_pending_commands.clear();
+    m_dropped_commands.clear();
+    m_batch_buffer.clear();
+    m_batch.clear();
 
     m_message_loggers.log_send(m_logger, LOG_EVERYTHING(), &message);
     return true;
 }
 
+void CommandQueueManager::flush_batch(Cancellable* cancellable, std::unique_lock<Mutex>& lg){
+    try{
+        //  One at a time so that batches go out in order.
+        while (m_flushing){
+            throw_if_cancelled(cancellable);
+            cv_wait(cancellable, lg);
+        }
+    }catch (...){
+        drop_batch(std::this_thread::get_id());
+        throw;
+    }
+    if (m_batch_buffer.empty()){
+        return;
+    }
+
+    std::string buffer = std::move(m_batch_buffer);
+    std::vector<BatchedCommand> batch = std::move(m_batch);
+    m_batch_buffer.clear();
+    m_batch.clear();
+
+    //  Set these before unlocking since the finishes can arrive before we
+    //  get the lock back.
+    WallClock now = current_time();
+    for (const BatchedCommand& command : batch){
+        auto iter = m_pending_commands.find(command.id);
+        if (iter != m_pending_commands.end()){
+            iter->second->sent_time = now;
+        }
+    }
+
+    m_flushing = true;
+    lg.unlock();
+    try{
+        m_connection.reliable_send_all_or_nothing(
+            cancellable,
+            buffer.data(), buffer.size()
+        );
+    }catch (...){
+        //  Nothing was sent. Drop our own commands and put everyone else's
+        //  back in front of whatever was batched in the meantime.
+        lg.lock();
+        m_flushing = false;
+        std::thread::id self = std::this_thread::get_id();
+        std::string kept_buffer;
+        std::vector<BatchedCommand> kept;
+        size_t offset = 0;
+        for (const BatchedCommand& command : batch){
+            if (command.owner == self){
+                m_pending_commands.erase(command.id);
+            }else{
+                kept_buffer.append(buffer, offset, command.bytes);
+                kept.emplace_back(command);
+            }
+            offset += command.bytes;
+        }
+        m_batch_buffer.insert(0, kept_buffer);
+        m_batch.insert(m_batch.begin(), kept.begin(), kept.end());
+        m_cv.notify_all();
+        throw;
+    }
+    lg.lock();
+    m_flushing = false;
+    m_cv.notify_all();
+}
+void CommandQueueManager::drop_batch(std::thread::id owner) noexcept{
+    std::string kept_buffer;
+    std::vector<BatchedCommand> kept;
+    size_t offset = 0;
+    for (const BatchedCommand& command : m_batch){
+        if (command.owner == owner){
+            m_pending_commands.erase(command.id);
+        }else{
+            kept_buffer.append(m_batch_buffer, offset, command.bytes);
+            kept.emplace_back(command);
+        }
+        offset += command.bytes;
+    }
+    m_batch_buffer = std::move(kept_buffer);
+    m_batch = std::move(kept);
+}
+void CommandQueueManager::throw_if_dropped(uint8_t id){
+    if (m_dropped_commands.erase(id) == 0){
+        return;
+    }
+    throw SerialProtocolException(
+        m_logger, PA_CURRENT_FUNCTION,
+        "Device dropped command " + std::to_string(id) + " because its command queue was full."
+    );
+}
+
 
 void CommandQueueManager::on_cancellable_cancel(
     Cancellable& cancellable,
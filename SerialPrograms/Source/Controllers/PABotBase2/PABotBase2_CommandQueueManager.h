@@ -8,6 +8,11 @@
 #define PokemonAutomation_Controllers_PABotBase2_CommandQueue_H
 
 #include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <functional>
+#include <thread>
 #include "Common/Cpp/Logging/AbstractLogger.h"
 #include "Common/Cpp/Concurrency/Mutex.h"
 #include "Common/Cpp/Concurrency/ConditionVariable.h"
@@ -22,6 +27,89 @@ namespace PABotBase2{
 
 
 
+//
+//  The number of commands in flight is adaptive.
+//
+//  "set_command_queue_size()" sets the ceiling. The actual window starts at
+//  4 and is adjusted once per round (a window's worth of finished commands)
+//  from the round trip of each command:
+//
+//    - The round trip minus the command's own duration is how long it spent
+//      on the wire and waiting behind other commands on the device. The
+//      smallest of these is the base round trip (empty device queue).
+//
+//    - The smallest of these in a round, minus the base round trip, is how
+//      much was queued on the device ahead of the command that waited the
+//      least. That's the device's buffered duration at its lowest point in
+//      the round. It's measured in time rather than commands since a few
+//      long commands can hold as much as many short ones.
+//
+//    - If less than "BACKLOG_LOW" was buffered and the sender ran out of
+//      window, the device is close to running dry. Grow the window.
+//      (doubling until the first time it doesn't need to grow, then by one)
+//
+//    - If more than "BACKLOG_HIGH" was buffered, shrink it by one. There's
+//      no point queuing more on the device since it only makes cancels and
+//      replaces take longer. Since this only looks at what was still
+//      buffered at the lowest point, it never shrinks below what covers the
+//      round trip.
+//
+//    - If the device drops a command because its queue is full, halve it.
+//
+//  Renegotiating the ceiling (which happens on every connect) starts over
+//  from slow start at 4 with no round trip history.
+//
+//  Commands can also be batched. Commands sent between "begin_batch()" and
+//  "end_batch()" are held back and pushed into the stream with a single send
+//  so that they share packets (and their acks) instead of each taking its
+//  own. The batch is also flushed if the window fills up, if it gets large,
+//  or if anyone waits on the queue. After the window fills up, the rest of the
+//  batch waits for a quarter of the window to free up before it continues.
+//
+//  A command that the device drops is a failure, not a finish. Waiting on it
+//  (directly or with "wait_for_all()") throws.
+//
+class CommandWindow{
+public:
+    CommandWindow(){
+        reset(4);
+    }
+
+    //  Start over with a new ceiling: slow start at the minimum window and
+    //  no round trip history.
+    void reset(uint8_t capacity);
+
+    uint8_t window() const{
+        return m_window;
+    }
+    bool slow_start() const{
+        return m_slow_start;
+    }
+
+    //  A command was ready to send but the window was full.
+    void report_window_full(){
+        m_window_limited = true;
+    }
+
+    //  "delay" is a command's round trip minus its own duration.
+    void report_delay(WallDuration delay, WallClock now);
+
+    //  The device dropped a command because its queue was full.
+    void report_dropped();
+
+private:
+    uint8_t m_capacity;
+    uint8_t m_window;
+    bool m_slow_start;
+    bool m_window_limited;
+    size_t m_round_remaining;
+    WallDuration m_round_min;
+    WallDuration m_base_rtt;
+    WallClock m_base_rtt_time;
+};
+
+
+
 class CommandQueueManager final : public Cancellable, public Cancellable::CancelListener{
 public:
     CommandQueueManager(
@@ -42,6 +130,16 @@ public:
 
     void set_command_queue_size(uint8_t command_queue_size);
 
+    //  The number of commands currently allowed in flight.
+    uint8_t command_window() const;
+
+    //  Called with the time from sending each command to receiving its
+    //  finish message. This runs under the queue lock before any waiters
+    //  are woken up so it must not call back into this class.
+    void set_command_finished_callback(
+        std::function<void(uint8_t id, WallDuration round_trip)> callback
+    );
+
     virtual bool cancel(std::exception_ptr exception) noexcept override;
 
 
@@ -52,13 +150,24 @@ public:
     void send_cancel() noexcept;
     void send_replace_on_next() noexcept;
 
+    void begin_batch();
+    void end_batch(Cancellable* cancellable);
+    void abort_batch() noexcept;
+
     uint8_t send_command(Cancellable* cancellable, MessageHeader& command);
     void report_command_finished(const MessageHeader& finished_message);
+    void report_command_dropped(const MessageHeader& dropped_message);
 
 
 private:
     bool try_push_pending_specials() noexcept;
 
+    //  All of these must be called under the lock.
+    void flush_batch(Cancellable* cancellable, std::unique_lock<Mutex>& lg);
+    //  Drop the batched commands that "owner" sent.
+    void drop_batch(std::thread::id owner) noexcept;
+    void throw_if_dropped(uint8_t id);
+
     virtual void on_cancellable_cancel(
         Cancellable& cancellable,
         std::exception_ptr reason
@@ -74,17 +183,39 @@ private:
 
     mutable Mutex m_lock;
     ConditionVariable m_cv;
-    uint8_t m_command_queue_size = 4;
     uint8_t m_command_seqnum = 0;
 
+    //  Adaptive window. (see top of file)
+    CommandWindow m_window;
+
+    //  Commands that have a slot but haven't been pushed into the stream yet.
+    size_t m_batch_depth = 0;
+    bool m_flushing = false;
+    bool m_batch_refill = false;
+    struct BatchedCommand{
+        uint8_t id;
+        uint16_t bytes;
+        std::thread::id owner;
+    };
+    std::string m_batch_buffer;
+    std::vector<BatchedCommand> m_batch;
+
     uint8_t m_pending_special = PABB2_MESSAGE_OPCODE_INVALID;
 
     SpinLock m_pending_commands_lock;
     struct CommandHandle{
         bool finished = false;
         uint32_t device_timestamp = 0;
+        WallDuration duration = WallDuration::zero();
+        WallClock sent_time = WallClock::min();
     };
     std::map<uint8_t, std::shared_ptr<CommandHandle>> m_pending_commands;
+
+    //  Commands the device dropped that nobody has waited on yet.
+    std::set<uint8_t> m_dropped_commands;
+
+
+    std::function<void(uint8_t id, WallDuration round_trip)> m_command_finished_callback;
 };
 
 
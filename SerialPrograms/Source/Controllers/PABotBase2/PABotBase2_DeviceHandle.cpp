@@ -526,6 +526,10 @@ void DeviceHandle::on_recv(const void* data, size_t bytes){
             m_command_queue.report_command_finished(*header);
             continue;
         }
+        case PABB2_MESSAGE_OPCODE_CQ_COMMAND_DROPPED:{
+            m_command_queue.report_command_dropped(*header);
+            continue;
+        }
         }
 
         auto iter = m_message_handlers.find(header->opcode);
@@ -10,6 +10,7 @@
 #include <string.h>
 #include <deque>
 #include <map>
+#include <optional>
 #include "Common/Cpp/Exceptions.h"
 #include "Common/Cpp/PrettyPrint.h"
 #include "Common/Cpp/Logging/AbstractLogger.h"
@@ -0,0 +1,269 @@
+/*  PABotBase2 Loopback Benchmark
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "Common/Cpp/Exceptions.h"
+#include "Common/Cpp/PrettyPrint.h"
+#include "Common/Cpp/CancellableScope.h"
+#include "Common/Cpp/Json/JsonObject.h"
+#include "Common/PABotBase2/Controllers/PABotBase2_Controller_NS_WiredController.h"
+#include "CommonFramework/Logging/Logger.h"
+#include "CommonFramework/Tools/GlobalThreadPools.h"
+#include "PABotBase2_LoopbackBenchmark.h"
+
+#ifndef _WIN32
+#include "Common/Cpp/SerialConnection/SerialConnection.h"
+#include "Common/Cpp/StreamConnections/PtyDevice.h"
+#include "Common/PABotBase2/ReliableConnectionLayer/PABotBase2CC_ReliableStreamConnection.h"
+#include "PABotBase2_DeviceHandle.h"
+#endif
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+namespace PokemonAutomation{
+namespace PABotBase2{
+
+
+#ifdef _WIN32
+
+int run_loopback_benchmark(const LoopbackBenchmarkOptions& options){
+    cout << "The PABotBase2 loopback benchmark needs pseudo-terminals and is not supported on Windows." << endl;
+    return 1;
+}
+
+#else
+
+using namespace std::chrono_literals;
+
+
+namespace{
+
+struct LoopbackResults{
+    size_t commands = 0;
+    double seconds = 0;
+    double commands_per_second = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+    uint8_t final_window = 0;
+    uint32_t host_retransmits = 0;
+    PtyDeviceStats device;
+};
+
+void summarize_round_trips(LoopbackResults& results, std::vector<uint64_t> nanoseconds){
+    if (nanoseconds.empty()){
+        return;
+    }
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+
+    //  Nearest-rank percentile in microseconds.
+    auto percentile = [&](double p){
+        size_t rank = (size_t)std::ceil(p * nanoseconds.size());
+        rank = std::max<size_t>(rank, 1);
+        return nanoseconds[std::min(rank, nanoseconds.size()) - 1] / 1000.;
+    };
+
+    double total = 0;
+    for (uint64_t ns : nanoseconds){
+        total += (double)ns;
+    }
+    results.mean = total / nanoseconds.size() / 1000.;
+    results.p50 = percentile(0.50);
+    results.p90 = percentile(0.90);
+    results.p99 = percentile(0.99);
+    results.max = nanoseconds.back() / 1000.;
+}
+
+JsonObject to_json(const LoopbackBenchmarkOptions& options, const LoopbackResults& results){
+    JsonObject obj;
+    obj["Commands"] = (int64_t)results.commands;
+    obj["BaudRate"] = (int64_t)options.baud_rate;
+    obj["DropRate"] = options.drop_rate;
+    obj["ReorderRate"] = options.reorder_rate;
+    obj["QueueDepth"] = (int64_t)options.queue_depth;
+    obj["BatchSize"] = (int64_t)options.batch_size;
+    obj["Seconds"] = results.seconds;
+    obj["CommandsPerSecond"] = results.commands_per_second;
+    obj["MeanMicroseconds"] = results.mean;
+    obj["P50Microseconds"] = results.p50;
+    obj["P90Microseconds"] = results.p90;
+    obj["P99Microseconds"] = results.p99;
+    obj["MaxMicroseconds"] = results.max;
+    obj["FinalWindow"] = (int64_t)results.final_window;
+    obj["HostRetransmits"] = (int64_t)results.host_retransmits;
+    obj["DeviceRetransmits"] = (int64_t)results.device.device_retransmits;
+    obj["HostToDevicePackets"] = (int64_t)results.device.host_to_device_packets;
+    obj["HostToDeviceDropped"] = (int64_t)results.device.host_to_device_dropped;
+    obj["HostToDeviceReordered"] = (int64_t)results.device.host_to_device_reordered;
+    obj["DeviceToHostPackets"] = (int64_t)results.device.device_to_host_packets;
+    obj["DeviceToHostDropped"] = (int64_t)results.device.device_to_host_dropped;
+    obj["DeviceToHostReordered"] = (int64_t)results.device.device_to_host_reordered;
+    obj["DeviceCommandsDropped"] = (int64_t)results.device.commands_dropped;
+    return obj;
+}
+
+std::string command_to_str(const pabb2_Message_Command_NS_WiredController_State* message){
+    return "id = " + std::to_string(message->id) + ", ms = " + std::to_string(message->milliseconds);
+}
+
+}
+
+
+
+int run_loopback_benchmark(const LoopbackBenchmarkOptions& options){
+    Logger& logger = global_logger_tagged();
+
+    PtyDeviceOptions device_options;
+    device_options.baud_rate = options.baud_rate;
+    device_options.drop_rate = options.drop_rate;
+    device_options.reorder_rate = options.reorder_rate;
+    device_options.command_queue_capacity = std::max<uint32_t>(
+        device_options.command_queue_capacity,
+        options.queue_depth
+    );
+
+    LoopbackResults results;
+    try{
+        CancellableHolder<CancellableScope> scope;
+
+        PtyDevice device(GlobalThreadPools::unlimited_realtime(), device_options);
+        cout << "Loopback device: " << device.port_name() << endl;
+
+        SerialConnection serial(
+            GlobalThreadPools::unlimited_realtime(),
+            device.port_name(),
+            options.baud_rate == 0 ? 921600 : options.baud_rate
+        );
+
+        //  Same sequence as SerialPABotBase2_Connection.
+        ReliableStreamConnection stream(
+            &scope,
+            logger, false,
+            GlobalThreadPools::unlimited_realtime(),
+            serial,
+            std::chrono::milliseconds(80),
+            nullptr
+        );
+        if (!stream.reset(1000ms)){
+            cout << "Loopback device did not respond to reset." << endl;
+            return 1;
+        }
+        stream.send_request(PABB2_CONNECTION_OPCODE_ASK_VERSION);
+        stream.wait_for_pending();
+        if (!stream.remote_protocol_is_compatible()){
+            cout << "Loopback device has an incompatible protocol: " << stream.remote_protocol() << endl;
+            return 1;
+        }
+        stream.send_request(PABB2_CONNECTION_OPCODE_ASK_PACKET_SIZE);
+        stream.wait_for_pending();
+        stream.send_request(PABB2_CONNECTION_OPCODE_ASK_BUFFER_SLOTS);
+        stream.wait_for_pending();
+
+        DeviceHandle handle(&scope, logger, stream);
+        handle.message_logger().add_message<pabb2_Message_Command_NS_WiredController_State>(
+            "PABB2_MESSAGE_CMD_NS_WIRED_CONTROLLER_STATE",
+            PABB2_MESSAGE_CMD_NS_WIRED_CONTROLLER_STATE,
+            false,
+            command_to_str
+        );
+        handle.connect();
+
+        CommandQueueManager& queue = handle.command_queue();
+        if (options.queue_depth != 0){
+            queue.set_command_queue_size(options.queue_depth);
+        }
+
+        //  This runs under the queue lock so everything is in by the time
+        //  "wait_for_all()" returns.
+        std::vector<uint64_t> round_trips;
+        round_trips.reserve(options.commands);
+        queue.set_command_finished_callback([&](uint8_t, WallDuration round_trip){
+            round_trips.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(round_trip).count());
+        });
+
+        pabb2_Message_Command_NS_WiredController_State command;
+        command.message_bytes = sizeof(command);
+        command.opcode = PABB2_MESSAGE_CMD_NS_WIRED_CONTROLLER_STATE;
+        command.milliseconds = 0;
+        command.report.buttons0 = 0;
+        command.report.buttons1 = 0;
+        command.report.dpad_byte = 8;
+        command.report.left_joystick_x = 0x80;
+        command.report.left_joystick_y = 0x80;
+        command.report.right_joystick_x = 0x80;
+        command.report.right_joystick_y = 0x80;
+
+        cout << "Sending " << tostr_u_commas(options.commands) << " commands..." << endl;
+        WallClock start = current_time();
+        size_t batch_size = std::max<size_t>(options.batch_size, 1);
+        for (size_t c = 0; c < options.commands; c += batch_size){
+            size_t end = std::min(c + batch_size, options.commands);
+            queue.begin_batch();
+            for (size_t i = c; i < end; i++){
+                queue.send_command(&scope, command);
+            }
+            queue.end_batch(&scope);
+        }
+        queue.wait_for_all(&scope);
+        WallClock end = current_time();
+
+        queue.set_command_finished_callback(nullptr);
+
+        results.commands = options.commands;
+        results.seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.;
+        results.commands_per_second = results.seconds == 0 ? 0 : options.commands / results.seconds;
+        summarize_round_trips(results, std::move(round_trips));
+        results.final_window = queue.command_window();
+        results.host_retransmits = stream.retransmits();
+        results.device = device.stats();
+    }catch (const Exception& e){
+        cout << "Loopback benchmark failed: " << e.name() << ": " << e.message() << endl;
+        return 1;
+    }
+
+    cout << "PABotBase2 Loopback Benchmark:" << endl;
+    cout << "- Commands: " << tostr_u_commas(results.commands)
+         << " in " << tostr_fixed(results.seconds, 3) << " s"
+         << " (" << tostr_fixed(results.commands_per_second, 1) << " commands/s)" << endl;
+    cout << "- Round Trip: mean = " << tostr_fixed(results.mean, 1) << " us"
+         << ", p50 = " << tostr_fixed(results.p50, 1) << " us"
+         << ", p90 = " << tostr_fixed(results.p90, 1) << " us"
+         << ", p99 = " << tostr_fixed(results.p99, 1) << " us"
+         << ", max = " << tostr_fixed(results.max, 1) << " us" << endl;
+    cout << "- Command Window: " << (unsigned)results.final_window
+         << " (batch size = " << std::max<size_t>(options.batch_size, 1) << ")" << endl;
+    cout << "- Retransmits: host = " << results.host_retransmits
+         << ", device = " << results.device.device_retransmits << endl;
+    cout << "- Host -> Device: packets = " << results.device.host_to_device_packets
+         << ", dropped = " << results.device.host_to_device_dropped
+         << ", reordered = " << results.device.host_to_device_reordered << endl;
+    cout << "- Device -> Host: packets = " << results.device.device_to_host_packets
+         << ", dropped = " << results.device.device_to_host_dropped
+         << ", reordered = " << results.device.device_to_host_reordered << endl;
+    if (results.device.commands_dropped != 0){
+        cout << "- Commands dropped by the device: " << results.device.commands_dropped << endl;
+    }
+
+    if (!options.output_path.empty()){
+        to_json(options, results).dump(options.output_path);
+        cout << "Benchmark results saved to: " << options.output_path << endl;
+    }
+
+    return 0;
+}
+
+#endif
+
+
+
+}
+}
@@ -0,0 +1,59 @@
+/*  PABotBase2 Loopback Benchmark
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  Measure the command throughput of the PABotBase2 stack without hardware.
+ *
+ *  This connects the real SerialConnection -> ReliableStreamConnection ->
+ *  DeviceHandle stack to a PtyDevice (see PtyDevice.h) and pushes a number of
+ *  zero-duration controller commands through the command queue as fast as it
+ *  will take them. Then it reports:
+ *    - Commands per second and where the adaptive command window ended up.
+ *    - Round-trip times from sending a command to receiving its finish.
+ *    - Retransmits on both sides and the drops/reorders that were injected.
+ *
+ *  Run it with "--pabb2-loopback-benchmark <commands>". Other options:
+ *      --pabb2-loopback-baud <baud rate>       (default 921600, 0 = unlimited)
+ *      --pabb2-loopback-drop <probability>     (per packet, default 0)
+ *      --pabb2-loopback-reorder <probability>  (per packet, default 0)
+ *      --pabb2-loopback-queue <depth>          (default: what the device reports)
+ *      --pabb2-loopback-batch <commands>       (commands per batch, default 1)
+ *      --pabb2-loopback-output <path>          (write the results as JSON)
+ *
+ */
+
+#ifndef PokemonAutomation_Controllers_PABotBase2_LoopbackBenchmark_H
+#define PokemonAutomation_Controllers_PABotBase2_LoopbackBenchmark_H
+
+#include <stdint.h>
+#include <string>
+
+namespace PokemonAutomation{
+namespace PABotBase2{
+
+
+
+struct LoopbackBenchmarkOptions{
+    size_t commands = 0;
+    uint32_t baud_rate = 921600;
+    double drop_rate = 0;
+    double reorder_rate = 0;
+
+    //  Ceiling for the command window on the host. Zero uses the normal
+    //  negotiation.
+    uint8_t queue_depth = 0;
+
+    //  Send this many commands at a time with "begin_batch()"/"end_batch()".
+    size_t batch_size = 1;
+
+    std::string output_path;
+};
+
+//  Returns the exit code for the program.
+int run_loopback_benchmark(const LoopbackBenchmarkOptions& options);
+
+
+
+}
+}
+#endif
@@ -152,6 +152,25 @@ void PABotBase2_Keyboard::wait_for_all(Cancellable* cancellable){
     execute_schedule(cancellable, schedule);
     m_connection.device().command_queue().wait_for_all(cancellable);
 }
+void PABotBase2_Keyboard::execute_schedule(
+    Cancellable* cancellable,
+    const SuperscalarScheduler::Schedule& schedule
+){
+    //  Batch the whole schedule so the commands share packets.
+    if (schedule.size() < 2 || !is_ready()){
+        KeyboardControllerWithScheduler::execute_schedule(cancellable, schedule);
+        return;
+    }
+    PABotBase2::CommandQueueManager& command_queue = m_connection.device().command_queue();
+    command_queue.begin_batch();
+    try{
+        KeyboardControllerWithScheduler::execute_schedule(cancellable, schedule);
+    }catch (...){
+        command_queue.abort_batch();
+        throw;
+    }
+    command_queue.end_batch(cancellable);
+}
 
 
 void PABotBase2_Keyboard::execute_state(
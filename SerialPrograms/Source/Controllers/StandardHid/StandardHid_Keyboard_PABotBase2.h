@@ -116,6 +116,10 @@ private:
         Cancellable* cancellable,
         const SuperscalarScheduler::ScheduleEntry& entry
     ) override;
+    virtual void execute_schedule(
+        Cancellable* cancellable,
+        const SuperscalarScheduler::Schedule& schedule
+    ) override;
 
     void status_thread();
 
@@ -0,0 +1,64 @@
+/*  Image Convert Planar Float
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include "Common/Cpp/CpuId/CpuId.h"
+#include "Kernels_ImageConvert_PlanarFloat.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void convert_RGB32_to_planar_float_row_Default(
+    float* r, float* g, float* b, const uint32_t* in, size_t width, float scale
+);
+void convert_RGB32_to_planar_float_row_x64_SSE41(
+    float* r, float* g, float* b, const uint32_t* in, size_t width, float scale
+);
+void convert_RGB32_to_planar_float_row_x64_AVX2(
+    float* r, float* g, float* b, const uint32_t* in, size_t width, float scale
+);
+
+using ConvertRow_PlanarFloat = void (*)(
+    float* r, float* g, float* b, const uint32_t* in, size_t width, float scale
+);
+ConvertRow_PlanarFloat select_planar_float_row(){
+#ifdef PA_AutoDispatch_x64_13_Haswell
+    if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+        return convert_RGB32_to_planar_float_row_x64_AVX2;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+    if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+        return convert_RGB32_to_planar_float_row_x64_SSE41;
+    }
+#endif
+    return convert_RGB32_to_planar_float_row_Default;
+}
+
+
+
+void convert_RGB32_to_planar_float(
+    float* r, float* g, float* b, size_t out_stride,
+    const uint32_t* in, size_t in_bytes_per_row,
+    size_t width, size_t height,
+    float scale
+){
+    ConvertRow_PlanarFloat row = select_planar_float_row();
+
+    for (size_t c = 0; c < height; c++){
+        row(r, g, b, in, width, scale);
+        r += out_stride;
+        g += out_stride;
+        b += out_stride;
+        in = (const uint32_t*)((const char*)in + in_bytes_per_row);
+    }
+}
+
+
+
+}
+}
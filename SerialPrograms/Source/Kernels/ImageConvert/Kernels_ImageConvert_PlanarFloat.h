@@ -0,0 +1,37 @@
+/*  Image Convert Planar Float
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *      Split ARGB32 images into separate R, G, B planes of floats.
+ *
+ *  This is the NCHW layout that most vision models take as input. The output
+ *  planes are strided so that the image can be written straight into the
+ *  middle of a larger (letterboxed) tensor.
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageConvert_PlanarFloat_H
+#define PokemonAutomation_Kernels_ImageConvert_PlanarFloat_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+//  Each output channel is the 8-bit input channel multiplied by "scale".
+//  Alpha is dropped. "out_stride" is in floats and is shared by all 3 planes.
+void convert_RGB32_to_planar_float(
+    float* r, float* g, float* b, size_t out_stride,
+    const uint32_t* in, size_t in_bytes_per_row,
+    size_t width, size_t height,
+    float scale
+);
+
+
+
+}
+}
+#endif
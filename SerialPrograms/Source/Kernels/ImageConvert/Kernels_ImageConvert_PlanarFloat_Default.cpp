@@ -0,0 +1,23 @@
+/*  Image Convert Planar Float (Default)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include "Kernels_ImageConvert_PlanarFloat_Routines.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void convert_RGB32_to_planar_float_row_Default(
+    float* r, float* g, float* b, const uint32_t* in, size_t width, float scale
+){
+    convert_RGB32_to_planar_float_pixels_Default(r, g, b, in, 0, width, scale);
+}
+
+
+
+}
+}
@@ -0,0 +1,37 @@
+/*  Image Convert Planar Float Routines
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *      Scalar per-pixel conversion shared by all the ISA implementations.
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageConvert_PlanarFloat_Routines_H
+#define PokemonAutomation_Kernels_ImageConvert_PlanarFloat_Routines_H
+
+#include "Common/Compiler.h"
+#include "Kernels_ImageConvert_PlanarFloat.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+//  Convert pixels [start, end) of one row.
+PA_FORCE_INLINE void convert_RGB32_to_planar_float_pixels_Default(
+    float* r, float* g, float* b, const uint32_t* in,
+    size_t start, size_t end, float scale
+){
+    for (size_t x = start; x < end; x++){
+        uint32_t pixel = in[x];
+        r[x] = (float)((pixel >> 16) & 0xff) * scale;
+        g[x] = (float)((pixel >> 8) & 0xff) * scale;
+        b[x] = (float)(pixel & 0xff) * scale;
+    }
+}
+
+
+
+}
+}
+#endif
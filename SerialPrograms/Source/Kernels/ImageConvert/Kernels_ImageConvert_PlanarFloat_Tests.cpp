@@ -0,0 +1,83 @@
+/*  Image Convert Planar Float Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <string>
+#include <vector>
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "Tests/TestUtils.h"
+#include "Kernels_ImageConvert_PlanarFloat.h"
+#include "Kernels_ImageConvert_PlanarFloat_Tests.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+//  Every ISA does the same single multiply per channel, so the output must
+//  match the scalar conversion exactly.
+class Test_ImageConvert_PlanarFloat : public UnitTest{
+public:
+    Test_ImageConvert_PlanarFloat()
+        : UnitTest("Kernels::ImageConvert_PlanarFloat")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        TestRandom random;
+
+        const float SCALE = 1.0f / 255;
+        const float UNTOUCHED = -1.0f;
+
+        for (size_t trial = 0; trial < 200; trial++){
+            size_t width = 1 + random() % 80;
+            size_t height = 1 + random() % 20;
+            size_t in_stride = width + random() % 5;
+            size_t out_stride = width + random() % 5;
+
+            std::vector<uint32_t> in = make_random_image(random, in_stride, height);
+
+            std::vector<float> out(3 * out_stride * height, UNTOUCHED);
+            float* planes[3] = {
+                out.data(),
+                out.data() + out_stride * height,
+                out.data() + 2 * out_stride * height,
+            };
+            convert_RGB32_to_planar_float(
+                planes[0], planes[1], planes[2], out_stride,
+                in.data(), in_stride * sizeof(uint32_t),
+                width, height, SCALE
+            );
+
+            for (size_t p = 0; p < 3; p++){
+                for (size_t r = 0; r < height; r++){
+                    for (size_t c = 0; c < out_stride; c++){
+                        float actual = planes[p][r * out_stride + c];
+                        float expected = c < width
+                            ? (float)((in[r * in_stride + c] >> (16 - 8*p)) & 0xff) * SCALE
+                            : UNTOUCHED;
+                        if (actual != expected){
+                            return "Plane " + std::to_string(p) +
+                                " at (" + std::to_string(c) + ", " + std::to_string(r) + "): " +
+                                std::to_string(actual) + ", expected " + std::to_string(expected);
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
+    };
+};
+
+
+
+void add_tests_ImageConvert_PlanarFloat(UnitTestDatabase& database){
+    database.add<Test_ImageConvert_PlanarFloat>();
+}
+
+
+
+}
+}
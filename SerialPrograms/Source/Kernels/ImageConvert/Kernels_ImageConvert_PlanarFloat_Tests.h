@@ -0,0 +1,23 @@
+/*  Image Convert Planar Float Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageConvert_PlanarFloat_Tests_H
+#define PokemonAutomation_Kernels_ImageConvert_PlanarFloat_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void add_tests_ImageConvert_PlanarFloat(UnitTestDatabase& database);
+
+
+
+}
+}
+#endif
@@ -0,0 +1,40 @@
+/*  Image Convert Planar Float (x64 AVX2)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_13_Haswell
+
+#include <immintrin.h>
+#include "Kernels_ImageConvert_PlanarFloat_Routines.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void convert_RGB32_to_planar_float_row_x64_AVX2(
+    float* r, float* g, float* b, const uint32_t* in, size_t width, float scale
+){
+    const __m256i MASK = _mm256_set1_epi32(0xff);
+    const __m256 SCALE = _mm256_set1_ps(scale);
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8){
+        __m256i pixels = _mm256_loadu_si256((const __m256i*)(in + x));
+        __m256i red   = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), MASK);
+        __m256i green = _mm256_and_si256(_mm256_srli_epi32(pixels, 8), MASK);
+        __m256i blue  = _mm256_and_si256(pixels, MASK);
+        _mm256_storeu_ps(r + x, _mm256_mul_ps(_mm256_cvtepi32_ps(red), SCALE));
+        _mm256_storeu_ps(g + x, _mm256_mul_ps(_mm256_cvtepi32_ps(green), SCALE));
+        _mm256_storeu_ps(b + x, _mm256_mul_ps(_mm256_cvtepi32_ps(blue), SCALE));
+    }
+    convert_RGB32_to_planar_float_pixels_Default(r, g, b, in, x, width, scale);
+}
+
+
+
+}
+}
+#endif
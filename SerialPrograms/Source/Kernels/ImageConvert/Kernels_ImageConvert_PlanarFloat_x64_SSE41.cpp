@@ -0,0 +1,40 @@
+/*  Image Convert Planar Float (x64 SSE4.1)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+
+#include <smmintrin.h>
+#include "Kernels_ImageConvert_PlanarFloat_Routines.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void convert_RGB32_to_planar_float_row_x64_SSE41(
+    float* r, float* g, float* b, const uint32_t* in, size_t width, float scale
+){
+    const __m128i MASK = _mm_set1_epi32(0xff);
+    const __m128 SCALE = _mm_set1_ps(scale);
+
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4){
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(in + x));
+        __m128i red   = _mm_and_si128(_mm_srli_epi32(pixels, 16), MASK);
+        __m128i green = _mm_and_si128(_mm_srli_epi32(pixels, 8), MASK);
+        __m128i blue  = _mm_and_si128(pixels, MASK);
+        _mm_storeu_ps(r + x, _mm_mul_ps(_mm_cvtepi32_ps(red), SCALE));
+        _mm_storeu_ps(g + x, _mm_mul_ps(_mm_cvtepi32_ps(green), SCALE));
+        _mm_storeu_ps(b + x, _mm_mul_ps(_mm_cvtepi32_ps(blue), SCALE));
+    }
+    convert_RGB32_to_planar_float_pixels_Default(r, g, b, in, x, width, scale);
+}
+
+
+
+}
+}
+#endif
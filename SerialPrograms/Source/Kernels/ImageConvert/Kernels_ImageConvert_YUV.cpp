@@ -0,0 +1,152 @@
+/*  Image Convert YUV
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <cmath>
+#include "Common/Cpp/CpuId/CpuId.h"
+#include "Kernels_ImageConvert_YUV.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+YuvToRgbCoefficients YuvToRgbCoefficients::make(YuvColorMatrix matrix, bool full_range){
+    double kr, kb;
+    switch (matrix){
+    case YuvColorMatrix::BT709:
+        kr = 0.2126;
+        kb = 0.0722;
+        break;
+    case YuvColorMatrix::BT601:
+    default:
+        kr = 0.299;
+        kb = 0.114;
+        break;
+    }
+    double kg = 1 - kr - kb;
+
+    double y_scale = full_range ? 1.0 : 255. / 219;
+    double c_scale = full_range ? 1.0 : 255. / 224;
+
+    auto fixed = [](double x){
+        return (int32_t)std::lround(x * (1 << 14));
+    };
+
+    YuvToRgbCoefficients ret;
+    ret.y_offset = full_range ? 0 : 16;
+    ret.y_scale = fixed(y_scale);
+    ret.r_v = fixed(2 * (1 - kr) * c_scale);
+    ret.g_u = fixed(2 * (1 - kb) * kb / kg * c_scale);
+    ret.g_v = fixed(2 * (1 - kr) * kr / kg * c_scale);
+    ret.b_u = fixed(2 * (1 - kb) * c_scale);
+    return ret;
+}
+
+
+
+void convert_NV12_row_Default(
+    uint32_t* out, const uint8_t* y, const uint8_t* uv, size_t width,
+    const YuvToRgbCoefficients& coefficients
+);
+void convert_NV12_row_x64_SSE41(
+    uint32_t* out, const uint8_t* y, const uint8_t* uv, size_t width,
+    const YuvToRgbCoefficients& coefficients
+);
+void convert_NV12_row_x64_AVX2(
+    uint32_t* out, const uint8_t* y, const uint8_t* uv, size_t width,
+    const YuvToRgbCoefficients& coefficients
+);
+
+using ConvertRow_NV12 = void (*)(
+    uint32_t* out, const uint8_t* y, const uint8_t* uv, size_t width,
+    const YuvToRgbCoefficients& coefficients
+);
+ConvertRow_NV12 select_NV12_row(){
+#ifdef PA_AutoDispatch_x64_13_Haswell
+    if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+        return convert_NV12_row_x64_AVX2;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+    if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+        return convert_NV12_row_x64_SSE41;
+    }
+#endif
+    return convert_NV12_row_Default;
+}
+
+void convert_YUY2_row_Default(
+    uint32_t* out, const uint8_t* in, size_t width,
+    const YuvToRgbCoefficients& coefficients
+);
+void convert_YUY2_row_x64_SSE41(
+    uint32_t* out, const uint8_t* in, size_t width,
+    const YuvToRgbCoefficients& coefficients
+);
+void convert_YUY2_row_x64_AVX2(
+    uint32_t* out, const uint8_t* in, size_t width,
+    const YuvToRgbCoefficients& coefficients
+);
+
+using ConvertRow_YUY2 = void (*)(
+    uint32_t* out, const uint8_t* in, size_t width,
+    const YuvToRgbCoefficients& coefficients
+);
+ConvertRow_YUY2 select_YUY2_row(){
+#ifdef PA_AutoDispatch_x64_13_Haswell
+    if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+        return convert_YUY2_row_x64_AVX2;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+    if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+        return convert_YUY2_row_x64_SSE41;
+    }
+#endif
+    return convert_YUY2_row_Default;
+}
+
+
+
+void convert_NV12_to_RGB32(
+    uint32_t* out, size_t out_bytes_per_row,
+    const uint8_t* y_plane, size_t y_bytes_per_row,
+    const uint8_t* uv_plane, size_t uv_bytes_per_row,
+    size_t width, size_t height,
+    const YuvToRgbCoefficients& coefficients
+){
+    ConvertRow_NV12 row = select_NV12_row();
+
+    for (size_t r = 0; r < height; r++){
+        row(
+            out,
+            y_plane + r * y_bytes_per_row,
+            uv_plane + (r / 2) * uv_bytes_per_row,
+            width, coefficients
+        );
+        out = (uint32_t*)((char*)out + out_bytes_per_row);
+    }
+}
+
+void convert_YUY2_to_RGB32(
+    uint32_t* out, size_t out_bytes_per_row,
+    const uint8_t* in, size_t in_bytes_per_row,
+    size_t width, size_t height,
+    const YuvToRgbCoefficients& coefficients
+){
+    ConvertRow_YUY2 row = select_YUY2_row();
+
+    for (size_t r = 0; r < height; r++){
+        row(out, in, width, coefficients);
+        in += in_bytes_per_row;
+        out = (uint32_t*)((char*)out + out_bytes_per_row);
+    }
+}
+
+
+
+}
+}
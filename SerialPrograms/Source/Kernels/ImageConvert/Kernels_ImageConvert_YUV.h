@@ -0,0 +1,61 @@
+/*  Image Convert YUV
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *      Convert packed and semi-planar YUV video frames to ARGB32.
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageConvert_YUV_H
+#define PokemonAutomation_Kernels_ImageConvert_YUV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+enum class YuvColorMatrix{
+    BT601,
+    BT709,
+};
+
+//  Q14 fixed-point coefficients. Every ISA uses the same integer math so the
+//  output is identical regardless of which one runs.
+struct YuvToRgbCoefficients{
+    int32_t y_offset;
+    int32_t y_scale;
+    int32_t r_v;
+    int32_t g_u;
+    int32_t g_v;
+    int32_t b_u;
+
+    static YuvToRgbCoefficients make(YuvColorMatrix matrix, bool full_range);
+};
+
+
+//  NV12: A full resolution Y plane followed by a half resolution plane of
+//  interleaved U/V samples.
+void convert_NV12_to_RGB32(
+    uint32_t* out, size_t out_bytes_per_row,
+    const uint8_t* y_plane, size_t y_bytes_per_row,
+    const uint8_t* uv_plane, size_t uv_bytes_per_row,
+    size_t width, size_t height,
+    const YuvToRgbCoefficients& coefficients
+);
+
+//  YUY2 (YUYV): Packed Y0 U0 Y1 V0 for every pair of pixels.
+void convert_YUY2_to_RGB32(
+    uint32_t* out, size_t out_bytes_per_row,
+    const uint8_t* in, size_t in_bytes_per_row,
+    size_t width, size_t height,
+    const YuvToRgbCoefficients& coefficients
+);
+
+
+
+}
+}
+#endif
@@ -0,0 +1,30 @@
+/*  Image Convert YUV (Default)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include "Kernels_ImageConvert_YUV_Routines.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void convert_NV12_row_Default(
+    uint32_t* out, const uint8_t* y, const uint8_t* uv, size_t width,
+    const YuvToRgbCoefficients& coefficients
+){
+    convert_NV12_pixels_Default(out, y, uv, 0, width, coefficients);
+}
+void convert_YUY2_row_Default(
+    uint32_t* out, const uint8_t* in, size_t width,
+    const YuvToRgbCoefficients& coefficients
+){
+    convert_YUY2_pixels_Default(out, in, 0, width, coefficients);
+}
+
+
+
+}
+}
@@ -0,0 +1,61 @@
+/*  Image Convert YUV Routines
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *      Scalar per-pixel conversion shared by all the ISA implementations.
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageConvert_YUV_Routines_H
+#define PokemonAutomation_Kernels_ImageConvert_YUV_Routines_H
+
+#include <algorithm>
+#include "Common/Compiler.h"
+#include "Kernels_ImageConvert_YUV.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+PA_FORCE_INLINE uint32_t yuv_to_rgb32_Default(
+    int32_t y, int32_t u, int32_t v,
+    const YuvToRgbCoefficients& coefficients
+){
+    y = (y - coefficients.y_offset) * coefficients.y_scale + (1 << 13);
+    u -= 128;
+    v -= 128;
+    int32_t r = (y + coefficients.r_v * v) >> 14;
+    int32_t g = (y - (coefficients.g_u * u + coefficients.g_v * v)) >> 14;
+    int32_t b = (y + coefficients.b_u * u) >> 14;
+    r = std::min(std::max(r, 0), 255);
+    g = std::min(std::max(g, 0), 255);
+    b = std::min(std::max(b, 0), 255);
+    return 0xff000000 | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+}
+
+//  Convert pixels [x, width) of a row.
+PA_FORCE_INLINE void convert_NV12_pixels_Default(
+    uint32_t* out, const uint8_t* y, const uint8_t* uv, size_t x, size_t width,
+    const YuvToRgbCoefficients& coefficients
+){
+    for (; x < width; x++){
+        size_t c = x & ~(size_t)1;
+        out[x] = yuv_to_rgb32_Default(y[x], uv[c], uv[c + 1], coefficients);
+    }
+}
+PA_FORCE_INLINE void convert_YUY2_pixels_Default(
+    uint32_t* out, const uint8_t* in, size_t x, size_t width,
+    const YuvToRgbCoefficients& coefficients
+){
+    for (; x < width; x++){
+        const uint8_t* pair = in + 2 * (x & ~(size_t)1);
+        out[x] = yuv_to_rgb32_Default(in[2 * x], pair[1], pair[3], coefficients);
+    }
+}
+
+
+
+}
+}
+#endif
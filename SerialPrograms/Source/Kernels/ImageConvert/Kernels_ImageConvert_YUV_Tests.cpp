@@ -0,0 +1,155 @@
+/*  Image Convert YUV Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <cmath>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include "Common/Cpp/PrettyPrint.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "Kernels_ImageConvert_YUV.h"
+#include "Kernels_ImageConvert_YUV_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+//  Straightforward double-precision conversion.
+uint32_t yuv_reference_pixel(uint8_t y, uint8_t u, uint8_t v, YuvColorMatrix matrix, bool full_range){
+    double kr = matrix == YuvColorMatrix::BT709 ? 0.2126 : 0.299;
+    double kb = matrix == YuvColorMatrix::BT709 ? 0.0722 : 0.114;
+    double kg = 1 - kr - kb;
+
+    double Y = full_range ? y : (y - 16) * 255. / 219;
+    double U = full_range ? u - 128. : (u - 128) * 255. / 224;
+    double V = full_range ? v - 128. : (v - 128) * 255. / 224;
+
+    double rgb[3] = {
+        Y + 2 * (1 - kr) * V,
+        Y - 2 * (1 - kb) * kb / kg * U - 2 * (1 - kr) * kr / kg * V,
+        Y + 2 * (1 - kb) * U,
+    };
+    uint32_t ret = 0xff000000;
+    for (size_t c = 0; c < 3; c++){
+        double x = std::min(std::max(std::floor(rgb[c] + 0.5), 0.), 255.);
+        ret |= (uint32_t)x << (16 - 8*c);
+    }
+    return ret;
+}
+//  Returns an error message if any channel is off by more than one.
+std::string yuv_compare_pixel(const char* format, size_t x, size_t y, uint32_t actual, uint32_t expected){
+    for (size_t c = 0; c < 4; c++){
+        int diff = (int)((actual >> (8*c)) & 0xff) - (int)((expected >> (8*c)) & 0xff);
+        if (diff < -1 || diff > 1){
+            std::stringstream ss;
+            ss << "Error: " << format << " at (" << x << ", " << y << "): " << tostr_hex(actual)
+               << ", expected " << tostr_hex(expected);
+            return ss.str();
+        }
+    }
+    return "";
+}
+
+
+//  Compare against the reference on random sizes, strides and samples.
+//  The kernels use Q14 fixed-point, so allow each channel to be off by one.
+class Test_ImageConvert_YUV : public UnitTest{
+public:
+    Test_ImageConvert_YUV()
+        : UnitTest("Kernels::ImageConvert_YUV")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        TestRandom random;
+
+        for (size_t trial = 0; trial < 200; trial++){
+            YuvColorMatrix matrix = trial % 2 ? YuvColorMatrix::BT709 : YuvColorMatrix::BT601;
+            bool full_range = trial % 4 >= 2;
+            YuvToRgbCoefficients coefficients = YuvToRgbCoefficients::make(matrix, full_range);
+
+            size_t width = 1 + random() % 80;
+            size_t height = 1 + random() % 20;
+            size_t chroma_width = (width + 1) & ~(size_t)1;
+            size_t out_stride = width + random() % 5;
+
+            //  NV12
+            {
+                size_t y_stride = width + random() % 7;
+                size_t uv_stride = chroma_width + random() % 7;
+                std::vector<uint8_t> y_plane = make_random_bytes(random, y_stride * height);
+                std::vector<uint8_t> uv_plane = make_random_bytes(random, uv_stride * ((height + 1) / 2));
+                std::vector<uint32_t> out(out_stride * height, 0xdeadbeef);
+                convert_NV12_to_RGB32(
+                    out.data(), out_stride * sizeof(uint32_t),
+                    y_plane.data(), y_stride,
+                    uv_plane.data(), uv_stride,
+                    width, height, coefficients
+                );
+                for (size_t r = 0; r < height; r++){
+                    for (size_t c = 0; c < out_stride; c++){
+                        uint32_t actual = out[r * out_stride + c];
+                        if (c >= width){
+                            if (actual != 0xdeadbeef){
+                                return "Error: NV12 wrote past the end of a row.";
+                            }
+                            continue;
+                        }
+                        const uint8_t* uv = &uv_plane[(r / 2) * uv_stride + (c & ~(size_t)1)];
+                        uint32_t expected = yuv_reference_pixel(y_plane[r * y_stride + c], uv[0], uv[1], matrix, full_range);
+                        std::string error = yuv_compare_pixel("NV12", c, r, actual, expected);
+                        if (!error.empty()){
+                            return error;
+                        }
+                    }
+                }
+            }
+
+            //  YUY2
+            {
+                size_t in_stride = 2 * chroma_width + random() % 7;
+                std::vector<uint8_t> in = make_random_bytes(random, in_stride * height);
+                std::vector<uint32_t> out(out_stride * height, 0xdeadbeef);
+                convert_YUY2_to_RGB32(
+                    out.data(), out_stride * sizeof(uint32_t),
+                    in.data(), in_stride,
+                    width, height, coefficients
+                );
+                for (size_t r = 0; r < height; r++){
+                    for (size_t c = 0; c < out_stride; c++){
+                        uint32_t actual = out[r * out_stride + c];
+                        if (c >= width){
+                            if (actual != 0xdeadbeef){
+                                return "Error: YUY2 wrote past the end of a row.";
+                            }
+                            continue;
+                        }
+                        const uint8_t* pair = &in[r * in_stride + 2 * (c & ~(size_t)1)];
+                        uint32_t expected = yuv_reference_pixel(in[r * in_stride + 2 * c], pair[1], pair[3], matrix, full_range);
+                        std::string error = yuv_compare_pixel("YUY2", c, r, actual, expected);
+                        if (!error.empty()){
+                            return error;
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
+    };
+};
+
+
+
+void add_tests_ImageConvert(UnitTestDatabase& database){
+    database.add<Test_ImageConvert_YUV>();
+}
+
+
+
+}
+}
@@ -0,0 +1,23 @@
+/*  Image Convert YUV Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageConvert_YUV_Tests_H
+#define PokemonAutomation_Kernels_ImageConvert_YUV_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void add_tests_ImageConvert(UnitTestDatabase& database);
+
+
+
+}
+}
+#endif
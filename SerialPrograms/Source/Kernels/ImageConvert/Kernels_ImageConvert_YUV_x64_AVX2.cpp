@@ -0,0 +1,114 @@
+/*  Image Convert YUV (x64 AVX2)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_13_Haswell
+
+#include <immintrin.h>
+#include "Kernels_ImageConvert_YUV_Routines.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+class YuvToRgb_x64_AVX2{
+public:
+    YuvToRgb_x64_AVX2(const YuvToRgbCoefficients& coefficients)
+        : m_y_offset(_mm256_set1_epi32(coefficients.y_offset))
+        , m_y_scale(_mm256_set1_epi32(coefficients.y_scale))
+        , m_r_v(_mm256_set1_epi32(coefficients.r_v))
+        , m_g_u(_mm256_set1_epi32(coefficients.g_u))
+        , m_g_v(_mm256_set1_epi32(coefficients.g_v))
+        , m_b_u(_mm256_set1_epi32(coefficients.b_u))
+    {}
+
+    //  "y", "u", "v" each hold 8 samples in the low 8 bytes.
+    PA_FORCE_INLINE __m256i convert(__m128i y8, __m128i u8, __m128i v8) const{
+        const __m256i ROUND = _mm256_set1_epi32(1 << 13);
+        const __m256i BIAS = _mm256_set1_epi32(128);
+        const __m256i MAX = _mm256_set1_epi32(255);
+        const __m256i ALPHA = _mm256_set1_epi32(0xff000000);
+
+        __m256i y = _mm256_cvtepu8_epi32(y8);
+        __m256i u = _mm256_sub_epi32(_mm256_cvtepu8_epi32(u8), BIAS);
+        __m256i v = _mm256_sub_epi32(_mm256_cvtepu8_epi32(v8), BIAS);
+
+        y = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(y, m_y_offset), m_y_scale), ROUND);
+        __m256i r = _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_mullo_epi32(v, m_r_v)), 14);
+        __m256i g = _mm256_srai_epi32(
+            _mm256_sub_epi32(y, _mm256_add_epi32(_mm256_mullo_epi32(u, m_g_u), _mm256_mullo_epi32(v, m_g_v))),
+            14
+        );
+        __m256i b = _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_mullo_epi32(u, m_b_u)), 14);
+
+        r = _mm256_min_epi32(_mm256_max_epi32(r, _mm256_setzero_si256()), MAX);
+        g = _mm256_min_epi32(_mm256_max_epi32(g, _mm256_setzero_si256()), MAX);
+        b = _mm256_min_epi32(_mm256_max_epi32(b, _mm256_setzero_si256()), MAX);
+
+        __m256i pixels = _mm256_or_si256(_mm256_slli_epi32(r, 16), _mm256_slli_epi32(g, 8));
+        return _mm256_or_si256(_mm256_or_si256(pixels, b), ALPHA);
+    }
+
+private:
+    __m256i m_y_offset;
+    __m256i m_y_scale;
+    __m256i m_r_v;
+    __m256i m_g_u;
+    __m256i m_g_v;
+    __m256i m_b_u;
+};
+
+
+void convert_NV12_row_x64_AVX2(
+    uint32_t* out, const uint8_t* y, const uint8_t* uv, size_t width,
+    const YuvToRgbCoefficients& coefficients
+){
+    const __m128i U_SHUFFLE = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i V_SHUFFLE = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    YuvToRgb_x64_AVX2 converter(coefficients);
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8){
+        __m128i chroma = _mm_loadl_epi64((const __m128i*)(uv + x));
+        __m256i pixels = converter.convert(
+            _mm_loadl_epi64((const __m128i*)(y + x)),
+            _mm_shuffle_epi8(chroma, U_SHUFFLE),
+            _mm_shuffle_epi8(chroma, V_SHUFFLE)
+        );
+        _mm256_storeu_si256((__m256i*)(out + x), pixels);
+    }
+    convert_NV12_pixels_Default(out, y, uv, x, width, coefficients);
+}
+
+void convert_YUY2_row_x64_AVX2(
+    uint32_t* out, const uint8_t* in, size_t width,
+    const YuvToRgbCoefficients& coefficients
+){
+    const __m128i Y_SHUFFLE = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i U_SHUFFLE = _mm_setr_epi8(1, 1, 5, 5, 9, 9, 13, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i V_SHUFFLE = _mm_setr_epi8(3, 3, 7, 7, 11, 11, 15, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    YuvToRgb_x64_AVX2 converter(coefficients);
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8){
+        __m128i packed = _mm_loadu_si128((const __m128i*)(in + 2 * x));
+        __m256i pixels = converter.convert(
+            _mm_shuffle_epi8(packed, Y_SHUFFLE),
+            _mm_shuffle_epi8(packed, U_SHUFFLE),
+            _mm_shuffle_epi8(packed, V_SHUFFLE)
+        );
+        _mm256_storeu_si256((__m256i*)(out + x), pixels);
+    }
+    convert_YUY2_pixels_Default(out, in, x, width, coefficients);
+}
+
+
+
+}
+}
+#endif
@@ -0,0 +1,118 @@
+/*  Image Convert YUV (x64 SSE4.1)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+
+#include <string.h>
+#include <smmintrin.h>
+#include "Kernels_ImageConvert_YUV_Routines.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+class YuvToRgb_x64_SSE41{
+public:
+    YuvToRgb_x64_SSE41(const YuvToRgbCoefficients& coefficients)
+        : m_y_offset(_mm_set1_epi32(coefficients.y_offset))
+        , m_y_scale(_mm_set1_epi32(coefficients.y_scale))
+        , m_r_v(_mm_set1_epi32(coefficients.r_v))
+        , m_g_u(_mm_set1_epi32(coefficients.g_u))
+        , m_g_v(_mm_set1_epi32(coefficients.g_v))
+        , m_b_u(_mm_set1_epi32(coefficients.b_u))
+    {}
+
+    //  "y", "u", "v" each hold 4 samples in the low 4 bytes.
+    PA_FORCE_INLINE __m128i convert(__m128i y, __m128i u, __m128i v) const{
+        const __m128i ROUND = _mm_set1_epi32(1 << 13);
+        const __m128i BIAS = _mm_set1_epi32(128);
+        const __m128i MAX = _mm_set1_epi32(255);
+        const __m128i ALPHA = _mm_set1_epi32(0xff000000);
+
+        y = _mm_cvtepu8_epi32(y);
+        u = _mm_sub_epi32(_mm_cvtepu8_epi32(u), BIAS);
+        v = _mm_sub_epi32(_mm_cvtepu8_epi32(v), BIAS);
+
+        y = _mm_add_epi32(_mm_mullo_epi32(_mm_sub_epi32(y, m_y_offset), m_y_scale), ROUND);
+        __m128i r = _mm_srai_epi32(_mm_add_epi32(y, _mm_mullo_epi32(v, m_r_v)), 14);
+        __m128i g = _mm_srai_epi32(
+            _mm_sub_epi32(y, _mm_add_epi32(_mm_mullo_epi32(u, m_g_u), _mm_mullo_epi32(v, m_g_v))),
+            14
+        );
+        __m128i b = _mm_srai_epi32(_mm_add_epi32(y, _mm_mullo_epi32(u, m_b_u)), 14);
+
+        r = _mm_min_epi32(_mm_max_epi32(r, _mm_setzero_si128()), MAX);
+        g = _mm_min_epi32(_mm_max_epi32(g, _mm_setzero_si128()), MAX);
+        b = _mm_min_epi32(_mm_max_epi32(b, _mm_setzero_si128()), MAX);
+
+        __m128i pixels = _mm_or_si128(_mm_slli_epi32(r, 16), _mm_slli_epi32(g, 8));
+        return _mm_or_si128(_mm_or_si128(pixels, b), ALPHA);
+    }
+
+private:
+    __m128i m_y_offset;
+    __m128i m_y_scale;
+    __m128i m_r_v;
+    __m128i m_g_u;
+    __m128i m_g_v;
+    __m128i m_b_u;
+};
+
+
+void convert_NV12_row_x64_SSE41(
+    uint32_t* out, const uint8_t* y, const uint8_t* uv, size_t width,
+    const YuvToRgbCoefficients& coefficients
+){
+    const __m128i U_SHUFFLE = _mm_setr_epi8(0, 0, 2, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i V_SHUFFLE = _mm_setr_epi8(1, 1, 3, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    YuvToRgb_x64_SSE41 converter(coefficients);
+
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4){
+        int32_t y4, uv4;
+        memcpy(&y4, y + x, sizeof(int32_t));
+        memcpy(&uv4, uv + x, sizeof(int32_t));
+        __m128i chroma = _mm_cvtsi32_si128(uv4);
+        __m128i pixels = converter.convert(
+            _mm_cvtsi32_si128(y4),
+            _mm_shuffle_epi8(chroma, U_SHUFFLE),
+            _mm_shuffle_epi8(chroma, V_SHUFFLE)
+        );
+        _mm_storeu_si128((__m128i*)(out + x), pixels);
+    }
+    convert_NV12_pixels_Default(out, y, uv, x, width, coefficients);
+}
+
+void convert_YUY2_row_x64_SSE41(
+    uint32_t* out, const uint8_t* in, size_t width,
+    const YuvToRgbCoefficients& coefficients
+){
+    const __m128i Y_SHUFFLE = _mm_setr_epi8(0, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i U_SHUFFLE = _mm_setr_epi8(1, 1, 5, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i V_SHUFFLE = _mm_setr_epi8(3, 3, 7, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    YuvToRgb_x64_SSE41 converter(coefficients);
+
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4){
+        __m128i packed = _mm_loadl_epi64((const __m128i*)(in + 2 * x));
+        __m128i pixels = converter.convert(
+            _mm_shuffle_epi8(packed, Y_SHUFFLE),
+            _mm_shuffle_epi8(packed, U_SHUFFLE),
+            _mm_shuffle_epi8(packed, V_SHUFFLE)
+        );
+        _mm_storeu_si128((__m128i*)(out + x), pixels);
+    }
+    convert_YUY2_pixels_Default(out, in, x, width, coefficients);
+}
+
+
+
+}
+}
+#endif
@@ -4,8 +4,12 @@
  *
  */
 
+#include <vector>
 #include "Common/Cpp/Color.h"
 #include "Common/Cpp/Time.h"
+#include "Common/Cpp/PrettyPrint.h"
+#include "Common/Cpp/CpuId/CpuId.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
 #include "CommonFramework/GlobalAutoPaths.h"
 #include "CommonFramework/ImageTypes/BinaryImage.h"
 #include "CommonFramework/ImageTypes/ImageRGB32.h"
@@ -20,6 +24,7 @@
 #include "Kernels/BinaryImageFilters/Kernels_BinaryImage_BasicFilters.h"
 #include "Kernels/ImageFilters/RGB32_Range/Kernels_ImageFilter_RGB32_Range.h"
 #include "Kernels/ImageFilters/RGB32_EuclideanDistance/Kernels_ImageFilter_RGB32_Euclidean.h"
+#include "Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32.h"
 #include "Kernels_ImageFilter_Tests.h"
 #include "Tests/TestUtils.h"
 
@@ -586,8 +591,116 @@ private:
 
 
 
-void add_tests_ImageFilters(UnitTestDatabase& database){
+void convert_rgb32_to_hsv32_Default(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+void convert_rgb32_to_hsv32_x64_SSE41(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+void convert_rgb32_to_hsv32_x64_AVX2(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+void convert_rgb32_to_hsv32_x64_AVX512(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+void convert_rgb32_to_hsv32_ARM64_NEON(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+
+//  Run every RGB value through every implementation the CPU supports and
+//  compare against the Default one. Then benchmark each of them.
+class Test_ImageFilterRGB32HSV32 : public UnitTest{
+public:
+    using Function = void (*)(
+        const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+        uint32_t* out, size_t out_bytes_per_row
+    );
+
+    Test_ImageFilterRGB32HSV32()
+        : UnitTest("Kernels::ImageFilterRGB32HSV32")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        //  One pixel for every RGB value. Odd width to exercise the tails.
+        const size_t width = 4099;
+        const size_t height = ((size_t)1 << 24) / width + 1;
+        std::vector<uint32_t> image(width * height);
+        for (size_t c = 0; c < image.size(); c++){
+            image[c] = (uint32_t)(c & 0x00ffffff) | (uint32_t)(c * 37) << 24;
+        }
+
+        std::vector<uint32_t> expected(width * height);
+        convert_rgb32_to_hsv32_Default(
+            image.data(), width * sizeof(uint32_t), width, height,
+            expected.data(), width * sizeof(uint32_t)
+        );
 
+        std::vector<std::pair<std::string, Function>> functions;
+        functions.emplace_back("Default", convert_rgb32_to_hsv32_Default);
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+        if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+            functions.emplace_back("x64 SSE4.1", convert_rgb32_to_hsv32_x64_SSE41);
+        }
+#endif
+#ifdef PA_AutoDispatch_x64_13_Haswell
+        if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+            functions.emplace_back("x64 AVX2", convert_rgb32_to_hsv32_x64_AVX2);
+        }
+#endif
+#ifdef PA_AutoDispatch_x64_17_Skylake
+        if (CPU_CAPABILITY_CURRENT.OK_17_Skylake){
+            functions.emplace_back("x64 AVX512", convert_rgb32_to_hsv32_x64_AVX512);
+        }
+#endif
+#ifdef PA_AutoDispatch_arm64_20_M1
+        if (CPU_CAPABILITY_CURRENT.OK_M1){
+            functions.emplace_back("ARM64 NEON", convert_rgb32_to_hsv32_ARM64_NEON);
+        }
+#endif
+
+        std::vector<uint32_t> out(width * height);
+        for (const auto& function : functions){
+            function.second(
+                image.data(), width * sizeof(uint32_t), width, height,
+                out.data(), width * sizeof(uint32_t)
+            );
+            for (size_t c = 0; c < out.size(); c++){
+                if (out[c] != expected[c]){
+                    cout << "Error: " << function.first << " mismatch on pixel " << tostr_hex(image[c])
+                         << ": " << tostr_hex(out[c]) << ", expected " << tostr_hex(expected[c]) << endl;
+                    return false;
+                }
+            }
+
+            const size_t num_iters = 10;
+            auto time_start = current_time();
+            for (size_t i = 0; i < num_iters; i++){
+                function.second(
+                    image.data(), width * sizeof(uint32_t), width, height,
+                    out.data(), width * sizeof(uint32_t)
+                );
+            }
+            auto time_end = current_time();
+            double seconds = std::chrono::duration_cast<std::chrono::microseconds>(time_end - time_start).count() / 1000000.;
+            double mpixels = (double)(width * height * num_iters) / 1000000.;
+            cout << function.first << ": " << mpixels / seconds << " MPixels/s" << endl;
+        }
+
+        return true;
+    };
+};
+
+
+
+
+
+void add_tests_ImageFilters(UnitTestDatabase& database){
+    database.add<Test_ImageFilterRGB32HSV32>();
 
 
 }
@@ -0,0 +1,75 @@
+/*  Image Filters RGB32 to HSV32
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include "Common/Cpp/CpuId/CpuId.h"
+#include "Kernels_ImageFilter_RGB32_HSV32.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void convert_rgb32_to_hsv32_Default(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+void convert_rgb32_to_hsv32_x64_SSE41(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+void convert_rgb32_to_hsv32_x64_AVX2(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+void convert_rgb32_to_hsv32_x64_AVX512(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+void convert_rgb32_to_hsv32_ARM64_NEON(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+
+
+
+void convert_rgb32_to_hsv32(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+){
+    if (width == 0 || height == 0){
+        return;
+    }
+#ifdef PA_AutoDispatch_x64_17_Skylake
+    if (CPU_CAPABILITY_CURRENT.OK_17_Skylake){
+        convert_rgb32_to_hsv32_x64_AVX512(in, in_bytes_per_row, width, height, out, out_bytes_per_row);
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_13_Haswell
+    if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+        convert_rgb32_to_hsv32_x64_AVX2(in, in_bytes_per_row, width, height, out, out_bytes_per_row);
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+    if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+        convert_rgb32_to_hsv32_x64_SSE41(in, in_bytes_per_row, width, height, out, out_bytes_per_row);
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_arm64_20_M1
+    if (CPU_CAPABILITY_CURRENT.OK_M1){
+        convert_rgb32_to_hsv32_ARM64_NEON(in, in_bytes_per_row, width, height, out, out_bytes_per_row);
+        return;
+    }
+#endif
+    convert_rgb32_to_hsv32_Default(in, in_bytes_per_row, width, height, out, out_bytes_per_row);
+}
+
+
+
+}
+}
@@ -0,0 +1,36 @@
+/*  Image Filters RGB32 to HSV32
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  Convert an RGB32 image to HSV32.
+ *
+ *  Each output pixel keeps the alpha of the input and stores H, S, V in
+ *  the bytes that previously held R, G, B. H is scaled from [0, 360) to
+ *  [0, 256) and wraps around. S and V are in [0, 255].
+ *
+ *  All implementations are bit-exact with the Default (scalar) one.
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageFilter_RGB32_HSV32_H
+#define PokemonAutomation_Kernels_ImageFilter_RGB32_HSV32_H
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+//  "in" and "out" are allowed to be the same buffer.
+void convert_rgb32_to_hsv32(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+);
+
+
+
+}
+}
+#endif
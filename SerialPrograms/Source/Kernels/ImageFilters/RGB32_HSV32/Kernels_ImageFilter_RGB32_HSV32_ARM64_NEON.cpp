@@ -0,0 +1,113 @@
+/*  Image Filters RGB32 to HSV32 (ARM64 NEON)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_arm64_20_M1
+
+#include <arm_neon.h>
+#include "Kernels_ImageFilter_RGB32_HSV32_Routines.h"
+#include "Kernels_ImageFilter_RGB32_HSV32.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+struct Rgb32ToHsv32_ARM64_NEON{
+    static const size_t VECTOR_SIZE = 4;
+
+    //  Convert the 4 x int32 to 2 x 2 doubles, run "op" on each half and
+    //  convert back with truncation.
+    template <typename Op>
+    static PA_FORCE_INLINE int32x4_t run_f64(int32x4_t x0, int32x4_t x1, int32x4_t x2, Op&& op){
+        float64x2_t L = op(
+            vcvtq_f64_s64(vmovl_s32(vget_low_s32(x0))),
+            vcvtq_f64_s64(vmovl_s32(vget_low_s32(x1))),
+            vcvtq_f64_s64(vmovl_s32(vget_low_s32(x2)))
+        );
+        float64x2_t H = op(
+            vcvtq_f64_s64(vmovl_s32(vget_high_s32(x0))),
+            vcvtq_f64_s64(vmovl_s32(vget_high_s32(x1))),
+            vcvtq_f64_s64(vmovl_s32(vget_high_s32(x2)))
+        );
+        return vcombine_s32(vmovn_s64(vcvtq_s64_f64(L)), vmovn_s64(vcvtq_s64_f64(H)));
+    }
+
+    static PA_FORCE_INLINE uint32x4_t convert(uint32x4_t p){
+        const int32x4_t ONE = vdupq_n_s32(1);
+        const int32x4_t BYTE = vdupq_n_s32(0xff);
+
+        int32x4_t r = vandq_s32(vreinterpretq_s32_u32(vshrq_n_u32(p, 16)), BYTE);
+        int32x4_t g = vandq_s32(vreinterpretq_s32_u32(vshrq_n_u32(p, 8)), BYTE);
+        int32x4_t b = vandq_s32(vreinterpretq_s32_u32(p), BYTE);
+
+        int32x4_t M = vmaxq_s32(vmaxq_s32(r, g), b);
+        int32x4_t m = vminq_s32(vminq_s32(r, g), b);
+        int32x4_t delta = vsubq_s32(M, m);
+
+        //  S = 255 - (m*255 + M/2) / M
+        int32x4_t S = run_f64(
+            vaddq_s32(vmulq_s32(m, BYTE), vshrq_n_s32(M, 1)),
+            vmaxq_s32(M, ONE),
+            M,
+            [](float64x2_t num, float64x2_t den, float64x2_t){
+                return vdivq_f64(num, den);
+            }
+        );
+        S = vsubq_s32(BYTE, S);
+        S = vandq_s32(S, vreinterpretq_s32_u32(vtstq_s32(M, M)));
+
+        //  Pick the numerator and offset depending on which channel is the max.
+        uint32x4_t is_r = vceqq_s32(M, r);
+        uint32x4_t is_g = vceqq_s32(M, g);
+        int32x4_t num = vsubq_s32(r, g);
+        int32x4_t offset = vdupq_n_s32(4);
+        num = vbslq_s32(is_g, vsubq_s32(b, r), num);
+        offset = vbslq_s32(is_g, vdupq_n_s32(2), offset);
+        num = vbslq_s32(is_r, vsubq_s32(g, b), num);
+        offset = vbslq_s32(is_r, vdupq_n_s32(6), offset);
+
+        int32x4_t H = run_f64(
+            num, vmaxq_s32(delta, ONE), offset,
+            [](float64x2_t num, float64x2_t den, float64x2_t offset){
+                const float64x2_t SIX = vdupq_n_f64(6.0);
+                float64x2_t Hf = vaddq_f64(vdivq_f64(num, den), offset);
+                Hf = vsubq_f64(Hf, vreinterpretq_f64_u64(vandq_u64(vcgeq_f64(Hf, SIX), vreinterpretq_u64_f64(SIX))));
+                Hf = vmulq_f64(Hf, vdupq_n_f64(256.0));
+                Hf = vdivq_f64(Hf, SIX);
+                return vaddq_f64(Hf, vdupq_n_f64(0.5));
+            }
+        );
+        H = vandq_s32(H, BYTE);
+        H = vandq_s32(H, vreinterpretq_s32_u32(vtstq_s32(delta, delta)));
+
+        uint32x4_t out = vandq_u32(p, vdupq_n_u32(0xff000000));
+        out = vorrq_u32(out, vreinterpretq_u32_s32(vshlq_n_s32(H, 16)));
+        out = vorrq_u32(out, vreinterpretq_u32_s32(vshlq_n_s32(S, 8)));
+        out = vorrq_u32(out, vreinterpretq_u32_s32(M));
+        return out;
+    }
+    static PA_FORCE_INLINE void convert_vector(uint32_t* out, const uint32_t* in){
+        vst1q_u32(out, convert(vld1q_u32(in)));
+    }
+};
+
+
+
+void convert_rgb32_to_hsv32_ARM64_NEON(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+){
+    convert_rgb32_to_hsv32_rows<Rgb32ToHsv32_ARM64_NEON>(
+        in, in_bytes_per_row, width, height,
+        out, out_bytes_per_row
+    );
+}
+
+
+
+}
+}
+#endif
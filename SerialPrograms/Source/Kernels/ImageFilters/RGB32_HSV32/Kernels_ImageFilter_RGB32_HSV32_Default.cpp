@@ -0,0 +1,38 @@
+/*  Image Filters RGB32 to HSV32 (Default)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include "Kernels_ImageFilter_RGB32_HSV32_Routines.h"
+#include "Kernels_ImageFilter_RGB32_HSV32.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+struct Rgb32ToHsv32_Default{
+    static const size_t VECTOR_SIZE = 1;
+
+    static PA_FORCE_INLINE void convert_vector(uint32_t* out, const uint32_t* in){
+        out[0] = rgb32_to_hsv32_pixel(in[0]);
+    }
+};
+
+
+
+void convert_rgb32_to_hsv32_Default(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+){
+    convert_rgb32_to_hsv32_rows<Rgb32ToHsv32_Default>(
+        in, in_bytes_per_row, width, height,
+        out, out_bytes_per_row
+    );
+}
+
+
+
+}
+}
@@ -0,0 +1,88 @@
+/*  Image Filters RGB32 to HSV32 Routines
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageFilter_RGB32_HSV32_Routines_H
+#define PokemonAutomation_Kernels_ImageFilter_RGB32_HSV32_Routines_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include "Common/Compiler.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+//  The reference single-pixel conversion. The vectorized versions replicate
+//  the exact sequence of floating-point operations done here.
+PA_FORCE_INLINE uint32_t rgb32_to_hsv32_pixel(uint32_t p){
+    int r = (uint32_t(0xff) & (p >> 16));
+    int g = (uint32_t(0xff) & (p >> 8));
+    int b = (uint32_t(0xff) & p);
+
+    int M = std::max(std::max(r, g), b);
+    int m = std::min(std::min(r, g), b);
+
+    int delta = M - m;
+
+    int S = 0;
+    if (M > 0){
+        S = std::min(std::max(255 - (m*255 + M/2)/M, 0), 255);
+    }
+
+    int V = M;
+
+    double Hf = 0;
+    if (delta > 0){
+        if (M == r){
+            Hf = std::fmod(std::fmod((g - b)/(double)delta, 6.0)+6.0, 6.0);
+        }else if (M == g){
+            Hf = (b - r)/(double)delta + 2.0;
+        }else{
+            Hf = (r - g)/(double)delta + 4.0;
+        }
+    }
+
+    //  Hf * 60.0 is the standard H value, which ranges in [0, 360).
+    //  To hold it in a uint8, need to convert its range to [0, 255]
+    int H = std::max(int(Hf * 256.0 / 6.0 + 0.5) % 256, 0);
+
+    return (p & 0xff000000) |
+           ((uint32_t)(uint8_t)H << 16) |
+           ((uint32_t)(uint8_t)S << 8) |
+           (uint8_t)V;
+}
+
+
+
+//  Run "Converter::convert_vector()" over every full vector of each row and
+//  finish each row with the scalar version.
+template <typename Converter>
+PA_FORCE_INLINE void convert_rgb32_to_hsv32_rows(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+){
+    const size_t VECTOR_SIZE = Converter::VECTOR_SIZE;
+    for (size_t r = 0; r < height; r++){
+        size_t c = 0;
+        for (; c + VECTOR_SIZE <= width; c += VECTOR_SIZE){
+            Converter::convert_vector(out + c, in + c);
+        }
+        for (; c < width; c++){
+            out[c] = rgb32_to_hsv32_pixel(in[c]);
+        }
+        in = (const uint32_t*)((const char*)in + in_bytes_per_row);
+        out = (uint32_t*)((char*)out + out_bytes_per_row);
+    }
+}
+
+
+
+}
+}
+#endif
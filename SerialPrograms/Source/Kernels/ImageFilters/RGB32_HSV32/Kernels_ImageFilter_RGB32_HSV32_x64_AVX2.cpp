@@ -0,0 +1,117 @@
+/*  Image Filters RGB32 to HSV32 (x64 AVX2)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_13_Haswell
+
+#include <immintrin.h>
+#include "Kernels_ImageFilter_RGB32_HSV32_Routines.h"
+#include "Kernels_ImageFilter_RGB32_HSV32.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+struct Rgb32ToHsv32_x64_AVX2{
+    static const size_t VECTOR_SIZE = 8;
+
+    //  Convert the 8 x int32 to 2 x 4 doubles, run "op" on each half and
+    //  convert back with truncation.
+    template <typename Op>
+    static PA_FORCE_INLINE __m256i run_f64(__m256i x0, __m256i x1, __m256i x2, Op&& op){
+        __m256d L = op(
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(x0)),
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(x1)),
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(x2))
+        );
+        __m256d H = op(
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(x0, 1)),
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(x1, 1)),
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(x2, 1))
+        );
+        return _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm256_cvttpd_epi32(L)),
+            _mm256_cvttpd_epi32(H), 1
+        );
+    }
+
+    static PA_FORCE_INLINE __m256i convert(__m256i p){
+        const __m256i ONE = _mm256_set1_epi32(1);
+        const __m256i BYTE = _mm256_set1_epi32(0xff);
+
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 16), BYTE);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 8), BYTE);
+        __m256i b = _mm256_and_si256(p, BYTE);
+
+        __m256i M = _mm256_max_epi32(_mm256_max_epi32(r, g), b);
+        __m256i m = _mm256_min_epi32(_mm256_min_epi32(r, g), b);
+        __m256i delta = _mm256_sub_epi32(M, m);
+
+        //  S = 255 - (m*255 + M/2) / M
+        __m256i S = run_f64(
+            _mm256_add_epi32(_mm256_mullo_epi32(m, BYTE), _mm256_srli_epi32(M, 1)),
+            _mm256_max_epi32(M, ONE),
+            M,
+            [](__m256d num, __m256d den, __m256d){
+                return _mm256_div_pd(num, den);
+            }
+        );
+        S = _mm256_sub_epi32(BYTE, S);
+        S = _mm256_andnot_si256(_mm256_cmpeq_epi32(M, _mm256_setzero_si256()), S);
+
+        //  Pick the numerator and offset depending on which channel is the max.
+        __m256i is_r = _mm256_cmpeq_epi32(M, r);
+        __m256i is_g = _mm256_cmpeq_epi32(M, g);
+        __m256i num = _mm256_sub_epi32(r, g);
+        __m256i offset = _mm256_set1_epi32(4);
+        num = _mm256_blendv_epi8(num, _mm256_sub_epi32(b, r), is_g);
+        offset = _mm256_blendv_epi8(offset, _mm256_set1_epi32(2), is_g);
+        num = _mm256_blendv_epi8(num, _mm256_sub_epi32(g, b), is_r);
+        offset = _mm256_blendv_epi8(offset, _mm256_set1_epi32(6), is_r);
+
+        __m256i H = run_f64(
+            num, _mm256_max_epi32(delta, ONE), offset,
+            [](__m256d num, __m256d den, __m256d offset){
+                const __m256d SIX = _mm256_set1_pd(6.0);
+                __m256d Hf = _mm256_add_pd(_mm256_div_pd(num, den), offset);
+                Hf = _mm256_sub_pd(Hf, _mm256_and_pd(_mm256_cmp_pd(Hf, SIX, _CMP_GE_OQ), SIX));
+                Hf = _mm256_mul_pd(Hf, _mm256_set1_pd(256.0));
+                Hf = _mm256_div_pd(Hf, SIX);
+                return _mm256_add_pd(Hf, _mm256_set1_pd(0.5));
+            }
+        );
+        H = _mm256_and_si256(H, BYTE);
+        H = _mm256_andnot_si256(_mm256_cmpeq_epi32(delta, _mm256_setzero_si256()), H);
+
+        __m256i out = _mm256_and_si256(p, _mm256_set1_epi32(0xff000000));
+        out = _mm256_or_si256(out, _mm256_slli_epi32(H, 16));
+        out = _mm256_or_si256(out, _mm256_slli_epi32(S, 8));
+        out = _mm256_or_si256(out, M);
+        return out;
+    }
+    static PA_FORCE_INLINE void convert_vector(uint32_t* out, const uint32_t* in){
+        __m256i p = _mm256_loadu_si256((const __m256i*)in);
+        _mm256_storeu_si256((__m256i*)out, convert(p));
+    }
+};
+
+
+
+void convert_rgb32_to_hsv32_x64_AVX2(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+){
+    convert_rgb32_to_hsv32_rows<Rgb32ToHsv32_x64_AVX2>(
+        in, in_bytes_per_row, width, height,
+        out, out_bytes_per_row
+    );
+}
+
+
+
+}
+}
+#endif
@@ -0,0 +1,115 @@
+/*  Image Filters RGB32 to HSV32 (x64 AVX512)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_17_Skylake
+
+#include <immintrin.h>
+#include "Kernels_ImageFilter_RGB32_HSV32_Routines.h"
+#include "Kernels_ImageFilter_RGB32_HSV32.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+struct Rgb32ToHsv32_x64_AVX512{
+    static const size_t VECTOR_SIZE = 16;
+
+    //  Convert the 16 x int32 to 2 x 8 doubles, run "op" on each half and
+    //  convert back with truncation.
+    template <typename Op>
+    static PA_FORCE_INLINE __m512i run_f64(__m512i x0, __m512i x1, __m512i x2, Op&& op){
+        __m512d L = op(
+            _mm512_cvtepi32_pd(_mm512_castsi512_si256(x0)),
+            _mm512_cvtepi32_pd(_mm512_castsi512_si256(x1)),
+            _mm512_cvtepi32_pd(_mm512_castsi512_si256(x2))
+        );
+        __m512d H = op(
+            _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(x0, 1)),
+            _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(x1, 1)),
+            _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(x2, 1))
+        );
+        return _mm512_inserti64x4(
+            _mm512_castsi256_si512(_mm512_cvttpd_epi32(L)),
+            _mm512_cvttpd_epi32(H), 1
+        );
+    }
+
+    static PA_FORCE_INLINE __m512i convert(__m512i p){
+        const __m512i ONE = _mm512_set1_epi32(1);
+        const __m512i BYTE = _mm512_set1_epi32(0xff);
+
+        __m512i r = _mm512_and_si512(_mm512_srli_epi32(p, 16), BYTE);
+        __m512i g = _mm512_and_si512(_mm512_srli_epi32(p, 8), BYTE);
+        __m512i b = _mm512_and_si512(p, BYTE);
+
+        __m512i M = _mm512_max_epi32(_mm512_max_epi32(r, g), b);
+        __m512i m = _mm512_min_epi32(_mm512_min_epi32(r, g), b);
+        __m512i delta = _mm512_sub_epi32(M, m);
+
+        //  S = 255 - (m*255 + M/2) / M
+        __m512i S = run_f64(
+            _mm512_add_epi32(_mm512_mullo_epi32(m, BYTE), _mm512_srli_epi32(M, 1)),
+            _mm512_max_epi32(M, ONE),
+            M,
+            [](__m512d num, __m512d den, __m512d){
+                return _mm512_div_pd(num, den);
+            }
+        );
+        S = _mm512_maskz_sub_epi32(_mm512_test_epi32_mask(M, M), BYTE, S);
+
+        //  Pick the numerator and offset depending on which channel is the max.
+        __mmask16 is_r = _mm512_cmpeq_epi32_mask(M, r);
+        __mmask16 is_g = _mm512_cmpeq_epi32_mask(M, g);
+        __m512i num = _mm512_sub_epi32(r, g);
+        __m512i offset = _mm512_set1_epi32(4);
+        num = _mm512_mask_sub_epi32(num, is_g, b, r);
+        offset = _mm512_mask_mov_epi32(offset, is_g, _mm512_set1_epi32(2));
+        num = _mm512_mask_sub_epi32(num, is_r, g, b);
+        offset = _mm512_mask_mov_epi32(offset, is_r, _mm512_set1_epi32(6));
+
+        __m512i H = run_f64(
+            num, _mm512_max_epi32(delta, ONE), offset,
+            [](__m512d num, __m512d den, __m512d offset){
+                const __m512d SIX = _mm512_set1_pd(6.0);
+                __m512d Hf = _mm512_add_pd(_mm512_div_pd(num, den), offset);
+                Hf = _mm512_mask_sub_pd(Hf, _mm512_cmp_pd_mask(Hf, SIX, _CMP_GE_OQ), Hf, SIX);
+                Hf = _mm512_mul_pd(Hf, _mm512_set1_pd(256.0));
+                Hf = _mm512_div_pd(Hf, SIX);
+                return _mm512_add_pd(Hf, _mm512_set1_pd(0.5));
+            }
+        );
+        H = _mm512_maskz_and_epi32(_mm512_test_epi32_mask(delta, delta), H, BYTE);
+
+        __m512i out = _mm512_and_si512(p, _mm512_set1_epi32(0xff000000));
+        out = _mm512_or_si512(out, _mm512_slli_epi32(H, 16));
+        out = _mm512_or_si512(out, _mm512_slli_epi32(S, 8));
+        out = _mm512_or_si512(out, M);
+        return out;
+    }
+    static PA_FORCE_INLINE void convert_vector(uint32_t* out, const uint32_t* in){
+        __m512i p = _mm512_loadu_si512((const __m512i*)in);
+        _mm512_storeu_si512((__m512i*)out, convert(p));
+    }
+};
+
+
+
+void convert_rgb32_to_hsv32_x64_AVX512(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+){
+    convert_rgb32_to_hsv32_rows<Rgb32ToHsv32_x64_AVX512>(
+        in, in_bytes_per_row, width, height,
+        out, out_bytes_per_row
+    );
+}
+
+
+
+}
+}
+#endif
@@ -0,0 +1,114 @@
+/*  Image Filters RGB32 to HSV32 (x64 SSE4.1)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+
+#include <smmintrin.h>
+#include "Kernels_ImageFilter_RGB32_HSV32_Routines.h"
+#include "Kernels_ImageFilter_RGB32_HSV32.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+struct Rgb32ToHsv32_x64_SSE41{
+    static const size_t VECTOR_SIZE = 4;
+
+    //  Convert the 4 x int32 to 2 x 2 doubles, run "op" on each half and
+    //  convert back with truncation.
+    template <typename Op>
+    static PA_FORCE_INLINE __m128i run_f64(__m128i x0, __m128i x1, __m128i x2, Op&& op){
+        __m128d L = op(
+            _mm_cvtepi32_pd(x0),
+            _mm_cvtepi32_pd(x1),
+            _mm_cvtepi32_pd(x2)
+        );
+        __m128d H = op(
+            _mm_cvtepi32_pd(_mm_shuffle_epi32(x0, 0xee)),
+            _mm_cvtepi32_pd(_mm_shuffle_epi32(x1, 0xee)),
+            _mm_cvtepi32_pd(_mm_shuffle_epi32(x2, 0xee))
+        );
+        return _mm_unpacklo_epi64(_mm_cvttpd_epi32(L), _mm_cvttpd_epi32(H));
+    }
+
+    static PA_FORCE_INLINE __m128i convert(__m128i p){
+        const __m128i ONE = _mm_set1_epi32(1);
+        const __m128i BYTE = _mm_set1_epi32(0xff);
+
+        __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), BYTE);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(p, 8), BYTE);
+        __m128i b = _mm_and_si128(p, BYTE);
+
+        __m128i M = _mm_max_epi32(_mm_max_epi32(r, g), b);
+        __m128i m = _mm_min_epi32(_mm_min_epi32(r, g), b);
+        __m128i delta = _mm_sub_epi32(M, m);
+
+        //  S = 255 - (m*255 + M/2) / M
+        __m128i S = run_f64(
+            _mm_add_epi32(_mm_mullo_epi32(m, BYTE), _mm_srli_epi32(M, 1)),
+            _mm_max_epi32(M, ONE),
+            M,
+            [](__m128d num, __m128d den, __m128d){
+                return _mm_div_pd(num, den);
+            }
+        );
+        S = _mm_sub_epi32(BYTE, S);
+        S = _mm_andnot_si128(_mm_cmpeq_epi32(M, _mm_setzero_si128()), S);
+
+        //  Pick the numerator and offset depending on which channel is the max.
+        __m128i is_r = _mm_cmpeq_epi32(M, r);
+        __m128i is_g = _mm_cmpeq_epi32(M, g);
+        __m128i num = _mm_sub_epi32(r, g);
+        __m128i offset = _mm_set1_epi32(4);
+        num = _mm_blendv_epi8(num, _mm_sub_epi32(b, r), is_g);
+        offset = _mm_blendv_epi8(offset, _mm_set1_epi32(2), is_g);
+        num = _mm_blendv_epi8(num, _mm_sub_epi32(g, b), is_r);
+        offset = _mm_blendv_epi8(offset, _mm_set1_epi32(6), is_r);
+
+        __m128i H = run_f64(
+            num, _mm_max_epi32(delta, ONE), offset,
+            [](__m128d num, __m128d den, __m128d offset){
+                const __m128d SIX = _mm_set1_pd(6.0);
+                __m128d Hf = _mm_add_pd(_mm_div_pd(num, den), offset);
+                Hf = _mm_sub_pd(Hf, _mm_and_pd(_mm_cmpge_pd(Hf, SIX), SIX));
+                Hf = _mm_mul_pd(Hf, _mm_set1_pd(256.0));
+                Hf = _mm_div_pd(Hf, SIX);
+                return _mm_add_pd(Hf, _mm_set1_pd(0.5));
+            }
+        );
+        H = _mm_and_si128(H, BYTE);
+        H = _mm_andnot_si128(_mm_cmpeq_epi32(delta, _mm_setzero_si128()), H);
+
+        __m128i out = _mm_and_si128(p, _mm_set1_epi32(0xff000000));
+        out = _mm_or_si128(out, _mm_slli_epi32(H, 16));
+        out = _mm_or_si128(out, _mm_slli_epi32(S, 8));
+        out = _mm_or_si128(out, M);
+        return out;
+    }
+    static PA_FORCE_INLINE void convert_vector(uint32_t* out, const uint32_t* in){
+        __m128i p = _mm_loadu_si128((const __m128i*)in);
+        _mm_storeu_si128((__m128i*)out, convert(p));
+    }
+};
+
+
+
+void convert_rgb32_to_hsv32_x64_SSE41(
+    const uint32_t* in, size_t in_bytes_per_row, size_t width, size_t height,
+    uint32_t* out, size_t out_bytes_per_row
+){
+    convert_rgb32_to_hsv32_rows<Rgb32ToHsv32_x64_SSE41>(
+        in, in_bytes_per_row, width, height,
+        out, out_bytes_per_row
+    );
+}
+
+
+
+}
+}
+#endif
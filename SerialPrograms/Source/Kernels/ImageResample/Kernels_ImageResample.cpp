@@ -0,0 +1,261 @@
+/*  Image Resample
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "Common/Cpp/CpuId/CpuId.h"
+#include "Kernels_ImageResample.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+//  Vertical pass: accumulator[0 .. 4*width) = sum(rows[k][...] * weights[k])
+void resample_vertical_Default(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+);
+void resample_vertical_x64_SSE41(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+);
+void resample_vertical_x64_AVX2(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+);
+void resample_vertical_arm64_NEON(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+);
+
+//  Horizontal pass: out[i] = sum(accumulator[start[i] + k] * weights[offset[i] + k])
+void resample_horizontal_Default(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+);
+void resample_horizontal_x64_SSE41(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+);
+void resample_horizontal_x64_AVX2(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+);
+void resample_horizontal_arm64_NEON(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+);
+
+
+
+void resample_vertical(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+){
+#ifdef PA_AutoDispatch_x64_13_Haswell
+    if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+        resample_vertical_x64_AVX2(accumulator, width, rows, weights, taps);
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+    if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+        resample_vertical_x64_SSE41(accumulator, width, rows, weights, taps);
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_arm64_20_M1
+    if (CPU_CAPABILITY_CURRENT.OK_M1){
+        resample_vertical_arm64_NEON(accumulator, width, rows, weights, taps);
+        return;
+    }
+#endif
+    resample_vertical_Default(accumulator, width, rows, weights, taps);
+}
+void resample_horizontal(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+){
+#ifdef PA_AutoDispatch_x64_13_Haswell
+    if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+        resample_horizontal_x64_AVX2(out, width, accumulator, start, offset, weights);
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+    if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+        resample_horizontal_x64_SSE41(out, width, accumulator, start, offset, weights);
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_arm64_20_M1
+    if (CPU_CAPABILITY_CURRENT.OK_M1){
+        resample_horizontal_arm64_NEON(out, width, accumulator, start, offset, weights);
+        return;
+    }
+#endif
+    resample_horizontal_Default(out, width, accumulator, start, offset, weights);
+}
+
+
+
+void ImageResampler::Taps::build(ResampleFilter filter, size_t in_size, size_t out_size){
+    start.resize(out_size);
+    offset.resize(out_size + 1);
+    weights.clear();
+
+    double scale = (double)in_size / (double)out_size;
+
+    for (size_t i = 0; i < out_size; i++){
+        offset[i] = (uint32_t)weights.size();
+        switch (filter){
+        case ResampleFilter::NEAREST:{
+            start[i] = (uint32_t)(((2*i + 1) * in_size) / (2 * out_size));
+            weights.emplace_back(1.0f);
+            break;
+        }
+        case ResampleFilter::BILINEAR:{
+            double f = ((double)i + 0.5) * scale - 0.5;
+            double s = std::floor(f);
+            f -= s;
+            if (s < 0){
+                s = 0;
+                f = 0;
+            }
+            if (s >= (double)(in_size - 1)){
+                s = (double)(in_size - 1);
+                f = 0;
+            }
+            start[i] = (uint32_t)s;
+            weights.emplace_back((float)(1 - f));
+            if (f != 0){
+                weights.emplace_back((float)f);
+            }
+            break;
+        }
+        case ResampleFilter::AREA:{
+            double lo = (double)i * scale;
+            double hi = lo + scale;
+            size_t first = std::min((size_t)lo, in_size - 1);
+            size_t last = std::min((size_t)std::ceil(hi), in_size);
+            last = std::max(last, first + 1);
+            start[i] = (uint32_t)first;
+            for (size_t c = first; c < last; c++){
+                double coverage = std::min(hi, (double)(c + 1)) - std::max(lo, (double)c);
+                weights.emplace_back((float)(std::max(coverage, 0.) / scale));
+            }
+            break;
+        }
+        }
+    }
+    offset[out_size] = (uint32_t)weights.size();
+}
+
+void ImageResampler::update_tables(
+    ResampleFilter filter,
+    size_t in_width, size_t in_height,
+    size_t out_width, size_t out_height
+){
+    if (m_valid &&
+        m_filter == filter &&
+        m_in_width == in_width && m_in_height == in_height &&
+        m_out_width == out_width && m_out_height == out_height
+    ){
+        return;
+    }
+
+    if (!m_valid || m_filter != filter || m_in_width != in_width || m_out_width != out_width){
+        m_x.build(filter, in_width, out_width);
+    }
+    if (!m_valid || m_filter != filter || m_in_height != in_height || m_out_height != out_height){
+        m_y.build(filter, in_height, out_height);
+    }
+
+    m_filter = filter;
+    m_in_width = in_width;
+    m_in_height = in_height;
+    m_out_width = out_width;
+    m_out_height = out_height;
+    m_valid = true;
+}
+
+void ImageResampler::resample(
+    ResampleFilter filter,
+    const uint32_t* in, size_t in_bytes_per_row, size_t in_width, size_t in_height,
+    uint32_t* out, size_t out_bytes_per_row, size_t out_width, size_t out_height
+){
+    if (in_width == 0 || in_height == 0 || out_width == 0 || out_height == 0){
+        return;
+    }
+
+    //  Same size is a straight copy for all filters.
+    if (in_width == out_width && in_height == out_height){
+        for (size_t r = 0; r < out_height; r++){
+            std::copy(in, in + in_width, out);
+            in = (const uint32_t*)((const char*)in + in_bytes_per_row);
+            out = (uint32_t*)((char*)out + out_bytes_per_row);
+        }
+        return;
+    }
+
+    update_tables(filter, in_width, in_height, out_width, out_height);
+
+    //  Nearest neighbor doesn't need the float passes.
+    if (filter == ResampleFilter::NEAREST){
+        const uint32_t* x_start = m_x.start.data();
+        for (size_t r = 0; r < out_height; r++){
+            const uint32_t* row = (const uint32_t*)((const char*)in + m_y.start[r] * in_bytes_per_row);
+            for (size_t c = 0; c < out_width; c++){
+                out[c] = row[x_start[c]];
+            }
+            out = (uint32_t*)((char*)out + out_bytes_per_row);
+        }
+        return;
+    }
+
+    if (m_accumulator.size() < 4 * in_width){
+        m_accumulator.resize(4 * in_width);
+    }
+
+    for (size_t r = 0; r < out_height; r++){
+        size_t first = m_y.start[r];
+        size_t taps = m_y.offset[r + 1] - m_y.offset[r];
+        m_rows.resize(taps);
+        for (size_t k = 0; k < taps; k++){
+            m_rows[k] = (const uint32_t*)((const char*)in + (first + k) * in_bytes_per_row);
+        }
+        resample_vertical(
+            m_accumulator.data(), in_width,
+            m_rows.data(), m_y.weights.data() + m_y.offset[r], taps
+        );
+        resample_horizontal(
+            out, out_width, m_accumulator.data(),
+            m_x.start.data(), m_x.offset.data(), m_x.weights.data()
+        );
+        out = (uint32_t*)((char*)out + out_bytes_per_row);
+    }
+}
+
+
+
+void resample(
+    ResampleFilter filter,
+    const uint32_t* in, size_t in_bytes_per_row, size_t in_width, size_t in_height,
+    uint32_t* out, size_t out_bytes_per_row, size_t out_width, size_t out_height
+){
+    ImageResampler resampler;
+    resampler.resample(
+        filter,
+        in, in_bytes_per_row, in_width, in_height,
+        out, out_bytes_per_row, out_width, out_height
+    );
+}
+
+
+
+}
+}
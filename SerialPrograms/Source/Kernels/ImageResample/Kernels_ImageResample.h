@@ -0,0 +1,104 @@
+/*  Image Resample
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *      Resize an ARGB32 image directly from one strided buffer into another.
+ *
+ *  The filter is separable. Each output row is formed by blending the
+ *  contributing input rows into a float accumulator (vertical pass) and then
+ *  blending columns of the accumulator into the output row (horizontal pass).
+ *  Both passes are ISA-dispatched.
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageResample_H
+#define PokemonAutomation_Kernels_ImageResample_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+enum class ResampleFilter{
+    //  Sample the input pixel under the center of each output pixel.
+    NEAREST,
+
+    //  Bilinear interpolation. Same pixel-center convention as OpenCV's
+    //  INTER_LINEAR. Aliases when shrinking by more than 2x.
+    BILINEAR,
+
+    //  Average of all input pixels covered by each output pixel, weighted by
+    //  coverage. Best for shrinking.
+    AREA,
+};
+
+
+
+//  Holds the filter tables and scratch space for resampling.
+//
+//  Keep one of these around when resizing many images with the same
+//  dimensions. The tables are only rebuilt when the filter or dimensions
+//  change, and the scratch buffers are only reallocated when they grow.
+//
+//  Not thread-safe. Use one per thread.
+class ImageResampler{
+public:
+    //  All channels (including alpha) are resampled independently.
+    //  Input and output must not overlap.
+    void resample(
+        ResampleFilter filter,
+        const uint32_t* in, size_t in_bytes_per_row, size_t in_width, size_t in_height,
+        uint32_t* out, size_t out_bytes_per_row, size_t out_width, size_t out_height
+    );
+
+private:
+    //  Contributions for each output index along one axis.
+    //  Output index "i" reads input indices [start[i], start[i] + offset[i + 1] - offset[i])
+    //  with weights [offset[i], offset[i + 1]).
+    struct Taps{
+        std::vector<uint32_t> start;
+        std::vector<uint32_t> offset;
+        std::vector<float> weights;
+
+        void build(ResampleFilter filter, size_t in_size, size_t out_size);
+    };
+
+private:
+    void update_tables(
+        ResampleFilter filter,
+        size_t in_width, size_t in_height,
+        size_t out_width, size_t out_height
+    );
+
+private:
+    bool m_valid = false;
+    ResampleFilter m_filter = ResampleFilter::NEAREST;
+    size_t m_in_width = 0;
+    size_t m_in_height = 0;
+    size_t m_out_width = 0;
+    size_t m_out_height = 0;
+
+    Taps m_x;
+    Taps m_y;
+
+    std::vector<float> m_accumulator;
+    std::vector<const uint32_t*> m_rows;
+};
+
+
+
+//  Convenience wrapper for one-off resizes.
+void resample(
+    ResampleFilter filter,
+    const uint32_t* in, size_t in_bytes_per_row, size_t in_width, size_t in_height,
+    uint32_t* out, size_t out_bytes_per_row, size_t out_width, size_t out_height
+);
+
+
+
+}
+}
+#endif
@@ -0,0 +1,74 @@
+/*  Image Resample (Default)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include "Common/Compiler.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+void resample_vertical_Default(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+){
+    for (size_t c = 0; c < width; c++){
+        float sum0 = 0;
+        float sum1 = 0;
+        float sum2 = 0;
+        float sum3 = 0;
+        for (size_t k = 0; k < taps; k++){
+            uint32_t pixel = rows[k][c];
+            float weight = weights[k];
+            sum0 += (float)((pixel >>  0) & 0xff) * weight;
+            sum1 += (float)((pixel >>  8) & 0xff) * weight;
+            sum2 += (float)((pixel >> 16) & 0xff) * weight;
+            sum3 += (float)((pixel >> 24) & 0xff) * weight;
+        }
+        accumulator[4*c + 0] = sum0;
+        accumulator[4*c + 1] = sum1;
+        accumulator[4*c + 2] = sum2;
+        accumulator[4*c + 3] = sum3;
+    }
+}
+
+
+PA_FORCE_INLINE uint32_t resample_pack_channel(float x){
+    x = std::min(x, 255.f);
+    x = std::max(x, 0.f);
+    return (uint32_t)(x + 0.5f);
+}
+void resample_horizontal_Default(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+){
+    for (size_t c = 0; c < width; c++){
+        const float* ptr = accumulator + 4 * (size_t)start[c];
+        const float* weight = weights + offset[c];
+        size_t taps = offset[c + 1] - offset[c];
+        float sum0 = 0;
+        float sum1 = 0;
+        float sum2 = 0;
+        float sum3 = 0;
+        for (size_t k = 0; k < taps; k++){
+            sum0 += ptr[4*k + 0] * weight[k];
+            sum1 += ptr[4*k + 1] * weight[k];
+            sum2 += ptr[4*k + 2] * weight[k];
+            sum3 += ptr[4*k + 3] * weight[k];
+        }
+        out[c] = resample_pack_channel(sum0) << 0
+               | resample_pack_channel(sum1) << 8
+               | resample_pack_channel(sum2) << 16
+               | resample_pack_channel(sum3) << 24;
+    }
+}
+
+
+
+}
+}
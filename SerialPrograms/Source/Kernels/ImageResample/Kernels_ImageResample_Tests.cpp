@@ -0,0 +1,346 @@
+/*  Image Resample Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <vector>
+#include <sstream>
+#include "Common/Cpp/PrettyPrint.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "Kernels_ImageResample.h"
+#include "Kernels_ImageResample_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+const char* resample_filter_name(ResampleFilter filter){
+    switch (filter){
+    case ResampleFilter::NEAREST:   return "Nearest";
+    case ResampleFilter::BILINEAR:  return "Bilinear";
+    case ResampleFilter::AREA:      return "Area";
+    }
+    return "Unknown";
+}
+
+//  Returns true if every channel of "actual" is within "tolerance" of "expected".
+bool resample_pixel_close(uint32_t actual, uint32_t expected, int tolerance){
+    for (size_t c = 0; c < 4; c++){
+        int diff = (int)((actual >> (8*c)) & 0xff) - (int)((expected >> (8*c)) & 0xff);
+        if (diff < -tolerance || diff > tolerance){
+            return false;
+        }
+    }
+    return true;
+}
+
+//  Resample into a padded output. Returns an error if anything was written
+//  past the end of a row.
+std::string resample_padded(
+    ImageResampler& resampler, ResampleFilter filter,
+    const std::vector<uint32_t>& in, size_t in_stride, size_t in_width, size_t in_height,
+    std::vector<uint32_t>& out, size_t out_stride, size_t out_width, size_t out_height
+){
+    const uint32_t UNTOUCHED = 0xdeadbeef;
+    out.assign(out_stride * out_height, UNTOUCHED);
+    resampler.resample(
+        filter,
+        in.data(), in_stride * sizeof(uint32_t), in_width, in_height,
+        out.data(), out_stride * sizeof(uint32_t), out_width, out_height
+    );
+    for (size_t y = 0; y < out_height; y++){
+        for (size_t x = out_width; x < out_stride; x++){
+            if (out[y * out_stride + x] != UNTOUCHED){
+                return std::string("Error: ") + resample_filter_name(filter) + " wrote past the end of a row.";
+            }
+        }
+    }
+    return "";
+}
+
+
+
+//  Small cases worked out by hand. Each pixel is a gray level repeated in all
+//  four channels.
+class Test_ImageResample_Examples : public UnitTest{
+public:
+    Test_ImageResample_Examples()
+        : UnitTest("Kernels::ImageResample - Examples")
+    {}
+
+    struct Example{
+        ResampleFilter filter;
+        size_t in_width;
+        size_t in_height;
+        std::vector<uint8_t> in;
+        size_t out_width;
+        size_t out_height;
+        std::vector<uint8_t> expected;
+    };
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const Example EXAMPLES[] = {
+            //  Nearest picks the input pixel under each output pixel center.
+            {ResampleFilter::NEAREST, 4, 1, {10, 20, 30, 40}, 2, 1, {20, 40}},
+            {ResampleFilter::NEAREST, 2, 1, {10, 20}, 4, 1, {10, 10, 20, 20}},
+            {ResampleFilter::NEAREST, 3, 3, {1, 2, 3, 4, 5, 6, 7, 8, 9}, 1, 1, {5}},
+
+            //  Output centers at input positions -0.25, 0.25, 0.75, 1.25.
+            //  The ends clamp. 0.25 * 255 = 63.75 and 0.75 * 255 = 191.25.
+            {ResampleFilter::BILINEAR, 2, 1, {0, 255}, 4, 1, {0, 64, 191, 255}},
+            {ResampleFilter::BILINEAR, 1, 2, {0, 255}, 1, 4, {0, 64, 191, 255}},
+
+            //  Halving puts each output center between two input pixels.
+            {ResampleFilter::BILINEAR, 4, 1, {10, 20, 100, 200}, 2, 1, {15, 150}},
+            {ResampleFilter::BILINEAR, 2, 2, {0, 100, 200, 40}, 1, 1, {85}},
+
+            //  Output centers at input positions 0.25 and 1.75.
+            {ResampleFilter::BILINEAR, 3, 1, {0, 100, 200}, 2, 1, {25, 175}},
+
+            //  Output pixels cover [0, 1.5) and [1.5, 3) of the input.
+            {ResampleFilter::AREA, 3, 1, {0, 90, 180}, 2, 1, {30, 150}},
+            {ResampleFilter::AREA, 1, 3, {0, 90, 180}, 1, 2, {30, 150}},
+
+            //  The middle output pixel covers half of each input pixel.
+            {ResampleFilter::AREA, 2, 1, {0, 100}, 3, 1, {0, 50, 100}},
+
+            //  2x2 block averages.
+            {ResampleFilter::AREA, 4, 2, {0, 10, 20, 30, 40, 50, 60, 70}, 2, 1, {25, 45}},
+        };
+
+        ImageResampler resampler;
+        for (const Example& example : EXAMPLES){
+            std::vector<uint32_t> in;
+            for (uint8_t gray : example.in){
+                in.emplace_back(gray * (uint32_t)0x01010101);
+            }
+            std::vector<uint32_t> out;
+            std::string error = resample_padded(
+                resampler, example.filter,
+                in, example.in_width, example.in_width, example.in_height,
+                out, example.out_width + 1, example.out_width, example.out_height
+            );
+            if (!error.empty()){
+                return error;
+            }
+            for (size_t y = 0; y < example.out_height; y++){
+                for (size_t x = 0; x < example.out_width; x++){
+                    uint32_t actual = out[y * (example.out_width + 1) + x];
+                    uint32_t expected = example.expected[y * example.out_width + x] * (uint32_t)0x01010101;
+                    if (actual != expected){
+                        std::stringstream ss;
+                        ss << "Error: " << resample_filter_name(example.filter) << " "
+                           << example.in_width << "x" << example.in_height << " -> "
+                           << example.out_width << "x" << example.out_height
+                           << " at (" << x << ", " << y << "): " << tostr_hex(actual)
+                           << ", expected " << tostr_hex(expected);
+                        return ss.str();
+                    }
+                }
+            }
+        }
+
+        return true;
+    };
+};
+
+
+
+//  Check properties that follow from the definition of each filter on random
+//  sizes, strides and pixels. Each check is computed independently of the
+//  filter tables. SIMD paths may use FMA, so allow each channel to be off by
+//  one where the result is not a straight copy.
+class Test_ImageResample_Properties : public UnitTest{
+public:
+    Test_ImageResample_Properties()
+        : UnitTest("Kernels::ImageResample - Properties")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const ResampleFilter FILTERS[] = {
+            ResampleFilter::NEAREST,
+            ResampleFilter::BILINEAR,
+            ResampleFilter::AREA,
+        };
+
+        TestRandom random;
+        ImageResampler resampler;
+        std::vector<uint32_t> out;
+
+        auto fail = [](ResampleFilter filter, const char* property, size_t x, size_t y, uint32_t actual, uint32_t expected){
+            std::stringstream ss;
+            ss << "Error: " << resample_filter_name(filter) << " " << property
+               << " at (" << x << ", " << y << "): " << tostr_hex(actual)
+               << ", expected " << tostr_hex(expected);
+            return ss.str();
+        };
+
+        for (size_t trial = 0; trial < 100; trial++){
+            size_t in_width = 1 + random() % 80;
+            size_t in_height = 1 + random() % 80;
+            size_t out_width = 1 + random() % 80;
+            size_t out_height = 1 + random() % 80;
+            size_t in_stride = in_width + random() % 5;
+            size_t out_stride = out_width + random() % 5;
+
+            for (ResampleFilter filter : FILTERS){
+                //  A solid color stays the same color.
+                uint32_t color = random.pixel();
+                std::vector<uint32_t> solid(in_stride * in_height, color);
+                std::string error = resample_padded(
+                    resampler, filter,
+                    solid, in_stride, in_width, in_height,
+                    out, out_stride, out_width, out_height
+                );
+                if (!error.empty()){
+                    return error;
+                }
+                for (size_t y = 0; y < out_height; y++){
+                    for (size_t x = 0; x < out_width; x++){
+                        uint32_t actual = out[y * out_stride + x];
+                        if (!resample_pixel_close(actual, color, 1)){
+                            return fail(filter, "solid color", x, y, actual, color);
+                        }
+                    }
+                }
+
+                //  Same size is an exact copy.
+                std::vector<uint32_t> in = make_random_image(random, in_stride, in_height);
+                size_t copy_stride = in_width + (out_stride - out_width);
+                error = resample_padded(
+                    resampler, filter,
+                    in, in_stride, in_width, in_height,
+                    out, copy_stride, in_width, in_height
+                );
+                if (!error.empty()){
+                    return error;
+                }
+                for (size_t y = 0; y < in_height; y++){
+                    for (size_t x = 0; x < in_width; x++){
+                        uint32_t actual = out[y * copy_stride + x];
+                        uint32_t expected = in[y * in_stride + x];
+                        if (actual != expected){
+                            return fail(filter, "copy", x, y, actual, expected);
+                        }
+                    }
+                }
+
+                //  Area preserves the mean of each channel up to rounding.
+                if (filter != ResampleFilter::AREA){
+                    continue;
+                }
+                error = resample_padded(
+                    resampler, filter,
+                    in, in_stride, in_width, in_height,
+                    out, out_stride, out_width, out_height
+                );
+                if (!error.empty()){
+                    return error;
+                }
+                for (size_t c = 0; c < 4; c++){
+                    double in_sum = 0;
+                    for (size_t y = 0; y < in_height; y++){
+                        for (size_t x = 0; x < in_width; x++){
+                            in_sum += (in[y * in_stride + x] >> (8*c)) & 0xff;
+                        }
+                    }
+                    double out_sum = 0;
+                    for (size_t y = 0; y < out_height; y++){
+                        for (size_t x = 0; x < out_width; x++){
+                            out_sum += (out[y * out_stride + x] >> (8*c)) & 0xff;
+                        }
+                    }
+                    double in_mean = in_sum / (in_width * in_height);
+                    double out_mean = out_sum / (out_width * out_height);
+                    if (out_mean < in_mean - 1 || out_mean > in_mean + 1){
+                        std::stringstream ss;
+                        ss << "Error: Area " << in_width << "x" << in_height << " -> " << out_width << "x" << out_height
+                           << " channel " << c << " mean is " << out_mean << ", expected " << in_mean;
+                        return ss.str();
+                    }
+                }
+            }
+
+            //  Integer scale factors.
+            size_t kx = 1 + random() % 4;
+            size_t ky = 1 + random() % 4;
+            size_t small_width = 1 + random() % 20;
+            size_t small_height = 1 + random() % 20;
+            size_t large_width = small_width * kx;
+            size_t large_height = small_height * ky;
+
+            //  Nearest enlarges by repeating each pixel.
+            std::vector<uint32_t> small = make_random_image(random, small_width, small_height);
+            std::string error = resample_padded(
+                resampler, ResampleFilter::NEAREST,
+                small, small_width, small_width, small_height,
+                out, large_width + 1, large_width, large_height
+            );
+            if (!error.empty()){
+                return error;
+            }
+            for (size_t y = 0; y < large_height; y++){
+                for (size_t x = 0; x < large_width; x++){
+                    uint32_t actual = out[y * (large_width + 1) + x];
+                    uint32_t expected = small[(y / ky) * small_width + x / kx];
+                    if (actual != expected){
+                        return fail(ResampleFilter::NEAREST, "integer enlarge", x, y, actual, expected);
+                    }
+                }
+            }
+
+            //  Area shrinks by averaging each block. So does bilinear when
+            //  halving since each output center lies between two pixels.
+            std::vector<uint32_t> large = make_random_image(random, large_width, large_height);
+            for (ResampleFilter filter : {ResampleFilter::AREA, ResampleFilter::BILINEAR}){
+                if (filter == ResampleFilter::BILINEAR && (kx != 2 || ky != 2)){
+                    continue;
+                }
+                error = resample_padded(
+                    resampler, filter,
+                    large, large_width, large_width, large_height,
+                    out, small_width + 1, small_width, small_height
+                );
+                if (!error.empty()){
+                    return error;
+                }
+                for (size_t y = 0; y < small_height; y++){
+                    for (size_t x = 0; x < small_width; x++){
+                        uint32_t expected = 0;
+                        for (size_t c = 0; c < 4; c++){
+                            uint32_t sum = 0;
+                            for (size_t j = 0; j < ky; j++){
+                                for (size_t i = 0; i < kx; i++){
+                                    sum += (large[(y * ky + j) * large_width + x * kx + i] >> (8*c)) & 0xff;
+                                }
+                            }
+                            uint32_t count = (uint32_t)(kx * ky);
+                            expected |= ((2 * sum + count) / (2 * count)) << (8*c);
+                        }
+                        uint32_t actual = out[y * (small_width + 1) + x];
+                        if (!resample_pixel_close(actual, expected, 1)){
+                            return fail(filter, "block average", x, y, actual, expected);
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
+    };
+};
+
+
+
+void add_tests_ImageResample(UnitTestDatabase& database){
+    database.add<Test_ImageResample_Examples>();
+    database.add<Test_ImageResample_Properties>();
+}
+
+
+
+}
+}
@@ -0,0 +1,23 @@
+/*  Image Resample Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImageResample_Tests_H
+#define PokemonAutomation_Kernels_ImageResample_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void add_tests_ImageResample(UnitTestDatabase& database);
+
+
+
+}
+}
+#endif
@@ -0,0 +1,80 @@
+/*  Image Resample (arm64 NEON)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_arm64_20_M1
+
+#include <stdint.h>
+#include <stddef.h>
+#include <arm_neon.h>
+#include "Common/Compiler.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+void resample_vertical_arm64_NEON(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+){
+    size_t c = 0;
+    for (; c + 4 <= width; c += 4){
+        float32x4_t sum0 = vdupq_n_f32(0);
+        float32x4_t sum1 = vdupq_n_f32(0);
+        float32x4_t sum2 = vdupq_n_f32(0);
+        float32x4_t sum3 = vdupq_n_f32(0);
+        for (size_t k = 0; k < taps; k++){
+            float weight = weights[k];
+            uint8x16_t pixels = vreinterpretq_u8_u32(vld1q_u32(rows[k] + c));
+            uint16x8_t lo = vmovl_u8(vget_low_u8(pixels));
+            uint16x8_t hi = vmovl_u8(vget_high_u8(pixels));
+            sum0 = vfmaq_n_f32(sum0, vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), weight);
+            sum1 = vfmaq_n_f32(sum1, vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), weight);
+            sum2 = vfmaq_n_f32(sum2, vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), weight);
+            sum3 = vfmaq_n_f32(sum3, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), weight);
+        }
+        vst1q_f32(accumulator + 4*c +  0, sum0);
+        vst1q_f32(accumulator + 4*c +  4, sum1);
+        vst1q_f32(accumulator + 4*c +  8, sum2);
+        vst1q_f32(accumulator + 4*c + 12, sum3);
+    }
+    for (; c < width; c++){
+        float32x4_t sum = vdupq_n_f32(0);
+        for (size_t k = 0; k < taps; k++){
+            uint8x8_t pixel = vreinterpret_u8_u32(vdup_n_u32(rows[k][c]));
+            uint16x4_t channels = vget_low_u16(vmovl_u8(pixel));
+            sum = vfmaq_n_f32(sum, vcvtq_f32_u32(vmovl_u16(channels)), weights[k]);
+        }
+        vst1q_f32(accumulator + 4*c, sum);
+    }
+}
+
+
+void resample_horizontal_arm64_NEON(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+){
+    for (size_t c = 0; c < width; c++){
+        const float* ptr = accumulator + 4 * (size_t)start[c];
+        const float* weight = weights + offset[c];
+        size_t taps = offset[c + 1] - offset[c];
+        float32x4_t sum = vdupq_n_f32(0);
+        for (size_t k = 0; k < taps; k++){
+            sum = vfmaq_n_f32(sum, vld1q_f32(ptr + 4*k), weight[k]);
+        }
+        sum = vminq_f32(sum, vdupq_n_f32(255.f));
+        sum = vmaxq_f32(sum, vdupq_n_f32(0));
+        uint32x4_t i = vcvtq_u32_f32(vaddq_f32(sum, vdupq_n_f32(0.5f)));
+        uint16x4_t s = vmovn_u32(i);
+        uint8x8_t b = vmovn_u16(vcombine_u16(s, s));
+        out[c] = vget_lane_u32(vreinterpret_u32_u8(b), 0);
+    }
+}
+
+
+
+}
+}
+#endif
@@ -0,0 +1,109 @@
+/*  Image Resample (x64 AVX2)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_13_Haswell
+
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+#include "Common/Compiler.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+//  Load 2 pixels and expand them to 8 floats.
+PA_FORCE_INLINE __m256 resample_load_2pixels_x64_AVX2(const uint32_t* ptr){
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)ptr)));
+}
+
+void resample_vertical_x64_AVX2(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+){
+    size_t c = 0;
+    for (; c + 8 <= width; c += 8){
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        __m256 sum2 = _mm256_setzero_ps();
+        __m256 sum3 = _mm256_setzero_ps();
+        for (size_t k = 0; k < taps; k++){
+            __m256 weight = _mm256_set1_ps(weights[k]);
+            const uint32_t* row = rows[k] + c;
+            sum0 = _mm256_fmadd_ps(resample_load_2pixels_x64_AVX2(row + 0), weight, sum0);
+            sum1 = _mm256_fmadd_ps(resample_load_2pixels_x64_AVX2(row + 2), weight, sum1);
+            sum2 = _mm256_fmadd_ps(resample_load_2pixels_x64_AVX2(row + 4), weight, sum2);
+            sum3 = _mm256_fmadd_ps(resample_load_2pixels_x64_AVX2(row + 6), weight, sum3);
+        }
+        _mm256_storeu_ps(accumulator + 4*c +  0, sum0);
+        _mm256_storeu_ps(accumulator + 4*c +  8, sum1);
+        _mm256_storeu_ps(accumulator + 4*c + 16, sum2);
+        _mm256_storeu_ps(accumulator + 4*c + 24, sum3);
+    }
+    for (; c + 2 <= width; c += 2){
+        __m256 sum = _mm256_setzero_ps();
+        for (size_t k = 0; k < taps; k++){
+            sum = _mm256_fmadd_ps(resample_load_2pixels_x64_AVX2(rows[k] + c), _mm256_set1_ps(weights[k]), sum);
+        }
+        _mm256_storeu_ps(accumulator + 4*c, sum);
+    }
+    if (c < width){
+        __m128 sum = _mm_setzero_ps();
+        for (size_t k = 0; k < taps; k++){
+            __m128 pixel = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(rows[k][c])));
+            sum = _mm_fmadd_ps(pixel, _mm_set1_ps(weights[k]), sum);
+        }
+        _mm_storeu_ps(accumulator + 4*c, sum);
+    }
+}
+
+
+//  Round, clamp and pack the 2 pixels in "x" into 2 ARGB32 pixels.
+PA_FORCE_INLINE uint64_t resample_pack_2pixels_x64_AVX2(__m256 x){
+    x = _mm256_min_ps(x, _mm256_set1_ps(255.f));
+    x = _mm256_max_ps(x, _mm256_setzero_ps());
+    __m256i i = _mm256_cvttps_epi32(_mm256_add_ps(x, _mm256_set1_ps(0.5f)));
+    __m128i p = _mm_packus_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+    p = _mm_packus_epi16(p, p);
+    return (uint64_t)_mm_cvtsi128_si64(p);
+}
+PA_FORCE_INLINE __m128 resample_horizontal_pixel_x64_AVX2(
+    const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights,
+    size_t c
+){
+    const float* ptr = accumulator + 4 * (size_t)start[c];
+    const float* weight = weights + offset[c];
+    size_t taps = offset[c + 1] - offset[c];
+    __m128 sum = _mm_setzero_ps();
+    for (size_t k = 0; k < taps; k++){
+        sum = _mm_fmadd_ps(_mm_loadu_ps(ptr + 4*k), _mm_set1_ps(weight[k]), sum);
+    }
+    return sum;
+}
+void resample_horizontal_x64_AVX2(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+){
+    size_t c = 0;
+    for (; c + 2 <= width; c += 2){
+        __m128 lo = resample_horizontal_pixel_x64_AVX2(accumulator, start, offset, weights, c + 0);
+        __m128 hi = resample_horizontal_pixel_x64_AVX2(accumulator, start, offset, weights, c + 1);
+        uint64_t pixels = resample_pack_2pixels_x64_AVX2(_mm256_set_m128(hi, lo));
+        out[c + 0] = (uint32_t)pixels;
+        out[c + 1] = (uint32_t)(pixels >> 32);
+    }
+    if (c < width){
+        __m128 sum = resample_horizontal_pixel_x64_AVX2(accumulator, start, offset, weights, c);
+        out[c] = (uint32_t)resample_pack_2pixels_x64_AVX2(_mm256_castps128_ps256(sum));
+    }
+}
+
+
+
+}
+}
+#endif
@@ -0,0 +1,85 @@
+/*  Image Resample (x64 SSE4.1)
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+
+#include <stdint.h>
+#include <stddef.h>
+#include <smmintrin.h>
+#include "Common/Compiler.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+PA_FORCE_INLINE __m128 resample_unpack_pixel_x64_SSE41(__m128i x){
+    return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(x));
+}
+
+void resample_vertical_x64_SSE41(
+    float* accumulator, size_t width,
+    const uint32_t* const* rows, const float* weights, size_t taps
+){
+    size_t c = 0;
+    for (; c + 4 <= width; c += 4){
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        __m128 sum2 = _mm_setzero_ps();
+        __m128 sum3 = _mm_setzero_ps();
+        for (size_t k = 0; k < taps; k++){
+            __m128 weight = _mm_set1_ps(weights[k]);
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(rows[k] + c));
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(resample_unpack_pixel_x64_SSE41(pixels), weight));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(resample_unpack_pixel_x64_SSE41(_mm_srli_si128(pixels, 4)), weight));
+            sum2 = _mm_add_ps(sum2, _mm_mul_ps(resample_unpack_pixel_x64_SSE41(_mm_srli_si128(pixels, 8)), weight));
+            sum3 = _mm_add_ps(sum3, _mm_mul_ps(resample_unpack_pixel_x64_SSE41(_mm_srli_si128(pixels, 12)), weight));
+        }
+        _mm_storeu_ps(accumulator + 4*c +  0, sum0);
+        _mm_storeu_ps(accumulator + 4*c +  4, sum1);
+        _mm_storeu_ps(accumulator + 4*c +  8, sum2);
+        _mm_storeu_ps(accumulator + 4*c + 12, sum3);
+    }
+    for (; c < width; c++){
+        __m128 sum = _mm_setzero_ps();
+        for (size_t k = 0; k < taps; k++){
+            __m128 weight = _mm_set1_ps(weights[k]);
+            __m128i pixel = _mm_cvtsi32_si128(rows[k][c]);
+            sum = _mm_add_ps(sum, _mm_mul_ps(resample_unpack_pixel_x64_SSE41(pixel), weight));
+        }
+        _mm_storeu_ps(accumulator + 4*c, sum);
+    }
+}
+
+
+PA_FORCE_INLINE uint32_t resample_pack_pixel_x64_SSE41(__m128 x){
+    x = _mm_min_ps(x, _mm_set1_ps(255.f));
+    x = _mm_max_ps(x, _mm_setzero_ps());
+    __m128i i = _mm_cvttps_epi32(_mm_add_ps(x, _mm_set1_ps(0.5f)));
+    i = _mm_packus_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+    return (uint32_t)_mm_cvtsi128_si32(i);
+}
+void resample_horizontal_x64_SSE41(
+    uint32_t* out, size_t width, const float* accumulator,
+    const uint32_t* start, const uint32_t* offset, const float* weights
+){
+    for (size_t c = 0; c < width; c++){
+        const float* ptr = accumulator + 4 * (size_t)start[c];
+        const float* weight = weights + offset[c];
+        size_t taps = offset[c + 1] - offset[c];
+        __m128 sum = _mm_setzero_ps();
+        for (size_t k = 0; k < taps; k++){
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(ptr + 4*k), _mm_set1_ps(weight[k])));
+        }
+        out[c] = resample_pack_pixel_x64_SSE41(sum);
+    }
+}
+
+
+
+}
+}
+#endif
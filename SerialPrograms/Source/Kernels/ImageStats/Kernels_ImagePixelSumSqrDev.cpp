@@ -144,5 +144,88 @@ void sum_sqr_deviation_masked(
 
 
 
+
+void sum_sqr_deviation_scaled_Default(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+void sum_sqr_deviation_scaled_x64_SSE41(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+void sum_sqr_deviation_scaled_x64_AVX2(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+void sum_sqr_deviation_scaled_x64_AVX512(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+
+void sum_sqr_deviation_scaled(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+){
+#ifdef PA_AutoDispatch_x64_17_Skylake
+    if (CPU_CAPABILITY_CURRENT.OK_17_Skylake){
+        sum_sqr_deviation_scaled_x64_AVX512(
+            count, sumsqrs,
+            width, height,
+            ref, ref_bytes_per_line,
+            img, img_bytes_per_line,
+            scaleR, scaleG, scaleB
+        );
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_13_Haswell
+    if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+        sum_sqr_deviation_scaled_x64_AVX2(
+            count, sumsqrs,
+            width, height,
+            ref, ref_bytes_per_line,
+            img, img_bytes_per_line,
+            scaleR, scaleG, scaleB
+        );
+        return;
+    }
+#endif
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+    if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+        sum_sqr_deviation_scaled_x64_SSE41(
+            count, sumsqrs,
+            width, height,
+            ref, ref_bytes_per_line,
+            img, img_bytes_per_line,
+            scaleR, scaleG, scaleB
+        );
+        return;
+    }
+#endif
+    sum_sqr_deviation_scaled_Default(
+        count, sumsqrs,
+        width, height,
+        ref, ref_bytes_per_line,
+        img, img_bytes_per_line,
+        scaleR, scaleG, scaleB
+    );
+}
+
+
 }
 }
@@ -64,6 +64,21 @@ void sum_sqr_deviation_masked(
 );
 
 
+
+//
+//  Same as sum_sqr_deviation(ref, img) except that "ref" is first brightness
+//  scaled by (scaleR, scaleG, scaleB) exactly as scale_brightness() would.
+//  This avoids materializing the scaled reference.
+//
+void sum_sqr_deviation_scaled(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+
+
 }
 }
 #endif
@@ -5,6 +5,7 @@
  */
 
 #include <stdint.h>
+#include <algorithm>
 #include "Common/Compiler.h"
 #include "Common/Cpp/Exceptions.h"
 #include "Kernels_ImagePixelSumSqrDev.h"
@@ -116,5 +117,43 @@ void sum_sqr_deviation_Default<SumSquareMode::ARBITRATE_ALPHAS>(
 
 
 
+
+//  Truncates like scale_brightness_Default().
+void sum_sqr_deviation_scaled_Default(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+){
+    scaleR = std::max(scaleR, 0.0f);
+    scaleG = std::max(scaleG, 0.0f);
+    scaleB = std::max(scaleB, 0.0f);
+    for (size_t r = 0; r < height; r++){
+        uint64_t total = 0;
+        uint64_t sum = 0;
+        for (size_t c = 0; c < width; c++){
+            uint32_t pr = ref[c];
+            uint32_t pi = img[c];
+            if ((int32_t)pr >= 0){
+                continue;
+            }
+            int32_t r0 = std::min((uint32_t)((float)((pr >>  0) & 0xff) * scaleB), (uint32_t)255);
+            int32_t r1 = std::min((uint32_t)((float)((pr >>  8) & 0xff) * scaleG), (uint32_t)255);
+            int32_t r2 = std::min((uint32_t)((float)((pr >> 16) & 0xff) * scaleR), (uint32_t)255);
+            r0 -= (pi >>  0) & 0xff;
+            r1 -= (pi >>  8) & 0xff;
+            r2 -= (pi >> 16) & 0xff;
+            total++;
+            sum += r0*r0 + r1*r1 + r2*r2;
+        }
+        count += total;
+        sumsqrs += sum;
+        ref = (const uint32_t*)((const char*)ref + ref_bytes_per_line);
+        img = (const uint32_t*)((const char*)img + img_bytes_per_line);
+    }
+}
+
+
 }
 }
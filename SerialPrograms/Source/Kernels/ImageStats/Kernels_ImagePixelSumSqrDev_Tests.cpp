@@ -0,0 +1,222 @@
+/*  Sum of Squares of Deviation Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <random>
+#include "Common/Cpp/CpuId/CpuId.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "Kernels/ImageScaleBrightness/Kernels_ImageScaleBrightness.h"
+#include "Kernels_ImagePixelSumSqrDev.h"
+#include "Kernels_ImagePixelSumSqrDev_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+void scale_brightness_Default(
+    size_t width, size_t height,
+    uint32_t* image, size_t bytes_per_row,
+    float scaleR, float scaleG, float scaleB
+);
+void scale_brightness_x64_SSE41(
+    size_t width, size_t height,
+    uint32_t* image, size_t bytes_per_row,
+    float scaleR, float scaleG, float scaleB
+);
+void scale_brightness_x64_AVX2(
+    size_t width, size_t height,
+    uint32_t* image, size_t bytes_per_row,
+    float scaleR, float scaleG, float scaleB
+);
+void scale_brightness_x64_AVX512(
+    size_t width, size_t height,
+    uint32_t* image, size_t bytes_per_row,
+    float scaleR, float scaleG, float scaleB
+);
+
+void sum_sqr_deviation_scaled_Default(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+void sum_sqr_deviation_scaled_x64_SSE41(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+void sum_sqr_deviation_scaled_x64_AVX2(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+void sum_sqr_deviation_scaled_x64_AVX512(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+
+
+
+namespace{
+
+typedef void (*ScaleBrightnessFunction)(
+    size_t width, size_t height,
+    uint32_t* image, size_t bytes_per_row,
+    float scaleR, float scaleG, float scaleB
+);
+typedef void (*SumSqrDeviationScaledFunction)(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+);
+
+//  Compare the fused kernel against scaling a copy of the reference with
+//  "scale" and then running the unscaled kernel. The unscaled kernel is exact
+//  integer math on every ISA so only the scaling has to come from the same
+//  ISA as the fused kernel.
+std::string compare_fused(
+    const std::string& name,
+    ScaleBrightnessFunction scale,
+    SumSqrDeviationScaledFunction fused
+){
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<uint32_t> pixel_dist;
+    std::uniform_real_distribution<float> scale_dist(0.80f, 1.20f);
+
+    for (size_t trial = 0; trial < 500; trial++){
+        //  At least 4 wide. The AVX512 scale_brightness() needs a full
+        //  vector of pixels per row.
+        size_t width = 4 + rng() % 80;
+        size_t height = 1 + rng() % 6;
+        size_t ref_stride = width + rng() % 3;
+        size_t img_stride = width + rng() % 3;
+
+        std::vector<uint32_t> ref(ref_stride * height);
+        std::vector<uint32_t> img(img_stride * height);
+        for (uint32_t& pixel : ref){
+            pixel = pixel_dist(rng) & 0x00ffffff;
+            if (rng() % 4 != 0){
+                pixel |= 0xff000000;
+            }
+        }
+        for (uint32_t& pixel : img){
+            pixel = pixel_dist(rng);
+        }
+
+        //  Mostly bright enough that some channels clamp at 255.
+        float scaleR = scale_dist(rng);
+        float scaleG = scale_dist(rng);
+        float scaleB = scale_dist(rng);
+        if (trial % 10 == 0){
+            scaleR = 1.0f;
+            scaleG = 1.0f;
+            scaleB = 1.0f;
+        }
+
+        uint64_t fused_count = 0;
+        uint64_t fused_sumsqrs = 0;
+        fused(
+            fused_count, fused_sumsqrs,
+            width, height,
+            ref.data(), ref_stride * sizeof(uint32_t),
+            img.data(), img_stride * sizeof(uint32_t),
+            scaleR, scaleG, scaleB
+        );
+
+        std::vector<uint32_t> scaled = ref;
+        scale(width, height, scaled.data(), ref_stride * sizeof(uint32_t), scaleR, scaleG, scaleB);
+        uint64_t count = 0;
+        uint64_t sumsqrs = 0;
+        sum_sqr_deviation(
+            count, sumsqrs,
+            width, height,
+            scaled.data(), ref_stride * sizeof(uint32_t),
+            img.data(), img_stride * sizeof(uint32_t)
+        );
+
+        std::string label = name + " trial " + std::to_string(trial);
+        TEST_RESULT_COMPONENT_EQUAL_STR(fused_count, count, label + " count");
+        TEST_RESULT_COMPONENT_EQUAL_STR(fused_sumsqrs, sumsqrs, label + " sumsqrs");
+    }
+    return "";
+}
+
+}
+
+
+
+class Test_SumSqrDeviationScaled : public UnitTest{
+public:
+    Test_SumSqrDeviationScaled()
+        : UnitTest("Kernels::SumSqrDeviationScaled")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        std::string error;
+
+        error = compare_fused("Default", scale_brightness_Default, sum_sqr_deviation_scaled_Default);
+        if (!error.empty()){
+            return error;
+        }
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+        if (CPU_CAPABILITY_CURRENT.OK_08_Nehalem){
+            error = compare_fused("SSE4.1", scale_brightness_x64_SSE41, sum_sqr_deviation_scaled_x64_SSE41);
+            if (!error.empty()){
+                return error;
+            }
+        }
+#endif
+#ifdef PA_AutoDispatch_x64_13_Haswell
+        if (CPU_CAPABILITY_CURRENT.OK_13_Haswell){
+            error = compare_fused("AVX2", scale_brightness_x64_AVX2, sum_sqr_deviation_scaled_x64_AVX2);
+            if (!error.empty()){
+                return error;
+            }
+        }
+#endif
+#ifdef PA_AutoDispatch_x64_17_Skylake
+        if (CPU_CAPABILITY_CURRENT.OK_17_Skylake){
+            error = compare_fused("AVX512", scale_brightness_x64_AVX512, sum_sqr_deviation_scaled_x64_AVX512);
+            if (!error.empty()){
+                return error;
+            }
+        }
+#endif
+
+        //  What the dispatchers pick. On arm64 the fused kernel falls back to
+        //  Default while scale_brightness() uses NEON.
+        error = compare_fused("Dispatched", scale_brightness, sum_sqr_deviation_scaled);
+        if (!error.empty()){
+            return error;
+        }
+
+        return true;
+    }
+};
+
+
+
+void add_tests_ImagePixelSumSqrDev(UnitTestDatabase& database){
+    database.add<Test_SumSqrDeviationScaled>();
+}
+
+
+
+}
+}
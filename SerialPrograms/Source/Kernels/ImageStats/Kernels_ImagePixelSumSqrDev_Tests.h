@@ -0,0 +1,23 @@
+/*  Sum of Squares of Deviation Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Kernels_ImagePixelSumSqrDev_Tests_H
+#define PokemonAutomation_Kernels_ImagePixelSumSqrDev_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+namespace Kernels{
+
+
+
+void add_tests_ImagePixelSumSqrDev(UnitTestDatabase& database);
+
+
+
+}
+}
+#endif
@@ -175,6 +175,77 @@ void sum_sqr_deviation_x64_AVX2<SumSquareMode::ARBITRATE_ALPHAS>(
 
 
 
+
+//  Rounds like scale_brightness_x64_AVX2().
+PA_FORCE_INLINE __m256i sum_sqr_deviation_scaled_channel_x64_AVX2(
+    __m256i r, __m256i i, __m256 scale
+){
+    __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(r), scale);
+    f = _mm256_min_ps(f, _mm256_set1_ps(255.));
+    f = _mm256_max_ps(f, _mm256_set1_ps(0.));
+    r = _mm256_sub_epi32(_mm256_cvtps_epi32(f), i);
+    return _mm256_mullo_epi32(r, r);
+}
+PA_FORCE_INLINE void sum_sqr_deviation_scaled_x64_AVX2(
+    __m256i& total, __m256i& sum,
+    __m256i r, __m256i i,
+    __m256 scaleR, __m256 scaleG, __m256 scaleB
+){
+    const __m256i mask = _mm256_set1_epi32(0x000000ff);
+    __m256i alphaR = _mm256_srai_epi32(r, 31);
+
+    __m256i d = sum_sqr_deviation_scaled_channel_x64_AVX2(
+        _mm256_and_si256(r, mask), _mm256_and_si256(i, mask), scaleB
+    );
+    d = _mm256_add_epi32(d, sum_sqr_deviation_scaled_channel_x64_AVX2(
+        _mm256_and_si256(_mm256_srli_epi32(r, 8), mask), _mm256_and_si256(_mm256_srli_epi32(i, 8), mask), scaleG
+    ));
+    d = _mm256_add_epi32(d, sum_sqr_deviation_scaled_channel_x64_AVX2(
+        _mm256_and_si256(_mm256_srli_epi32(r, 16), mask), _mm256_and_si256(_mm256_srli_epi32(i, 16), mask), scaleR
+    ));
+
+    total = _mm256_sub_epi32(total, alphaR);
+    sum = _mm256_add_epi32(sum, _mm256_and_si256(d, alphaR));
+}
+void sum_sqr_deviation_scaled_x64_AVX2(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+){
+    if (width > 22017){
+        throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Width limit exceeded: " + std::to_string(width));
+    }
+    __m256 vscaleR = _mm256_set1_ps(scaleR);
+    __m256 vscaleG = _mm256_set1_ps(scaleG);
+    __m256 vscaleB = _mm256_set1_ps(scaleB);
+    for (size_t row = 0; row < height; row++){
+        __m256i total = _mm256_setzero_si256();
+        __m256i sum = _mm256_setzero_si256();
+        size_t c = 0;
+        for (; c + 8 <= width; c += 8){
+            __m256i r = _mm256_loadu_si256((const __m256i*)(ref + c));
+            __m256i i = _mm256_loadu_si256((const __m256i*)(img + c));
+            sum_sqr_deviation_scaled_x64_AVX2(total, sum, r, i, vscaleR, vscaleG, vscaleB);
+        }
+        if (c < width){
+            __m256i mask = _mm256_cmpgt_epi32(
+                _mm256_set1_epi32((int)(width - c)),
+                _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)
+            );
+            __m256i r = _mm256_maskload_epi32((const int*)(ref + c), mask);
+            __m256i i = _mm256_maskload_epi32((const int*)(img + c), mask);
+            sum_sqr_deviation_scaled_x64_AVX2(total, sum, r, i, vscaleR, vscaleG, vscaleB);
+        }
+        count += reduce_add32_x64_AVX2(total);
+        sumsqrs += reduce_add32_x64_AVX2(sum);
+        ref = (const uint32_t*)((const char*)ref + ref_bytes_per_line);
+        img = (const uint32_t*)((const char*)img + img_bytes_per_line);
+    }
+}
+
+
 }
 }
 #endif
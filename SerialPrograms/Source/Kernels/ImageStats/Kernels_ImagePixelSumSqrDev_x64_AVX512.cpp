@@ -181,6 +181,74 @@ void sum_sqr_deviation_x64_AVX512<SumSquareMode::ARBITRATE_ALPHAS>(
 
 
 
+
+//  Rounds like scale_brightness_x64_AVX512().
+PA_FORCE_INLINE __m512i sum_sqr_deviation_scaled_channel_x64_AVX512(
+    __m512i r, __m512i i, __m512 scale
+){
+    __m512 f = _mm512_mul_ps(_mm512_cvtepi32_ps(r), scale);
+    f = _mm512_min_ps(f, _mm512_set1_ps(255.));
+    f = _mm512_max_ps(f, _mm512_set1_ps(0.));
+    r = _mm512_sub_epi32(_mm512_cvtps_epi32(f), i);
+    return _mm512_mullo_epi32(r, r);
+}
+PA_FORCE_INLINE void sum_sqr_deviation_scaled_x64_AVX512(
+    __m512i& total, __m512i& sum,
+    __m512i r, __m512i i,
+    __m512 scaleR, __m512 scaleG, __m512 scaleB
+){
+    const __m512i mask = _mm512_set1_epi32(0x000000ff);
+    __mmask16 alphaR = _mm512_cmplt_epi32_mask(r, _mm512_setzero_si512());
+
+    __m512i d = sum_sqr_deviation_scaled_channel_x64_AVX512(
+        _mm512_and_si512(r, mask), _mm512_and_si512(i, mask), scaleB
+    );
+    d = _mm512_add_epi32(d, sum_sqr_deviation_scaled_channel_x64_AVX512(
+        _mm512_and_si512(_mm512_srli_epi32(r, 8), mask), _mm512_and_si512(_mm512_srli_epi32(i, 8), mask), scaleG
+    ));
+    d = _mm512_add_epi32(d, sum_sqr_deviation_scaled_channel_x64_AVX512(
+        _mm512_and_si512(_mm512_srli_epi32(r, 16), mask), _mm512_and_si512(_mm512_srli_epi32(i, 16), mask), scaleR
+    ));
+
+    total = _mm512_mask_sub_epi32(total, alphaR, total, _mm512_set1_epi32(-1));
+    sum = _mm512_mask_add_epi32(sum, alphaR, sum, d);
+}
+void sum_sqr_deviation_scaled_x64_AVX512(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+){
+    if (width > 22017){
+        throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Width limit exceeded: " + std::to_string(width));
+    }
+    __m512 vscaleR = _mm512_set1_ps(scaleR);
+    __m512 vscaleG = _mm512_set1_ps(scaleG);
+    __m512 vscaleB = _mm512_set1_ps(scaleB);
+    for (size_t row = 0; row < height; row++){
+        __m512i total = _mm512_setzero_si512();
+        __m512i sum = _mm512_setzero_si512();
+        size_t c = 0;
+        for (; c + 16 <= width; c += 16){
+            __m512i r = _mm512_loadu_si512(ref + c);
+            __m512i i = _mm512_loadu_si512(img + c);
+            sum_sqr_deviation_scaled_x64_AVX512(total, sum, r, i, vscaleR, vscaleG, vscaleB);
+        }
+        if (c < width){
+            __mmask16 mask = (((uint32_t)1 << (width - c))) - 1;
+            __m512i r = _mm512_maskz_loadu_epi32(mask, ref + c);
+            __m512i i = _mm512_maskz_loadu_epi32(mask, img + c);
+            sum_sqr_deviation_scaled_x64_AVX512(total, sum, r, i, vscaleR, vscaleG, vscaleB);
+        }
+        count += (uint32_t)_mm512_reduce_add_epi32(total);
+        sumsqrs += (uint32_t)_mm512_reduce_add_epi32(sum);
+        ref = (const uint32_t*)((const char*)ref + ref_bytes_per_line);
+        img = (const uint32_t*)((const char*)img + img_bytes_per_line);
+    }
+}
+
+
 }
 }
 #endif
@@ -181,6 +181,74 @@ void sum_sqr_deviation_x64_SSE41<SumSquareMode::ARBITRATE_ALPHAS>(
 
 
 
+
+//  Rounds like scale_brightness_x64_SSE41().
+PA_FORCE_INLINE __m128i sum_sqr_deviation_scaled_channel_x64_SSE41(
+    __m128i r, __m128i i, __m128 scale
+){
+    __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(r), scale);
+    f = _mm_min_ps(f, _mm_set1_ps(255.));
+    f = _mm_max_ps(f, _mm_set1_ps(0.));
+    r = _mm_sub_epi32(_mm_cvtps_epi32(f), i);
+    return _mm_mullo_epi32(r, r);
+}
+PA_FORCE_INLINE void sum_sqr_deviation_scaled_x64_SSE41(
+    __m128i& total, __m128i& sum,
+    __m128i r, __m128i i,
+    __m128 scaleR, __m128 scaleG, __m128 scaleB
+){
+    const __m128i mask = _mm_set1_epi32(0x000000ff);
+    __m128i alphaR = _mm_srai_epi32(r, 31);
+
+    __m128i d = sum_sqr_deviation_scaled_channel_x64_SSE41(
+        _mm_and_si128(r, mask), _mm_and_si128(i, mask), scaleB
+    );
+    d = _mm_add_epi32(d, sum_sqr_deviation_scaled_channel_x64_SSE41(
+        _mm_and_si128(_mm_srli_epi32(r, 8), mask), _mm_and_si128(_mm_srli_epi32(i, 8), mask), scaleG
+    ));
+    d = _mm_add_epi32(d, sum_sqr_deviation_scaled_channel_x64_SSE41(
+        _mm_and_si128(_mm_srli_epi32(r, 16), mask), _mm_and_si128(_mm_srli_epi32(i, 16), mask), scaleR
+    ));
+
+    total = _mm_sub_epi32(total, alphaR);
+    sum = _mm_add_epi32(sum, _mm_and_si128(d, alphaR));
+}
+void sum_sqr_deviation_scaled_x64_SSE41(
+    uint64_t& count, uint64_t& sumsqrs,
+    size_t width, size_t height,
+    const uint32_t* ref, size_t ref_bytes_per_line,
+    const uint32_t* img, size_t img_bytes_per_line,
+    float scaleR, float scaleG, float scaleB
+){
+    if (width > 22017){
+        throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Width limit exceeded: " + std::to_string(width));
+    }
+    __m128 vscaleR = _mm_set1_ps(scaleR);
+    __m128 vscaleG = _mm_set1_ps(scaleG);
+    __m128 vscaleB = _mm_set1_ps(scaleB);
+    for (size_t row = 0; row < height; row++){
+        __m128i total = _mm_setzero_si128();
+        __m128i sum = _mm_setzero_si128();
+        size_t c = 0;
+        for (; c + 4 <= width; c += 4){
+            __m128i r = _mm_loadu_si128((const __m128i*)(ref + c));
+            __m128i i = _mm_loadu_si128((const __m128i*)(img + c));
+            sum_sqr_deviation_scaled_x64_SSE41(total, sum, r, i, vscaleR, vscaleG, vscaleB);
+        }
+        for (; c < width; c++){
+            //  The empty lanes have zero alpha so they are ignored.
+            __m128i r = _mm_cvtsi32_si128(ref[c]);
+            __m128i i = _mm_cvtsi32_si128(img[c]);
+            sum_sqr_deviation_scaled_x64_SSE41(total, sum, r, i, vscaleR, vscaleG, vscaleB);
+        }
+        count += reduce32_x64_SSE41(total);
+        sumsqrs += reduce32_x64_SSE41(sum);
+        ref = (const uint32_t*)((const char*)ref + ref_bytes_per_line);
+        img = (const uint32_t*)((const char*)img + img_bytes_per_line);
+    }
+}
+
+
 }
 }
 #endif
@@ -6,8 +6,12 @@
 
 #include "Kernels_Tests.h"
 #include "BinaryMatrix/Kernels_BinaryMatrix_Tests.h"
+#include "ImageConvert/Kernels_ImageConvert_PlanarFloat_Tests.h"
+#include "ImageConvert/Kernels_ImageConvert_YUV_Tests.h"
 #include "ImageFilters/Kernels_ImageFilter_Tests.h"
+#include "ImageResample/Kernels_ImageResample_Tests.h"
 #include "ImageScaleBrightness/Kernels_ImageScaleBrightness_Tests.h"
+#include "ImageStats/Kernels_ImagePixelSumSqrDev_Tests.h"
 #include "Waterfill/Kernels_Waterfill_Tests.h"
 
 namespace PokemonAutomation{
@@ -17,8 +21,12 @@ namespace Kernels{
 
 void add_tests(UnitTestDatabase& database){
     add_tests_BinaryMatrix(database);
+    add_tests_ImageConvert(database);
+    add_tests_ImageConvert_PlanarFloat(database);
     add_tests_ImageFilters(database);
+    add_tests_ImageResample(database);
     add_tests_ImageScaleBrightness(database);
+    add_tests_ImagePixelSumSqrDev(database);
     add_tests_Waterfill(database);
 }
 
@@ -75,6 +75,64 @@ std::vector<WaterfillObject> find_objects_inplace(PackedBinaryMatrix_IB& matrix,
 }
 
 
+std::vector<WaterfillObject> find_objects_parallel_64x4_Default      (ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+std::vector<WaterfillObject> find_objects_parallel_64x8_Default      (ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+
+std::vector<WaterfillObject> find_objects_parallel_64x8_x64_SSE42    (ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+std::vector<WaterfillObject> find_objects_parallel_64x16_x64_AVX2    (ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+std::vector<WaterfillObject> find_objects_parallel_64x32_x64_AVX512  (ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+std::vector<WaterfillObject> find_objects_parallel_64x64_x64_AVX512  (ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+std::vector<WaterfillObject> find_objects_parallel_64x32_x64_AVX512GF(ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+std::vector<WaterfillObject> find_objects_parallel_64x64_x64_AVX512GF(ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+std::vector<WaterfillObject> find_objects_parallel_64x8_arm64_NEON   (ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects);
+
+std::vector<WaterfillObject> find_objects_parallel(
+    ThreadPool& thread_pool,
+    const PackedBinaryMatrix_IB& matrix, size_t min_area,
+    bool keep_objects
+){
+    switch (matrix.type()){
+
+#ifdef PA_ARCH_x86
+#ifdef PA_AutoDispatch_x64_17_Skylake
+    case BinaryMatrixType::i64x64_x64_AVX512:
+        if (CPU_CAPABILITY_CURRENT.OK_19_IceLake){
+            return find_objects_parallel_64x64_x64_AVX512GF(thread_pool, matrix, min_area, keep_objects);
+        }else{
+            return find_objects_parallel_64x64_x64_AVX512(thread_pool, matrix, min_area, keep_objects);
+        }
+    case BinaryMatrixType::i64x32_x64_AVX512:
+        if (CPU_CAPABILITY_CURRENT.OK_19_IceLake){
+            return find_objects_parallel_64x32_x64_AVX512GF(thread_pool, matrix, min_area, keep_objects);
+        }else{
+            return find_objects_parallel_64x32_x64_AVX512(thread_pool, matrix, min_area, keep_objects);
+        }
+#endif
+#ifdef PA_AutoDispatch_x64_13_Haswell
+    case BinaryMatrixType::i64x16_x64_AVX2:
+        return find_objects_parallel_64x16_x64_AVX2(thread_pool, matrix, min_area, keep_objects);
+#endif
+#ifdef PA_AutoDispatch_x64_08_Nehalem
+    case BinaryMatrixType::i64x8_x64_SSE42:
+        return find_objects_parallel_64x8_x64_SSE42(thread_pool, matrix, min_area, keep_objects);
+#endif
+#elif PA_ARCH_arm64
+#ifdef PA_AutoDispatch_arm64_20_M1
+    case BinaryMatrixType::arm64x8_x64_NEON:
+        return find_objects_parallel_64x8_arm64_NEON(thread_pool, matrix, min_area, keep_objects);
+#endif
+#endif
+
+    case BinaryMatrixType::i64x8_Default:
+        return find_objects_parallel_64x8_Default(thread_pool, matrix, min_area, keep_objects);
+    case BinaryMatrixType::i64x4_Default:
+        return find_objects_parallel_64x4_Default(thread_pool, matrix, min_area, keep_objects);
+    default:
+        throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Unsupported tile type.");
+    }
+}
+
+
 
 
 }
@@ -12,6 +12,9 @@
 #include "Kernels_Waterfill_Types.h"
 
 namespace PokemonAutomation{
+
+class ThreadPool;
+
 namespace Kernels{
 namespace Waterfill{
 
@@ -20,6 +23,16 @@ namespace Waterfill{
 //  Find all the objects in the matrix. This will destroy "matrix".
 std::vector<WaterfillObject> find_objects_inplace(PackedBinaryMatrix_IB& matrix, size_t min_area);
 
+//  Same as above, but splits the matrix into strips that are filled in
+//  parallel on "thread_pool". Returns the same objects in the same order.
+//  "matrix" is left untouched.
+//  If "keep_objects" is true, the "object" matrix of each object is filled in.
+std::vector<WaterfillObject> find_objects_parallel(
+    ThreadPool& thread_pool,
+    const PackedBinaryMatrix_IB& matrix, size_t min_area,
+    bool keep_objects = false
+);
+
 
 
 
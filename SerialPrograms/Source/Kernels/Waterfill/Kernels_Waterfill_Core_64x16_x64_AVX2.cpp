@@ -20,6 +20,15 @@ std::vector<WaterfillObject> find_objects_inplace_64x16_x64_AVX2(PackedBinaryMat
         min_area
     );
 }
+std::vector<WaterfillObject> find_objects_parallel_64x16_x64_AVX2(
+    ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects
+){
+    return find_objects_parallel<BinaryTile_64x16_x64_AVX2, Waterfill_64x16_x64_AVX2>(
+        thread_pool,
+        static_cast<const PackedBinaryMatrix_64x16_x64_AVX2&>(matrix).get(),
+        min_area, keep_objects
+    );
+}
 std::unique_ptr<WaterfillSession> make_WaterfillSession_64x16_x64_AVX2(PackedBinaryMatrix_IB* matrix){
     return matrix == nullptr
         ? std::make_unique<WaterfillSession_t<BinaryTile_64x16_x64_AVX2, Waterfill_64x16_x64_AVX2>>()
@@ -22,6 +22,15 @@ std::vector<WaterfillObject> find_objects_inplace_64x64_x64_AVX512GF(PackedBinar
         min_area
     );
 }
+std::vector<WaterfillObject> find_objects_parallel_64x64_x64_AVX512GF(
+    ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects
+){
+    return find_objects_parallel<BinaryTile_64x64_x64_AVX512, Waterfill_64x64_x64_AVX512GF>(
+        thread_pool,
+        static_cast<const PackedBinaryMatrix_64x64_x64_AVX512&>(matrix).get(),
+        min_area, keep_objects
+    );
+}
 std::unique_ptr<WaterfillSession> make_WaterfillSession_64x64_x64_AVX512GF(PackedBinaryMatrix_IB* matrix){
     return matrix == nullptr
         ? std::make_unique<WaterfillSession_t<BinaryTile_64x64_x64_AVX512, Waterfill_64x64_x64_AVX512GF>>()
@@ -29,6 +29,15 @@ std::vector<WaterfillObject> find_objects_inplace_64x8_arm64_NEON(PackedBinaryMa
         min_area
     );
 }
+std::vector<WaterfillObject> find_objects_parallel_64x8_arm64_NEON(
+    ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects
+){
+    return find_objects_parallel<BinaryTile_64x8_arm64_NEON, Waterfill_64x8_Default>(
+        thread_pool,
+        static_cast<const PackedBinaryMatrix_64x8_arm64_NEON&>(matrix).get(),
+        min_area, keep_objects
+    );
+}
 std::unique_ptr<WaterfillSession> make_WaterfillSession_64x8_arm64_NEON(PackedBinaryMatrix_IB* matrix){
     return matrix == nullptr
         ? std::make_unique<WaterfillSession_t<BinaryTile_64x8_arm64_NEON, Waterfill_64x8_Default>>()
@@ -45,6 +54,15 @@ std::vector<WaterfillObject> find_objects_inplace_64x8_arm64_NEON(PackedBinaryMa
         min_area
     );
 }
+std::vector<WaterfillObject> find_objects_parallel_64x8_arm64_NEON(
+    ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects
+){
+    return find_objects_parallel<BinaryTile_64x8_arm64_NEON, Waterfill_64x8_arm64_NEON>(
+        thread_pool,
+        static_cast<const PackedBinaryMatrix_64x8_arm64_NEON&>(matrix).get(),
+        min_area, keep_objects
+    );
+}
 std::unique_ptr<WaterfillSession> make_WaterfillSession_64x8_arm64_NEON(PackedBinaryMatrix_IB* matrix){
     return matrix == nullptr
         ? std::make_unique<WaterfillSession_t<BinaryTile_64x8_arm64_NEON, Waterfill_64x8_arm64_NEON>>()
@@ -21,6 +21,15 @@ std::vector<WaterfillObject> find_objects_inplace_64x8_x64_SSE42(PackedBinaryMat
         min_area
     );
 }
+std::vector<WaterfillObject> find_objects_parallel_64x8_x64_SSE42(
+    ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects
+){
+    return find_objects_parallel<BinaryTile_64x8_x64_SSE42, Waterfill_64x8_x64_SSE42>(
+        thread_pool,
+        static_cast<const PackedBinaryMatrix_64x8_x64_SSE42&>(matrix).get(),
+        min_area, keep_objects
+    );
+}
 std::unique_ptr<WaterfillSession> make_WaterfillSession_64x8_x64_SSE42(PackedBinaryMatrix_IB* matrix){
 //    cout << "make_WaterfillSession_64x8_x64_SSE42()" << endl;
 #if 0
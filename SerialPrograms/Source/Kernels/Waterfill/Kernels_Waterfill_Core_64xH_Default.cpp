@@ -23,6 +23,15 @@ std::vector<WaterfillObject> find_objects_inplace_64x4_Default(PackedBinaryMatri
         min_area
     );
 }
+std::vector<WaterfillObject> find_objects_parallel_64x4_Default(
+    ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects
+){
+    return find_objects_parallel<BinaryTile_64x4_Default, Waterfill_64x4_Default<BinaryTile_64x4_Default>>(
+        thread_pool,
+        static_cast<const PackedBinaryMatrix_64x4_Default&>(matrix).get(),
+        min_area, keep_objects
+    );
+}
 std::unique_ptr<WaterfillSession> make_WaterfillSession_64x4_Default(PackedBinaryMatrix_IB* matrix){
     return matrix == nullptr
         ? std::make_unique<WaterfillSession_t<BinaryTile_64x4_Default, Waterfill_64x4_Default<BinaryTile_64x4_Default>>>()
@@ -37,6 +46,15 @@ std::vector<WaterfillObject> find_objects_inplace_64x8_Default(PackedBinaryMatri
         min_area
     );
 }
+std::vector<WaterfillObject> find_objects_parallel_64x8_Default(
+    ThreadPool& thread_pool, const PackedBinaryMatrix_IB& matrix, size_t min_area, bool keep_objects
+){
+    return find_objects_parallel<BinaryTile_64x8_Default, Waterfill_64xH_Default<BinaryTile_64x8_Default>>(
+        thread_pool,
+        static_cast<const PackedBinaryMatrix_64x8_Default&>(matrix).get(),
+        min_area, keep_objects
+    );
+}
 std::unique_ptr<WaterfillSession> make_WaterfillSession_64x8_Default(PackedBinaryMatrix_IB* matrix){
     return matrix == nullptr
         ? std::make_unique<WaterfillSession_t<BinaryTile_64x8_Default, Waterfill_64xH_Default<BinaryTile_64x8_Default>>>()
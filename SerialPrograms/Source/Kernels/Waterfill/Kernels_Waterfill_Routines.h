@@ -9,6 +9,11 @@
 
 #include <vector>
 #include <set>
+#include <map>
+#include <algorithm>
+#include "Common/Cpp/Concurrency/ThreadPool.h"
+#include "Kernels/Kernels_BitScan.h"
+#include "Kernels/Algorithm/Kernels_Algorithm_DisjointSet.h"
 #include "Kernels/BinaryMatrix/Kernels_BinaryMatrix_t.h"
 #include "Kernels/BinaryMatrix/Kernels_PackedBinaryMatrixCore.h"
 #include "Kernels/BinaryMatrix/Kernels_SparseBinaryMatrixCore.h"
@@ -51,6 +56,183 @@ std::vector<WaterfillObject> find_objects_inplace(PackedBinaryMatrixCore<Tile>&
 
 
 
+//  Same as find_objects_inplace(), but the matrix is cut into horizontal strips
+//  of whole tile rows. Each strip is filled on its own thread, then objects
+//  that touch across strip edges are joined with a disjoint set.
+//
+//  Every fragment found in a strip records which of its pixels lie on the
+//  strip's top and bottom rows. Since the session clears an object's bits from
+//  the source as it finds it, those are exactly the edge bits that disappear.
+//
+//  Fragments are found in the same scan order as the serial version. So
+//  ordering the joined objects by their first fragment and taking that
+//  fragment's body gives the same results in the same order.
+template <typename Tile, typename TileRoutines>
+std::vector<WaterfillObject> find_objects_parallel(
+    ThreadPool& thread_pool,
+    const PackedBinaryMatrixCore<Tile>& matrix, size_t min_area,
+    bool keep_objects
+){
+    constexpr uint32_t NO_LABEL = (uint32_t)0 - 1;
+
+    const size_t width = matrix.width();
+    const size_t height = matrix.height();
+    const size_t tile_width = matrix.tile_width();
+    const size_t tile_height = matrix.tile_height();
+    if (tile_height == 0){
+        return {};
+    }
+
+    //  Don't bother splitting below this many pixel rows per strip.
+    const size_t MIN_STRIP_ROWS = 64;
+    size_t strip_tiles = (MIN_STRIP_ROWS + Tile::HEIGHT - 1) / Tile::HEIGHT;
+    size_t strips = (tile_height + strip_tiles - 1) / strip_tiles;
+    strips = std::min(strips, std::max<size_t>(thread_pool.max_threads(), 1));
+    strip_tiles = (tile_height + strips - 1) / strips;
+    strips = (tile_height + strip_tiles - 1) / strip_tiles;
+
+    struct Strip{
+        std::vector<WaterfillObject> fragments;
+        std::vector<uint32_t> top_labels;       //  Fragment index on each pixel of the top row.
+        std::vector<uint32_t> bottom_labels;    //  Fragment index on each pixel of the bottom row.
+    };
+    std::vector<Strip> results(strips);
+
+    thread_pool.run_in_parallel(
+        [&](size_t index){
+            Strip& strip = results[index];
+            const size_t tile_start = index * strip_tiles;
+            const size_t tile_end = std::min(tile_start + strip_tiles, tile_height);
+            const size_t row_start = tile_start * Tile::HEIGHT;
+            const size_t rows = std::min(tile_end * Tile::HEIGHT, height) - row_start;
+            const size_t last_row = rows - 1;
+
+            PackedBinaryMatrixCore<Tile> source(width, rows);
+            for (size_t r = tile_start; r < tile_end; r++){
+                for (size_t c = 0; c < tile_width; c++){
+                    source.tile(c, r - tile_start) = matrix.tile(c, r);
+                }
+            }
+
+            std::vector<uint64_t> top(tile_width);
+            std::vector<uint64_t> bottom(tile_width);
+            for (size_t c = 0; c < tile_width; c++){
+                top[c] = source.word64(c, 0);
+                bottom[c] = source.word64(c, last_row);
+            }
+            strip.top_labels.assign(width, NO_LABEL);
+            strip.bottom_labels.assign(width, NO_LABEL);
+
+            auto label_edge = [&](
+                std::vector<uint64_t>& edge, std::vector<uint32_t>& labels, size_t row,
+                const WaterfillObject& object, uint32_t label
+            ){
+                size_t end = (object.max_x + 63) / 64;
+                for (size_t c = object.min_x / 64; c < end; c++){
+                    uint64_t now = source.word64(c, row);
+                    uint64_t removed = edge[c] & ~now;
+                    edge[c] = now;
+                    size_t bit;
+                    while (trailing_zeros(bit, removed)){
+                        labels[c * 64 + bit] = label;
+                        removed &= removed - 1;
+                    }
+                }
+            };
+
+            WaterfillSession_t<Tile, TileRoutines> session(source);
+            for (size_t r = 0; r < source.tile_height(); r++){
+                for (size_t c = 0; c < tile_width; c++){
+                    while (true){
+                        WaterfillObject object;
+                        if (!session.find_object_in_tile(object, keep_objects, c, r)){
+                            break;
+                        }
+
+                        uint32_t label = (uint32_t)strip.fragments.size();
+                        if (object.min_y == 0){
+                            label_edge(top, strip.top_labels, 0, object, label);
+                        }
+                        if (object.max_y == rows){
+                            label_edge(bottom, strip.bottom_labels, last_row, object, label);
+                        }
+
+                        //  Move the fragment from strip coordinates to matrix coordinates.
+                        if (keep_objects){
+                            const SparseBinaryMatrixCore<Tile>& local =
+                                static_cast<const SparseBinaryMatrix_t<Tile>&>(*object.object).get();
+                            std::map<TileIndex, Tile> tiles;
+                            size_t tile_max_x = (object.max_x + Tile::WIDTH - 1) / Tile::WIDTH;
+                            size_t tile_max_y = (object.max_y + Tile::HEIGHT - 1) / Tile::HEIGHT;
+                            for (size_t y = object.min_y / Tile::HEIGHT; y < tile_max_y; y++){
+                                for (size_t x = object.min_x / Tile::WIDTH; x < tile_max_x; x++){
+                                    const Tile& tile = local.tile(x, y);
+                                    if (TileRoutines::row_or(tile) != 0){
+                                        tiles[TileIndex(x, y + tile_start)] = tile;
+                                    }
+                                }
+                            }
+                            auto global = std::make_unique<SparseBinaryMatrix_t<Tile>>(width, height);
+                            global->get().set_data(std::move(tiles));
+                            object.object = std::move(global);
+                        }
+                        object.body_y += row_start;
+                        object.min_y += row_start;
+                        object.max_y += row_start;
+                        object.sum_y += (uint64_t)row_start * object.area;
+
+                        strip.fragments.emplace_back(std::move(object));
+                    }
+                }
+            }
+        },
+        0, strips, 1
+    );
+
+    //  Join the fragments that touch across each strip edge.
+    std::vector<size_t> offsets(strips + 1, 0);
+    for (size_t s = 0; s < strips; s++){
+        offsets[s + 1] = offsets[s] + results[s].fragments.size();
+    }
+    DisjointSet sets(offsets[strips]);
+    for (size_t s = 1; s < strips; s++){
+        const std::vector<uint32_t>& above = results[s - 1].bottom_labels;
+        const std::vector<uint32_t>& below = results[s].top_labels;
+        for (size_t x = 0; x < width; x++){
+            if (above[x] != NO_LABEL && below[x] != NO_LABEL){
+                sets.merge(offsets[s - 1] + above[x], offsets[s] + below[x]);
+            }
+        }
+    }
+
+    //  The first fragment of each set is where the serial scan would have
+    //  started that object.
+    std::vector<WaterfillObject> objects;
+    std::vector<size_t> slot(offsets[strips], (size_t)0 - 1);
+    for (size_t s = 0; s < strips; s++){
+        for (size_t c = 0; c < results[s].fragments.size(); c++){
+            WaterfillObject& fragment = results[s].fragments[c];
+            size_t root = sets.find(offsets[s] + c);
+            if (slot[root] == (size_t)0 - 1){
+                slot[root] = objects.size();
+                objects.emplace_back(std::move(fragment));
+            }else{
+                objects[slot[root]].merge_assume_no_overlap(fragment);
+            }
+        }
+    }
+
+    std::vector<WaterfillObject> ret;
+    for (WaterfillObject& object : objects){
+        if (object.area >= min_area){
+            ret.emplace_back(std::move(object));
+        }
+    }
+    return ret;
+}
+
+
+
 
 
 
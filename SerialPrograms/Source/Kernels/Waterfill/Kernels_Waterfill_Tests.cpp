@@ -7,6 +7,8 @@
 #include "Common/Cpp/Color.h"
 #include "Common/Cpp/CpuId/CpuId.h"
 #include "Common/Cpp/Time.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "CommonFramework/Tools/GlobalThreadPools.h"
 #include "CommonFramework/GlobalAutoPaths.h"
 #include "CommonFramework/ImageTypes/BinaryImage.h"
 #include "CommonFramework/ImageTypes/ImageRGB32.h"
@@ -123,11 +125,79 @@ private:
 
 
 
+//  Compare find_objects_parallel() against find_objects_inplace() on random
+//  matrices. Objects must match exactly and come back in the same order.
+class Test_WaterfillParallel : public UnitTest{
+public:
+    Test_WaterfillParallel()
+        : UnitTest("Kernels::Waterfill - Parallel")
+    {}
 
-void add_tests_Waterfill(UnitTestDatabase& database){
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        TestRandom random;
+        auto random_matrix = [&](size_t width, size_t height, uint32_t density){
+            PackedBinaryMatrix matrix(width, height);
+            for (size_t r = 0; r < height; r++){
+                for (size_t c = 0; c < width; c++){
+                    matrix.set(c, r, random() % 100 < density);
+                }
+            }
+            return matrix;
+        };
+
+        ThreadPool& thread_pool = GlobalThreadPools::computation_realtime();
+
+        for (size_t trial = 0; trial < 100; trial++){
+            size_t width = 1 + random() % 400;
+            size_t height = 1 + random() % 600;
+            size_t min_area = random() % 20;
+            bool keep_objects = trial % 4 == 0;
+            PackedBinaryMatrix matrix = random_matrix(width, height, 30 + random() % 40);
+            PackedBinaryMatrix source = matrix.copy();
+
+            std::vector<Waterfill::WaterfillObject> objects = Waterfill::find_objects_parallel(thread_pool, matrix, min_area, keep_objects);
+            PackedBinaryMatrix gt_matrix = matrix.copy();
+            std::vector<Waterfill::WaterfillObject> gt_objects = Waterfill::find_objects_inplace(gt_matrix, min_area);
+
+            TEST_RESULT_COMPONENT_EQUAL_STR(objects.size(), gt_objects.size(), "number of objects");
+            for (size_t i = 0; i < objects.size(); ++i){
+                const Waterfill::WaterfillObject& object = objects[i];
+                const Waterfill::WaterfillObject& gt = gt_objects[i];
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.area, gt.area, "object " + std::to_string(i) + " area");
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.min_x, gt.min_x, "object " + std::to_string(i) + " min_x");
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.min_y, gt.min_y, "object " + std::to_string(i) + " min_y");
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.max_x, gt.max_x, "object " + std::to_string(i) + " max_x");
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.max_y, gt.max_y, "object " + std::to_string(i) + " max_y");
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.sum_x, gt.sum_x, "object " + std::to_string(i) + " sum_x");
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.sum_y, gt.sum_y, "object " + std::to_string(i) + " sum_y");
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.body_x, gt.body_x, "object " + std::to_string(i) + " body_x");
+                TEST_RESULT_COMPONENT_EQUAL_STR(object.body_y, gt.body_y, "object " + std::to_string(i) + " body_y");
+                if (!keep_objects){
+                    continue;
+                }
+                size_t area = 0;
+                for (size_t r = object.min_y; r < object.max_y; r++){
+                    for (size_t c = object.min_x; c < object.max_x; c++){
+                        area += object.object->get(c, r) && matrix.get(c, r);
+                    }
+                }
+                TEST_RESULT_COMPONENT_EQUAL_STR(area, object.area, "object " + std::to_string(i) + " bits");
+            }
+
+
+            //  The input must be left untouched.
+            TEST_RESULT_COMPONENT_EQUAL_STR(matrix.dump() == source.dump(), true, "input matrix unchanged");
+        }
+
+        return true;
+    };
+};
 
 
 
+
+void add_tests_Waterfill(UnitTestDatabase& database){
+    database.add<Test_WaterfillParallel>();
 }
 
 
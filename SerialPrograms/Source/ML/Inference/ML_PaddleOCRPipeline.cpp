@@ -5,8 +5,10 @@
  *  
  */
 
+#include <array>
 #include <fstream>
 #include <limits>
+#include <algorithm>
 #include "Common/Cpp/Exceptions.h"
 #include "Common/Cpp/Filesystem/Filesystem.h"
 #include "Common/Cpp/Logging/GlobalLogger.h"
@@ -72,8 +74,13 @@ PaddleOCRPipeline::PaddleOCRPipeline(Language language, std::string rec_path, st
     , m_input_name(m_rec_session.GetInputNameAllocated(0, Ort::AllocatorWithDefaultOptions{}).get())
     , m_output_name(m_rec_session.GetOutputNameAllocated(0, Ort::AllocatorWithDefaultOptions{}).get())
     , m_logger(global_logger_raw(), "OCR")
+    , m_memory_info(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
 {
     load_dictionary(Filesystem::Path(dict_path));
+
+    //  Only batch if the model takes a dynamic batch size.
+    std::vector<int64_t> input_shape = m_rec_session.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    m_dynamic_batch = !input_shape.empty() && input_shape[0] < 0;
 }
 
 void PaddleOCRPipeline::run(const std::string& img_path){
@@ -149,7 +156,7 @@ void PaddleOCRPipeline::load_dictionary(const Filesystem::Path& path){
 }
 
 
-std::string PaddleOCRPipeline::recognize(const ImageViewRGB32& image){
+PaddleOCRPipeline::TextCrop PaddleOCRPipeline::preprocess(const ImageViewRGB32& image){
 
     const bool debugging = STATIC_GLOBALS.PADDLE_OCR_DEBUG;
 
@@ -157,7 +164,7 @@ std::string PaddleOCRPipeline::recognize(const ImageViewRGB32& image){
     cv::Mat cv_image_rgb = imageviewrgb32_to_cv_mat_rgb(image);
     if (cv_image_rgb.empty()) {
         m_logger.log("[OCR-DEBUG] Input was an empty image.");
-        return "";
+        return {};
     }
 
     
@@ -165,14 +172,14 @@ std::string PaddleOCRPipeline::recognize(const ImageViewRGB32& image){
     cv::Mat cropped_image = crop_to_text_region(cv_image_rgb);
     if (cropped_image.empty()){
         m_logger.log("[OCR-DEBUG] Crop to text region returned empty image.");
-        return "";
+        return {};
     }
 
     // add horizontal padding to tall/narrow characters
     add_horizontal_padding(cropped_image);
 
     // 3. Calculate dynamic width (maintain aspect ratio)
-    // the model shape is {1, 3, 48, dynamic_width}. Note that the height is fixed at 48 pixels
+    // the model shape is {N, 3, 48, dynamic_width}. Note that the height is fixed at 48 pixels
     // the input image must be scaled to match the height of 48, for the neural network
     int target_h = 48;
     float aspect_ratio = (float)cropped_image.cols / cropped_image.rows;
@@ -184,25 +191,35 @@ std::string PaddleOCRPipeline::recognize(const ImageViewRGB32& image){
 
     if (target_w <= 0 || target_w > 8192){
         m_logger.log("[OCR-ERROR] Abnormally scaled target width calculated: " + std::to_string(target_w));
-        return "";
+        return {};
+    }
+
+    if (debugging){
+        m_logger.log("[OCR-DEBUG] Cropped image constraints - Width: " + std::to_string(cropped_image.cols) 
+            + ", Height: " + std::to_string(cropped_image.rows) 
+            + ", Channels: " + std::to_string(cropped_image.channels()) 
+            + ", Total Pixels: " + std::to_string(cropped_image.total()));
     }
 
-    cv::Mat resized;
+    TextCrop ret;
     cv::resize(
         cropped_image,
-        resized,
+        ret.image,
         cv::Size(target_w, target_h),
         0,
         0,
         cv::INTER_LINEAR
     );
 
+    //  Used to pad this crop out to the width of the widest crop in a batch.
+    ret.background = estimate_background_color(ret.image) * (1.0 / 255.0);
+
 
     // 4. Normalize
     // convert UC3 8-bit [0,255] to 32FC3 float [0,1], then use ImageNet Normalization
     // output = (Input * Scale) = (old_pixel * 1/255). This transforms [0,255] to range [0, 1]
     // TODO: determine if normalizing to [-1,1] is preferred or to perform ImageNet normalization (mean = [0.485, 0.456, 0.406] and std = [0.229, 0.224, 0.225])
-    resized.convertTo(resized, CV_32FC3, 1.0 / 255.0);
+    ret.image.convertTo(ret.image, CV_32FC3, 1.0 / 255.0);
     
     // 4b. Apply Mean/Std (Standard for PaddleOCR). except for Chinese
     // Mean: [0.485, 0.456, 0.406], Std: [0.229, 0.224, 0.225]
@@ -216,89 +233,123 @@ std::string PaddleOCRPipeline::recognize(const ImageViewRGB32& image){
 #if 0
         cv::Scalar mean(0.485, 0.456, 0.406);
         cv::Scalar std(0.229, 0.224, 0.225);
-        cv::subtract(resized, mean, resized);
-        cv::divide(resized, std, resized);
+        cv::subtract(ret.image, mean, ret.image);
+        cv::divide(ret.image, std, ret.image);
 #endif
     }
-    
-    
-    // 5. Convert HWC to NCHW
-    std::vector<float> input_tensor_values = preprocess_NCHW(resized);
 
-    // 6. Define Dynamic Shape
-    std::vector<int64_t> input_shape = {1, 3, target_h, target_w};
+    return ret;
+}
 
 
-    size_t expected_elements = 1 * 3 * target_h * target_w;
-    if (debugging){
-        m_logger.log("[OCR-DEBUG] Cropped image constraints - Width: " + std::to_string(cropped_image.cols) 
-            + ", Height: " + std::to_string(cropped_image.rows) 
-            + ", Channels: " + std::to_string(cropped_image.channels()) 
-            + ", Total Pixels: " + std::to_string(cropped_image.total()));
+std::string PaddleOCRPipeline::recognize(const ImageViewRGB32& image){
+    return recognize(std::vector<ImageViewRGB32>{image})[0];
+}
+std::vector<std::string> PaddleOCRPipeline::recognize(const std::vector<ImageViewRGB32>& images){
+    std::vector<std::string> results(images.size());
+
+    std::vector<TextCrop> crops;
+    crops.reserve(images.size());
+    std::vector<size_t> order;
+    for (size_t c = 0; c < images.size(); c++){
+        crops.emplace_back(preprocess(images[c]));
+        if (!crops.back().image.empty()){
+            order.emplace_back(c);
+        }
+    }
+
+    //  Sort by width so that each batch wastes as little as possible on
+    //  padding. Then cut it into batches of similar widths.
+    std::sort(
+        order.begin(), order.end(),
+        [&](size_t x, size_t y){
+            return crops[x].image.cols < crops[y].image.cols;
+        }
+    );
+    size_t max_batch = m_dynamic_batch ? MAX_BATCH_SIZE : 1;
+    for (size_t start = 0; start < order.size();){
+        int min_width = crops[order[start]].image.cols;
+        size_t end = start + 1;
+        while (end < order.size() &&
+            end - start < max_batch &&
+            crops[order[end]].image.cols <= min_width * MAX_BATCH_WIDTH_RATIO
+        ){
+            end++;
+        }
+        recognize_batch(crops, order.data() + start, end - start, results);
+        start = end;
+    }
+
+    return results;
+}
+
+
+void PaddleOCRPipeline::recognize_batch(
+    const std::vector<TextCrop>& crops,
+    const size_t* indices, size_t count,
+    std::vector<std::string>& results
+){
+    const bool debugging = STATIC_GLOBALS.PADDLE_OCR_DEBUG;
+
+    const int height = crops[indices[0]].image.rows;
+    int width = 0;
+    for (size_t c = 0; c < count; c++){
+        width = std::max(width, crops[indices[c]].image.cols);
+    }
+
+    // 5. Convert HWC to NCHW, straight into the (reused) batch buffer.
+    std::unique_ptr<BatchBuffers> buffers = checkout_buffers();
+    const size_t image_size = 3 * (size_t)height * width;
+    buffers->input.resize(count * image_size);
+    for (size_t c = 0; c < count; c++){
+        const TextCrop& crop = crops[indices[c]];
+        preprocess_NCHW(crop.image, buffers->input.data() + c * image_size, width, crop.background);
+    }
 
+    // 6. Define Dynamic Shape
+    std::array<int64_t, 4> input_shape{(int64_t)count, 3, height, width};
+
+    if (debugging){
         size_t nan_count = 0;
         size_t subnormal_count = 0;
-        for (float val : input_tensor_values) {
+        for (float val : buffers->input) {
             if (std::isnan(val)) {
                 nan_count++;
             } else if (val != 0.0f && std::fpclassify(val) == FP_SUBNORMAL) {
                 subnormal_count++;
             }
         }
-        m_logger.log("[OCR-DEBUG] Tensor payload validation - Total Floats: " + std::to_string(input_tensor_values.size())
+        m_logger.log("[OCR-DEBUG] Tensor payload validation - Total Floats: " + std::to_string(buffers->input.size())
                 + ", NaNs detected: " + std::to_string(nan_count) 
                 + ", Subnormal (denormal) values: " + std::to_string(subnormal_count));
-    
-        // Validate expected payload sizing matches matrix dimensionality
         m_logger.log("[OCR-DEBUG] Shape Definition - NCHW: [" + std::to_string(input_shape[0]) + "," + std::to_string(input_shape[1]) 
-                + "," + std::to_string(input_shape[2]) + "," + std::to_string(input_shape[3]) + "]. Expected Elements: " + std::to_string(expected_elements));
-
-    }
-
-    if (input_tensor_values.size() != static_cast<size_t>(expected_elements)) {
-        m_logger.log("[OCR-ERROR] Vector length vs input_shape calculation mismatch!");
-        m_logger.log("[OCR-ERROR] Fatal memory stride mismatch. Vector size (" + std::to_string(input_tensor_values.size())
-                    + ") does not match shape requirement (" + std::to_string(expected_elements));
-        return "";
+                + "," + std::to_string(input_shape[2]) + "," + std::to_string(input_shape[3]) + "]");
     }
 
-    // 7. Create tensor with its own managed memory
-    Ort::AllocatorWithDefaultOptions allocator;    
-    auto input_tensor = Ort::Value::CreateTensor<float>(
-        allocator,
-        input_shape.data(),
-        input_shape.size()
-    );
-
-    // Copy your processed data into that memory
-    std::memcpy(
-        input_tensor.GetTensorMutableData<float>(),
-        input_tensor_values.data(),
-        input_tensor_values.size() * sizeof(float)
-    );
-
-    const char* input_names[] = {m_input_name.c_str()};
-    const char* output_names[] = {m_output_name.c_str()};  
-
     try{
+        // 7. Bind the buffer as the input tensor. Let ONNX allocate the
+        //    output since its sequence length depends on the input width.
+        Ort::Value input_tensor = create_tensor<float>(m_memory_info, buffers->input, input_shape);
+        buffers->binding.BindInput(m_input_name.c_str(), input_tensor);
+        buffers->binding.BindOutput(m_output_name.c_str(), m_memory_info);
+
         if (debugging) {
             m_logger.log("[OCR-DEBUG] Calling m_rec_session.Run() now...");
         }
 
         // 8. Run the recognition session
-        auto outputs = m_rec_session.Run(
-            Ort::RunOptions{nullptr}, 
-            input_names,   // char** 
-            &input_tensor, // Ort::Value* (array of 1)
-            1,             // input_count
-            output_names,  // char**
-            1              // output_count
-        );
-        return decode_CTC(
-            outputs[0].GetTensorMutableData<float>(),
-            outputs[0].GetTensorTypeAndShapeInfo().GetShape(),
-            m_dictionary
-        );
+        m_rec_session.Run(Ort::RunOptions{nullptr}, buffers->binding);
+        std::vector<Ort::Value> outputs = buffers->binding.GetOutputValues();
+        buffers->binding.ClearBoundInputs();
+        buffers->binding.ClearBoundOutputs();
+
+        std::vector<int64_t> output_shape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
+        float* data = outputs[0].GetTensorMutableData<float>();
+        const size_t output_size = (size_t)(output_shape[1] * output_shape[2]);
+        output_shape[0] = 1;
+        for (size_t c = 0; c < count; c++){
+            results[indices[c]] = decode_CTC(data + c * output_size, output_shape, m_dictionary);
+        }
     }catch (Ort::Exception& e){
         throw InternalProgramError(
             nullptr,
@@ -306,7 +357,25 @@ std::string PaddleOCRPipeline::recognize(const ImageViewRGB32& image){
             "PaddleOCRPipeline::recognize(): Failed." + std::string(e.what())
         );
     }
-    
+
+    checkin_buffers(std::move(buffers));
+}
+
+
+std::unique_ptr<PaddleOCRPipeline::BatchBuffers> PaddleOCRPipeline::checkout_buffers(){
+    {
+        WriteSpinLock lg(m_buffers_lock, "PaddleOCRPipeline::checkout_buffers()");
+        if (!m_idle_buffers.empty()){
+            std::unique_ptr<BatchBuffers> ret = std::move(m_idle_buffers.back());
+            m_idle_buffers.pop_back();
+            return ret;
+        }
+    }
+    return std::unique_ptr<BatchBuffers>(new BatchBuffers{{}, Ort::IoBinding(m_rec_session)});
+}
+void PaddleOCRPipeline::checkin_buffers(std::unique_ptr<BatchBuffers> buffers){
+    WriteSpinLock lg(m_buffers_lock, "PaddleOCRPipeline::checkin_buffers()");
+    m_idle_buffers.emplace_back(std::move(buffers));
 }
 
 cv::Mat crop_to_text_region(const cv::Mat& image) {
@@ -423,33 +492,39 @@ cv::Scalar estimate_background_color(const cv::Mat& image) {
 
 
 std::vector<float> preprocess_NCHW(cv::Mat& img){
+    std::vector<float> dst(img.rows * img.cols * 3);
+    preprocess_NCHW(img, dst.data(), img.cols, cv::Scalar());
+    return dst;
+}
+void preprocess_NCHW(const cv::Mat& img, float* dst, int width, const cv::Scalar& padding){
     const int rows = img.rows;
     const int cols = img.cols;
     const int channels = 3;
-    
-    // Allocate a flat memory buffer big enough for all channels
-    std::vector<float> dst(rows * cols * channels);
 
     // Define the size of one complete "color plane" (channel)
-    const int plane_size = rows * cols;
+    const size_t plane_size = (size_t)rows * width;
 
     // Loop through the image row-by-row
     for (int y = 0; y < rows; ++y) {
         // Safely locate the exact memory address for the start of row 'y'
         const float* row_ptr = img.ptr<float>(y);
-        
+        float* dst0 = dst + 0 * plane_size + (size_t)y * width;
+        float* dst1 = dst + 1 * plane_size + (size_t)y * width;
+        float* dst2 = dst + 2 * plane_size + (size_t)y * width;
+
         // Loop through every pixel column in the current row
+        // Extract the interleaved channels explicitly
         for (int x = 0; x < cols; ++x) {
-            // Calculate the 1D coordinate of the pixel inside a flat 2D plane
-            int linear_idx = y * cols + x;
-            
-            // Extract the interleaved BGR channels explicitly
-            dst[0 * plane_size + linear_idx] = row_ptr[x * channels + 0]; // Channel 0
-            dst[1 * plane_size + linear_idx] = row_ptr[x * channels + 1]; // Channel 1
-            dst[2 * plane_size + linear_idx] = row_ptr[x * channels + 2]; // Channel 2
+            dst0[x] = row_ptr[x * channels + 0]; // Channel 0
+            dst1[x] = row_ptr[x * channels + 1]; // Channel 1
+            dst2[x] = row_ptr[x * channels + 2]; // Channel 2
         }
+
+        // Pad out to the batch width.
+        std::fill(dst0 + cols, dst0 + width, (float)padding[0]);
+        std::fill(dst1 + cols, dst1 + width, (float)padding[1]);
+        std::fill(dst2 + cols, dst2 + width, (float)padding[2]);
     }
-    return dst;
 }
 
 
@@ -10,10 +10,12 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <onnxruntime_cxx_api.h>
 #include <opencv2/opencv.hpp>
 #include "Common/Cpp/Logging/TaggedLogger.h"
 #include "Common/Cpp/Filesystem/FilePath.h"
+#include "Common/Cpp/Concurrency/SpinLock.h"
 #include "CommonFramework/Language.h"
 #include "CommonFramework/ImageTypes/ImageViewRGB32.h"
 #include "CommonFramework/ImageTools/ImageBoxes.h"
@@ -31,13 +33,46 @@ public:
 
     std::string recognize(const ImageViewRGB32& image);
 
+    //  Recognize a batch of images. Returns one string per image in the same
+    //  order. Crops of similar width are padded to a common width and sent
+    //  through the model together as one NCHW batch.
+    std::vector<std::string> recognize(const std::vector<ImageViewRGB32>& images);
+
     static std::pair<std::string, std::string> get_paths(Language language);
 
     std::string decode_CTC(float* data, const std::vector<int64_t>& shape, const std::vector<std::string>& dict);
 
 private:
+    static constexpr size_t MAX_BATCH_SIZE = 8;
+    //  Don't put crops in the same batch if the widest would be more than
+    //  this many times wider than the narrowest. It's all padding otherwise.
+    static constexpr double MAX_BATCH_WIDTH_RATIO = 1.5;
+
+    //  A crop resized to the model height and converted to float.
+    struct TextCrop{
+        cv::Mat image;
+        cv::Scalar background;
+    };
+
+    //  Input buffer and binding for one batch. Reused across calls.
+    struct BatchBuffers{
+        std::vector<float> input;
+        Ort::IoBinding binding;
+    };
+
     void load_dictionary(const Filesystem::Path& path);
 
+    //  Returns an empty image if there is nothing to read.
+    TextCrop preprocess(const ImageViewRGB32& image);
+    void recognize_batch(
+        const std::vector<TextCrop>& crops,
+        const size_t* indices, size_t count,
+        std::vector<std::string>& results
+    );
+
+    std::unique_ptr<BatchBuffers> checkout_buffers();
+    void checkin_buffers(std::unique_ptr<BatchBuffers> buffers);
+
     // Ort::Session det_session;
     Ort::Session m_rec_session;
     // Ort::MemoryInfo memory_info;
@@ -47,6 +82,13 @@ private:
     std::vector<std::string> m_dictionary;
     TaggedLogger m_logger;
 
+    Ort::MemoryInfo m_memory_info;
+    bool m_dynamic_batch;
+
+    //  The session is shared by all threads. Each concurrent call checks out
+    //  its own buffers.
+    SpinLock m_buffers_lock;
+    std::vector<std::unique_ptr<BatchBuffers>> m_idle_buffers;
 };
 
 // assumes the input image is RGB
@@ -65,6 +107,10 @@ cv::Scalar estimate_background_color(const cv::Mat& image);
 // NCHW: [All Blue Pixels...] [All Green Pixels...] [All Red Pixels...]
 std::vector<float> preprocess_NCHW(cv::Mat& img);
 
+// Same as above, but writes into "dst" with each plane "width" pixels wide.
+// Columns past the image width are filled with "padding".
+void preprocess_NCHW(const cv::Mat& img, float* dst, int width, const cv::Scalar& padding);
+
 
 cv::Mat imageviewrgb32_to_cv_mat_rgb(const ImageViewRGB32& image);
 
@@ -47,6 +47,7 @@ YOLOv5Detector::~YOLOv5Detector() = default;
 YOLOv5Detector::YOLOv5Detector(const std::string& model_path)
     : m_model_path(to_resource_filepath(model_path))
     , m_use_gpu(PerformanceOptions::instance().ONNX_OPTIONS.USE_GPU)
+    , m_input_size(PerformanceOptions::instance().ONNX_OPTIONS.YOLO_INPUT_SIZE)
 {
     if (!model_path.ends_with(".onnx")){
         throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, 
@@ -54,7 +55,7 @@ YOLOv5Detector::YOLOv5Detector(const std::string& model_path)
     }
 
     std::string label_file_path = model_path.substr(0, model_path.size() - 5) + "_label.txt";
-    m_yolo_session = std::make_unique<YOLOv5Session>(m_model_path, m_use_gpu);
+    m_yolo_session = std::make_unique<YOLOv5Session>(m_model_path, m_use_gpu, m_input_size);
 }
 
 bool YOLOv5Detector::detect(const ImageViewRGB32& screen){
@@ -62,10 +63,6 @@ bool YOLOv5Detector::detect(const ImageViewRGB32& screen){
         return false;
     }
 
-    cv::Mat frame_mat_bgra = to_OpenCV_ref(screen);
-    cv::Mat frame_mat_rgb;
-    cv::cvtColor(frame_mat_bgra, frame_mat_rgb, cv::COLOR_BGRA2RGB);
-
     m_output_boxes.clear();
 
     // fall back to CPU if fails with GPU.
@@ -73,14 +70,14 @@ bool YOLOv5Detector::detect(const ImageViewRGB32& screen){
         try{
             // if (m_use_gpu){ throw Ort::Exception("Testing.", ORT_FAIL); }  // to simulate GPU/CPU failure
             // If fails with GPU, fall back to CPU.
-            m_yolo_session->run(frame_mat_rgb, m_output_boxes);
+            m_yolo_session->run(screen, m_output_boxes);
             break;
         }catch (Ort::Exception& e){
             if (m_use_gpu){
                 std::cerr << "Warning: YOLO session failed using the GPU. Will reattempt with the CPU.\n" << e.what() << std::endl;
                 m_use_gpu = false;
                 std::vector<std::string> labels = m_yolo_session->get_label_names();
-                m_yolo_session = std::make_unique<YOLOv5Session>(m_model_path, m_use_gpu);
+                m_yolo_session = std::make_unique<YOLOv5Session>(m_model_path, m_use_gpu, m_input_size);
             }else{
                 throw InternalProgramError(nullptr, PA_CURRENT_FUNCTION, "Error: YOLO session failed even when using the CPU." + std::string(e.what()));
             }
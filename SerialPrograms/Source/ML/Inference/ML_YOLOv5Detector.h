@@ -47,6 +47,7 @@ public:
 protected:
     std::string m_model_path;
     bool m_use_gpu;
+    int m_input_size;
     // std::vector<std::string> m_labels;
     std::unique_ptr<YOLOv5Session> m_yolo_session;
     std::vector<DetectionBox> m_output_boxes;
@@ -13,8 +13,10 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/dnn.hpp>
 #include "3rdParty/ONNX/OnnxToolsPA.h"
+#include "Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat.h"
 #include "CommonFramework/GlobalAutoPaths.h"
 #include "CommonFramework/Logging/Logger.h"
+#include "CommonFramework/ImageTypes/ImageViewRGB32.h"
 #include "ML/Models/ML_ONNXRuntimeHelpers.h"
 #include "ML_YOLOv5Model.h"
 
@@ -132,12 +134,11 @@ std::tuple<int, int, double, double> resize_image_with_border(
 }
 
 
-YOLOv5Session::YOLOv5Session(const std::string& model_path, bool use_gpu)
+YOLOv5Session::YOLOv5Session(const std::string& model_path, bool use_gpu, int input_size)
     : m_session{create_session(model_path, ML_MODEL_CACHE_PATH() + "YOLOv5", use_gpu)}
     , m_memory_info{Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU)}
     , m_input_names{m_session.GetInputNames()}
     , m_output_names{m_session.GetOutputNames()}
-    , m_model_input(3*YOLO5_INPUT_IMAGE_SIZE*YOLO5_INPUT_IMAGE_SIZE)
 {
     // Extract YOLO labels from model metadata
     try{
@@ -173,14 +174,71 @@ YOLOv5Session::YOLOv5Session(const std::string& model_path, bool use_gpu)
     if (output_dims.size() != 3 || output_dims[2] <= 5){
         throw std::runtime_error("YOLOv5 model does not have the correct output dimension, found shape " + to_string(output_dims));
     }
-    m_output_shape[2] = output_dims[2];
     if (output_dims[2] - 5 != static_cast<int>(m_label_names.size())){
         throw std::runtime_error(
             "YOLOv5 model has " + std::to_string(output_dims[2]-5) +
             " output labels but YOLOv5Session was initialized with " + std::to_string(m_label_names.size()) + " labels"
         );
     }
-    m_model_output.resize(YOLO5_NUM_CANDIDATES * m_output_shape[2]);
+
+    std::vector<int64_t> input_dims = m_session.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    if (input_dims.size() != 4){
+        throw std::runtime_error("YOLOv5 model does not have the correct input dimension, found shape " + to_string(input_dims));
+    }
+    if (input_dims[2] > 0 && input_dims[3] > 0){
+        if (input_dims[2] != input_dims[3]){
+            throw std::runtime_error("YOLOv5 model input is not square, found shape " + to_string(input_dims));
+        }
+        m_input_size = (int)input_dims[2];
+        if (input_size > 0 && input_size != m_input_size){
+            global_logger_tagged().log(
+                "YOLOv5: Model was exported with a fixed input size of " + std::to_string(m_input_size) +
+                ". Ignoring requested input size of " + std::to_string(input_size) + ".",
+                COLOR_ORANGE
+            );
+        }
+    }else{
+        //  The model downsamples by up to 32x. So the input must be a multiple of that.
+        m_input_size = input_size > 0 ? input_size : DEFAULT_INPUT_SIZE;
+        m_input_size = std::max(m_input_size / 32 * 32, 32);
+    }
+
+    //  One candidate per anchor (3) per cell of each of the 3 output grids.
+    size_t cells = 0;
+    for (int stride : {8, 16, 32}){
+        size_t grid = m_input_size / stride;
+        cells += grid * grid;
+    }
+    m_num_candidates = 3 * cells;
+    if (output_dims[1] > 0 && (size_t)output_dims[1] != m_num_candidates){
+        throw std::runtime_error(
+            "YOLOv5 model has " + std::to_string(output_dims[1]) + " output candidates but expected " +
+            std::to_string(m_num_candidates) + " for input size " + std::to_string(m_input_size)
+        );
+    }
+
+    m_input_shape = {1, 3, m_input_size, m_input_size};
+    m_output_shape = {1, (int64_t)m_num_candidates, output_dims[2]};
+    m_model_input.resize(3 * (size_t)m_input_size * m_input_size);
+    m_model_output.resize(m_num_candidates * output_dims[2]);
+}
+
+
+YOLOv5Session::Letterbox YOLOv5Session::compute_letterbox(size_t original_width, size_t original_height) const{
+    double scale = std::min(
+        static_cast<double>(m_input_size) / original_width,
+        static_cast<double>(m_input_size) / original_height
+    );
+
+    Letterbox ret;
+    ret.width = std::min(static_cast<int>(original_width * scale), m_input_size);
+    ret.height = std::min(static_cast<int>(original_height * scale), m_input_size);
+    if (ret.width == 0 || ret.height == 0){
+        throw std::runtime_error("Input Image too small: " + std::to_string(original_width) + " x " + std::to_string(original_height));
+    }
+    ret.left = (m_input_size - ret.width) / 2;
+    ret.top = (m_input_size - ret.height) / 2;
+    return ret;
 }
 
 // input: rgb color order
@@ -190,10 +248,19 @@ void YOLOv5Session::run(const cv::Mat& input_image, std::vector<YOLOv5Session::D
 
     cv::Mat image_resized;
 
-    int x_shift = 0, y_shift = 0;
-    double x_scale = 1.0, y_scale = 1.0;
+    int x_shift, y_shift;
+    double x_scale, y_scale;
     std::tie(x_shift, y_shift, x_scale, y_scale) = resize_image_with_border(input_image, image_resized,
-        YOLO5_INPUT_IMAGE_SIZE, YOLO5_INPUT_IMAGE_SIZE, cv::Scalar(114, 114, 114));
+        m_input_size, m_input_size, cv::Scalar(114, 114, 114));
+
+    //  Postprocessing maps boxes back through the letterbox, so it must
+    //  describe exactly where the image was placed.
+    Letterbox letterbox = compute_letterbox(input_image.cols, input_image.rows);
+    if (x_shift != letterbox.left || y_shift != letterbox.top ||
+        x_scale != 1.0 / letterbox.width || y_scale != 1.0 / letterbox.height
+    ){
+        throw std::runtime_error("YOLO letterbox does not match the resized image.");
+    }
 
     // Declare a destination Mat for float32
     cv::Mat image_float;
@@ -213,6 +280,60 @@ void YOLOv5Session::run(const cv::Mat& input_image, std::vector<YOLOv5Session::D
         }
     }
 
+    run_model(letterbox, output_boxes);
+}
+
+void YOLOv5Session::run(const ImageViewRGB32& image, std::vector<YOLOv5Session::DetectionBox>& output_boxes){
+    Letterbox letterbox = compute_letterbox(image.width(), image.height());
+
+    const size_t size = m_input_size;
+    const size_t right = letterbox.left + letterbox.width;
+    const size_t bottom = letterbox.top + letterbox.height;
+    const float PADDING = 114.0f / 255.0f;
+
+    float* planes[3];
+    for (size_t c = 0; c < 3; c++){
+        float* plane = m_model_input.data() + c * size * size;
+        planes[c] = plane + letterbox.top * size + letterbox.left;
+
+        //  Only the border needs the padding color. The image goes everywhere else.
+        std::fill(plane, plane + letterbox.top * size, PADDING);
+        for (size_t row = letterbox.top; row < bottom; row++){
+            float* line = plane + row * size;
+            std::fill(line, line + letterbox.left, PADDING);
+            std::fill(line + right, line + size, PADDING);
+        }
+        std::fill(plane + bottom * size, plane + size * size, PADDING);
+    }
+
+    //  Same bilinear filter as cv::INTER_LINEAR in resize_image_with_border().
+    const uint32_t* pixels = image.data();
+    size_t bytes_per_row = image.bytes_per_row();
+    if (image.width() != (size_t)letterbox.width || image.height() != (size_t)letterbox.height){
+        m_resized.resize((size_t)letterbox.width * letterbox.height);
+        m_resampler.resample(
+            Kernels::ResampleFilter::BILINEAR,
+            image.data(), image.bytes_per_row(), image.width(), image.height(),
+            m_resized.data(), letterbox.width * sizeof(uint32_t), letterbox.width, letterbox.height
+        );
+        pixels = m_resized.data();
+        bytes_per_row = letterbox.width * sizeof(uint32_t);
+    }
+
+    Kernels::convert_RGB32_to_planar_float(
+        planes[0], planes[1], planes[2], size,
+        pixels, bytes_per_row,
+        letterbox.width, letterbox.height,
+        1.0f / 255.0f
+    );
+
+    run_model(letterbox, output_boxes);
+}
+
+void YOLOv5Session::run_model(const Letterbox& letterbox, std::vector<YOLOv5Session::DetectionBox>& output_boxes){
+    const float SCORE_THRESHOLD = 0.2f;
+    const float NMS_THRESHOLD = 0.45f;
+
     auto input_tensor = create_tensor<float>(m_memory_info, m_model_input, m_input_shape);
     auto output_tensor = create_tensor<float>(m_memory_info, m_model_output, m_output_shape);
 
@@ -224,54 +345,69 @@ void YOLOv5Session::run(const cv::Mat& input_image, std::vector<YOLOv5Session::D
     // auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
     // std::cout << "Yolov5 inference time: " << milliseconds << " ms" << std::endl;
 
-    const size_t cand_size = m_label_names.size() + 5;
+    const size_t num_labels = m_label_names.size();
+    const size_t cand_size = num_labels + 5;
 
-    std::vector<cv::Rect> pixel_boxes;
-    std::vector<int> indices;
-    std::vector<float> scores;
-    std::vector<size_t> labels;
+    m_pixel_boxes.clear();
+    m_scores.clear();
+    m_labels.clear();
+    m_indices.clear();
 
-    for (int i = 0; i < YOLO5_NUM_CANDIDATES; i++){
-        float cx = m_model_output[cand_size*i];
-        float cy = m_model_output[cand_size*i+1];
-        float w = m_model_output[cand_size*i+2];
-        float h = m_model_output[cand_size*i+3];
-        float sc = m_model_output[cand_size*i+4];
+    const float* candidate = m_model_output.data();
+    for (size_t i = 0; i < m_num_candidates; i++, candidate += cand_size){
+        float sc = candidate[4];
+
+        //  All scores are in [0, 1]. So if the objectness alone does not beat
+        //  the threshold, the final score can't either and NMSBoxes() would
+        //  drop the candidate anyway. This skips almost every candidate.
+        if (sc <= SCORE_THRESHOLD){
+            continue;
+        }
 
         float max_score = 0.0;
         size_t pred_label = 0;  // predicted label
-        for (size_t j_label = 0; j_label < m_label_names.size(); j_label++){
-            float score = m_model_output[cand_size*i+5+j_label];
+        for (size_t j_label = 0; j_label < num_labels; j_label++){
+            float score = candidate[5 + j_label];
             if (score > max_score){
                 max_score = score;
                 pred_label = j_label;
             }
         }
-        scores.push_back(max_score * sc); // sc is like a global confidence scale?
-        pixel_boxes.emplace_back((int)(cx - w / 2 + 0.5), (int)(cy - h / 2 + 0.5), int(w + 0.5), int(h + 0.5));
-        indices.push_back(i);
-        labels.push_back(pred_label);
+        float score = max_score * sc; // sc is like a global confidence scale?
+        if (score <= SCORE_THRESHOLD){
+            continue;
+        }
+
+        float cx = candidate[0];
+        float cy = candidate[1];
+        float w = candidate[2];
+        float h = candidate[3];
+        m_scores.push_back(score);
+        m_pixel_boxes.emplace_back((int)(cx - w / 2 + 0.5), (int)(cy - h / 2 + 0.5), int(w + 0.5), int(h + 0.5));
+        m_labels.push_back(pred_label);
     }
 
-    cv::dnn::NMSBoxes(pixel_boxes, scores, 0.2f, 0.45f, indices);
+    cv::dnn::NMSBoxes(m_pixel_boxes, m_scores, SCORE_THRESHOLD, NMS_THRESHOLD, m_indices);
 
-    // std::cout << "num found pixel_boxes " << indices.size() << std::endl;
+    // std::cout << "num found pixel_boxes " << m_indices.size() << std::endl;
     // return;
 
-    for (int index : indices)
+    const double x_scale = 1.0 / letterbox.width;
+    const double y_scale = 1.0 / letterbox.height;
+    for (int index : m_indices)
     {
-        // Note the model predicts on (640x640) images, we need to convert the detected pixel_boxes back to
-        // the full frame dimension.
-        double x = (pixel_boxes[index].x - x_shift) * x_scale;
-        double y = (pixel_boxes[index].y - y_shift) * y_scale;
-        double w = pixel_boxes[index].width * x_scale;
-        double h = pixel_boxes[index].height * y_scale;
-        // std::cout << scores[index] << " " <<  x << " " << y << " " << w << " " << h << std::endl;
+        // Note the model predicts on (m_input_size x m_input_size) images, we need to convert the
+        // detected pixel_boxes back to the full frame dimension.
+        double x = (m_pixel_boxes[index].x - letterbox.left) * x_scale;
+        double y = (m_pixel_boxes[index].y - letterbox.top) * y_scale;
+        double w = m_pixel_boxes[index].width * x_scale;
+        double h = m_pixel_boxes[index].height * y_scale;
+        // std::cout << m_scores[index] << " " <<  x << " " << y << " " << w << " " << h << std::endl;
 
         YOLOv5Session::DetectionBox b;
         b.box = ImageFloatBox(x, y, w, h);
-        b.score = scores[index];
-        b.label_idx = labels[index];
+        b.score = m_scores[index];
+        b.label_idx = m_labels[index];
         output_boxes.push_back(b);
     }
 }
@@ -11,9 +11,11 @@
 
 #include <opencv2/core/mat.hpp>
 #include <onnxruntime_cxx_api.h>
+#include "Kernels/ImageResample/Kernels_ImageResample.h"
 #include "CommonFramework/ImageTools/ImageBoxes.h"
 
 namespace PokemonAutomation{
+    class ImageViewRGB32;
 namespace ML{
 
 
@@ -29,18 +31,40 @@ public:
         size_t label_idx;
     };
 
-    YOLOv5Session(const std::string& model_path, bool use_gpu);
+    //  input_size: Side length of the square model input. Smaller is faster
+    //  but less accurate. Only models exported with dynamic input dimensions
+    //  can change it. Zero means the model's own size.
+    YOLOv5Session(const std::string& model_path, bool use_gpu, int input_size = 0);
 
+    int input_size() const{ return m_input_size; }
+
+    //  input: rgb color order
     void run(const cv::Mat& input_image, std::vector<DetectionBox>& detections);
 
+    //  Same as above, but letterboxes and normalizes the frame directly into
+    //  the model input without going through OpenCV.
+    void run(const ImageViewRGB32& image, std::vector<DetectionBox>& detections);
+
     const std::string& label_name(size_t idx) const { return m_label_names[idx]; }
     const std::vector<std::string>& get_label_names() const { return m_label_names; }
     // Return SIZE_MAX if no such label name exists.
     size_t label_index(const std::string& label_name) const;
     
 private:
-    const int YOLO5_INPUT_IMAGE_SIZE = 640;
-    const int YOLO5_NUM_CANDIDATES = 25200;
+    //  Placement of the resized image inside the square model input.
+    struct Letterbox{
+        int left;
+        int top;
+        int width;
+        int height;
+    };
+    Letterbox compute_letterbox(size_t original_width, size_t original_height) const;
+
+    //  Run the model on "m_model_input" and append the detections.
+    void run_model(const Letterbox& letterbox, std::vector<DetectionBox>& detections);
+
+private:
+    static constexpr int DEFAULT_INPUT_SIZE = 640;
 
     std::vector<std::string> m_label_names;
 
@@ -49,11 +73,21 @@ private:
     Ort::RunOptions m_run_options;
     std::vector<std::string> m_input_names, m_output_names;
 
-    const std::array<int64_t, 4> m_input_shape{1, 3, YOLO5_INPUT_IMAGE_SIZE, YOLO5_INPUT_IMAGE_SIZE};
-    std::array<int64_t, 3> m_output_shape{1, YOLO5_NUM_CANDIDATES, 0};
+    int m_input_size;
+    size_t m_num_candidates;
+    std::array<int64_t, 4> m_input_shape;
+    std::array<int64_t, 3> m_output_shape;
 
     std::vector<float> m_model_input;
     std::vector<float> m_model_output;
+
+    //  Scratch space reused across frames.
+    Kernels::ImageResampler m_resampler;
+    std::vector<uint32_t> m_resized;
+    std::vector<cv::Rect> m_pixel_boxes;
+    std::vector<float> m_scores;
+    std::vector<size_t> m_labels;
+    std::vector<int> m_indices;
 };
 
 // Find the first detection matching the given label ID from a YOLOv5Session detection output.
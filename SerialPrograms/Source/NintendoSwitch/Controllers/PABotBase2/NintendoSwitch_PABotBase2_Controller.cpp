@@ -69,6 +69,27 @@ void PABotBase2_Controller::wait_for_all(Cancellable* cancellable){
 }
 
 
+void PABotBase2_Controller::execute_schedule(
+    Cancellable* cancellable,
+    const SuperscalarScheduler::Schedule& schedule
+){
+    //  Batch the whole schedule so the commands share packets.
+    if (schedule.size() < 2 || !is_ready()){
+        ControllerWithScheduler::execute_schedule(cancellable, schedule);
+        return;
+    }
+    PABotBase2::CommandQueueManager& command_queue = m_connection.device().command_queue();
+    command_queue.begin_batch();
+    try{
+        ControllerWithScheduler::execute_schedule(cancellable, schedule);
+    }catch (...){
+        command_queue.abort_batch();
+        throw;
+    }
+    command_queue.end_batch(cancellable);
+}
+
+
 
 
 }
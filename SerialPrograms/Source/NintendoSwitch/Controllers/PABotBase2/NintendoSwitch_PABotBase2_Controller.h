@@ -41,6 +41,13 @@ public:
     void wait_for_all(Cancellable* cancellable);
 
 
+protected:
+    virtual void execute_schedule(
+        Cancellable* cancellable,
+        const SuperscalarScheduler::Schedule& schedule
+    ) override;
+
+
 protected:
     //  These are set on construction and never changed again. So it is safe to
     //  access these asynchronously.
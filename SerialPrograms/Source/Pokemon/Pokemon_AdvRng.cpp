@@ -6,6 +6,9 @@
 
 #include <cstddef>
 #include <algorithm>
+#include "Common/Cpp/CancellableScope.h"
+#include "Common/Cpp/Concurrency/Mutex.h"
+#include "CommonFramework/Tools/GlobalThreadPools.h"
 #include "Pokemon_AdvRng.h"
 
 namespace PokemonAutomation{
@@ -43,12 +46,42 @@ AdvRngState rngstate_from_internal_state(uint16_t seed, uint64_t advances, uint3
     return  {seed, advances, method, s0, s1, s2, s3, s4, s5};
 }
 
-AdvRngState rngstate_from_seed(uint16_t seed, uint64_t advances, AdvRngMethod method){
-    uint32_t state = seed;
-    state = increment_internal_rng_state(state);
-    for (uint64_t i=0; i<advances; i++){ 
-        state = increment_internal_rng_state(state);
+//  Multiplier and increment for jumping the LCG ahead by 2^k advances.
+//  The state is 32 bits, so the sequence repeats every 2^32 advances.
+struct AdvRngJump{
+    uint32_t mul;
+    uint32_t add;
+};
+struct AdvRngJumpTable{
+    AdvRngJump jumps[32];
+
+    constexpr AdvRngJumpTable()
+        : jumps{}
+    {
+        uint32_t mul = 0x41c64e6d;
+        uint32_t add = 0x6073;
+        for (size_t k = 0; k < 32; k++){
+            jumps[k] = {mul, add};
+            add = add * mul + add;
+            mul = mul * mul;
+        }
+    }
+};
+constexpr AdvRngJumpTable ADV_RNG_JUMP_TABLE;
+
+uint32_t jump_internal_rng_state(uint32_t state, uint64_t advances){
+    uint32_t steps = (uint32_t)advances;
+    for (size_t k = 0; steps != 0; k++, steps >>= 1){
+        if (steps & 1){
+            const AdvRngJump& jump = ADV_RNG_JUMP_TABLE.jumps[k];
+            state = state * jump.mul + jump.add;
+        }
     }
+    return state;
+}
+
+AdvRngState rngstate_from_seed(uint16_t seed, uint64_t advances, AdvRngMethod method){
+    uint32_t state = jump_internal_rng_state(seed, advances + 1);
 
     return rngstate_from_internal_state(seed, advances, state, method);
 }
@@ -327,14 +360,14 @@ int slot_to_unownform(AdvEncounterSlot slot){
     }
 }
 
-AdvWildPokemonResult wild_pokemon_from_state(AdvRngState state, std::vector<AdvEncounterSlot> slots, bool super_rod){
+AdvWildPokemonResult wild_pokemon_from_state(const AdvRngState& state, const std::vector<AdvEncounterSlot>& slots, bool super_rod){
 
     uint8_t slot_roll = (state.s0 >> 16) % 100;
     uint16_t level_roll = state.s1 >> 16;
     uint8_t nature = (state.s2 >> 16) % 25;
 
     uint8_t slot_num = slot_number_from_roll(slot_roll, slots.size(), super_rod);
-    AdvEncounterSlot slot = slots[slot_num];
+    const AdvEncounterSlot& slot = slots[slot_num];
     int unownform = slot_to_unownform(slot);
 
     uint8_t diff = slot.maxlevel - slot.minlevel;
@@ -496,7 +529,7 @@ AdvShinyType shiny_type_from_pid(uint32_t pid, uint16_t tid_xor_sid){
 }
 
 
-bool check_for_match(AdvPokemonResult res, AdvRngFilters target, int16_t gender_threshold, uint16_t tid_xor_sid){
+bool check_for_match(const AdvPokemonResult& res, const AdvRngFilters& target, int16_t gender_threshold, uint16_t tid_xor_sid){
     return (target.nature == AdvNature::Any || (res.nature == target.nature))
         && (target.ability == AdvAbility::Any || (res.ability == target.ability))
         && (target.gender == AdvGender::Any || (gender_from_gender_value(res.gender, gender_threshold) == target.gender))
@@ -509,7 +542,7 @@ bool check_for_match(AdvPokemonResult res, AdvRngFilters target, int16_t gender_
         && ((target.ivs.speed.low <= res.ivs.speed) && (target.ivs.speed.high >= res.ivs.speed));
 }
 
-bool check_for_match(AdvWildPokemonResult res, AdvRngFilters target, int16_t gender_threshold, uint16_t tid_xor_sid){
+bool check_for_match(const AdvWildPokemonResult& res, const AdvRngFilters& target, int16_t gender_threshold, uint16_t tid_xor_sid){
     std::string res_name = res.species.find("unown") != std::string::npos ? "unown" : res.species;
     return (target.species == res_name)
         && (target.level == res.level)
@@ -770,6 +803,460 @@ std::string gender_to_string(const AdvGender& gender){
 }
 
 
+//
+//  Parallel Search Engine
+//
+//  A search is split into tasks of (seed, method, block of advances) which are
+//  run on the computation thread pool. Each task screens its advances in
+//  batches of lanes with a branch-free prefilter that the compiler can
+//  vectorize. Only the lanes that survive are generated and checked exactly.
+//
+//  Each task keeps its own hits. They are concatenated in task order so the
+//  final result is in the same order as a serial scan.
+//
+
+const uint64_t ADV_SEARCH_BLOCK_ADVANCES = 4096;
+const uint64_t ADV_EGG_HELD_BLOCK_ADVANCES = 64;
+const size_t ADV_SEARCH_LANES = 64;
+
+std::vector<AdvRngMethod> search_methods(AdvRngMethod target, bool egg){
+    const AdvRngMethod POKEMON_METHODS[] = {
+        AdvRngMethod::Method1, AdvRngMethod::Method2, AdvRngMethod::Method4,
+    };
+    const AdvRngMethod EGG_METHODS[] = {
+        AdvRngMethod::Method1, AdvRngMethod::Method2, AdvRngMethod::Method3, AdvRngMethod::Method4,
+    };
+    std::vector<AdvRngMethod> ret;
+    auto add = [&](AdvRngMethod method){
+        if (target == AdvRngMethod::Any || target == method){
+            ret.emplace_back(method);
+        }
+    };
+    if (egg){
+        for (AdvRngMethod method : EGG_METHODS){
+            add(method);
+        }
+    }else{
+        for (AdvRngMethod method : POKEMON_METHODS){
+            add(method);
+        }
+    }
+    return ret;
+}
+
+//  Splits the inclusive range [min_advances, max_advances] into blocks.
+struct AdvAdvanceBlocks{
+    uint64_t min_advances;
+    uint64_t max_advances;
+    uint64_t block_size;
+    size_t blocks;
+
+    AdvAdvanceBlocks(uint64_t p_min_advances, uint64_t p_max_advances, uint64_t p_block_size)
+        : min_advances(p_min_advances)
+        , max_advances(p_max_advances)
+        , block_size(p_block_size)
+        , blocks(p_min_advances > p_max_advances ? 0 : (size_t)((p_max_advances - p_min_advances) / p_block_size + 1))
+    {}
+
+    uint64_t first(size_t block) const{
+        return min_advances + block * block_size;
+    }
+    uint64_t last(size_t block) const{
+        return std::min(max_advances, first(block) + (block_size - 1));
+    }
+};
+
+template <typename HitType>
+class AdvHitCollector{
+public:
+    AdvHitCollector(size_t tasks, const std::function<void(const HitType&)>& on_hit)
+        : m_on_hit(on_hit)
+        , m_task_hits(tasks)
+    {}
+
+    //  Only the thread running "task" may add to it.
+    void add(size_t task, const HitType& hit){
+        m_task_hits[task].emplace_back(hit);
+        if (m_on_hit){
+            std::lock_guard<Mutex> lg(m_lock);
+            m_on_hit(hit);
+        }
+    }
+
+    std::vector<HitType> take(){
+        size_t total = 0;
+        for (const std::vector<HitType>& hits : m_task_hits){
+            total += hits.size();
+        }
+        std::vector<HitType> ret;
+        ret.reserve(total);
+        for (std::vector<HitType>& hits : m_task_hits){
+            ret.insert(ret.end(), hits.begin(), hits.end());
+        }
+        return ret;
+    }
+
+private:
+    const std::function<void(const HitType&)>& m_on_hit;
+    Mutex m_lock;
+    std::vector<std::vector<HitType>> m_task_hits;
+};
+
+//  Conservative branch-free version of the nature and IV part of check_for_match().
+class AdvIvNaturePrefilter{
+public:
+    AdvIvNaturePrefilter(const AdvRngFilters& target)
+        : m_low{
+            target.ivs.hp.low, target.ivs.attack.low, target.ivs.defense.low,
+            target.ivs.speed.low, target.ivs.spatk.low, target.ivs.spdef.low,
+        }
+        , m_high{
+            target.ivs.hp.high, target.ivs.attack.high, target.ivs.defense.high,
+            target.ivs.speed.high, target.ivs.spatk.high, target.ivs.spdef.high,
+        }
+        , m_any_nature(target.nature == AdvNature::Any)
+        , m_nature((uint32_t)target.nature)
+    {}
+
+    bool nature(uint32_t pid) const{
+        return m_any_nature | (pid % 25 == m_nature);
+    }
+
+    //  "group1" and "group2" are the top 16 bits of the two IV states.
+    bool ivs(uint32_t group1, uint32_t group2) const{
+        return in_range(0, group1 & 0x1f)
+            & in_range(1, (group1 >> 5) & 0x1f)
+            & in_range(2, (group1 >> 10) & 0x1f)
+            & in_range(3, group2 & 0x1f)
+            & in_range(4, (group2 >> 5) & 0x1f)
+            & in_range(5, (group2 >> 10) & 0x1f);
+    }
+    bool ivs(AdvIVs& ivs) const{
+        bool ok = true;
+        for (int c = 0; c < 6; c++){
+            ok &= in_range(c, ivs[c]);
+        }
+        return ok;
+    }
+
+private:
+    bool in_range(int index, uint32_t iv) const{
+        return (m_low[index] <= (int32_t)iv) & ((int32_t)iv <= m_high[index]);
+    }
+
+private:
+    //  Indexed in AdvIVs::operator[] order.
+    int32_t m_low[6];
+    int32_t m_high[6];
+    bool m_any_nature;
+    uint32_t m_nature;
+};
+
+//  Fills "states" with the internal states of "count" consecutive advances
+//  starting from "state" and returns the state following the last one.
+uint32_t fill_internal_rng_states(uint32_t* states, size_t count, uint32_t state){
+    for (size_t i = 0; i < count; i++){
+        states[i] = state;
+        state = increment_internal_rng_state(state);
+    }
+    return state;
+}
+
+void search_pokemon_block(
+    AdvHitCollector<AdvRngState>& hits, size_t task,
+    const AdvRngFilters& target,
+    const AdvIvNaturePrefilter& prefilter,
+    uint16_t seed, AdvRngMethod method, bool roaming,
+    uint64_t min_advances, uint64_t max_advances,
+    int16_t gender_threshold, uint16_t tid_xor_sid,
+    Cancellable* cancellable
+){
+    //  Same state selection as pokemon_from_state().
+    size_t iv1_offset = 2;
+    size_t iv2_offset = 3;
+    switch (method){
+    case AdvRngMethod::Method2:
+        iv1_offset = 3;
+        iv2_offset = 4;
+        break;
+    case AdvRngMethod::Method4:
+        iv2_offset = 4;
+        break;
+    default:;
+    }
+    uint32_t iv1_mask = 0xffff;
+    uint32_t iv2_mask = 0xffff;
+    if (roaming){
+        iv1_offset = 2;
+        iv1_mask = 0xff;
+        iv2_mask = 0;
+    }
+
+    uint32_t states[ADV_SEARCH_LANES + 5];
+    bool pass[ADV_SEARCH_LANES];
+
+    uint32_t state = jump_internal_rng_state(seed, min_advances + 1);
+    uint64_t advance = min_advances;
+    while (true){
+        if (cancellable != nullptr){
+            cancellable->throw_if_cancelled();
+        }
+
+        //  The window overlaps the next batch by the 5 trailing states.
+        fill_internal_rng_states(states, ADV_SEARCH_LANES + 5, state);
+        state = states[ADV_SEARCH_LANES];
+
+        for (size_t i = 0; i < ADV_SEARCH_LANES; i++){
+            uint32_t pid = pid_from_states(states[i], states[i + 1]);
+            uint32_t group1 = (states[i + iv1_offset] >> 16) & iv1_mask;
+            uint32_t group2 = (states[i + iv2_offset] >> 16) & iv2_mask;
+            pass[i] = prefilter.nature(pid) & prefilter.ivs(group1, group2);
+        }
+
+        size_t lanes = (size_t)std::min<uint64_t>(ADV_SEARCH_LANES - 1, max_advances - advance) + 1;
+        for (size_t i = 0; i < lanes; i++){
+            if (!pass[i]){
+                continue;
+            }
+            AdvRngState hit{
+                seed, advance + i, method,
+                states[i], states[i + 1], states[i + 2],
+                states[i + 3], states[i + 4], states[i + 5],
+            };
+            AdvPokemonResult res = pokemon_from_state(hit, roaming);
+            if (check_for_match(res, target, gender_threshold, tid_xor_sid)){
+                hits.add(task, hit);
+            }
+        }
+
+        if (max_advances - advance < ADV_SEARCH_LANES){
+            return;
+        }
+        advance += ADV_SEARCH_LANES;
+    }
+}
+
+//  Rejects wild advances whose encounter slot or level cannot match.
+class AdvWildSlotPrefilter{
+public:
+    AdvWildSlotPrefilter(
+        const AdvRngFilters& target,
+        const std::vector<AdvEncounterSlot>& slots,
+        bool super_rod
+    )
+        : m_any_nature(target.nature == AdvNature::Any)
+        , m_nature((uint32_t)target.nature)
+        , m_target_level(target.level)
+    {
+        for (uint8_t roll = 0; roll < 100; roll++){
+            m_slot_from_roll[roll] = slot_number_from_roll(roll, slots.size(), super_rod);
+        }
+        for (const AdvEncounterSlot& slot : slots){
+            bool unown = slot.species.find("unown") != std::string::npos;
+            uint8_t diff = slot.maxlevel - slot.minlevel;
+            if (slot.maxlevel < slot.minlevel){
+                diff = 0;
+            }
+            m_slots.emplace_back(Slot{
+                (unown ? "unown" : slot.species) == target.species,
+                unown,
+                slot.minlevel,
+                (uint16_t)(diff + 1),
+            });
+        }
+    }
+
+    bool operator()(uint32_t s0, uint32_t s1, uint32_t s2) const{
+        uint8_t slot_num = m_slot_from_roll[(s0 >> 16) % 100];
+        if (slot_num >= m_slots.size()){
+            return false;
+        }
+        const Slot& slot = m_slots[slot_num];
+        if (!slot.species_ok){
+            return false;
+        }
+        uint8_t level = slot.minlevel + ((s1 >> 16) % slot.levels);
+        if (level != m_target_level){
+            return false;
+        }
+
+        //  Apart from Unown, the PID is rerolled until it has this nature.
+        return slot.unown || m_any_nature || (s2 >> 16) % 25 == m_nature;
+    }
+
+private:
+    struct Slot{
+        bool species_ok;
+        bool unown;
+        uint8_t minlevel;
+        uint16_t levels;
+    };
+
+    bool m_any_nature;
+    uint32_t m_nature;
+    uint8_t m_target_level;
+    uint8_t m_slot_from_roll[100];
+    std::vector<Slot> m_slots;
+};
+
+void search_wild_block(
+    AdvHitCollector<AdvRngState>& hits, size_t task,
+    const AdvRngFilters& target,
+    const AdvWildSlotPrefilter& prefilter,
+    const std::vector<AdvEncounterSlot>& encounter_slots,
+    uint16_t seed, AdvRngMethod method, bool super_rod,
+    uint64_t min_advances, uint64_t max_advances,
+    int16_t gender_threshold, uint16_t tid_xor_sid,
+    Cancellable* cancellable
+){
+    uint32_t states[ADV_SEARCH_LANES + 5];
+
+    uint32_t state = jump_internal_rng_state(seed, min_advances + 1);
+    uint64_t advance = min_advances;
+    while (true){
+        if (cancellable != nullptr){
+            cancellable->throw_if_cancelled();
+        }
+
+        fill_internal_rng_states(states, ADV_SEARCH_LANES + 5, state);
+        state = states[ADV_SEARCH_LANES];
+
+        size_t lanes = (size_t)std::min<uint64_t>(ADV_SEARCH_LANES - 1, max_advances - advance) + 1;
+        for (size_t i = 0; i < lanes; i++){
+            if (!prefilter(states[i], states[i + 1], states[i + 2])){
+                continue;
+            }
+            AdvRngState hit{
+                seed, advance + i, method,
+                states[i], states[i + 1], states[i + 2],
+                states[i + 3], states[i + 4], states[i + 5],
+            };
+            AdvWildPokemonResult res = wild_pokemon_from_state(hit, encounter_slots, super_rod);
+            if (check_for_match(res, target, gender_threshold, tid_xor_sid)){
+                hits.add(task, hit);
+            }
+        }
+
+        if (max_advances - advance < ADV_SEARCH_LANES){
+            return;
+        }
+        advance += ADV_SEARCH_LANES;
+    }
+}
+
+//  A pickup advance whose IVs (after inheritance) pass the filters.
+//  The IVs of an egg do not depend on the held advance, so these are found
+//  once and then paired against every held advance.
+struct AdvEggPickupCandidates{
+    std::vector<AdvRngState> states;
+    std::vector<uint32_t> pid_high;
+
+    void add(const AdvRngState& state){
+        states.emplace_back(state);
+        pid_high.emplace_back((state.s0 >> 16) << 16);
+    }
+};
+
+void search_egg_pickup_block(
+    AdvEggPickupCandidates& candidates,
+    const AdvIvNaturePrefilter& prefilter,
+    uint16_t seed, AdvRngMethod method,
+    uint64_t min_advances, uint64_t max_advances,
+    AdvIVs& parentA_ivs, AdvIVs& parentB_ivs,
+    Cancellable* cancellable
+){
+    AdvRngState state = rngstate_from_seed(seed, min_advances, method);
+    for (uint64_t a = min_advances;; a++){
+        if (cancellable != nullptr && (a - min_advances) % 1024 == 0){
+            cancellable->throw_if_cancelled();
+        }
+        AdvEggResult egg = egg_from_pickup_state(state, 0);
+        AdvIVs ivs = apply_inherited_ivs(egg.ivs, egg.inherited_ivs, parentA_ivs, parentB_ivs);
+        if (prefilter.ivs(ivs)){
+            candidates.add(state);
+        }
+        if (a == max_advances){
+            return;
+        }
+        advance_rng_state(state);
+    }
+}
+
+void search_egg_pickups(
+    AdvHitCollector<std::pair<AdvRngState, AdvRngState>>& hits, size_t task,
+    const AdvRngFilters& target,
+    const AdvIvNaturePrefilter& prefilter,
+    const AdvEggPickupCandidates& candidates,
+    const AdvRngState& held_state,
+    AdvIVs& parentA_ivs, AdvIVs& parentB_ivs,
+    int16_t gender_threshold, uint16_t tid_xor_sid
+){
+    uint16_t held_pid_half = (((held_state.s1) >> 16) % 0xfffe) + 1;
+
+    //  Gender and ability only depend on the held half of the PID.
+    if (target.ability != AdvAbility::Any && ability_from_pid(held_pid_half) != target.ability){
+        return;
+    }
+    if (target.gender != AdvGender::Any &&
+        gender_from_gender_value(gender_value_from_pid(held_pid_half), gender_threshold) != target.gender
+    ){
+        return;
+    }
+
+    bool pass[ADV_SEARCH_LANES];
+    const size_t total = candidates.states.size();
+    for (size_t c = 0; c < total; c += ADV_SEARCH_LANES){
+        size_t lanes = std::min(ADV_SEARCH_LANES, total - c);
+        const uint32_t* pid_high = candidates.pid_high.data() + c;
+        for (size_t i = 0; i < lanes; i++){
+            pass[i] = prefilter.nature(pid_high[i] + held_pid_half);
+        }
+        for (size_t i = 0; i < lanes; i++){
+            if (!pass[i]){
+                continue;
+            }
+            const AdvRngState& pickup_state = candidates.states[c + i];
+            AdvEggResult egg_res = egg_from_pickup_state(pickup_state, held_pid_half);
+            AdvPokemonResult poke_res = egg_to_pokemon(egg_res, parentA_ivs, parentB_ivs);
+            if (check_for_match(poke_res, target, gender_threshold, tid_xor_sid)){
+                hits.add(task, {held_state, pickup_state});
+            }
+        }
+    }
+}
+
+void search_egg_held_block(
+    AdvHitCollector<std::pair<AdvRngState, AdvRngState>>& hits, size_t task,
+    const AdvRngFilters& target,
+    const AdvIvNaturePrefilter& prefilter,
+    const AdvEggPickupCandidates& candidates,
+    uint16_t seed, AdvRngMethod method,
+    uint64_t min_advances, uint64_t max_advances,
+    AdvIVs& parentA_ivs, AdvIVs& parentB_ivs,
+    AdvEggCompatibility compatibility,
+    int16_t gender_threshold, uint16_t tid_xor_sid,
+    Cancellable* cancellable
+){
+    AdvRngState held_state = rngstate_from_seed(seed, min_advances, method);
+    for (uint64_t a = min_advances;; a++){
+        if (cancellable != nullptr){
+            cancellable->throw_if_cancelled();
+        }
+        if (egg_held_at_state(held_state.s0, compatibility)){
+            search_egg_pickups(
+                hits, task, target, prefilter, candidates, held_state,
+                parentA_ivs, parentB_ivs, gender_threshold, tid_xor_sid
+            );
+        }
+        if (a == max_advances){
+            return;
+        }
+        advance_rng_state(held_state);
+    }
+}
+
+
+
 AdvRngSearcher::AdvRngSearcher(uint16_t seed, AdvRngState state, bool roaming)
     : seed(seed)
     , state(state)
@@ -799,62 +1286,39 @@ AdvPokemonResult AdvRngSearcher::generate_pokemon(){
     return pokemon_from_state(state, roaming);
 }
 
-void AdvRngSearcher::search_advance_range(
-    std::vector<AdvRngState>& hits,
-    AdvRngFilters& target,
-    uint64_t min_advances,
-    uint64_t max_advances,
-    int16_t gender_threshold,
-    uint16_t tid_xor_sid
-){
-    for (uint8_t m=0; m<3; m++){
-        set_state_advances(min_advances);
-
-        AdvRngMethod method;
-        switch (m){
-        case 1:
-            method = AdvRngMethod::Method2;
-            break;
-        case 2:
-            method = AdvRngMethod::Method4;
-            break;
-        case 0:
-        default:
-            method = AdvRngMethod::Method1;
-            break;
-        }
-
-        if ((target.method != AdvRngMethod::Any) && (target.method != method)){
-            continue;
-        }else{
-            state.method = method;
-        }
-
-        for (uint64_t a=min_advances; a<=max_advances; a++){
-            AdvPokemonResult res = pokemon_from_state(state, roaming);
-            bool match = check_for_match(res, target, gender_threshold, tid_xor_sid);
-            if (match){
-               hits.emplace_back(state);
-            }
-            advance_state();
-        }
-    }
-}
-
 std::vector<AdvRngState> AdvRngSearcher::search(
     AdvRngFilters& target,
     const std::vector<uint16_t>& seeds,
     uint64_t min_advances,
     uint64_t max_advances,
     int16_t gender_threshold,
-    uint16_t tid_xor_sid
+    uint16_t tid_xor_sid,
+    Cancellable* cancellable,
+    const AdvRngHitCallback& on_hit
 ){
-    std::vector<AdvRngState> hits;
-    for (uint16_t seed : seeds){
-        set_seed(seed);
-        search_advance_range(hits, target, min_advances, max_advances, gender_threshold, tid_xor_sid);
-    }
-    return hits;
+    const std::vector<AdvRngMethod> methods = search_methods(target.method, false);
+    const AdvAdvanceBlocks blocks(min_advances, max_advances, ADV_SEARCH_BLOCK_ADVANCES);
+    const AdvIvNaturePrefilter prefilter(target);
+
+    //  Tasks are ordered by (seed, method, block).
+    const size_t tasks = seeds.size() * methods.size() * blocks.blocks;
+    AdvHitCollector<AdvRngState> hits(tasks, on_hit);
+    GlobalThreadPools::computation_normal().run_in_parallel(
+        [&](size_t task){
+            size_t block = task % blocks.blocks;
+            size_t method = task / blocks.blocks % methods.size();
+            size_t seed = task / blocks.blocks / methods.size();
+            search_pokemon_block(
+                hits, task, target, prefilter,
+                seeds[seed], methods[method], roaming,
+                blocks.first(block), blocks.last(block),
+                gender_threshold, tid_xor_sid,
+                cancellable
+            );
+        },
+        0, tasks, 1
+    );
+    return hits.take();
 }
 
 
@@ -888,49 +1352,6 @@ AdvWildPokemonResult AdvRngWildSearcher::generate_pokemon(bool super_rod){
     return wild_pokemon_from_state(state, encounter_slots, super_rod);
 }
 
-void AdvRngWildSearcher::search_advance_range(
-    std::vector<AdvRngState>& hits,
-    AdvRngFilters& target,
-    uint64_t min_advances,
-    uint64_t max_advances,
-    int16_t gender_threshold,
-    bool super_rod,
-    uint16_t tid_xor_sid
-){
-    for (uint8_t m=0; m<3; m++){
-        set_state_advances(min_advances);
-
-        AdvRngMethod method;
-        switch (m){
-        case 1:
-            method = AdvRngMethod::Method2;
-            break;
-        case 2:
-            method = AdvRngMethod::Method4;
-            break;
-        case 0:
-        default:
-            method = AdvRngMethod::Method1;
-            break;
-        }
-
-        if ((target.method != AdvRngMethod::Any) && (target.method != method)){
-            continue;
-        }else{
-            state.method = method;
-        }
-
-        for (uint64_t a=min_advances; a<=max_advances; a++){
-            AdvWildPokemonResult res = wild_pokemon_from_state(state, encounter_slots, super_rod);
-            bool match = check_for_match(res, target, gender_threshold, tid_xor_sid);
-            if (match){
-                hits.emplace_back(state);
-            }
-            advance_state();
-        }
-    }
-}
-
 std::vector<AdvRngState> AdvRngWildSearcher::search(
     AdvRngFilters& target,
     const std::vector<uint16_t>& seeds,
@@ -938,14 +1359,33 @@ std::vector<AdvRngState> AdvRngWildSearcher::search(
     uint64_t max_advances,
     int16_t gender_threshold,
     bool super_rod,
-    uint16_t tid_xor_sid
+    uint16_t tid_xor_sid,
+    Cancellable* cancellable,
+    const AdvRngHitCallback& on_hit
 ){
-    std::vector<AdvRngState> hits;
-    for (uint16_t seed : seeds){
-        set_seed(seed);
-        search_advance_range(hits, target, min_advances, max_advances, gender_threshold, super_rod, tid_xor_sid);
-    }
-    return hits;
+    const std::vector<AdvRngMethod> methods = search_methods(target.method, false);
+    const AdvAdvanceBlocks blocks(min_advances, max_advances, ADV_SEARCH_BLOCK_ADVANCES);
+    const AdvWildSlotPrefilter prefilter(target, encounter_slots, super_rod);
+
+    //  Tasks are ordered by (seed, method, block).
+    const size_t tasks = seeds.size() * methods.size() * blocks.blocks;
+    AdvHitCollector<AdvRngState> hits(tasks, on_hit);
+    GlobalThreadPools::computation_normal().run_in_parallel(
+        [&](size_t task){
+            size_t block = task % blocks.blocks;
+            size_t method = task / blocks.blocks % methods.size();
+            size_t seed = task / blocks.blocks / methods.size();
+            search_wild_block(
+                hits, task, target, prefilter, encounter_slots,
+                seeds[seed], methods[method], super_rod,
+                blocks.first(block), blocks.last(block),
+                gender_threshold, tid_xor_sid,
+                cancellable
+            );
+        },
+        0, tasks, 1
+    );
+    return hits.take();
 }
 
 
@@ -1006,77 +1446,9 @@ AdvPokemonResult AdvRngEggSearcher::generate_pokemon(AdvIVs& parentA_ivs, AdvIVs
     return egg_to_pokemon(egg_result, parentA_ivs, parentB_ivs);
 }
 
-void AdvRngEggSearcher::search_pickup_advances_range(
-        std::vector<std::pair<AdvRngState, AdvRngState>>& hits,
-        AdvRngFilters& target,
-        uint16_t held_pid_half,
-        uint64_t min_pickup_advances,
-        uint64_t max_pickup_advances,
-        AdvIVs& parentA_ivs,
-        AdvIVs& parentB_ivs,
-        int16_t gender_threshold,
-        uint16_t tid_xor_sid
-    ){
-    for (uint8_t m=0; m<4; m++){
-        set_pickup_state_advances(min_pickup_advances);
-
-        AdvRngMethod method;
-        switch (m){
-        case 1:
-            method = AdvRngMethod::Method2;
-            break;
-        case 2:
-            method = AdvRngMethod::Method3;
-            break;
-        case 3:
-            method = AdvRngMethod::Method4;
-            break;
-        case 0:
-        default:
-            method = AdvRngMethod::Method1;
-            break;
-        }
-
-        if ((target.method != AdvRngMethod::Any) && (target.method != method)){
-            continue;
-        }else{
-            pickup_state.method = method;
-        }
-
-        for (uint64_t a=min_pickup_advances; a<=max_pickup_advances; a++){
-            AdvEggResult egg_res = egg_from_pickup_state(pickup_state, held_pid_half);
-            AdvPokemonResult poke_res = egg_to_pokemon(egg_res, parentA_ivs, parentB_ivs);
-            bool match = check_for_match(poke_res, target, gender_threshold, tid_xor_sid);
-            if (match){
-                std::pair<AdvRngState, AdvRngState> state_pair = { held_state, pickup_state };
-                hits.emplace_back(state_pair);
-            }
-            advance_pickup_state();
-        }
-    }
-}
-
-void AdvRngEggSearcher::search_pickups(
-    std::vector<std::pair<AdvRngState, AdvRngState>>& hits,
-    AdvRngFilters& target,
-    uint16_t held_pid_half,
-    const std::vector<uint16_t>& pickup_seeds,
-    uint64_t min_pickup_advances,
-    uint64_t max_pickup_advances,
-    AdvIVs& parentA_ivs,
-    AdvIVs& parentB_ivs,
-    int16_t gender_threshold,
-    uint16_t tid_xor_sid
-){
-    for (uint16_t pickup_seed : pickup_seeds){
-        set_pickup_seed(pickup_seed);
-        search_pickup_advances_range(hits, target, held_pid_half, min_pickup_advances, max_pickup_advances, parentA_ivs, parentB_ivs, gender_threshold, tid_xor_sid);
-    }
-}
-
-void AdvRngEggSearcher::search_held_advances_range(
-    std::vector<std::pair<AdvRngState, AdvRngState>>& hits,
+std::vector<std::pair<AdvRngState, AdvRngState>> AdvRngEggSearcher::search(
     AdvRngFilters& target,
+    const std::vector<uint16_t>& held_seeds,
     uint64_t min_held_advances,
     uint64_t max_held_advances,
     const std::vector<uint16_t>& pickup_seeds,
@@ -1086,54 +1458,63 @@ void AdvRngEggSearcher::search_held_advances_range(
     AdvIVs& parentB_ivs,
     AdvEggCompatibility compatibility,
     int16_t gender_threshold,
-    uint16_t tid_xor_sid
+    uint16_t tid_xor_sid,
+    Cancellable* cancellable,
+    const AdvRngEggHitCallback& on_hit
 ){
-    set_held_state_advances(min_held_advances);
-    for (uint64_t a=min_held_advances; a<=max_held_advances; a++){
-        if (egg_held_at_state(held_state.s0, compatibility)){
-            uint16_t held_pid_half = (((held_state.s1) >> 16) % 0xfffe) + 1;
-            search_pickups(
-                hits, target, 
-                held_pid_half, pickup_seeds, 
-                min_pickup_advances, max_pickup_advances,
+    const AdvIvNaturePrefilter prefilter(target);
+
+    //  Find the pickup advances whose IVs can match. Tasks are ordered by
+    //  (seed, method, block).
+    const std::vector<AdvRngMethod> methods = search_methods(target.method, true);
+    const AdvAdvanceBlocks pickup_blocks(min_pickup_advances, max_pickup_advances, ADV_SEARCH_BLOCK_ADVANCES);
+    const size_t pickup_tasks = pickup_seeds.size() * methods.size() * pickup_blocks.blocks;
+    std::vector<AdvEggPickupCandidates> task_candidates(pickup_tasks);
+    GlobalThreadPools::computation_normal().run_in_parallel(
+        [&](size_t task){
+            size_t block = task % pickup_blocks.blocks;
+            size_t method = task / pickup_blocks.blocks % methods.size();
+            size_t seed = task / pickup_blocks.blocks / methods.size();
+            search_egg_pickup_block(
+                task_candidates[task], prefilter,
+                pickup_seeds[seed], methods[method],
+                pickup_blocks.first(block), pickup_blocks.last(block),
                 parentA_ivs, parentB_ivs,
-                gender_threshold, tid_xor_sid
+                cancellable
             );
-        }
-        
-        advance_held_state();
-    }
-
-    
-}
+        },
+        0, pickup_tasks, 1
+    );
 
-std::vector<std::pair<AdvRngState, AdvRngState>> AdvRngEggSearcher::search(
-    AdvRngFilters& target,
-    const std::vector<uint16_t>& held_seeds,
-    uint64_t min_held_advances,
-    uint64_t max_held_advances,
-    const std::vector<uint16_t>& pickup_seeds,
-    uint64_t min_pickup_advances,
-    uint64_t max_pickup_advances,
-    AdvIVs& parentA_ivs,
-    AdvIVs& parentB_ivs,
-    AdvEggCompatibility compatibility,
-    int16_t gender_threshold,
-    uint16_t tid_xor_sid
-){
-    std::vector<std::pair<AdvRngState, AdvRngState>> hits;
-    for (uint16_t h_seed : held_seeds){
-        set_held_seed(h_seed);
-        search_held_advances_range(
-            hits, target,
-            min_held_advances, max_held_advances, 
-            pickup_seeds, min_pickup_advances, max_pickup_advances,
-            parentA_ivs, parentB_ivs, compatibility, 
-            gender_threshold, tid_xor_sid
-        );
+    AdvEggPickupCandidates candidates;
+    for (const AdvEggPickupCandidates& item : task_candidates){
+        candidates.states.insert(candidates.states.end(), item.states.begin(), item.states.end());
+        candidates.pid_high.insert(candidates.pid_high.end(), item.pid_high.begin(), item.pid_high.end());
+    }
+    if (candidates.states.empty()){
+        return {};
     }
 
-    return hits;
+    //  Pair them with every held advance. Tasks are ordered by (seed, block).
+    const AdvAdvanceBlocks held_blocks(min_held_advances, max_held_advances, ADV_EGG_HELD_BLOCK_ADVANCES);
+    const size_t held_tasks = held_seeds.size() * held_blocks.blocks;
+    AdvHitCollector<std::pair<AdvRngState, AdvRngState>> hits(held_tasks, on_hit);
+    GlobalThreadPools::computation_normal().run_in_parallel(
+        [&](size_t task){
+            size_t block = task % held_blocks.blocks;
+            size_t seed = task / held_blocks.blocks;
+            search_egg_held_block(
+                hits, task, target, prefilter, candidates,
+                held_seeds[seed], held_state.method,
+                held_blocks.first(block), held_blocks.last(block),
+                parentA_ivs, parentB_ivs, compatibility,
+                gender_threshold, tid_xor_sid,
+                cancellable
+            );
+        },
+        0, held_tasks, 1
+    );
+    return hits.take();
 }
 
 
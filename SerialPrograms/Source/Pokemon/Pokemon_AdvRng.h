@@ -8,12 +8,14 @@
 #define Pokemon_AdvRng_H
 
 #include <stdint.h>
+#include <functional>
 #include <utility>
 #include <vector>
 #include <stdexcept>
 #include "Pokemon_StatsCalculation.h"
 
 namespace PokemonAutomation{
+class Cancellable;
 namespace Pokemon{
 
 struct AdvIvGroup{
@@ -191,6 +193,12 @@ struct AdvRngFilters{
     AdvRngMethod method;
 };
 
+// returns the internal LCG state after "advances" steps from "state" in O(log n)
+uint32_t jump_internal_rng_state(uint32_t state, uint64_t advances);
+
+// returns the search state for a seed at an arbitrary advance
+AdvRngState rngstate_from_seed(uint16_t seed, uint64_t advances, AdvRngMethod method);
+
 // updates the AdvObservedPokemon with info from leveling up
 // assumes levels are earned sequentially
 // input EVs are the ones earned since the last level up, not the total
@@ -215,6 +223,12 @@ AdvPokemonResult egg_to_pokemon(
     AdvIVs& parentB_ivs
 );
 
+// Search hits are reported through these as they are found. They are called
+// from the search threads, one at a time and in no particular order.
+// The vectors returned by search() are always ordered by seed, method, then advance.
+using AdvRngHitCallback = std::function<void(const AdvRngState& hit)>;
+using AdvRngEggHitCallback = std::function<void(const std::pair<AdvRngState, AdvRngState>& hit)>;
+
 class AdvRngSearcher{
 public:
     uint16_t seed;
@@ -236,17 +250,9 @@ public:
         uint64_t min_advances,
         uint64_t max_advances,
         int16_t gender_threshold = 126,
-        uint16_t tid_xor_sid = 0
-    );
-
-private:
-    void search_advance_range(
-        std::vector<AdvRngState>& hits,
-        AdvRngFilters& target,
-        uint64_t min_advances,
-        uint64_t max_advances,
-        int16_t gender_threshold,
-        uint16_t tid_xor_sid
+        uint16_t tid_xor_sid = 0,
+        Cancellable* cancellable = nullptr,
+        const AdvRngHitCallback& on_hit = nullptr
     );
 };
 
@@ -272,18 +278,9 @@ public:
         uint64_t max_advances,
         int16_t gender_threshold = 126,
         bool super_rod = false,
-        uint16_t tid_xor_sid = 0
-    );
-
-private:
-    void search_advance_range(
-        std::vector<AdvRngState>& hits,
-        AdvRngFilters& target,
-        uint64_t min_advances,
-        uint64_t max_advances,
-        int16_t gender_threshold,
-        bool super_rod,
-        uint16_t tid_xor_sid
+        uint16_t tid_xor_sid = 0,
+        Cancellable* cancellable = nullptr,
+        const AdvRngHitCallback& on_hit = nullptr
     );
 };
 
@@ -326,49 +323,9 @@ public:
         AdvIVs& parentB_ivs,
         AdvEggCompatibility compatibility,
         int16_t gender_threshold = 126,
-        uint16_t tid_xor_sid = 0
-    );
-
-private:
-
-    void search_held_advances_range(
-        std::vector<std::pair<AdvRngState, AdvRngState>>& hits,
-        AdvRngFilters& target,
-        uint64_t min_held_advances,
-        uint64_t max_held_advances,
-        const std::vector<uint16_t>& pickup_seeds,
-        uint64_t min_pickup_advances,
-        uint64_t max_pickup_advances,
-        AdvIVs& parentA_ivs,
-        AdvIVs& parentB_ivs,
-        AdvEggCompatibility compatibility,
-        int16_t gender_threshold,
-        uint16_t tid_xor_sid
-    );
-
-    void search_pickups(
-        std::vector<std::pair<AdvRngState, AdvRngState>>& hits,
-        AdvRngFilters& target,
-        uint16_t held_pid_half,
-        const std::vector<uint16_t>& pickup_seeds,
-        uint64_t min_pickup_advances,
-        uint64_t max_pickup_advances,
-        AdvIVs& parentA_ivs,
-        AdvIVs& parentB_ivs,
-        int16_t gender_threshold,
-        uint16_t tid_xor_sid
-    );
-
-    void search_pickup_advances_range(
-        std::vector<std::pair<AdvRngState, AdvRngState>>& hits,
-        AdvRngFilters& target,
-        uint16_t held_pid_half,
-        uint64_t min_pickup_advances,
-        uint64_t max_pickup_advances,
-        AdvIVs& parentA_ivs,
-        AdvIVs& parentB_ivs,
-        int16_t gender_threshold,
-        uint16_t tid_xor_sid
+        uint16_t tid_xor_sid = 0,
+        Cancellable* cancellable = nullptr,
+        const AdvRngEggHitCallback& on_hit = nullptr
     );
 };
 
@@ -42,23 +42,52 @@ Gf2Matrix128 Gf2Matrix128::identity(){
     return ret;
 }
 
-//  row i of the product is the XOR of every row k in x that has x[k][i] == 1.
-Gf2Matrix128 Gf2Matrix128::operator*(const Gf2Matrix128& x) const{
+Gf2Matrix128 Gf2Matrix128::transpose() const{
     Gf2Matrix128 ret;
     for (size_t i = 0; i < 128; i++){
-        Gf2Vec128 accumulator;
         uint64_t bits = m_rows[i].high;
         while (bits != 0){
             //  index = 63 - position.
-            accumulator ^= x.m_rows[63 - (size_t)std::countr_zero(bits)];
+            ret.m_rows[63 - (size_t)std::countr_zero(bits)].set(i, true);
             bits &= bits - 1;
         }
         bits = m_rows[i].low;
         while (bits != 0){
             //  index = 127 - position.
-            accumulator ^= x.m_rows[127 - (size_t)std::countr_zero(bits)];
+            ret.m_rows[127 - (size_t)std::countr_zero(bits)].set(i, true);
             bits &= bits - 1;
         }
+    }
+    return ret;
+}
+
+//  row i of the product is the XOR of every row k in x that has x[k][i] == 1.
+//
+//  The rows of x are grouped 4 at a time and each group gets a table of all
+//  16 XOR-combinations. Then each row of the product is 32 lookups. 4 bits
+//  rather than 8 since the tables are rebuilt for every product and this
+//  keeps them small enough to stay in L1.
+Gf2Matrix128 Gf2Matrix128::operator*(const Gf2Matrix128& x) const{
+    std::array<Gf2Vec128, 32 * 16> tables;
+    for (size_t group = 0; group < 32; group++){
+        Gf2Vec128* table = tables.data() + group * 16;
+        table[0] = Gf2Vec128();
+        for (size_t nibble = 1; nibble < 16; nibble++){
+            size_t position = (size_t)std::countr_zero(nibble);
+            table[nibble] = table[nibble & (nibble - 1)] ^ x.m_rows[group * 4 + 3 - position];
+        }
+    }
+
+    Gf2Matrix128 ret;
+    for (size_t i = 0; i < 128; i++){
+        const Gf2Vec128* table = tables.data();
+        Gf2Vec128 accumulator;
+        for (size_t shift = 64; shift > 0; shift -= 4, table += 16){
+            accumulator ^= table[(m_rows[i].high >> (shift - 4)) & 0xf];
+        }
+        for (size_t shift = 64; shift > 0; shift -= 4, table += 16){
+            accumulator ^= table[(m_rows[i].low >> (shift - 4)) & 0xf];
+        }
         ret.m_rows[i] = accumulator;
     }
     return ret;
@@ -86,6 +115,71 @@ Gf2Matrix128 Gf2Matrix128::pow(uint64_t exponent) const{
     return ret;
 }
 
+
+
+Gf2MatrixLookup128::Gf2MatrixLookup128(const Gf2Matrix128& matrix){
+    //  "matrix * x" is the XOR of the columns selected by x.
+    Gf2Matrix128 columns = matrix.transpose();
+
+    m_tables.resize(16 * 256);
+    for (size_t group = 0; group < 16; group++){
+        size_t base = group * 256;
+
+        //  The MSB of each byte is the lowest index in the group. Each entry
+        //  is an earlier entry plus one more column.
+        for (size_t byte = 1; byte < 256; byte++){
+            size_t position = (size_t)std::countr_zero(byte);
+            m_tables[base + byte] = m_tables[base + (byte & (byte - 1))] ^ columns[group * 8 + 7 - position];
+        }
+    }
+}
+Gf2Vec128 Gf2MatrixLookup128::operator*(const Gf2Vec128& column) const{
+    const Gf2Vec128* table = m_tables.data();
+    Gf2Vec128 ret;
+    for (size_t shift = 64; shift > 0; shift -= 8, table += 256){
+        ret ^= table[(column.high >> (shift - 8)) & 0xff];
+    }
+    for (size_t shift = 64; shift > 0; shift -= 8, table += 256){
+        ret ^= table[(column.low >> (shift - 8)) & 0xff];
+    }
+    return ret;
+}
+
+
+
+Gf2JumpTable128::Gf2JumpTable128(const Gf2Matrix128& step){
+    m_powers[0] = step;
+    for (size_t c = 1; c < m_powers.size(); c++){
+        m_powers[c] = m_powers[c - 1] * m_powers[c - 1];
+    }
+}
+const Gf2MatrixLookup128& Gf2JumpTable128::lookup(size_t k) const{
+    std::call_once(m_lookup_once[k], [this, k]{
+        m_lookups[k] = std::make_unique<Gf2MatrixLookup128>(m_powers[k]);
+    });
+    return *m_lookups[k];
+}
+Gf2Matrix128 Gf2JumpTable128::power(uint64_t count) const{
+    Gf2Matrix128 ret = Gf2Matrix128::identity();
+    for (size_t bit = 0; count != 0; count >>= 1, bit++){
+        if ((count & 1) != 0){
+            ret = m_powers[bit] * ret;
+        }
+    }
+    return ret;
+}
+Gf2Vec128 Gf2JumpTable128::jump(Gf2Vec128 state, uint64_t count) const{
+    //  Powers of the same matrix commute so the order doesn't matter.
+    for (size_t bit = 0; count != 0; count >>= 1, bit++){
+        if ((count & 1) != 0){
+            state = lookup(bit) * state;
+        }
+    }
+    return state;
+}
+
+
+
 Gf2SolveResult gf2_solve_128(
     const std::vector<Gf2Vec128>& equations,
     const std::vector<bool>& rhs
@@ -12,6 +12,8 @@
 #include <array>
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
 
 namespace PokemonAutomation{
 namespace Pokemon{
@@ -48,13 +50,23 @@ class Gf2Matrix128{
 public:
     static Gf2Matrix128 identity();
 
+    //  Build the matrix of a linear map by feeding it each basis vector.
+    template <typename LinearMap>
+    static Gf2Matrix128 from_linear_map(LinearMap&& map);
+
     const Gf2Vec128& operator[](size_t row) const{ return m_rows[row]; }
     Gf2Vec128& operator[](size_t row){ return m_rows[row]; }
 
     bool operator==(const Gf2Matrix128& x) const{ return m_rows == x.m_rows; }
     bool operator!=(const Gf2Matrix128& x) const{ return !(*this == x); }
 
+    Gf2Matrix128 transpose() const;
+
+    //  Uses 4-bit lookup tables over the rows of "x".
     Gf2Matrix128 operator*(const Gf2Matrix128& x) const;
+
+    //  One dot product per row. For many vectors with the same matrix, build
+    //  a Gf2MatrixLookup128 instead.
     Gf2Vec128 operator*(const Gf2Vec128& column) const;
 
     Gf2Matrix128 pow(uint64_t exponent) const;
@@ -63,6 +75,70 @@ private:
     std::array<Gf2Vec128, 128> m_rows;
 };
 
+template <typename LinearMap>
+Gf2Matrix128 Gf2Matrix128::from_linear_map(LinearMap&& map){
+    Gf2Matrix128 matrix;
+    for (size_t column = 0; column < 128; column++){
+        Gf2Vec128 basis;
+        basis.set(column, true);
+
+        Gf2Vec128 image = map(basis);
+
+        for (size_t row = 0; row < 128; row++){
+            if (image.get(row)){
+                matrix[row].set(column, true);
+            }
+        }
+    }
+    return matrix;
+}
+
+
+//  A matrix prepared for fast "matrix * vector" with the "Method of Four
+//  Russians". The columns are grouped 8 at a time and each group gets a table
+//  of all 256 XOR-combinations of its columns. A product is then 16 lookups
+//  instead of 128 dot products.
+//
+//  Each one is 64 KB and costs a few matrix products to build, so this only
+//  pays off when the same matrix is applied to many vectors.
+class Gf2MatrixLookup128{
+public:
+    explicit Gf2MatrixLookup128(const Gf2Matrix128& matrix);
+
+    Gf2Vec128 operator*(const Gf2Vec128& column) const;
+
+private:
+    std::vector<Gf2Vec128> m_tables;
+};
+
+
+//  The powers T^(2^k) of a step matrix T for every k that fits in a 64-bit
+//  count. Jumping "count" steps is then one lookup product per set bit of
+//  "count" without ever building T^count.
+//
+//  The lookups are built the first time each power is used.
+class Gf2JumpTable128{
+public:
+    explicit Gf2JumpTable128(const Gf2Matrix128& step);
+
+    //  T^(2^k)
+    const Gf2Matrix128& power_of_two(size_t k) const{ return m_powers[k]; }
+
+    //  T^count
+    Gf2Matrix128 power(uint64_t count) const;
+
+    //  T^count * state
+    Gf2Vec128 jump(Gf2Vec128 state, uint64_t count) const;
+
+private:
+    const Gf2MatrixLookup128& lookup(size_t k) const;
+
+private:
+    std::array<Gf2Matrix128, 64> m_powers;
+    mutable std::array<std::once_flag, 64> m_lookup_once;
+    mutable std::array<std::unique_ptr<Gf2MatrixLookup128>, 64> m_lookups;
+};
+
 
 struct Gf2SolveResult{
     //  False means the system has no solution at all. This normally indicates
@@ -10,6 +10,10 @@
 namespace PokemonAutomation{
 namespace Pokemon{
 
+
+const uint64_t JUMP_THRESHOLD = 512;
+
+
 Xoroshiro128PlusState::Xoroshiro128PlusState(uint64_t s0, uint64_t s1)
     : s0(s0)
     , s1(s1)
@@ -40,6 +44,38 @@ uint64_t Xoroshiro128Plus::next(){
     return result;
 }
 
+void Xoroshiro128Plus::prev(){
+    uint64_t s1 = rotl(state.s1, 27);
+    const uint64_t s0 = rotl(state.s0 ^ s1 ^ (s1 << 16), 40);
+    s1 ^= s0;
+
+    state.s0 = s0;
+    state.s1 = s1;
+}
+
+void Xoroshiro128Plus::advance(uint64_t count){
+    if (count < JUMP_THRESHOLD){
+        for (uint64_t c = 0; c < count; c++){
+            next();
+        }
+        return;
+    }
+    state = xoroshiro128plus_state_from_vector(
+        xoroshiro128plus_jump_table().jump(xoroshiro128plus_state_to_vector(state), count)
+    );
+}
+void Xoroshiro128Plus::rewind(uint64_t count){
+    if (count < JUMP_THRESHOLD){
+        for (uint64_t c = 0; c < count; c++){
+            prev();
+        }
+        return;
+    }
+    state = xoroshiro128plus_state_from_vector(
+        xoroshiro128plus_inverse_jump_table().jump(xoroshiro128plus_state_to_vector(state), count)
+    );
+}
+
 Xoroshiro128PlusState Xoroshiro128Plus::get_state(){
     return state;
 }
@@ -266,5 +302,45 @@ Xoroshiro128Plus Xoroshiro128Plus::xoroshiro128plus_from_last_bits(std::pair<uin
 }
 
 
+
+Gf2Vec128 xoroshiro128plus_state_to_vector(const Xoroshiro128PlusState& state){
+    return Gf2Vec128(state.s0, state.s1);
+}
+Xoroshiro128PlusState xoroshiro128plus_state_from_vector(const Gf2Vec128& vector){
+    return Xoroshiro128PlusState(vector.high, vector.low);
+}
+
+template <typename StepFunction>
+static Gf2Matrix128 build_step_matrix(StepFunction&& step){
+    return Gf2Matrix128::from_linear_map([&](const Gf2Vec128& vector){
+        Xoroshiro128Plus rng(xoroshiro128plus_state_from_vector(vector));
+        step(rng);
+        return xoroshiro128plus_state_to_vector(rng.get_state());
+    });
+}
+
+const Gf2Matrix128& xoroshiro128plus_transition_matrix(){
+    static Gf2Matrix128 matrix = build_step_matrix([](Xoroshiro128Plus& rng){ rng.next(); });
+    return matrix;
+}
+const Gf2Matrix128& xoroshiro128plus_inverse_transition_matrix(){
+    static Gf2Matrix128 matrix = build_step_matrix([](Xoroshiro128Plus& rng){ rng.prev(); });
+    return matrix;
+}
+
+const Gf2JumpTable128& xoroshiro128plus_jump_table(){
+    static Gf2JumpTable128 table(xoroshiro128plus_transition_matrix());
+    return table;
+}
+const Gf2JumpTable128& xoroshiro128plus_inverse_jump_table(){
+    static Gf2JumpTable128 table(xoroshiro128plus_inverse_transition_matrix());
+    return table;
+}
+
+Gf2Matrix128 xoroshiro128plus_transition_power(uint64_t count){
+    return xoroshiro128plus_jump_table().power(count);
+}
+
+
 }
 }
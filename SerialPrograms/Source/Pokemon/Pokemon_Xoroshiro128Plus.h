@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <utility>
 #include <vector>
+#include "Pokemon_Gf2Matrix.h"
 
 namespace PokemonAutomation{
 namespace Pokemon{
@@ -28,6 +29,14 @@ public:
     Xoroshiro128Plus(uint64_t s0, uint64_t s1);
     uint64_t next();
     uint64_t nextInt(uint64_t);
+
+    // Step backwards. Undoes exactly one next().
+    void prev();
+
+    // Large counts jump with the cached transition matrices instead of stepping.
+    void advance(uint64_t count);
+    void rewind(uint64_t count);
+
     Xoroshiro128PlusState get_state();
     std::vector<bool> generate_last_bit_sequence(size_t max_advances);
 
@@ -47,6 +56,20 @@ private:
     uint64_t rotl(const uint64_t x, int k);
 };
 
+
+// "high" is s0 and "low" is s1.
+Gf2Vec128 xoroshiro128plus_state_to_vector(const Xoroshiro128PlusState& state);
+Xoroshiro128PlusState xoroshiro128plus_state_from_vector(const Gf2Vec128& vector);
+
+const Gf2Matrix128& xoroshiro128plus_transition_matrix();
+const Gf2Matrix128& xoroshiro128plus_inverse_transition_matrix();
+
+const Gf2JumpTable128& xoroshiro128plus_jump_table();
+const Gf2JumpTable128& xoroshiro128plus_inverse_jump_table();
+
+Gf2Matrix128 xoroshiro128plus_transition_power(uint64_t count);
+
+
 }
 }
 #endif
@@ -79,7 +79,7 @@ void Xorshift128::advance(uint64_t count){
         return;
     }
     m_state = xorshift128_state_from_vector(
-        xorshift128_transition_power(count) * xorshift128_state_to_vector(m_state)
+        xorshift128_jump_table().jump(xorshift128_state_to_vector(m_state), count)
     );
 }
 void Xorshift128::rewind(uint64_t count){
@@ -90,7 +90,7 @@ void Xorshift128::rewind(uint64_t count){
         return;
     }
     m_state = xorshift128_state_from_vector(
-        xorshift128_inverse_transition_matrix().pow(count) * xorshift128_state_to_vector(m_state)
+        xorshift128_inverse_jump_table().jump(xorshift128_state_to_vector(m_state), count)
     );
 }
 
@@ -98,22 +98,11 @@ void Xorshift128::rewind(uint64_t count){
 
 template <typename StepFunction>
 static Gf2Matrix128 build_step_matrix(StepFunction&& step){
-    Gf2Matrix128 matrix;
-    for (size_t column = 0; column < 128; column++){
-        Gf2Vec128 basis;
-        basis.set(column, true);
-
-        Xorshift128 rng(xorshift128_state_from_vector(basis));
+    return Gf2Matrix128::from_linear_map([&](const Gf2Vec128& vector){
+        Xorshift128 rng(xorshift128_state_from_vector(vector));
         step(rng);
-        Gf2Vec128 image = xorshift128_state_to_vector(rng.state());
-
-        for (size_t row = 0; row < 128; row++){
-            if (image.get(row)){
-                matrix[row].set(column, true);
-            }
-        }
-    }
-    return matrix;
+        return xorshift128_state_to_vector(rng.state());
+    });
 }
 
 const Gf2Matrix128& xorshift128_transition_matrix(){
@@ -125,28 +114,17 @@ const Gf2Matrix128& xorshift128_inverse_transition_matrix(){
     return matrix;
 }
 
-//  T^(2^k) for every k that fits in a 64-bit count.
-static const std::array<Gf2Matrix128, 64>& xorshift128_transition_powers_of_two(){
-    static std::array<Gf2Matrix128, 64> table = [](){
-        std::array<Gf2Matrix128, 64> ret;
-        ret[0] = xorshift128_transition_matrix();
-        for (size_t c = 1; c < ret.size(); c++){
-            ret[c] = ret[c - 1] * ret[c - 1];
-        }
-        return ret;
-    }();
+const Gf2JumpTable128& xorshift128_jump_table(){
+    static Gf2JumpTable128 table(xorshift128_transition_matrix());
+    return table;
+}
+const Gf2JumpTable128& xorshift128_inverse_jump_table(){
+    static Gf2JumpTable128 table(xorshift128_inverse_transition_matrix());
     return table;
 }
 
 Gf2Matrix128 xorshift128_transition_power(uint64_t count){
-    const std::array<Gf2Matrix128, 64>& powers = xorshift128_transition_powers_of_two();
-    Gf2Matrix128 ret = Gf2Matrix128::identity();
-    for (size_t bit = 0; count != 0; count >>= 1, bit++){
-        if ((count & 1) != 0){
-            ret = powers[bit] * ret;
-        }
-    }
-    return ret;
+    return xorshift128_jump_table().power(count);
 }
 
 
@@ -71,6 +71,10 @@ private:
 const Gf2Matrix128& xorshift128_transition_matrix();
 const Gf2Matrix128& xorshift128_inverse_transition_matrix();
 
+//  Cached powers of the above for "advance()" and "rewind()".
+const Gf2JumpTable128& xorshift128_jump_table();
+const Gf2JumpTable128& xorshift128_inverse_jump_table();
+
 Gf2Matrix128 xorshift128_transition_power(uint64_t count);
 
 
@@ -6,7 +6,7 @@
 
 #include "Common/Cpp/PrettyPrint.h"
 #include "Common/Cpp/Concurrency/SpinLock.h"
-#include "Kernels/Waterfill/Kernels_Waterfill_Session.h"
+#include "Kernels/Waterfill/Kernels_Waterfill.h"
 #include "CommonFramework/Tools/GlobalThreadPools.h"
 #include "CommonTools/Images/BinaryImage_FilterRgb32.h"
 #include "PokemonSwSh/Inference/ShinyDetection/PokemonSwSh_SparkleDetectorRadial.h"
@@ -86,11 +86,12 @@ void ShinySparkleSetBDSP::update_alphas(){
 
 
 
-ShinySparkleSetBDSP find_sparkles(size_t screen_area, WaterfillSession& session){
+ShinySparkleSetBDSP find_sparkles(size_t screen_area, const PackedBinaryMatrix& matrix){
     ShinySparkleSetBDSP sparkles;
-    auto finder = session.make_iterator(20);
-    WaterfillObject object;
-    while (finder->find_next(object, true)){
+    std::vector<WaterfillObject> objects = find_objects_parallel(
+        GlobalThreadPools::computation_realtime(), matrix, 20, true
+    );
+    for (const WaterfillObject& object : objects){
         PokemonSwSh::RadialSparkleDetector radial_sparkle(screen_area, object);
         if (radial_sparkle.is_ball()){
             sparkles.balls.emplace_back(object.min_x, object.min_y, object.max_x, object.max_y);
@@ -123,9 +124,7 @@ void ShinySparkleSetBDSP::read_from_image(size_t screen_area, const ImageViewRGB
     double best_alpha = 0;
     GlobalThreadPools::computation_realtime().run_in_parallel(
         [&](size_t index){
-            auto session = make_WaterfillSession();
-            session->set_source(matrices[index]);
-            ShinySparkleSetBDSP sparkles = find_sparkles(screen_area, *session);
+            ShinySparkleSetBDSP sparkles = find_sparkles(screen_area, matrices[index]);
             sparkles.update_alphas();
             double alpha = sparkles.alpha_overall();
 
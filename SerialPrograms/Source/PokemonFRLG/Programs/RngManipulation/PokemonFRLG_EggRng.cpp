@@ -449,7 +449,7 @@ bool EggRng::reset_and_check_seed(
         MAX_HISTORY_LENGTH, candies_left, AdvRngMethod::Any, false,
         stats.errors, NOTIFICATION_ERROR_RECOVERABLE,
         [&](AdvRngFilters& f){
-            return get_wild_search_results(env.console, wild_searcher, f, SEED_VALUES, wild_advances_estimate, WILD_ADVANCES_RADIUS, species_stats.gender_threshold);
+            return get_wild_search_results(env.console, wild_searcher, f, SEED_VALUES, wild_advances_estimate, WILD_ADVANCES_RADIUS, species_stats.gender_threshold, false, 0, &context);
         },
         [&](const std::vector<AdvRngState>& h){
             if (pickup_frame){ PICKUP_CALIBRATION.set_hits(h); }else{ HELD_CALIBRATION.set_hits(h); }
@@ -550,12 +550,19 @@ bool EggRng::held_frame_check(
         EggRefineOptions{ true, 1, 0 },
         stats.errors, NOTIFICATION_ERROR_RECOVERABLE,
         [&](AdvRngFilters& f){
+            //  Show held hits while the search is still running.
+            std::vector<AdvRngState> partial_hits;
             return get_egg_search_results(
                 env.console, egg_searcher, f,
                 { current_seed }, { current_seed },
                 HELD_ADVANCES, advances_radius, advances_estimate, HELD_CHECK_ADVANCES_RADIUS,
                 PARENT_A, PARENT_B, COMPATIBILITY,
-                EGG_STATS.gender_threshold, 0
+                EGG_STATS.gender_threshold, 0,
+                &context,
+                [&](const std::pair<AdvRngState, AdvRngState>& hit){
+                    partial_hits.emplace_back(hit.first);
+                    HELD_CALIBRATION.set_hits(partial_hits);
+                }
             );
         },
         [&](const std::vector<AdvRngState>& h){ HELD_CALIBRATION.set_hits(h); },
@@ -662,12 +669,19 @@ bool EggRng::pickup_frame_check(
         EggRefineOptions{ false, 2, 1 },
         stats.errors, NOTIFICATION_ERROR_RECOVERABLE,
         [&](AdvRngFilters& f){
+            //  Show pickup hits while the search is still running.
+            std::vector<AdvRngState> partial_hits;
             return get_egg_search_results(
                 env.console, egg_searcher, f,
                 { TARGET_HELD_SEED }, { TARGET_PICKUP_SEED },
                 HELD_ADVANCES, 0, PICKUP_ADVANCES, advances_radius,
                 PARENT_A, PARENT_B, COMPATIBILITY,
-                EGG_STATS.gender_threshold, 0
+                EGG_STATS.gender_threshold, 0,
+                &context,
+                [&](const std::pair<AdvRngState, AdvRngState>& hit){
+                    partial_hits.emplace_back(hit.second);
+                    PICKUP_CALIBRATION.set_hits(partial_hits);
+                }
             );
         },
         [&](const std::vector<AdvRngState>& h){ PICKUP_CALIBRATION.set_hits(h); },
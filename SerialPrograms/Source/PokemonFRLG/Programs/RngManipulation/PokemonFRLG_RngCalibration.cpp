@@ -196,15 +196,15 @@ std::vector<AdvRngState> get_search_results(
     const uint64_t& ADVANCES, 
     const uint64_t& advances_radius,
     int16_t gender_threshold,
-    uint16_t tid_xor_sid
-
+    uint16_t tid_xor_sid,
+    Cancellable* cancellable
 ){
     std::vector<AdvRngState> search_hits;
     for (int i=0; i<4; i++){
         uint64_t adv_radius = advances_radius * (uint64_t(1) << i);
         uint64_t min_adv = ADVANCES - std::min(uint64_t(ADVANCES), adv_radius);    
         uint64_t max_adv = ADVANCES + adv_radius;
-        search_hits = searcher.search(filters, SEED_VALUES, min_adv, max_adv, gender_threshold, tid_xor_sid);
+        search_hits = searcher.search(filters, SEED_VALUES, min_adv, max_adv, gender_threshold, tid_xor_sid, cancellable);
         if (search_hits.size() > 0){
             console.log("Number of search hits: " + std::to_string(search_hits.size()));
             return search_hits;
@@ -223,15 +223,15 @@ std::vector<AdvRngState> get_wild_search_results(
     const uint64_t& advances_radius,
     int16_t gender_threshold,
     bool super_rod,
-    uint16_t tid_xor_sid
-
+    uint16_t tid_xor_sid,
+    Cancellable* cancellable
 ){
     std::vector<AdvRngState> search_hits;
     for (int i=0; i<4; i++){
         uint64_t adv_radius = advances_radius * (uint64_t(1) << i);
         uint64_t min_adv = ADVANCES - std::min(uint64_t(ADVANCES), adv_radius);    
         uint64_t max_adv = ADVANCES + adv_radius;
-        search_hits = searcher.search(filters, SEED_VALUES, min_adv, max_adv, gender_threshold, super_rod, tid_xor_sid);
+        search_hits = searcher.search(filters, SEED_VALUES, min_adv, max_adv, gender_threshold, super_rod, tid_xor_sid, cancellable);
         if (search_hits.size() > 0){
             console.log("Number of search hits: " + std::to_string(search_hits.size()));
             return search_hits;
@@ -255,7 +255,9 @@ std::vector<std::pair<AdvRngState,AdvRngState>> get_egg_search_results(
     AdvIVs& parentB,
     AdvEggCompatibility compatibility,
     int16_t gender_threshold,
-    uint16_t tid_xor_sid
+    uint16_t tid_xor_sid,
+    Cancellable* cancellable,
+    const AdvRngEggHitCallback& on_hit
 ){
     std::vector<std::pair<AdvRngState,AdvRngState>> search_hits;
     for (int i=0; i<1; i++){
@@ -270,7 +272,8 @@ std::vector<std::pair<AdvRngState,AdvRngState>> get_egg_search_results(
             held_min_adv, held_max_adv, 
             PICKUP_SEED_VALUES, pickup_min_adv, pickup_max_adv, 
             parentA, parentB, compatibility,
-            gender_threshold, tid_xor_sid
+            gender_threshold, tid_xor_sid,
+            cancellable, on_hit
         );
         if (search_hits.size() > 0){
             console.log("Number of search hits: " + std::to_string(search_hits.size()));
@@ -101,7 +101,8 @@ std::vector<AdvRngState> get_search_results(
     const uint64_t& ADVANCES, 
     const uint64_t& advances_radius,
     int16_t gender_threshold = 126,
-    uint16_t tid_xor_sid = 0
+    uint16_t tid_xor_sid = 0,
+    Cancellable* cancellable = nullptr
 );
 
 std::vector<AdvRngState> get_wild_search_results(
@@ -113,7 +114,8 @@ std::vector<AdvRngState> get_wild_search_results(
     const uint64_t& advances_radius,
     int16_t gender_threshold = 126,
     bool super_rod = false,
-    uint16_t tid_xor_sid = 0
+    uint16_t tid_xor_sid = 0,
+    Cancellable* cancellable = nullptr
 );
 
 std::vector<std::pair<AdvRngState,AdvRngState>> get_egg_search_results(
@@ -130,7 +132,9 @@ std::vector<std::pair<AdvRngState,AdvRngState>> get_egg_search_results(
     AdvIVs& parentB,
     AdvEggCompatibility compatibility,
     int16_t gender_threshold,
-    uint16_t tid_xor_sid
+    uint16_t tid_xor_sid,
+    Cancellable* cancellable = nullptr,
+    const AdvRngEggHitCallback& on_hit = nullptr
 );
 
 // double-check read level against possible encounter slots for the observed species and return true if valid
@@ -79,8 +79,8 @@ public:
     // Check if the input image contains green pixels with hue close to 51
     virtual bool check_image(const ImageViewRGB32& input_image) const override{
         // Convert RGB to HSV
-        ImageHSV32 input_hsv(input_image);
-        ImageViewHSV32 hsv_view(input_hsv);
+        std::shared_ptr<const ImageHSV32> input_hsv = ImageHSV32::cached_from(input_image);
+        ImageViewHSV32 hsv_view(*input_hsv);
 
         // Target hue for green arrow border
         const uint32_t target_hue = 50;
@@ -7,6 +7,7 @@
 #include "Common/Cpp/Exceptions.h"
 #include "Kernels/Waterfill/Kernels_Waterfill.h"
 #include "CommonFramework/GlobalAutoPaths.h"
+#include "CommonFramework/Tools/GlobalThreadPools.h"
 #include "CommonTools/Images/BinaryImage_FilterRgb32.h"
 #include "CommonTools/ImageMatch/ExactImageMatcher.h"
 #include "CommonTools/ImageMatch/SubObjectTemplateMatcher.h"
@@ -119,7 +120,7 @@ std::vector<ImagePixelBox> find_exclamation_marks(const ImageViewRGB32& image){
         0, 160,
         0, 192
     );
-    std::vector<WaterfillObject> objects = find_objects_inplace(matrix, 20);
+    std::vector<WaterfillObject> objects = find_objects_parallel(GlobalThreadPools::computation_realtime(), matrix, 20);
 #if 0
     cout << "objects = " << objects.size() << endl;
     static int c = 0;
@@ -149,7 +150,7 @@ std::vector<ImagePixelBox> find_question_marks(const ImageViewRGB32& image){
         0, 255,
         128, 255
     );
-    std::vector<WaterfillObject> objects = find_objects_inplace(matrix, 50);
+    std::vector<WaterfillObject> objects = find_objects_parallel(GlobalThreadPools::computation_realtime(), matrix, 50);
     std::vector<ImagePixelBox> ret;
 #if 1
     for (const WaterfillObject& object : objects){
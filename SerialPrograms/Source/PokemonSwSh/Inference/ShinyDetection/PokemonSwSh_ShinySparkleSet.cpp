@@ -6,7 +6,7 @@
 
 #include <sstream>
 #include "Common/Cpp/Concurrency/SpinLock.h"
-#include "Kernels/Waterfill/Kernels_Waterfill_Session.h"
+#include "Kernels/Waterfill/Kernels_Waterfill.h"
 #include "CommonFramework/Tools/GlobalThreadPools.h"
 #include "CommonTools/Images/BinaryImage_FilterRgb32.h"
 #include "PokemonSwSh/PokemonSwSh_Settings.h"
@@ -86,11 +86,12 @@ void ShinySparkleSetSwSh::update_alphas(){
 
 
 
-ShinySparkleSetSwSh find_sparkles(size_t screen_area, WaterfillSession& session){
+ShinySparkleSetSwSh find_sparkles(size_t screen_area, const PackedBinaryMatrix& matrix){
     ShinySparkleSetSwSh sparkles;
-    auto finder = session.make_iterator(20);
-    WaterfillObject object;
-    while (finder->find_next(object, true)){
+    std::vector<WaterfillObject> objects = find_objects_parallel(
+        GlobalThreadPools::computation_realtime(), matrix, 20, true
+    );
+    for (const WaterfillObject& object : objects){
         RadialSparkleDetector radial_sparkle(screen_area, object);
         if (radial_sparkle.is_ball()){
             sparkles.balls.emplace_back(object.min_x, object.min_y, object.max_x, object.max_y);
@@ -131,9 +132,7 @@ void ShinySparkleSetSwSh::read_from_image(size_t screen_area, const ImageViewRGB
     double best_alpha = 0;
     GlobalThreadPools::computation_realtime().run_in_parallel(
         [&](size_t index){
-            auto session = make_WaterfillSession();
-            session->set_source(matrices[index]);
-            ShinySparkleSetSwSh sparkles = find_sparkles(screen_area, *session);
+            ShinySparkleSetSwSh sparkles = find_sparkles(screen_area, matrices[index]);
             sparkles.update_alphas();
             double alpha = sparkles.alpha_overall();
 
@@ -147,12 +146,9 @@ void ShinySparkleSetSwSh::read_from_image(size_t screen_area, const ImageViewRGB
     );
 
 #if 0
-    auto session = make_WaterfillSession();
-
     double best_alpha = 0;
     for (PackedBinaryMatrix& matrix : matrices){
-        session->set_source(matrix);
-        ShinySparkleSetSwSh sparkles = find_sparkles(screen_area, *session);
+        ShinySparkleSetSwSh sparkles = find_sparkles(screen_area, matrix);
         sparkles.update_alphas();
         double alpha = sparkles.alpha_overall();
         if (best_alpha < alpha){
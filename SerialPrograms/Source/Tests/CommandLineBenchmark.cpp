@@ -0,0 +1,211 @@
+/*  Command Line Benchmark
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "Common/Cpp/Exceptions.h"
+#include "Common/Cpp/Time.h"
+#include "Common/Cpp/PrettyPrint.h"
+#include "Common/Cpp/CancellableScope.h"
+#include "Common/Cpp/CpuId/CpuId.h"
+#include "Common/Cpp/Json/JsonValue.h"
+#include "Common/Cpp/Json/JsonObject.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "Kernels/Kernels_Tests.h"
+#include "CommandLineBenchmark.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+namespace PokemonAutomation{
+
+
+
+bool CommandLineBenchmark::run_test_file(
+    const std::string& name,
+    const TestFunction& test_func,
+    const std::string& file_path
+){
+    if (m_iterations == 0){
+        return true;
+    }
+
+    std::vector<uint64_t> nanoseconds;
+    for (size_t c = 0; c < m_iterations; c++){
+        int ret;
+        WallClock start = current_time();
+        try{
+            ret = test_func(file_path);
+        }catch (const std::exception& e){
+            cout << "Benchmark: " << file_path << " threw exception: " << e.what() << endl;
+            return false;
+        }catch (const Exception& e){
+            cout << "Benchmark: " << file_path << " threw " << e.name() << ": <<<" << e.message() << ">>>" << endl;
+            return false;
+        }
+        WallClock end = current_time();
+        if (ret < 0){
+            return true;
+        }
+        if (ret > 0){
+            cout << "Benchmark: " << file_path << " failed on run " << c + 1 << "." << endl;
+            return false;
+        }
+        nanoseconds.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    Samples& samples = m_results[name];
+    samples.files++;
+    samples.nanoseconds.insert(samples.nanoseconds.end(), nanoseconds.begin(), nanoseconds.end());
+    return true;
+}
+
+bool CommandLineBenchmark::run_kernel_tests(Logger& logger){
+    if (m_iterations == 0){
+        return true;
+    }
+
+    UnitTestDatabase tests;
+    Kernels::add_tests(tests);
+
+    const CPU_Features saved = CPU_CAPABILITY_CURRENT;
+    bool passed = true;
+    for (const CpuCapabilityOption& capability : AVAILABLE_CAPABILITIES()){
+        if (!capability.available){
+            continue;
+        }
+        CPU_CAPABILITY_CURRENT = capability.features;
+        cout << "Benchmarking kernels with: " << capability.display << endl;
+
+        for (const auto& item : tests){
+            const UnitTest& test = *item.second;
+            Samples samples;
+            for (size_t c = 0; c < m_iterations; c++){
+                CancellableHolder<CancellableScope> scope;
+                WallClock start = current_time();
+                UnitTestResult result = test.run(logger, scope);
+                WallClock end = current_time();
+
+                if (result.result == UnitTestResult::SKIPPED || result.result == UnitTestResult::NOT_RUN){
+                    break;
+                }
+                if (result.result != UnitTestResult::PASSED){
+                    cout << "Benchmark: " << test.name() << " failed with " << capability.slug << "." << endl;
+                    passed = false;
+                    break;
+                }
+                samples.nanoseconds.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+            if (!samples.nanoseconds.empty()){
+                samples.files = 1;
+                m_results[std::string("Kernels/") + capability.slug + "/" + test.name()] = std::move(samples);
+            }
+        }
+    }
+    CPU_CAPABILITY_CURRENT = saved;
+
+    return passed;
+}
+
+
+
+CommandLineBenchmark::Summary CommandLineBenchmark::summarize(const Samples& samples){
+    Summary summary;
+    std::vector<uint64_t> sorted = samples.nanoseconds;
+    if (sorted.empty()){
+        return summary;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    //  Nearest-rank percentile in microseconds.
+    auto percentile = [&](double p){
+        size_t rank = (size_t)std::ceil(p * sorted.size());
+        rank = std::max<size_t>(rank, 1);
+        return sorted[std::min(rank, sorted.size()) - 1] / 1000.;
+    };
+
+    double total = 0;
+    for (uint64_t ns : sorted){
+        total += (double)ns;
+    }
+
+    summary.runs = sorted.size();
+    summary.files = samples.files;
+    summary.mean = total / sorted.size() / 1000.;
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    summary.max = sorted.back() / 1000.;
+    summary.per_second = total == 0 ? 0 : sorted.size() / (total / 1000000000.);
+    return summary;
+}
+
+JsonObject CommandLineBenchmark::to_json() const{
+    JsonObject obj;
+    for (const auto& item : m_results){
+        Summary summary = summarize(item.second);
+        JsonObject entry;
+        entry["Runs"] = (int64_t)summary.runs;
+        entry["Files"] = (int64_t)summary.files;
+        entry["MeanMicroseconds"] = summary.mean;
+        entry["P50Microseconds"] = summary.p50;
+        entry["P90Microseconds"] = summary.p90;
+        entry["P99Microseconds"] = summary.p99;
+        entry["MaxMicroseconds"] = summary.max;
+        entry["ImagesPerSecond"] = summary.per_second;
+        obj[item.first] = std::move(entry);
+    }
+    return obj;
+}
+void CommandLineBenchmark::save(const std::string& path) const{
+    to_json().dump(path);
+    cout << "Benchmark results saved to: " << path << endl;
+}
+void CommandLineBenchmark::print_summary() const{
+    cout << "Benchmark (" << m_iterations << " iteration" << (m_iterations > 1 ? "s" : "") << " per file):" << endl;
+    for (const auto& item : m_results){
+        Summary summary = summarize(item.second);
+        cout << "- " << item.first
+             << ": p50 = " << tostr_fixed(summary.p50, 1) << " us"
+             << ", p90 = " << tostr_fixed(summary.p90, 1) << " us"
+             << ", p99 = " << tostr_fixed(summary.p99, 1) << " us"
+             << ", " << tostr_fixed(summary.per_second, 1) << " images/s"
+             << endl;
+    }
+}
+
+size_t CommandLineBenchmark::compare_to_baseline(const std::string& baseline_path, double tolerance) const{
+    JsonValue json = load_json_file(baseline_path);
+    const JsonObject& baseline = json.to_object_throw(baseline_path);
+
+    size_t regressions = 0;
+    for (const auto& item : m_results){
+        const JsonObject* entry = baseline.get_object(item.first);
+        if (entry == nullptr){
+            continue;
+        }
+        double baseline_p50;
+        if (!entry->read_float(baseline_p50, "P50Microseconds") || baseline_p50 <= 0){
+            continue;
+        }
+
+        Summary summary = summarize(item.second);
+        if (summary.p50 > baseline_p50 * (1 + tolerance)){
+            cout << "Regression: " << item.first
+                 << ": p50 = " << tostr_fixed(summary.p50, 1) << " us"
+                 << ", baseline = " << tostr_fixed(baseline_p50, 1) << " us"
+                 << " (" << tostr_fixed((summary.p50 / baseline_p50 - 1) * 100, 1) << "% slower)"
+                 << endl;
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+
+
+}
@@ -0,0 +1,104 @@
+/*  Command Line Benchmark
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ *  Benchmark mode for the command line tests. (see CommandLineTests.h)
+ *
+ *  Enable it by setting "20-GlobalSettings": "COMMAND_LINE_TESTS": "BENCHMARK": "ITERATIONS"
+ *  to a positive number, or by passing "--benchmark <iterations>" on the command line.
+ *
+ *  Every test file that passes is then run that many more times and the time
+ *  of each run is recorded against its test object. (e.g. "PokemonLA/BattleMenuDetector")
+ *  After that, every Kernels unit test is run the same way once for each CPU
+ *  capability this machine supports so that every SIMD path gets measured.
+ *
+ *  The results are written as JSON to "BENCHMARK": "OUTPUT"
+ *  (or "--benchmark-output <path>"):
+ *  {
+ *      "PokemonLA/BattleMenuDetector": {
+ *          "Runs": <number of timed runs>,
+ *          "Files": <number of test files>,
+ *          "MeanMicroseconds": ...,
+ *          "P50Microseconds": ...,
+ *          "P90Microseconds": ...,
+ *          "P99Microseconds": ...,
+ *          "MaxMicroseconds": ...,
+ *          "ImagesPerSecond": <runs per second>
+ *      },
+ *      "Kernels/<capability>/<unit test name>": { ... },
+ *      ...
+ *  }
+ *
+ *  If "BENCHMARK": "BASELINE" (or "--benchmark-baseline <path>") is set to a
+ *  file written by an earlier run, every entry whose median is more than
+ *  "BENCHMARK": "TOLERANCE" (default 0.10 = 10%) slower than in the baseline
+ *  is reported as a regression and the command line tests fail.
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_CommandLineBenchmark_H
+#define PokemonAutomation_Tests_CommandLineBenchmark_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "TestMap.h"
+
+namespace PokemonAutomation{
+
+class Logger;
+class JsonObject;
+
+
+class CommandLineBenchmark{
+public:
+    CommandLineBenchmark(size_t iterations)
+        : m_iterations(iterations)
+    {}
+
+    //  Run "test_func" on "file_path" for the set number of iterations and
+    //  record the times under "name".
+    //  Returns false if any of the runs fails. Skipped files are not recorded.
+    bool run_test_file(const std::string& name, const TestFunction& test_func, const std::string& file_path);
+
+    //  Run the Kernels unit tests once per available CPU capability.
+    //  Returns false if any of them fails.
+    bool run_kernel_tests(Logger& logger);
+
+    JsonObject to_json() const;
+    void save(const std::string& path) const;
+    void print_summary() const;
+
+    //  Compare against the results saved at "baseline_path".
+    //  Returns the number of regressions.
+    size_t compare_to_baseline(const std::string& baseline_path, double tolerance) const;
+
+
+private:
+    struct Samples{
+        size_t files = 0;
+        std::vector<uint64_t> nanoseconds;
+    };
+    struct Summary{
+        size_t runs = 0;
+        size_t files = 0;
+        double mean = 0;
+        double p50 = 0;
+        double p90 = 0;
+        double p99 = 0;
+        double max = 0;
+        double per_second = 0;
+    };
+    static Summary summarize(const Samples& samples);
+
+
+private:
+    const size_t m_iterations;
+    std::map<std::string, Samples> m_results;
+};
+
+
+
+}
+#endif
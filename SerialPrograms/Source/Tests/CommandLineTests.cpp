@@ -11,12 +11,14 @@
 #include "CommonFramework/Logging/Logger.h"
 #include "ComputerPrograms/UnitTestRunner.h"
 #include "TestMap.h"
+#include "CommandLineBenchmark.h"
 #include <QDir>
 #include <QDirIterator>
 #include <QFileInfo>
 
 #include <iostream>
 #include <list>
+#include <memory>
 #include <functional>
 using std::cout;
 using std::cerr;
@@ -65,6 +67,15 @@ void print_equals(){
         } \
     }while (0)
 
+#define RETURN_IF_BENCHMARK_FAILED(benchmark, test_key, test_func, file_path) \
+    do { \
+        if ((benchmark) != nullptr && !(benchmark)->run_test_file(test_key, test_func, file_path)){ \
+            print_equals(); \
+            cout << "Test: " << (file_path) << " failed during benchmark." << endl; \
+            return 1; \
+        } \
+    }while (0)
+
 bool skip_ignored_path(const QString& file_path, const std::vector<QString>& ignore_list){
     for (const auto& path_prefix : ignore_list){
         if (file_path.startsWith(path_prefix)){
@@ -75,7 +86,10 @@ bool skip_ignored_path(const QString& file_path, const std::vector<QString>& ign
     return false;
 }
 
-int run_test_obj_dir(TestFunction test_func, const QString& directory_path, size_t& num_passed, const std::vector<QString>& ignore_list){
+int run_test_obj_dir(
+    TestFunction test_func, const std::string& test_key, const QString& directory_path,
+    size_t& num_passed, const std::vector<QString>& ignore_list, CommandLineBenchmark* benchmark
+){
     QDirIterator file_iter(directory_path, QDir::Filter::Files, QDirIterator::IteratorFlag::Subdirectories);
 
     bool first_test_file = true;
@@ -102,6 +116,7 @@ int run_test_obj_dir(TestFunction test_func, const QString& directory_path, size
         // Call the function to do the actual test:
         cout << file_path << endl;
         RETURN_IF_TEST_FAILED(test_func, file_path, num_passed);
+        RETURN_IF_BENCHMARK_FAILED(benchmark, test_key, test_func, file_path);
     }
 
     return 0;
@@ -109,7 +124,10 @@ int run_test_obj_dir(TestFunction test_func, const QString& directory_path, size
 
 // Run the tests inside a folder representing a "test object".
 // It is usually defined as one detector, e.g. CommandLineTests/PokemonLA/BattleMenuDetector/
-int run_test_obj(const std::string& test_space, const QFileInfo& obj_info, size_t& num_passed, const std::vector<QString>& ignore_list){
+int run_test_obj(
+    const std::string& test_space, const QFileInfo& obj_info,
+    size_t& num_passed, const std::vector<QString>& ignore_list, CommandLineBenchmark* benchmark
+){
     const std::string test_name = obj_info.fileName().toStdString();
     if (test_name == "." || test_name == ".."){
         return 0;
@@ -130,12 +148,15 @@ int run_test_obj(const std::string& test_space, const QFileInfo& obj_info, size_
 
     // Recursively get test filenames, like:
     // ./CommandLineTests/PokemonLA/BattleMenuDetector/IngoBattleMenuDayTime_True.png
-    return run_test_obj_dir(test_func, obj_info.filePath(), num_passed, ignore_list);
+    return run_test_obj_dir(test_func, test_space + "/" + test_name, obj_info.filePath(), num_passed, ignore_list, benchmark);
 }
 
 // Run the tests inside a folder representing a "test space".
 // It is usually defined as one pokemon game, e.g. CommandLineTests/PokemonLA/
-int run_test_space(const QFileInfo& space_info, size_t& num_passed, const std::vector<QString>& ignore_list){
+int run_test_space(
+    const QFileInfo& space_info,
+    size_t& num_passed, const std::vector<QString>& ignore_list, CommandLineBenchmark* benchmark
+){
     QDir sub_dir(space_info.filePath());
     if (!sub_dir.exists()){
         cerr << "Error: cannot access " << space_info.filePath().toStdString() << endl;
@@ -157,7 +178,7 @@ int run_test_space(const QFileInfo& space_info, size_t& num_passed, const std::v
     // ./CommandLineTests/PokemonLA/BattleMenuDetector/
     const QFileInfoList obj_list = sub_dir.entryInfoList();
     for (const QFileInfo& obj_info : obj_list){
-        RETURN_IF_NOT_ZERO(run_test_obj(test_space, obj_info, num_passed, ignore_list));
+        RETURN_IF_NOT_ZERO(run_test_obj(test_space, obj_info, num_passed, ignore_list, benchmark));
     }
 
     return 0;
@@ -166,6 +187,40 @@ int run_test_space(const QFileInfo& space_info, size_t& num_passed, const std::v
 
 
 
+// Finish benchmark mode: measure the kernels, then save and check the results.
+int run_benchmark_report(CommandLineBenchmark& benchmark){
+    print_equals();
+    if (!benchmark.run_kernel_tests(global_logger_command_line())){
+        return 1;
+    }
+
+    print_equals();
+    benchmark.print_summary();
+
+    const GlobalSettings& settings = GlobalSettings::instance();
+    const std::string& output = settings.COMMAND_LINE_BENCHMARK_OUTPUT;
+    benchmark.save(output.empty() ? "CommandLineBenchmark.json" : output);
+
+    const std::string& baseline = settings.COMMAND_LINE_BENCHMARK_BASELINE;
+    if (baseline.empty()){
+        return 0;
+    }
+    size_t regressions = 0;
+    try{
+        regressions = benchmark.compare_to_baseline(baseline, settings.COMMAND_LINE_BENCHMARK_TOLERANCE);
+    }catch (const Exception& e){
+        cerr << "Error: cannot read benchmark baseline " << baseline << ": " << e.message() << endl;
+        return 1;
+    }
+    if (regressions > 0){
+        cout << regressions << " benchmark regression" << (regressions > 1 ? "s" : "") << " against " << baseline << endl;
+        return 1;
+    }
+    cout << "No benchmark regressions against " << baseline << endl;
+    return 0;
+}
+
+
 } // end of anonymous namespace
 
 
@@ -194,6 +249,14 @@ int run_command_line_tests(){
 
     size_t num_passed = 0;
 
+    //  Only set in benchmark mode.
+    std::unique_ptr<CommandLineBenchmark> benchmark;
+    size_t iterations = GlobalSettings::instance().COMMAND_LINE_BENCHMARK_ITERATIONS;
+    if (iterations > 0){
+        cout << "Benchmark mode: " << iterations << " iteration" << (iterations > 1 ? "s" : "") << " per test file." << endl;
+        benchmark = std::make_unique<CommandLineBenchmark>(iterations);
+    }
+
     const auto& selected_test_list = GlobalSettings::instance().COMMAND_LINE_TEST_LIST;
 
     // The ignore list will be used to skip path.
@@ -217,7 +280,7 @@ int run_command_line_tests(){
         test_root_dir.setFilter(QDir::Filter::Dirs);
         const QFileInfoList sub_dir_list = test_root_dir.entryInfoList();
         for (const QFileInfo& sub_dir_info : sub_dir_list){
-            RETURN_IF_NOT_ZERO(run_test_space(sub_dir_info, num_passed, ignore_list));
+            RETURN_IF_NOT_ZERO(run_test_space(sub_dir_info, num_passed, ignore_list, benchmark.get()));
         }
     }else{
         // Only run on selected tests
@@ -270,7 +333,7 @@ int run_command_line_tests(){
             QFileInfo test_space_info(cur_dir.filePath(*it));
             cur_dir = QDir(test_space_info.filePath());
             if (path_components.size() == 1){
-                RETURN_IF_NOT_ZERO(run_test_space(test_space_info, num_passed, ignore_list));
+                RETURN_IF_NOT_ZERO(run_test_space(test_space_info, num_passed, ignore_list, benchmark.get()));
                 continue;
             }
 
@@ -278,7 +341,7 @@ int run_command_line_tests(){
             std::string test_name = it->toStdString();
             QFileInfo test_obj_info(cur_dir.filePath(*it));
             if (path_components.size() == 2){
-                RETURN_IF_NOT_ZERO(run_test_obj(test_space, test_obj_info, num_passed, ignore_list));
+                RETURN_IF_NOT_ZERO(run_test_obj(test_space, test_obj_info, num_passed, ignore_list, benchmark.get()));
                 continue;
             }
 
@@ -291,15 +354,23 @@ int run_command_line_tests(){
             if (selected_path_info.isFile()){
                 // Call the function to do the actual test:
                 RETURN_IF_TEST_FAILED(test_func, full_path_cleaned.toStdString(), num_passed);
+                RETURN_IF_BENCHMARK_FAILED(benchmark, test_space + "/" + test_name, test_func, full_path_cleaned.toStdString());
             }else{
                 // selected_path_info is a directory, go through each file recursively in the directory
-                RETURN_IF_NOT_ZERO(run_test_obj_dir(test_func, full_path_cleaned, num_passed, ignore_list));
+                RETURN_IF_NOT_ZERO(run_test_obj_dir(
+                    test_func, test_space + "/" + test_name, full_path_cleaned,
+                    num_passed, ignore_list, benchmark.get()
+                ));
             }
         } // end selected_test_list
     }
 
     print_equals();
     cout << num_passed << " test" << (num_passed > 1 ? "s" : "") << " passed" << std::endl;
+
+    if (benchmark){
+        return run_benchmark_report(*benchmark);
+    }
     return 0;
 }
 
@@ -45,6 +45,9 @@
  *  "20-GlobalSettings": "COMMAND_LINE_TESTS": "IGNORE_LIST" as a list of strings to skip the paths to those tests.
  *  Each string in the list serves as a prefix to the test path that the test framework uses to filter out paths.
  * 
+ *  To measure how fast the inferences are instead of only whether they pass, use the benchmark mode.
+ *  See CommandLineBenchmark.h.
+ * 
  * You can also change a filename to be starting with "_" to skip those file. Those skipped files are useful for storing metadata
  * or serving as an extra file in case some tests need more than one test files. Files whose parent directory name starts with "_"
  * are skipped as well.
@@ -0,0 +1,214 @@
+/*  Image Match Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <stdint.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "CommonFramework/ImageTypes/ImageRGB32.h"
+#include "CommonFramework/ImageTools/ImageBoxes.h"
+#include "CommonTools/ImageMatch/ExactImageDictionaryMatcher.h"
+#include "ImageMatch_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+namespace ImageMatch{
+    std::vector<ImageRGB32> make_image_set(
+        const ImageViewRGB32& screen,
+        const ImageFloatBox& box,
+        size_t width, size_t height,
+        size_t tolerance
+    );
+}
+
+
+
+namespace{
+
+const size_t SPRITE_SIZE = 24;
+const size_t SCREEN_SIZE = 40;
+const size_t SPRITE_OFFSET = 8;
+
+uint8_t clamp_channel(double x){
+    return (uint8_t)std::min(std::max(x, 0.), 255.);
+}
+
+//  A handful of base patterns with per-sprite contrast and small per-pixel
+//  changes. Some sprites score close to each other and some are far enough
+//  apart in brightness and contrast that the bounds skip them.
+std::vector<ImageRGB32> make_sprites(std::mt19937& rng, size_t count){
+    const size_t BASES = 4;
+    std::vector<ImageRGB32> bases;
+    for (size_t c = 0; c < BASES; c++){
+        ImageRGB32 base(SPRITE_SIZE, SPRITE_SIZE);
+        for (size_t y = 0; y < SPRITE_SIZE; y++){
+            for (size_t x = 0; x < SPRITE_SIZE; x++){
+                base.pixel(x, y) = 0xff000000 | (rng() & 0x00ffffff);
+            }
+        }
+        bases.emplace_back(std::move(base));
+    }
+
+    std::uniform_real_distribution<double> contrast_distribution(0.2, 1.0);
+    std::vector<ImageRGB32> ret;
+    for (size_t c = 0; c < count; c++){
+        const ImageRGB32& base = bases[c % BASES];
+        ImageRGB32 sprite(SPRITE_SIZE, SPRITE_SIZE);
+        double radius = 8 + rng() % 4;
+        double contrast = contrast_distribution(rng);
+        double offset[3];
+        for (double& x : offset){
+            x = (1 - contrast) * (rng() % 256);
+        }
+        for (size_t y = 0; y < SPRITE_SIZE; y++){
+            for (size_t x = 0; x < SPRITE_SIZE; x++){
+                double dx = x - (SPRITE_SIZE - 1) / 2.;
+                double dy = y - (SPRITE_SIZE - 1) / 2.;
+                if (dx*dx + dy*dy > radius*radius){
+                    sprite.pixel(x, y) = rng() & 0x00ffffff;
+                    continue;
+                }
+                uint32_t pixel = base.pixel(x, y);
+                if (rng() % 8 == 0){
+                    pixel = rng();
+                }
+                uint32_t r = clamp_channel(((pixel >> 16) & 0xff) * contrast + offset[0]);
+                uint32_t g = clamp_channel(((pixel >>  8) & 0xff) * contrast + offset[1]);
+                uint32_t b = clamp_channel(((pixel >>  0) & 0xff) * contrast + offset[2]);
+                sprite.pixel(x, y) = 0xff000000 | (r << 16) | (g << 8) | b;
+            }
+        }
+        ret.emplace_back(std::move(sprite));
+    }
+    return ret;
+}
+
+//  "sprite" on a noisy background with a brightness change and noise.
+ImageRGB32 make_screen(std::mt19937& rng, const ImageViewRGB32& sprite){
+    ImageRGB32 screen(SCREEN_SIZE, SCREEN_SIZE);
+    for (size_t y = 0; y < SCREEN_SIZE; y++){
+        for (size_t x = 0; x < SCREEN_SIZE; x++){
+            screen.pixel(x, y) = 0xff000000 | (rng() & 0x00ffffff);
+        }
+    }
+
+    std::uniform_real_distribution<double> brightness(0.85, 1.15);
+    std::uniform_real_distribution<double> noise(-12, 12);
+    double scaleR = brightness(rng);
+    double scaleG = brightness(rng);
+    double scaleB = brightness(rng);
+    for (size_t y = 0; y < SPRITE_SIZE; y++){
+        for (size_t x = 0; x < SPRITE_SIZE; x++){
+            uint32_t pixel = sprite.pixel(x, y);
+            if ((pixel >> 24) == 0){
+                continue;
+            }
+            uint32_t r = clamp_channel(((pixel >> 16) & 0xff) * scaleR + noise(rng));
+            uint32_t g = clamp_channel(((pixel >>  8) & 0xff) * scaleG + noise(rng));
+            uint32_t b = clamp_channel(((pixel >>  0) & 0xff) * scaleB + noise(rng));
+            screen.pixel(SPRITE_OFFSET + x, SPRITE_OFFSET + y) = 0xff000000 | (r << 16) | (g << 8) | b;
+        }
+    }
+    return screen;
+}
+
+}
+
+
+
+//  ExactImageDictionaryMatcher::match() skips candidates and sprites whose
+//  lower bound can't win. Check that it returns exactly what scoring every
+//  sprite against every candidate with WeightedExactImageMatcher::diff()
+//  does.
+class Test_ExactImageDictionaryMatcherPruning : public UnitTest{
+public:
+    Test_ExactImageDictionaryMatcherPruning()
+        : UnitTest("ImageMatch::ExactImageDictionaryMatcherPruning")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        using namespace ImageMatch;
+
+        const size_t SPRITES = 40;
+        const size_t TOLERANCE = 1;
+
+        std::mt19937 rng(7);
+        std::vector<ImageRGB32> sprites = make_sprites(rng, SPRITES);
+
+        WeightedExactImageMatcher::InverseStddevWeight weight{0.1, 1.0};
+        ExactImageDictionaryMatcher matcher(weight);
+        std::vector<std::string> slugs;
+        for (size_t c = 0; c < SPRITES; c++){
+            slugs.emplace_back("sprite-" + std::to_string(c));
+            matcher.add(slugs.back(), sprites[c].copy());
+        }
+
+        ImageFloatBox box(
+            (double)SPRITE_OFFSET / SCREEN_SIZE, (double)SPRITE_OFFSET / SCREEN_SIZE,
+            (double)SPRITE_SIZE / SCREEN_SIZE, (double)SPRITE_SIZE / SCREEN_SIZE
+        );
+
+        for (size_t trial = 0; trial < 20; trial++){
+            size_t expected_index = rng() % SPRITES;
+            ImageRGB32 screen = make_screen(rng, sprites[expected_index]);
+
+            //  Unpruned: every sprite against every candidate.
+            std::vector<ImageRGB32> candidates = make_image_set(
+                screen, box, SPRITE_SIZE, SPRITE_SIZE, TOLERANCE
+            );
+            std::vector<double> alphas;
+            for (const std::string& slug : slugs){
+                const WeightedExactImageMatcher& sprite = matcher.image_matcher(slug);
+                double best = 10000;
+                for (const ImageRGB32& candidate : candidates){
+                    best = std::min(best, sprite.diff(candidate));
+                }
+                alphas.emplace_back(best);
+            }
+
+            for (double alpha_spread : {0.02, 0.5, 1000.}){
+                std::string name = "trial " + std::to_string(trial) + " spread " + std::to_string(alpha_spread);
+
+                ImageMatchResult expected;
+                for (size_t c = 0; c < SPRITES; c++){
+                    expected.add(alphas[c], slugs[c]);
+                    expected.clear_beyond_spread(alpha_spread);
+                }
+
+                ImageMatchResult actual = matcher.match(screen, box, TOLERANCE, alpha_spread);
+
+                TEST_RESULT_COMPONENT_EQUAL_STR(actual.results.size(), expected.results.size(), name + " size");
+                auto iter0 = actual.results.begin();
+                auto iter1 = expected.results.begin();
+                for (; iter0 != actual.results.end(); ++iter0, ++iter1){
+                    TEST_RESULT_COMPONENT_EQUAL_STR(iter0->second, iter1->second, name + " slug");
+                    if (std::abs(iter0->first - iter1->first) > 1e-9){
+                        TEST_RESULT_COMPONENT_EQUAL_STR(iter0->first, iter1->first, name + " alpha of " + iter1->second);
+                    }
+                }
+                TEST_RESULT_COMPONENT_EQUAL_STR(
+                    actual.results.begin()->second, slugs[expected_index],
+                    name + " best"
+                );
+            }
+        }
+
+        return true;
+    }
+};
+
+
+
+void add_tests_ImageMatch(UnitTestDatabase& database){
+    database.add<Test_ExactImageDictionaryMatcherPruning>();
+}
+
+
+
+}
@@ -0,0 +1,21 @@
+/*  Image Match Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_ImageMatch_Tests_H
+#define PokemonAutomation_Tests_ImageMatch_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+
+
+
+void add_tests_ImageMatch(UnitTestDatabase& database);
+
+
+
+}
+#endif
@@ -0,0 +1,219 @@
+/*  JSON Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <functional>
+#include <random>
+#include "Common/Cpp/Filesystem/FileIO.h"
+#include "Common/Cpp/Json/JsonArray.h"
+#include "Common/Cpp/Json/JsonObject.h"
+#include "Common/Cpp/Json/JsonTools.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "CommonFramework/GlobalAutoPaths.h"
+#include "Json_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+
+
+
+namespace{
+
+//  The nlohmann path that json_parse() and json_dump() replace.
+JsonValue parse_json_nlohmann(const std::string& str){
+    return from_nlohmann(nlohmann::json::parse(str, nullptr, false));
+}
+std::string dump_json_nlohmann(const JsonValue& value, int indent){
+    return to_nlohmann(value).dump(indent);
+}
+
+}
+
+
+
+//  json_parse() must accept exactly what nlohmann accepts with the same values,
+//  and json_dump() must write text that nlohmann reads back to the same values.
+class Test_JsonParseAndDump : public UnitTest{
+public:
+    Test_JsonParseAndDump()
+        : UnitTest("Json::ParseAndDump")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        std::mt19937_64 random(1);
+
+        auto random_string = [&]{
+            static const char* PIECES[] = {
+                "a", "Z", " ", "\"", "\\", "/", "\n", "\t", "\x01", "\x7f",
+                "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xef\xbf\xbf",
+            };
+            std::string str;
+            size_t length = random() % 6;
+            for (size_t c = 0; c < length; c++){
+                str += PIECES[random() % (sizeof(PIECES) / sizeof(PIECES[0]))];
+            }
+            return str;
+        };
+        auto random_double = [&]{
+            switch (random() % 4){
+            case 0:
+                return std::ldexp((double)(random() >> 11), (int)(random() % 200) - 150);
+            case 1:
+                return -(double)(random() % 100000) / 1000;
+            case 2:
+                return (double)(int64_t)(random() % 2000) - 1000;
+            default:
+                return random() % 2 ? 0.0 : -0.0;
+            }
+        };
+        std::function<JsonValue(size_t)> random_value = [&](size_t depth) -> JsonValue{
+            switch (random() % (depth < 4 ? 7 : 5)){
+            case 0:
+                return JsonValue();
+            case 1:
+                return JsonValue(random() % 2 == 0);
+            case 2:
+                return JsonValue((int64_t)random());
+            case 3:
+                return JsonValue(random_double());
+            case 4:
+                return JsonValue(random_string());
+            case 5:{
+                JsonArray array;
+                size_t size = random() % 5;
+                for (size_t c = 0; c < size; c++){
+                    array.push_back(random_value(depth + 1));
+                }
+                return array;
+            }
+            default:{
+                JsonObject object;
+                size_t size = random() % 5;
+                for (size_t c = 0; c < size; c++){
+                    object[random_string()] = random_value(depth + 1);
+                }
+                return object;
+            }
+            }
+        };
+
+        auto check_parse = [&](const std::string& text) -> std::string{
+            JsonValue expected = parse_json_nlohmann(text);
+            JsonValue actual = json_parse(text.data(), text.size());
+            if (expected.type() != actual.type() ||
+                dump_json_nlohmann(expected, -1) != dump_json_nlohmann(actual, -1)
+            ){
+                return "Parse mismatch: " + text;
+            }
+            return "";
+        };
+
+        static const char* EDITS[] = {
+            ",", "]", "}", "\"", "\\u", "\\ud800", "\\udc00", "\\ud83d\\ude00",
+            "-", ".", "e", "01", "-0", "\xff", "\xc0\x80", "\xed\xa0\x80",
+            "\x01", "\xef\xbb\xbf", "/**/", "tru", "1e400",
+            "18446744073709551615", "18446744073709551616", "-9223372036854775809",
+        };
+
+        for (size_t trial = 0; trial < 5000; trial++){
+            JsonValue value = random_value(0);
+            for (int indent : {-1, 0, 4}){
+                std::string expected = dump_json_nlohmann(value, indent);
+                std::string actual = value.dump(indent);
+
+                //  The shortest digits for a float are not always unique.
+                //  Either is fine as long as it reads back the same.
+                if (actual != expected && dump_json_nlohmann(parse_json_nlohmann(actual), indent) != expected){
+                    return "Dump mismatch: " + expected + " vs. " + actual;
+                }
+            }
+
+            std::string text = dump_json_nlohmann(value, (int)(random() % 3) - 1);
+            std::string error = check_parse(text);
+            if (!error.empty()){
+                return error;
+            }
+
+            //  Break it in random ways.
+            for (size_t c = 0; c < 4 && !text.empty(); c++){
+                std::string edited = text;
+                size_t pos = random() % edited.size();
+                const char* edit = EDITS[random() % (sizeof(EDITS) / sizeof(EDITS[0]))];
+                if (random() % 2){
+                    edited.insert(pos, edit);
+                }else{
+                    edited.erase(pos, 1 + random() % 3);
+                }
+                error = check_parse(edited);
+                if (error.empty()){
+                    error = check_parse("[" + edited + "]");
+                }
+                if (!error.empty()){
+                    return error;
+                }
+            }
+        }
+
+        return true;
+    };
+};
+
+
+
+//  Both paths must agree on the largest JSON resources.
+class Test_JsonResourceFiles : public UnitTest{
+public:
+    Test_JsonResourceFiles()
+        : UnitTest("Json::ResourceFiles")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        static const char* FILES[] = {
+            "Pokemon/PokemonNameOCR/PokemonOCR-eng.json",
+            "Pokemon/AllFormDisplayMap.json",
+            "PokemonHome/DexTemplates/living_dex_by_forms.json",
+            "PokemonLA/PokemonSprites.json",
+            "PokemonSwSh/PokemonSprites.json",
+            "PokemonSwSh/MaxLair/boss_matchup_LUT.json",
+            "PokemonSwSh/MaxLair/path_tree.json",
+        };
+
+        size_t files = 0;
+        for (const char* file : FILES){
+            std::string text;
+            if (!file_to_string(RESOURCE_PATH() + file, text)){
+                continue;
+            }
+            files++;
+
+            std::string expected = dump_json_nlohmann(parse_json_nlohmann(text), -1);
+            JsonValue value = json_parse(text.data(), text.size());
+            TEST_RESULT_COMPONENT_EQUAL_STR(
+                dump_json_nlohmann(value, -1) == expected, true,
+                std::string(file) + " parse"
+            );
+            TEST_RESULT_COMPONENT_EQUAL_STR(
+                dump_json_nlohmann(parse_json_nlohmann(value.dump(4)), -1) == expected, true,
+                std::string(file) + " dump"
+            );
+        }
+
+        if (files == 0){
+            return UnitTestResult(UnitTestResult::SKIPPED, "Resources not found.");
+        }
+        return true;
+    };
+};
+
+
+
+void add_tests_Json(UnitTestDatabase& database){
+    database.add<Test_JsonParseAndDump>();
+    database.add<Test_JsonResourceFiles>();
+}
+
+
+
+}
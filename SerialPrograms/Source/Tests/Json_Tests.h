@@ -0,0 +1,21 @@
+/*  JSON Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_Json_Tests_H
+#define PokemonAutomation_Tests_Json_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+
+
+
+void add_tests_Json(UnitTestDatabase& database);
+
+
+
+}
+#endif
@@ -0,0 +1,437 @@
+/*  PABotBase2 Command Queue Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include "Common/Cpp/Exceptions.h"
+#include "Common/Cpp/CancellableScope.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "Common/PABotBase2/Controllers/PABotBase2_Controller_NS_WiredController.h"
+#include "Controllers/PABotBase2/PABotBase2_CommandQueueManager.h"
+#include "PABotBase2_CommandQueue_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+
+using namespace std::chrono_literals;
+
+
+
+namespace{
+
+//  Feeds a CommandWindow one round at a time with an explicit clock.
+//  The first round after a reset or a drop is a single command. After that
+//  a round is whatever the window was at the end of the previous one.
+struct WindowDriver{
+    PABotBase2::CommandWindow window;
+    WallClock now = current_time();
+    size_t round_length = 1;
+
+    size_t window_size() const{
+        return window.window();
+    }
+
+    void reset(uint8_t capacity){
+        window.reset(capacity);
+        round_length = 1;
+    }
+    void dropped(){
+        window.report_dropped();
+        round_length = 1;
+    }
+
+    //  One round in which every command took "delay" beyond its own duration.
+    void round(WallDuration delay, bool window_full){
+        if (window_full){
+            window.report_window_full();
+        }
+        for (size_t c = 0; c < round_length; c++){
+            now += 1ms;
+            window.report_delay(delay, now);
+        }
+        round_length = window.window();
+    }
+};
+
+}
+
+
+
+class Test_PABotBase2CommandWindow : public UnitTest{
+public:
+    Test_PABotBase2CommandWindow()
+        : UnitTest("PABotBase2::CommandWindow")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        //  Slow start doubles up to the ceiling while the device runs dry.
+        {
+            WindowDriver driver;
+            driver.reset(32);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 4, "slow start: initial");
+            driver.round(2ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 8, "slow start: round 1");
+            driver.round(2ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 16, "slow start: round 2");
+            driver.round(2ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 32, "slow start: round 3");
+            driver.round(2ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 32, "slow start: ceiling");
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window.slow_start(), true, "slow start: still on");
+        }
+
+        //  Don't grow if the sender never ran out of window.
+        {
+            WindowDriver driver;
+            driver.reset(32);
+            driver.round(2ms, false);
+            driver.round(2ms, false);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 4, "not window-limited");
+        }
+
+        //  The backlog is measured in time, not commands.
+        {
+            WindowDriver driver;
+            driver.reset(32);
+            driver.round(2ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 8, "backlog: slow start");
+
+            //  20ms still buffered at the lowest point. (e.g. ten 2ms
+            //  commands) Enough to cover the round trip. Leave it alone.
+            driver.round(2ms + 20ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 8, "backlog: 20ms");
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window.slow_start(), false, "backlog: slow start ended");
+
+            //  Too much buffered. Shrink by one.
+            driver.round(2ms + 100ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 7, "backlog: 100ms");
+
+            //  Running dry after slow start. Grow by one.
+            driver.round(2ms + 3ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 8, "backlog: 3ms");
+        }
+
+        //  Never shrink below the minimum window.
+        {
+            WindowDriver driver;
+            driver.reset(32);
+            driver.round(2ms, true);
+            for (size_t c = 0; c < 10; c++){
+                driver.round(2ms + 1000ms, true);
+            }
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 4, "shrink floor");
+        }
+
+        //  A drop halves the window and ends slow start.
+        {
+            WindowDriver driver;
+            driver.reset(32);
+            driver.round(2ms, true);
+            driver.round(2ms, true);
+            driver.round(2ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 32, "drop: before");
+            driver.dropped();
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 16, "drop: 1");
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window.slow_start(), false, "drop: slow start ended");
+            driver.dropped();
+            driver.dropped();
+            driver.dropped();
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 4, "drop: floor");
+
+            //  Only by one from here on.
+            driver.round(2ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 5, "drop: regrow");
+        }
+
+        //  A ceiling below the minimum window.
+        {
+            WindowDriver driver;
+            driver.reset(2);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 2, "small ceiling: initial");
+            driver.dropped();
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 2, "small ceiling: drop");
+        }
+
+        //  Renegotiating re-arms slow start and forgets the base round trip.
+        {
+            WindowDriver driver;
+            driver.reset(32);
+            driver.round(2ms, true);
+            driver.round(2ms + 20ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window.slow_start(), false, "reset: slow start ended");
+
+            driver.reset(32);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 4, "reset: window");
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window.slow_start(), true, "reset: slow start");
+
+            //  Slower link than before. If the old 2ms base were kept, this
+            //  would look like 28ms of backlog.
+            driver.round(30ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 8, "reset: new base");
+        }
+
+        //  The base round trip expires.
+        {
+            WindowDriver driver;
+            driver.reset(32);
+            driver.round(2ms, true);
+            driver.now += 11s;
+            driver.round(30ms, true);
+            TEST_RESULT_COMPONENT_EQUAL_STR(driver.window_size(), 16, "base expires");
+        }
+
+        return true;
+    }
+};
+
+
+
+namespace{
+
+//  Records everything sent. Can be told to fail the next send.
+class FakeConnection : public ReliableStreamConnectionPushing{
+public:
+    virtual void reliable_send_all_or_nothing(
+        Cancellable* cancellable,
+        const void* data, size_t bytes
+    ) override{
+        if (fail_next){
+            fail_next = false;
+            throw ConnectionException(nullptr, "Send failed.");
+        }
+        sent.append((const char*)data, bytes);
+    }
+    virtual bool reliable_send_all_or_nothing(
+        Cancellable* cancellable,
+        const void* data, size_t bytes,
+        WallClock deadline
+    ) override{
+        reliable_send_all_or_nothing(cancellable, data, bytes);
+        return true;
+    }
+
+    std::vector<uint8_t> sent_ids() const{
+        std::vector<uint8_t> ret;
+        size_t offset = 0;
+        while (offset + sizeof(PABotBase2::MessageHeader) <= sent.size()){
+            PABotBase2::MessageHeader header;
+            memcpy(&header, sent.data() + offset, sizeof(header));
+            ret.emplace_back(header.id);
+            offset += header.message_bytes;
+        }
+        return ret;
+    }
+
+    bool fail_next = false;
+    std::string sent;
+};
+
+PABotBase2::pabb2_Message_Command_NS_WiredController_State make_command(){
+    PABotBase2::pabb2_Message_Command_NS_WiredController_State command;
+    memset(&command, 0, sizeof(command));
+    command.message_bytes = sizeof(command);
+    command.opcode = PABB2_MESSAGE_CMD_NS_WIRED_CONTROLLER_STATE;
+    command.report.dpad_byte = 8;
+    command.report.left_joystick_x = 0x80;
+    command.report.left_joystick_y = 0x80;
+    command.report.right_joystick_x = 0x80;
+    command.report.right_joystick_y = 0x80;
+    return command;
+}
+
+void finish(PABotBase2::CommandQueueManager& queue, uint8_t id){
+    PABotBase2::Message_u32 message;
+    message.message_bytes = sizeof(message);
+    message.opcode = PABB2_MESSAGE_OPCODE_CQ_COMMAND_FINISHED;
+    message.id = id;
+    message.data = 0;
+    queue.report_command_finished(message);
+}
+void drop(PABotBase2::CommandQueueManager& queue, uint8_t id){
+    PABotBase2::MessageHeader message;
+    message.message_bytes = sizeof(message);
+    message.opcode = PABB2_MESSAGE_OPCODE_CQ_COMMAND_DROPPED;
+    message.id = id;
+    queue.report_command_dropped(message);
+}
+
+std::string ids_to_str(const std::vector<uint8_t>& ids){
+    std::string ret = "{";
+    for (uint8_t id : ids){
+        if (ret.size() > 1){
+            ret += ", ";
+        }
+        ret += std::to_string(id);
+    }
+    return ret + "}";
+}
+
+}
+
+
+
+//  A dropped command is a failure to whoever waits on it.
+class Test_PABotBase2CommandQueueDropped : public UnitTest{
+public:
+    Test_PABotBase2CommandQueueDropped()
+        : UnitTest("PABotBase2::CommandQueueDropped")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& parent) const override{
+        CancellableHolder<CancellableScope> scope(parent);
+        FakeConnection connection;
+        PABotBase2::MessageLogger message_logger;
+        PABotBase2::CommandQueueManager queue(logger, scope, connection, message_logger);
+        queue.set_command_queue_size(16);
+
+        auto command = make_command();
+
+        //  Waiting on a dropped command throws once.
+        {
+            uint8_t dropped = queue.send_command(&scope, command);
+            uint8_t finished = queue.send_command(&scope, command);
+            drop(queue, dropped);
+            finish(queue, finished);
+
+            bool threw = false;
+            try{
+                queue.wait_for_command_finish(&scope, dropped);
+            }catch (const SerialProtocolException&){
+                threw = true;
+            }
+            TEST_RESULT_COMPONENT_EQUAL_STR(threw, true, "wait on dropped command");
+
+            queue.wait_for_command_finish(&scope, finished);
+            queue.wait_for_command_finish(&scope, dropped);
+            queue.wait_for_all(&scope);
+        }
+
+        //  So does waiting on everything.
+        {
+            uint8_t dropped = queue.send_command(&scope, command);
+            uint8_t finished = queue.send_command(&scope, command);
+            finish(queue, finished);
+            drop(queue, dropped);
+
+            bool threw = false;
+            try{
+                queue.wait_for_all(&scope);
+            }catch (const SerialProtocolException&){
+                threw = true;
+            }
+            TEST_RESULT_COMPONENT_EQUAL_STR(threw, true, "wait for all with dropped command");
+            queue.wait_for_all(&scope);
+        }
+
+        //  A later command that reuses a dropped ID isn't affected.
+        {
+            uint8_t id = 0;
+            for (size_t c = 0; c < 256; c++){
+                id = queue.send_command(&scope, command);
+                finish(queue, id);
+            }
+            queue.wait_for_command_finish(&scope, id);
+            queue.wait_for_all(&scope);
+        }
+
+        return true;
+    }
+};
+
+
+
+//  Batches belong to the thread that sent them. Aborting or failing one
+//  thread's batch leaves other threads' commands alone.
+class Test_PABotBase2CommandQueueBatchOwner : public UnitTest{
+public:
+    Test_PABotBase2CommandQueueBatchOwner()
+        : UnitTest("PABotBase2::CommandQueueBatchOwner")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& parent) const override{
+        CancellableHolder<CancellableScope> scope(parent);
+        FakeConnection connection;
+        PABotBase2::MessageLogger message_logger;
+        PABotBase2::CommandQueueManager queue(logger, scope, connection, message_logger);
+        queue.set_command_queue_size(16);
+
+        auto command = make_command();
+
+        //  Another thread aborts its batch while ours is open.
+        {
+            queue.begin_batch();
+            uint8_t a0 = queue.send_command(&scope, command);
+            uint8_t a1 = queue.send_command(&scope, command);
+
+            std::thread other([&]{
+                auto other_command = make_command();
+                queue.begin_batch();
+                queue.send_command(&scope, other_command);
+                queue.abort_batch();
+            });
+            other.join();
+
+            queue.end_batch(&scope);
+            std::vector<uint8_t> sent = connection.sent_ids();
+            std::vector<uint8_t> expected{a0, a1};
+            TEST_RESULT_COMPONENT_EQUAL_STR(ids_to_str(sent), ids_to_str(expected), "abort: sent");
+
+            finish(queue, a0);
+            finish(queue, a1);
+            queue.wait_for_all(&scope);
+            connection.sent.clear();
+        }
+
+        //  Our flush fails while another thread has commands in the batch.
+        {
+            uint8_t b0 = 0;
+            std::thread other([&]{
+                auto other_command = make_command();
+                queue.begin_batch();
+                b0 = queue.send_command(&scope, other_command);
+            });
+            other.join();
+
+            queue.send_command(&scope, command);
+            TEST_RESULT_COMPONENT_EQUAL_STR(connection.sent.size(), 0, "flush failure: held");
+
+            connection.fail_next = true;
+            bool threw = false;
+            try{
+                queue.wait_for_all(&scope);
+            }catch (const ConnectionException&){
+                threw = true;
+            }
+            TEST_RESULT_COMPONENT_EQUAL_STR(threw, true, "flush failure: threw");
+
+            //  The other thread's command is still queued. Ours isn't.
+            queue.end_batch(&scope);
+            std::vector<uint8_t> sent = connection.sent_ids();
+            std::vector<uint8_t> expected{b0};
+            TEST_RESULT_COMPONENT_EQUAL_STR(ids_to_str(sent), ids_to_str(expected), "flush failure: sent");
+
+            finish(queue, b0);
+            queue.wait_for_all(&scope);
+        }
+
+        return true;
+    }
+};
+
+
+
+void add_tests_PABotBase2CommandQueue(UnitTestDatabase& database){
+    database.add<Test_PABotBase2CommandWindow>();
+    database.add<Test_PABotBase2CommandQueueDropped>();
+    database.add<Test_PABotBase2CommandQueueBatchOwner>();
+}
+
+
+
+}
@@ -0,0 +1,21 @@
+/*  PABotBase2 Command Queue Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_PABotBase2_CommandQueue_Tests_H
+#define PokemonAutomation_Tests_PABotBase2_CommandQueue_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+
+
+
+void add_tests_PABotBase2CommandQueue(UnitTestDatabase& database);
+
+
+
+}
+#endif
@@ -0,0 +1,198 @@
+/*  Pokemon RNG Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <random>
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "Pokemon/Pokemon_Gf2Matrix.h"
+#include "Pokemon/Pokemon_Xorshift128.h"
+#include "Pokemon/Pokemon_Xoroshiro128Plus.h"
+#include "Pokemon_Rng_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+
+using namespace Pokemon;
+
+
+
+namespace{
+
+//  Below, at and above the 512 step threshold where advance() and rewind()
+//  switch from stepping to jumping.
+const uint64_t JUMP_COUNTS[] = {0, 1, 511, 512, 513, 4096, 100000, 1234567};
+
+Gf2Matrix128 random_matrix(std::mt19937_64& rng){
+    Gf2Matrix128 ret;
+    for (size_t row = 0; row < 128; row++){
+        ret[row] = Gf2Vec128(rng(), rng());
+    }
+    return ret;
+}
+
+//  One row at a time, one bit at a time.
+Gf2Matrix128 naive_product(const Gf2Matrix128& x, const Gf2Matrix128& y){
+    Gf2Matrix128 ret;
+    for (size_t row = 0; row < 128; row++){
+        for (size_t k = 0; k < 128; k++){
+            if (x[row].get(k)){
+                ret[row] ^= y[k];
+            }
+        }
+    }
+    return ret;
+}
+
+std::string xoroshiro_to_str(const Xoroshiro128PlusState& state){
+    return "[" + std::to_string(state.s0) + ", " + std::to_string(state.s1) + "]";
+}
+
+}
+
+
+
+class Test_Gf2Matrix128 : public UnitTest{
+public:
+    Test_Gf2Matrix128()
+        : UnitTest("Pokemon::Gf2Matrix128")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        std::mt19937_64 rng(1);
+
+        for (size_t trial = 0; trial < 4; trial++){
+            Gf2Matrix128 x = random_matrix(rng);
+            Gf2Matrix128 y = random_matrix(rng);
+
+            TEST_RESULT_COMPONENT_EQUAL_STR(x * y == naive_product(x, y), true, "product " + std::to_string(trial));
+            TEST_RESULT_COMPONENT_EQUAL_STR(x.transpose().transpose() == x, true, "transpose " + std::to_string(trial));
+
+            Gf2MatrixLookup128 lookup(x);
+            for (size_t c = 0; c < 16; c++){
+                Gf2Vec128 vector(rng(), rng());
+                TEST_RESULT_COMPONENT_EQUAL_STR(lookup * vector == x * vector, true, "lookup " + std::to_string(trial));
+            }
+
+            //  Every column on its own.
+            for (size_t column = 0; column < 128; column++){
+                Gf2Vec128 basis;
+                basis.set(column, true);
+                TEST_RESULT_COMPONENT_EQUAL_STR(lookup * basis == x * basis, true, "lookup column " + std::to_string(column));
+            }
+        }
+
+        Gf2JumpTable128 table(xorshift128_transition_matrix());
+        for (uint64_t count : JUMP_COUNTS){
+            TEST_RESULT_COMPONENT_EQUAL_STR(
+                table.power(count) == xorshift128_transition_matrix().pow(count), true,
+                "jump table power " + std::to_string(count)
+            );
+        }
+
+        return true;
+    }
+};
+
+
+
+class Test_Xorshift128Jumps : public UnitTest{
+public:
+    Test_Xorshift128Jumps()
+        : UnitTest("Pokemon::Xorshift128Jumps")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        std::mt19937_64 rng(2);
+
+        //  prev() undoes next().
+        for (size_t c = 0; c < 64; c++){
+            Xorshift128State start((uint32_t)rng(), (uint32_t)rng(), (uint32_t)rng(), (uint32_t)rng());
+            Xorshift128 generator(start);
+            generator.next();
+            generator.prev();
+            TEST_RESULT_COMPONENT_EQUAL_STR(generator.state().to_string(), start.to_string(), "prev");
+        }
+
+        const Xorshift128State start((uint32_t)rng(), (uint32_t)rng(), (uint32_t)rng(), (uint32_t)rng());
+        for (uint64_t count : JUMP_COUNTS){
+            std::string name = std::to_string(count);
+
+            Xorshift128 jumped(start);
+            Xorshift128 stepped(start);
+            jumped.advance(count);
+            for (uint64_t c = 0; c < count; c++){
+                stepped.next();
+            }
+            TEST_RESULT_COMPONENT_EQUAL_STR(jumped.state().to_string(), stepped.state().to_string(), "advance " + name);
+
+            jumped.rewind(count);
+            for (uint64_t c = 0; c < count; c++){
+                stepped.prev();
+            }
+            TEST_RESULT_COMPONENT_EQUAL_STR(jumped.state().to_string(), start.to_string(), "rewind " + name);
+            TEST_RESULT_COMPONENT_EQUAL_STR(stepped.state().to_string(), start.to_string(), "prev " + name);
+        }
+
+        return true;
+    }
+};
+
+
+
+class Test_Xoroshiro128PlusJumps : public UnitTest{
+public:
+    Test_Xoroshiro128PlusJumps()
+        : UnitTest("Pokemon::Xoroshiro128PlusJumps")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        std::mt19937_64 rng(3);
+
+        //  prev() undoes next().
+        for (size_t c = 0; c < 64; c++){
+            Xoroshiro128PlusState start(rng(), rng());
+            Xoroshiro128Plus generator(start);
+            generator.next();
+            generator.prev();
+            TEST_RESULT_COMPONENT_EQUAL_STR(xoroshiro_to_str(generator.state), xoroshiro_to_str(start), "prev");
+        }
+
+        const Xoroshiro128PlusState start(rng(), rng());
+        for (uint64_t count : JUMP_COUNTS){
+            std::string name = std::to_string(count);
+
+            Xoroshiro128Plus jumped(start);
+            Xoroshiro128Plus stepped(start);
+            jumped.advance(count);
+            for (uint64_t c = 0; c < count; c++){
+                stepped.next();
+            }
+            TEST_RESULT_COMPONENT_EQUAL_STR(xoroshiro_to_str(jumped.state), xoroshiro_to_str(stepped.state), "advance " + name);
+
+            jumped.rewind(count);
+            for (uint64_t c = 0; c < count; c++){
+                stepped.prev();
+            }
+            TEST_RESULT_COMPONENT_EQUAL_STR(xoroshiro_to_str(jumped.state), xoroshiro_to_str(start), "rewind " + name);
+            TEST_RESULT_COMPONENT_EQUAL_STR(xoroshiro_to_str(stepped.state), xoroshiro_to_str(start), "prev " + name);
+        }
+
+        return true;
+    }
+};
+
+
+
+void add_tests_PokemonRng(UnitTestDatabase& database){
+    database.add<Test_Gf2Matrix128>();
+    database.add<Test_Xorshift128Jumps>();
+    database.add<Test_Xoroshiro128PlusJumps>();
+}
+
+
+
+}
@@ -0,0 +1,21 @@
+/*  Pokemon RNG Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_Pokemon_Rng_Tests_H
+#define PokemonAutomation_Tests_Pokemon_Rng_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+
+
+
+void add_tests_PokemonRng(UnitTestDatabase& database);
+
+
+
+}
+#endif
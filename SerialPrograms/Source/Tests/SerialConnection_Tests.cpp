@@ -0,0 +1,467 @@
+/*  Serial Connection Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include "Common/Cpp/Exceptions.h"
+#include "Common/Cpp/CancellableScope.h"
+#include "Common/Cpp/Concurrency/Mutex.h"
+#include "Common/Cpp/Concurrency/ConditionVariable.h"
+#include "Common/Cpp/SerialConnection/SerialLatencyHistogram.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "SerialConnection_Tests.h"
+#include "Tests/TestUtils.h"
+
+#ifndef _WIN32
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include "Common/Cpp/SerialConnection/SerialConnection.h"
+#include "Common/Cpp/StreamConnections/PtyDevice.h"
+#include "Common/PABotBase2/Controllers/PABotBase2_Controller_NS_WiredController.h"
+#include "Common/PABotBase2/ReliableConnectionLayer/PABotBase2CC_ReliableStreamConnection.h"
+#include "CommonFramework/Tools/GlobalThreadPools.h"
+#include "Controllers/PABotBase2/PABotBase2_CommandQueueManager.h"
+#endif
+
+namespace PokemonAutomation{
+
+
+
+//  Percentiles are nearest-rank: the ceil(p * samples)-th smallest sample.
+class Test_SerialLatencyHistogramPercentile : public UnitTest{
+public:
+    Test_SerialLatencyHistogramPercentile()
+        : UnitTest("SerialConnection::LatencyHistogramPercentile")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        using std::chrono::microseconds;
+
+        {
+            SerialLatencyHistogram histogram;
+            TEST_RESULT_COMPONENT_EQUAL_STR(histogram.take().percentile_us(0.5), 0, "empty p50");
+        }
+
+        //  9 samples in [0, 1) and 1 sample in [64, 128).
+        {
+            SerialLatencyHistogram histogram;
+            for (size_t c = 0; c < 9; c++){
+                histogram.record(microseconds(0));
+            }
+            histogram.record(microseconds(100));
+            SerialLatencyHistogram::Snapshot snapshot = histogram.take();
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.samples, 10, "samples");
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.percentile_us(0.00), 1, "p0");
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.percentile_us(0.90), 1, "p90");
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.percentile_us(0.91), 128, "p91");
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.percentile_us(0.99), 128, "p99");
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.percentile_us(1.00), 128, "p100");
+        }
+
+        //  1 sample in [0, 1) and 2 samples in [64, 128). Rank 2 for p50.
+        {
+            SerialLatencyHistogram histogram;
+            histogram.record(microseconds(0));
+            histogram.record(microseconds(100));
+            histogram.record(microseconds(100));
+            SerialLatencyHistogram::Snapshot snapshot = histogram.take();
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.percentile_us(0.33), 1, "p33");
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.percentile_us(0.50), 128, "p50");
+        }
+
+        //  The last bucket reports the max.
+        {
+            SerialLatencyHistogram histogram;
+            histogram.record(std::chrono::seconds(100));
+            SerialLatencyHistogram::Snapshot snapshot = histogram.take();
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.percentile_us(0.5), 100000000, "overflow p50");
+        }
+
+        return true;
+    }
+};
+
+
+
+#ifndef _WIN32
+
+namespace{
+
+using namespace std::chrono_literals;
+
+//  Hands the command queue messages to the CommandQueueManager the same way
+//  DeviceHandle does.
+class CommandQueueListener : public StreamListener{
+public:
+    CommandQueueListener(PABotBase2::CommandQueueManager& queue)
+        : m_queue(queue)
+    {}
+
+    virtual void on_recv(const void* data, size_t bytes) override{
+        m_buffer.append((const char*)data, bytes);
+        while (m_buffer.size() >= sizeof(PABotBase2::MessageHeader)){
+            uint16_t message_bytes;
+            memcpy(&message_bytes, m_buffer.data(), sizeof(message_bytes));
+            if (message_bytes < sizeof(PABotBase2::MessageHeader)){
+                m_buffer.clear();
+                return;
+            }
+            if (m_buffer.size() < message_bytes){
+                return;
+            }
+            const PABotBase2::MessageHeader& header = *(const PABotBase2::MessageHeader*)m_buffer.data();
+            switch (header.opcode){
+            case PABB2_MESSAGE_OPCODE_CQ_COMMAND_FINISHED:
+                m_queue.report_command_finished(header);
+                break;
+            case PABB2_MESSAGE_OPCODE_CQ_COMMAND_DROPPED:
+                m_queue.report_command_dropped(header);
+                break;
+            }
+            m_buffer.erase(0, message_bytes);
+        }
+    }
+
+private:
+    PABotBase2::CommandQueueManager& m_queue;
+    std::string m_buffer;
+};
+
+//  Cancel the scope if the test is still running after the timeout.
+class Watchdog{
+public:
+    Watchdog(Cancellable& scope, std::chrono::milliseconds timeout)
+        : m_thread([&, timeout]{
+            std::unique_lock<Mutex> lg(m_lock);
+            if (!m_cv.wait_for(lg, timeout, [this]{ return m_done; })){
+                scope.cancel(nullptr);
+            }
+        })
+    {}
+    ~Watchdog(){
+        {
+            std::lock_guard<Mutex> lg(m_lock);
+            m_done = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+private:
+    Mutex m_lock;
+    ConditionVariable m_cv;
+    bool m_done = false;
+    std::thread m_thread;
+};
+
+//  Push "commands" commands through SerialConnection ->
+//  ReliableStreamConnection -> CommandQueueManager to a PtyDevice and check
+//  that every one of them comes back finished.
+std::string run_loopback(
+    Logger& logger, CancellableScope& parent,
+    const std::string& name,
+    const SerialConnectionOptions& serial_options,
+    size_t commands
+){
+    //  A clean wire. Drops and reorders only exercise the retransmits above
+    //  the serial connection and make the run time unpredictable.
+    PtyDeviceOptions device_options;
+
+    CancellableHolder<CancellableScope> scope(parent);
+    Watchdog watchdog(scope, 60s);
+
+    try{
+        PtyDevice device(GlobalThreadPools::unlimited_realtime(), device_options);
+        SerialConnection serial(
+            GlobalThreadPools::unlimited_realtime(),
+            device.port_name(),
+            device_options.baud_rate,
+            serial_options
+        );
+
+        PABotBase2::ReliableStreamConnection stream(
+            &scope,
+            logger, false,
+            GlobalThreadPools::unlimited_realtime(),
+            serial,
+            80ms,
+            nullptr
+        );
+        if (!stream.reset(1000ms)){
+            return name + ": Device did not respond to reset.";
+        }
+        stream.send_request(PABB2_CONNECTION_OPCODE_ASK_VERSION);
+        stream.wait_for_pending();
+        if (!stream.remote_protocol_is_compatible()){
+            return name + ": Incompatible protocol: " + std::to_string(stream.remote_protocol());
+        }
+        stream.send_request(PABB2_CONNECTION_OPCODE_ASK_PACKET_SIZE);
+        stream.wait_for_pending();
+        stream.send_request(PABB2_CONNECTION_OPCODE_ASK_BUFFER_SLOTS);
+        stream.wait_for_pending();
+
+        PABotBase2::MessageLogger message_logger;
+        PABotBase2::CommandQueueManager queue(logger, scope, stream, message_logger);
+        CommandQueueListener listener(queue);
+        stream.add_listener(listener);
+        queue.set_command_queue_size(16);
+
+        PABotBase2::pabb2_Message_Command_NS_WiredController_State command;
+        memset(&command, 0, sizeof(command));
+        command.message_bytes = sizeof(command);
+        command.opcode = PABB2_MESSAGE_CMD_NS_WIRED_CONTROLLER_STATE;
+        command.milliseconds = 0;
+        command.report.dpad_byte = 8;
+        command.report.left_joystick_x = 0x80;
+        command.report.left_joystick_y = 0x80;
+        command.report.right_joystick_x = 0x80;
+        command.report.right_joystick_y = 0x80;
+
+        //  Stop the serial connection before removing the listener so that
+        //  remove_listener() doesn't have to fight the receiver thread for
+        //  the listener locks.
+        try{
+            for (size_t c = 0; c < commands; c++){
+                queue.send_command(&scope, command);
+            }
+            queue.wait_for_all(&scope);
+        }catch (...){
+            serial.stop();
+            stream.remove_listener(listener);
+            throw;
+        }
+        serial.stop();
+        stream.remove_listener(listener);
+
+        PtyDeviceStats stats = device.stats();
+        TEST_RESULT_COMPONENT_EQUAL_STR(stats.commands_finished, commands, name + ": commands finished");
+        TEST_RESULT_COMPONENT_EQUAL_STR(stats.commands_dropped, 0, name + ": commands dropped");
+    }catch (const OperationCancelledException&){
+        return name + ": Timed out.";
+    }catch (const Exception& e){
+        return name + ": " + e.to_str();
+    }
+    return "";
+}
+
+//  Sends everything it receives straight back from the receiver thread, the
+//  same way the reliable layer acks packets.
+class EchoListener : public StreamListener{
+public:
+    EchoListener(UnreliableStreamSender& sender)
+        : m_sender(sender)
+    {}
+
+    virtual void on_recv(const void* data, size_t bytes) override{
+        m_sender.unreliable_send(data, bytes);
+    }
+
+private:
+    UnreliableStreamSender& m_sender;
+};
+
+//  Stream "bytes" bytes from the master end of "master_fd" to an echoing
+//  SerialConnection on the slave end. The master doesn't read anything back
+//  until its writes stop going through. By then the host is stuck sending
+//  from its receiver thread and has to get going again once the master reads.
+std::string run_echo(
+    int master_fd, const std::string& port_name,
+    const std::string& name,
+    const SerialConnectionOptions& serial_options,
+    size_t bytes
+){
+    std::vector<uint8_t> sent(bytes);
+    for (size_t c = 0; c < bytes; c++){
+        sent[c] = (uint8_t)(c * 7 + c / 251);
+    }
+    std::vector<uint8_t> echoed;
+    echoed.reserve(bytes);
+
+    size_t written = 0;
+    bool reading = false;
+    bool stalled = false;
+    try{
+        SerialConnection serial(
+            GlobalThreadPools::unlimited_realtime(),
+            port_name,
+            921600,
+            serial_options
+        );
+        EchoListener listener(serial);
+        serial.add_listener(listener);
+
+        auto deadline = std::chrono::steady_clock::now() + 30s;
+        while (echoed.size() < bytes && std::chrono::steady_clock::now() < deadline){
+            pollfd fd;
+            fd.fd = master_fd;
+            fd.events = 0;
+            if (written < bytes){
+                fd.events |= POLLOUT;
+            }
+            if (reading){
+                fd.events |= POLLIN;
+            }
+            fd.revents = 0;
+
+            int ret = poll(&fd, 1, 100);
+            if (ret == 0 && !reading){
+                stalled = written < bytes;
+                reading = true;
+                continue;
+            }
+            if (fd.revents & POLLOUT){
+                ssize_t actual = write(master_fd, sent.data() + written, std::min<size_t>(bytes - written, 4096));
+                if (actual > 0){
+                    written += actual;
+                }
+            }
+            if (fd.revents & POLLIN){
+                uint8_t buffer[4096];
+                ssize_t actual = read(master_fd, buffer, sizeof(buffer));
+                if (actual > 0){
+                    echoed.insert(echoed.end(), buffer, buffer + actual);
+                }
+            }
+        }
+
+        serial.stop();
+        serial.remove_listener(listener);
+    }catch (const Exception& e){
+        return name + ": " + e.to_str();
+    }
+
+    if (echoed.size() < bytes){
+        return name + ": Timed out. Sent " + std::to_string(written) + " / " + std::to_string(bytes) +
+            " bytes. Echoed " + std::to_string(echoed.size()) + " bytes. " +
+            (stalled ? "(master stopped reading)" : "");
+    }
+    for (size_t c = 0; c < bytes; c++){
+        if (echoed[c] != sent[c]){
+            return name + ": Byte " + std::to_string(c) + " was not echoed back correctly.";
+        }
+    }
+    return "";
+}
+
+}
+
+
+
+//  The whole PABotBase2 host stack against a PtyDevice with both serial I/O
+//  modes. The small send buffer forces senders to wait for the event loop to
+//  drain it.
+class Test_SerialConnectionLoopback : public UnitTest{
+public:
+    Test_SerialConnectionLoopback()
+        : UnitTest("SerialConnection::Loopback")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const size_t COMMANDS = 2000;
+
+        SerialConnectionOptions blocking;
+        blocking.event_driven = false;
+        blocking.latency_report_interval = std::chrono::seconds(0);
+
+        SerialConnectionOptions event_driven;
+        event_driven.event_driven = true;
+        event_driven.latency_report_interval = std::chrono::seconds(0);
+
+        SerialConnectionOptions small_buffer = event_driven;
+        small_buffer.send_buffer_size = 16;
+
+        std::string error;
+        error = run_loopback(logger, scope, "blocking", blocking, COMMANDS);
+        if (!error.empty()){
+            return error;
+        }
+#ifndef __APPLE__
+        error = run_loopback(logger, scope, "event-driven", event_driven, COMMANDS);
+        if (!error.empty()){
+            return error;
+        }
+        error = run_loopback(logger, scope, "event-driven (16-byte send buffer)", small_buffer, COMMANDS);
+        if (!error.empty()){
+            return error;
+        }
+#endif
+        return true;
+    }
+};
+
+
+
+
+//  Send from the receiver thread while the other end has stopped reading.
+//  In event-driven mode this fills the send buffer with nobody else to drain
+//  it.
+class Test_SerialConnectionSendFromReceiver : public UnitTest{
+public:
+    Test_SerialConnectionSendFromReceiver()
+        : UnitTest("SerialConnection::SendFromReceiver")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        //  Enough to fill the pty buffers in both directions and the send
+        //  buffer.
+        const size_t BYTES = 1 << 20;
+
+        int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master_fd == -1){
+            return UnitTestResult(UnitTestResult::SKIPPED, "posix_openpt() failed. Error = " + std::to_string(errno));
+        }
+        const char* port_name = grantpt(master_fd) == 0 && unlockpt(master_fd) == 0
+            ? ptsname(master_fd)
+            : nullptr;
+        if (port_name == nullptr){
+            close(master_fd);
+            return UnitTestResult(UnitTestResult::SKIPPED, "Unable to open the pty slave.");
+        }
+        std::string port = port_name;
+        fcntl(master_fd, F_SETFL, fcntl(master_fd, F_GETFL) | O_NONBLOCK);
+
+        SerialConnectionOptions blocking;
+        blocking.event_driven = false;
+        blocking.latency_report_interval = std::chrono::seconds(0);
+
+        SerialConnectionOptions event_driven;
+        event_driven.event_driven = true;
+        event_driven.latency_report_interval = std::chrono::seconds(0);
+
+        std::string error = run_echo(master_fd, port, "blocking", blocking, BYTES);
+#ifndef __APPLE__
+        if (error.empty()){
+            error = run_echo(master_fd, port, "event-driven", event_driven, BYTES);
+        }
+#endif
+        close(master_fd);
+        if (!error.empty()){
+            return error;
+        }
+        return true;
+    }
+};
+
+#endif
+
+
+
+void add_tests_SerialConnection(UnitTestDatabase& database){
+    database.add<Test_SerialLatencyHistogramPercentile>();
+#ifndef _WIN32
+    database.add<Test_SerialConnectionLoopback>();
+    database.add<Test_SerialConnectionSendFromReceiver>();
+#endif
+}
+
+
+
+}
@@ -0,0 +1,21 @@
+/*  Serial Connection Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_SerialConnection_Tests_H
+#define PokemonAutomation_Tests_SerialConnection_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+
+
+
+void add_tests_SerialConnection(UnitTestDatabase& database);
+
+
+
+}
+#endif
@@ -0,0 +1,287 @@
+/*  Stats Database Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <QFile>
+#include <QTemporaryDir>
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "CommonFramework/ProgramStats/StatsDatabase.h"
+#include "StatsDatabase_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+
+
+
+namespace{
+
+const char DIVIDER[] = "================================================================================\r\n";
+
+const std::string PROGRAM = "PokemonSwSh:StatsReset";
+const std::string OTHER = "Test:OtherProgram";
+
+
+class TestStats : public StatsTracker{
+public:
+    TestStats()
+        : resets(m_stats["Resets"])
+        , shinies(m_stats["Shinies"])
+    {
+        m_display_order.emplace_back("Resets");
+        m_display_order.emplace_back("Shinies", HIDDEN_IF_ZERO);
+    }
+
+    //  Every count, including labels that are not in the display order.
+    std::string counts() const{
+        std::string str;
+        for (const auto& item : m_stats){
+            if (!str.empty()){
+                str += ", ";
+            }
+            str += item.first + " = " + std::to_string(item.second.load());
+        }
+        return str;
+    }
+
+    std::atomic<uint64_t>& resets;
+    std::atomic<uint64_t>& shinies;
+};
+
+
+std::string read_file(const std::string& filepath){
+    QFile file(QString::fromStdString(filepath));
+    if (!file.open(QIODevice::ReadOnly)){
+        return "";
+    }
+    return file.readAll().toStdString();
+}
+void write_file(const std::string& filepath, const std::string& data, bool append = false){
+    QFile file(QString::fromStdString(filepath));
+    if (file.open(append ? QIODevice::WriteOnly | QIODevice::Append : QIODevice::WriteOnly)){
+        file.write(data.c_str(), data.size());
+    }
+}
+
+size_t count_sections(const std::string& data){
+    size_t sections = 0;
+    for (size_t c = 0; c < data.size(); c++){
+        if (data[c] == '=' && (c == 0 || data[c - 1] == '\n')){
+            sections++;
+        }
+    }
+    return sections;
+}
+
+//  The totals of "identifier" as the index has them.
+std::string index_totals(StatsFileIndex& index, const std::string& filepath, const std::string& identifier){
+    TestStats stats;
+    index.aggregate(filepath, identifier, stats);
+    return stats.counts();
+}
+
+//  The totals of "identifier" from parsing the whole file.
+std::string parsed_totals(const std::string& filepath, const std::string& identifier){
+    StatSet set;
+    set.open_from_file(filepath);
+    TestStats stats;
+    set[identifier].aggregate(stats);
+    return stats.counts();
+}
+
+}
+
+
+
+//  StatsFileIndex must always agree with parsing the whole file, across
+//  appends, edits made behind its back and compaction.
+class Test_StatsFileIndex : public UnitTest{
+public:
+    Test_StatsFileIndex()
+        : UnitTest("ProgramStats::StatsFileIndex")
+    {}
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        QTemporaryDir dir;
+        if (!dir.isValid()){
+            return UnitTestResult(UnitTestResult::SKIPPED, "Unable to create a temporary directory.");
+        }
+        const std::string filepath = dir.filePath("Stats.txt").toStdString();
+
+        //  An existing file with a legacy label for PROGRAM and a label the
+        //  tracker doesn't display.
+        write_file(
+            filepath,
+            std::string("Some header that isn't a section.\r\n\r\n") +
+            DIVIDER + "Stats Reset\r\n\r\n" +
+            "2020-01-01 00:00:00 - Resets: 1,000 - Shinies: 1\r\n" +
+            "2020-01-02 00:00:00 - Resets: 200 - Errors: 3\r\n\r\n" +
+            DIVIDER + OTHER + "\r\n\r\n" +
+            "2020-01-03 00:00:00 - Resets: 5\r\n\r\n" +
+            DIVIDER + PROGRAM + "\r\n\r\n" +
+            "2020-01-04 00:00:00 - Resets: 20\r\n\r\n"
+        );
+
+        StatsFileIndex index;
+
+        //  Aliases: the legacy section counts towards PROGRAM.
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, PROGRAM),
+            std::string("Errors = 3, Resets = 1220, Shinies = 1"),
+            "aliased totals"
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, "Stats Reset"),
+            std::string("Resets = 0, Shinies = 0"),
+            "legacy label"
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, PROGRAM),
+            parsed_totals(filepath, PROGRAM),
+            "initial totals"
+        );
+
+        //  Appending to the existing file.
+        {
+            TestStats stats;
+            stats.resets += 7;
+            stats.shinies += 2;
+            if (!index.append(filepath, PROGRAM, stats)){
+                return "Unable to append to " + filepath;
+            }
+        }
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, PROGRAM),
+            std::string("Errors = 3, Resets = 1227, Shinies = 3"),
+            "totals after append"
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, PROGRAM),
+            parsed_totals(filepath, PROGRAM),
+            "totals after append"
+        );
+
+        //  An edit behind the index's back. The last line is left unterminated,
+        //  so it doesn't count until the next append finishes it. That append
+        //  is to another program, so its label must not run into that line.
+        write_file(
+            filepath,
+            std::string(DIVIDER) + OTHER + "\r\n\r\n" +
+            "2020-01-05 00:00:00 - Resets: 100",
+            true
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, OTHER),
+            std::string("Resets = 5, Shinies = 0"),
+            "totals after outside edit"
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, OTHER),
+            parsed_totals(filepath, OTHER),
+            "totals after outside edit"
+        );
+        {
+            TestStats stats;
+            stats.resets += 1;
+            if (!index.append(filepath, PROGRAM, stats)){
+                return "Unable to append to " + filepath;
+            }
+        }
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, OTHER),
+            std::string("Resets = 105, Shinies = 0"),
+            "totals after append to unterminated line"
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, PROGRAM),
+            std::string("Errors = 3, Resets = 1228, Shinies = 3"),
+            "totals after append to unterminated line"
+        );
+        for (const std::string& identifier : {PROGRAM, OTHER}){
+            TEST_RESULT_COMPONENT_EQUAL_STR(
+                index_totals(index, filepath, identifier),
+                parsed_totals(filepath, identifier),
+                identifier + " totals after append to unterminated line"
+            );
+        }
+
+        //  Enough appends to compact the file a few times, but not on every
+        //  append.
+        const size_t APPENDS = 80;
+        size_t max_sections = 0;
+        size_t compactions = 0;
+        size_t sections = count_sections(read_file(filepath));
+        for (size_t c = 0; c < APPENDS; c++){
+            TestStats stats;
+            stats.resets += c;
+            stats.shinies += c % 2;
+            if (!index.append(filepath, c % 3 == 0 ? OTHER : PROGRAM, stats)){
+                return "Unable to append to " + filepath;
+            }
+            for (const std::string& identifier : {PROGRAM, OTHER}){
+                TEST_RESULT_COMPONENT_EQUAL_STR(
+                    index_totals(index, filepath, identifier),
+                    parsed_totals(filepath, identifier),
+                    identifier + " totals after append " + std::to_string(c)
+                );
+            }
+            size_t current = count_sections(read_file(filepath));
+            compactions += current <= sections;
+            sections = current;
+            max_sections = std::max(max_sections, sections);
+        }
+
+        //  Compaction bounds the number of sections, and sorts the file with
+        //  the legacy label rewritten.
+        std::string data = read_file(filepath);
+        if (max_sections > 40){
+            return "The file was never compacted. Sections: " + std::to_string(max_sections);
+        }
+        if (compactions > APPENDS / 16){
+            return "The file was compacted too often. Compactions: " + std::to_string(compactions);
+        }
+        if (data.find("\r\nStats Reset\r\n") != std::string::npos){
+            return "The file was never compacted. The legacy label is still there.";
+        }
+
+        //  The totals survive compaction, both in the index and for an index
+        //  that starts from scratch.
+        uint64_t resets = 0;
+        uint64_t shinies = 0;
+        for (size_t c = 0; c < APPENDS; c++){
+            if (c % 3 != 0){
+                resets += c;
+                shinies += c % 2;
+            }
+        }
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            index_totals(index, filepath, PROGRAM),
+            "Errors = 3, Resets = " + std::to_string(1228 + resets) + ", Shinies = " + std::to_string(3 + shinies),
+            "final totals"
+        );
+        StatsFileIndex fresh;
+        for (const std::string& identifier : {PROGRAM, OTHER}){
+            TEST_RESULT_COMPONENT_EQUAL_STR(
+                index_totals(fresh, filepath, identifier),
+                index_totals(index, filepath, identifier),
+                identifier + " totals from a fresh index"
+            );
+        }
+
+        return true;
+    }
+};
+
+
+
+void add_tests_StatsDatabase(UnitTestDatabase& database){
+    database.add<Test_StatsFileIndex>();
+}
+
+
+
+}
@@ -0,0 +1,21 @@
+/*  Stats Database Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_StatsDatabase_Tests_H
+#define PokemonAutomation_Tests_StatsDatabase_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+
+
+
+void add_tests_StatsDatabase(UnitTestDatabase& database);
+
+
+
+}
+#endif
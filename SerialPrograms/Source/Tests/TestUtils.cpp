@@ -105,5 +105,21 @@ bool load_slug_list(const std::string& filepath, std::vector<std::string>& sprit
     return true;
 }
 
+std::vector<uint32_t> make_random_image(TestRandom& random, size_t stride, size_t height){
+    std::vector<uint32_t> ret(stride * height);
+    for (uint32_t& pixel : ret){
+        pixel = random.pixel();
+    }
+    return ret;
+}
+
+std::vector<uint8_t> make_random_bytes(TestRandom& random, size_t size){
+    std::vector<uint8_t> ret(size);
+    for (uint8_t& byte : ret){
+        byte = (uint8_t)random();
+    }
+    return ret;
+}
+
 
 }
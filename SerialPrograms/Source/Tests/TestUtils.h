@@ -51,6 +51,36 @@ bool load_sprite_count(const std::string& filepath, std::map<std::string, int>&
 bool load_slug_list(const std::string& filepath, std::vector<std::string>& sprites);
 
 
+// Deterministic random numbers for randomized tests.
+// The same seed gives the same sequence on every platform.
+class TestRandom{
+public:
+    TestRandom(uint32_t seed = 1) : m_state(seed) {}
+
+    // Return 24 random bits.
+    uint32_t operator()(){
+        m_state = m_state * 1103515245 + 12345;
+        return m_state >> 8;
+    }
+
+    // Return a random RGB32 pixel. All four channels are random.
+    uint32_t pixel(){
+        uint32_t high = (*this)();
+        return (high << 8) ^ (*this)();
+    }
+
+private:
+    uint32_t m_state;
+};
+
+// Return "height" rows of "stride" random RGB32 pixels.
+// The padding past the image width is random as well.
+std::vector<uint32_t> make_random_image(TestRandom& random, size_t stride, size_t height);
+
+// Return "size" random bytes.
+std::vector<uint8_t> make_random_bytes(TestRandom& random, size_t size);
+
+
 // Implement the dummy interface of BotBase so that we can run the test code
 // that relies on a BotBase.
 class DummyBotBase : public BotBaseController{
@@ -0,0 +1,230 @@
+/*  Thread Pool Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "Common/Cpp/Concurrency/AsyncTask.h"
+#include "Common/Cpp/Concurrency/Backends/ThreadPool_WorkStealing.h"
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "ThreadPool_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+
+
+
+namespace{
+
+//  Holds a worker inside a task until released.
+class Blocker{
+public:
+    std::function<void()> task(){
+        return [this]{
+            m_started.store(true, std::memory_order_release);
+            while (!m_released.load(std::memory_order_acquire)){
+                std::this_thread::yield();
+            }
+        };
+    }
+    void wait_until_started() const{
+        while (!m_started.load(std::memory_order_acquire)){
+            std::this_thread::yield();
+        }
+    }
+    void release(){
+        m_released.store(true, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> m_started{false};
+    std::atomic<bool> m_released{false};
+};
+
+}
+
+
+
+//  run_in_parallel() nested three deep, both from outside the pool and from
+//  inside tasks that occupy every worker. Every index must run exactly once
+//  and none of it may deadlock.
+class Test_ThreadPoolNestedParallel : public UnitTest{
+public:
+    Test_ThreadPoolNestedParallel()
+        : UnitTest("ThreadPool::NestedParallel")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const size_t THREADS = 4;
+        const size_t N = 8;
+        ThreadPool_WorkStealing pool(nullptr, THREADS, THREADS);
+
+        auto nested = [&](std::atomic<size_t>* counts){
+            pool.run_in_parallel([&](size_t i){
+                pool.run_in_parallel([&](size_t j){
+                    pool.run_in_parallel([&](size_t k){
+                        counts[(i * N + j) * N + k].fetch_add(1, std::memory_order_relaxed);
+                    }, 0, N, 1);
+                }, 0, N, 1);
+            }, 0, N, 1);
+        };
+
+        for (size_t iteration = 0; iteration < 20; iteration++){
+            //  From outside the pool.
+            {
+                std::unique_ptr<std::atomic<size_t>[]> counts(new std::atomic<size_t>[N * N * N]());
+                nested(counts.get());
+                for (size_t c = 0; c < N * N * N; c++){
+                    TEST_RESULT_COMPONENT_EQUAL_STR(counts[c].load(), 1, "outside: index " + std::to_string(c));
+                }
+            }
+
+            //  From inside more tasks than there are workers.
+            {
+                const size_t TASKS = 2 * THREADS;
+                std::vector<std::unique_ptr<std::atomic<size_t>[]>> counts;
+                std::vector<AsyncTask> tasks;
+                for (size_t t = 0; t < TASKS; t++){
+                    counts.emplace_back(new std::atomic<size_t>[N * N * N]());
+                    std::atomic<size_t>* ptr = counts.back().get();
+                    tasks.emplace_back(pool.dispatch([&, ptr]{ nested(ptr); }));
+                }
+                for (AsyncTask& task : tasks){
+                    task.wait_and_rethrow_exceptions();
+                }
+                for (size_t t = 0; t < TASKS; t++){
+                    for (size_t c = 0; c < N * N * N; c++){
+                        TEST_RESULT_COMPONENT_EQUAL_STR(
+                            counts[t][c].load(), 1,
+                            "inside: task " + std::to_string(t) + ", index " + std::to_string(c)
+                        );
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+};
+
+
+
+//  Tasks from dispatch() start in the order they were dispatched.
+class Test_ThreadPoolDispatchOrder : public UnitTest{
+public:
+    Test_ThreadPoolDispatchOrder()
+        : UnitTest("ThreadPool::DispatchOrder")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const size_t N = 1000;
+        ThreadPool_WorkStealing pool(nullptr, 1, 1);
+
+        Blocker blocker;
+        AsyncTask blocking = pool.dispatch(blocker.task());
+        blocker.wait_until_started();
+
+        //  Only the one worker touches these.
+        std::vector<size_t> order;
+        std::vector<AsyncTask> tasks;
+        for (size_t c = 0; c < N; c++){
+            tasks.emplace_back(pool.dispatch([&order, c]{ order.emplace_back(c); }));
+        }
+        blocker.release();
+
+        blocking.wait_and_rethrow_exceptions();
+        for (AsyncTask& task : tasks){
+            task.wait_and_rethrow_exceptions();
+        }
+
+        TEST_RESULT_COMPONENT_EQUAL_STR(order.size(), N, "order.size()");
+        for (size_t c = 0; c < N; c++){
+            TEST_RESULT_COMPONENT_EQUAL_STR(order[c], c, "order[" + std::to_string(c) + "]");
+        }
+        return true;
+    }
+};
+
+
+
+//  stop() with tasks still queued. Every task must end up either run or
+//  cancelled so that waiting on it returns, and nothing may run after
+//  stop() has returned.
+class Test_ThreadPoolStopWithPending : public UnitTest{
+public:
+    Test_ThreadPoolStopWithPending()
+        : UnitTest("ThreadPool::StopWithPending")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const size_t THREADS = 2;
+        const size_t N = 200;
+
+        for (size_t iteration = 0; iteration < 20; iteration++){
+            ThreadPool_WorkStealing pool(nullptr, THREADS, THREADS);
+
+            std::vector<std::unique_ptr<Blocker>> blockers;
+            std::vector<AsyncTask> blocking;
+            for (size_t c = 0; c < THREADS; c++){
+                blockers.emplace_back(new Blocker());
+                blocking.emplace_back(pool.dispatch(blockers.back()->task()));
+            }
+            for (auto& blocker : blockers){
+                blocker->wait_until_started();
+            }
+
+            std::atomic<size_t> ran(0);
+            std::vector<AsyncTask> tasks;
+            for (size_t c = 0; c < N; c++){
+                tasks.emplace_back(pool.dispatch([&ran]{
+                    ran.fetch_add(1, std::memory_order_relaxed);
+                }));
+            }
+
+            //  stop() joins the workers, so the blockers have to be released
+            //  while it's waiting. Whatever the workers get to before they
+            //  see the stop may run. The rest must be cancelled.
+            std::thread stopper([&]{ pool.stop(); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(iteration % 4));
+            for (auto& blocker : blockers){
+                blocker->release();
+            }
+            stopper.join();
+
+            for (AsyncTask& task : blocking){
+                TEST_RESULT_COMPONENT_EQUAL_STR(task.is_finished(), true, "blocker finished");
+            }
+            for (size_t c = 0; c < N; c++){
+                TEST_RESULT_COMPONENT_EQUAL_STR(tasks[c].is_finished(), true, "task " + std::to_string(c) + " finished");
+                tasks[c].wait_and_rethrow_exceptions();
+            }
+
+            size_t ran_at_stop = ran.load();
+            TEST_RESULT_COMPONENT_EQUAL_STR(ran_at_stop <= N, true, "ran <= N");
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            TEST_RESULT_COMPONENT_EQUAL_STR(ran.load(), ran_at_stop, "ran after stop()");
+
+            //  A second stop() is a no-op.
+            pool.stop();
+        }
+
+        return true;
+    }
+};
+
+
+
+void add_tests_ThreadPool(UnitTestDatabase& database){
+    database.add<Test_ThreadPoolNestedParallel>();
+    database.add<Test_ThreadPoolDispatchOrder>();
+    database.add<Test_ThreadPoolStopWithPending>();
+}
+
+
+
+}
@@ -0,0 +1,21 @@
+/*  Thread Pool Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_ThreadPool_Tests_H
+#define PokemonAutomation_Tests_ThreadPool_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+
+
+
+void add_tests_ThreadPool(UnitTestDatabase& database);
+
+
+
+}
+#endif
@@ -0,0 +1,318 @@
+/*  Video Snapshot Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <random>
+#include "Common/Cpp/TestRunners/UnitTestDatabase.h"
+#include "CommonFramework/VideoPipeline/VideoFeed.h"
+#include "CommonFramework/VideoPipeline/Backends/SnapshotRegionRectangles.h"
+#include "VideoSnapshot_Tests.h"
+#include "Tests/TestUtils.h"
+
+namespace PokemonAutomation{
+
+
+
+namespace{
+
+SnapshotRegions make_regions(std::vector<ImageFloatBox> boxes){
+    return std::make_shared<const std::vector<ImageFloatBox>>(std::move(boxes));
+}
+
+VideoSnapshot make_snapshot(size_t width, size_t height, SnapshotRegions regions){
+    VideoSnapshot ret(ImageRGB32(width, height), WallClock::min());
+    ret.regions = std::move(regions);
+    return ret;
+}
+
+ImagePixelBox clipped_pixelbox(size_t width, size_t height, const ImageFloatBox& box){
+    ImagePixelBox ret = floatbox_to_pixelbox(width, height, box);
+    ret.max_x = std::min(ret.max_x, width);
+    ret.max_y = std::min(ret.max_y, height);
+    return ret;
+}
+
+bool is_even_or(size_t x, size_t limit){
+    return (x & 1) == 0 || x == limit;
+}
+
+std::string to_str(const ImageFloatBox& box){
+    return "(" + std::to_string(box.x) + ", " + std::to_string(box.y) + ", " +
+        std::to_string(box.width) + ", " + std::to_string(box.height) + ")";
+}
+
+//  Run for_each_region_rectangle() over a width x height frame and check that:
+//    - The rectangles tile the frame exactly once.
+//    - Converted edges are even or on the frame edge.
+//    - Every pixel of every region is converted.
+//    - Nothing further than the padding away from a region is converted.
+//    - Anything covers() accepts is entirely converted.
+//  Returns an empty string on success.
+std::string check_region_rectangles(
+    size_t width, size_t height,
+    const std::vector<ImageFloatBox>& regions,
+    const std::vector<ImageFloatBox>& requests
+){
+    std::string name = std::to_string(width) + " x " + std::to_string(height) + " with " +
+        std::to_string(regions.size()) + " regions";
+
+    std::vector<uint8_t> visits(width * height);
+    std::vector<uint8_t> converted(width * height);
+    std::string error;
+    auto mark = [&](size_t min_x, size_t min_y, size_t max_x, size_t max_y, bool inside){
+        if (!error.empty()){
+            return;
+        }
+        if (min_x >= max_x || min_y >= max_y || max_x > width || max_y > height){
+            error = name + ": bad rectangle [" + std::to_string(min_x) + ", " + std::to_string(min_y) +
+                ", " + std::to_string(max_x) + ", " + std::to_string(max_y) + ")";
+            return;
+        }
+        if (inside && !(
+            is_even_or(min_x, width) && is_even_or(max_x, width) &&
+            is_even_or(min_y, height) && is_even_or(max_y, height)
+        )){
+            error = name + ": converted rectangle splits a chroma pair at (" +
+                std::to_string(min_x) + ", " + std::to_string(min_y) + ")";
+            return;
+        }
+        for (size_t y = min_y; y < max_y; y++){
+            for (size_t x = min_x; x < max_x; x++){
+                visits[y * width + x]++;
+                converted[y * width + x] = inside;
+            }
+        }
+    };
+    for_each_region_rectangle(
+        width, height, regions,
+        [&](size_t min_x, size_t min_y, size_t max_x, size_t max_y){
+            mark(min_x, min_y, max_x, max_y, true);
+        },
+        [&](size_t min_x, size_t min_y, size_t max_x, size_t max_y){
+            mark(min_x, min_y, max_x, max_y, false);
+        }
+    );
+    if (!error.empty()){
+        return error;
+    }
+
+    for (size_t y = 0; y < height; y++){
+        for (size_t x = 0; x < width; x++){
+            if (visits[y * width + x] != 1){
+                return name + ": pixel (" + std::to_string(x) + ", " + std::to_string(y) +
+                    ") visited " + std::to_string(visits[y * width + x]) + " times";
+            }
+            if (!converted[y * width + x]){
+                continue;
+            }
+            //  Padded by a pixel, then rounded out to even.
+            bool near = false;
+            for (const ImageFloatBox& region : regions){
+                ImagePixelBox box = floatbox_to_pixelbox(width, height, region).expand_as(2);
+                if (box.min_x <= x && x < box.max_x && box.min_y <= y && y < box.max_y){
+                    near = true;
+                    break;
+                }
+            }
+            if (!near){
+                return name + ": converted pixel (" + std::to_string(x) + ", " + std::to_string(y) +
+                    ") is not near any region";
+            }
+        }
+    }
+
+    auto all_converted = [&](const ImageFloatBox& box){
+        ImagePixelBox pixels = clipped_pixelbox(width, height, box);
+        for (size_t y = pixels.min_y; y < pixels.max_y; y++){
+            for (size_t x = pixels.min_x; x < pixels.max_x; x++){
+                if (!converted[y * width + x]){
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    for (const ImageFloatBox& region : regions){
+        if (!all_converted(region)){
+            return name + ": region " + to_str(region) + " is not fully converted";
+        }
+    }
+
+    VideoSnapshot snapshot = make_snapshot(width, height, make_regions(regions));
+    for (const ImageFloatBox& request : requests){
+        if (snapshot.covers(make_regions({request})) && !all_converted(request)){
+            return name + ": covers() accepted " + to_str(request) + " but it is not fully converted";
+        }
+    }
+
+    return "";
+}
+
+}
+
+
+
+class Test_VideoSnapshotCovers : public UnitTest{
+public:
+    Test_VideoSnapshotCovers()
+        : UnitTest("VideoPipeline::VideoSnapshotCovers")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const size_t WIDTH = 100;
+        const size_t HEIGHT = 60;
+
+        const ImageFloatBox LEFT(0.10, 0.10, 0.30, 0.30);
+        const ImageFloatBox RIGHT(0.30, 0.10, 0.30, 0.30);
+        const ImageFloatBox INNER(0.15, 0.15, 0.10, 0.10);
+
+        //  A null region list is the whole frame.
+        {
+            VideoSnapshot snapshot = make_snapshot(WIDTH, HEIGHT, nullptr);
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.covers(nullptr), true, "whole frame covers whole frame");
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.covers(make_regions({LEFT})), true, "whole frame covers region");
+            TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.covers(make_regions({})), true, "whole frame covers nothing");
+        }
+
+        SnapshotRegions regions = make_regions({LEFT, RIGHT, INNER});
+        VideoSnapshot snapshot = make_snapshot(WIDTH, HEIGHT, regions);
+
+        TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.covers(nullptr), false, "regions cover whole frame");
+        TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.covers(regions), true, "same list");
+        TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.covers(make_regions({})), true, "empty request");
+
+        //  Nested and overlapping.
+        TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.covers(make_regions({LEFT})), true, "same box");
+        TEST_RESULT_COMPONENT_EQUAL_STR(snapshot.covers(make_regions({INNER})), true, "nested box");
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            snapshot.covers(make_regions({ImageFloatBox(0.32, 0.12, 0.05, 0.05)})), true,
+            "box in the overlap"
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            snapshot.covers(make_regions({LEFT, RIGHT, ImageFloatBox(0.35, 0.30, 0.20, 0.05)})), true,
+            "several boxes"
+        );
+
+        //  Different floats that land on the same pixels.
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            snapshot.covers(make_regions({ImageFloatBox(0.1004, 0.1004, 0.2994, 0.2994)})), true,
+            "same pixels"
+        );
+
+        //  The padding pixel counts, two pixels doesn't.
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            snapshot.covers(make_regions({ImageFloatBox(0.09, 0.10, 0.31, 0.30)})), true,
+            "one pixel over"
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            snapshot.covers(make_regions({ImageFloatBox(0.08, 0.10, 0.32, 0.30)})), false,
+            "two pixels over"
+        );
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            snapshot.covers(make_regions({INNER, ImageFloatBox(0.70, 0.70, 0.10, 0.10)})), false,
+            "one box outside"
+        );
+
+        //  Off the edge of the frame only needs what's on it.
+        VideoSnapshot corner = make_snapshot(WIDTH, HEIGHT, make_regions({ImageFloatBox(0.80, 0.80, 0.20, 0.20)}));
+        TEST_RESULT_COMPONENT_EQUAL_STR(
+            corner.covers(make_regions({ImageFloatBox(0.85, 0.85, 0.30, 0.30)})), true,
+            "past the frame edge"
+        );
+
+        //  Nothing to compare against.
+        VideoSnapshot empty;
+        empty.frame.reset();
+        empty.regions = regions;
+        TEST_RESULT_COMPONENT_EQUAL_STR(empty.covers(make_regions({INNER})), false, "no frame");
+
+        return true;
+    }
+};
+
+
+class Test_SnapshotRegionRectangles : public UnitTest{
+public:
+    Test_SnapshotRegionRectangles()
+        : UnitTest("VideoPipeline::SnapshotRegionRectangles")
+    {}
+
+    virtual UnitTestResult run(Logger& logger, CancellableScope& scope) const override{
+        const ImageFloatBox LEFT(0.10, 0.10, 0.30, 0.30);
+        const ImageFloatBox RIGHT(0.30, 0.20, 0.30, 0.30);
+        const ImageFloatBox INNER(0.15, 0.15, 0.10, 0.10);
+        const ImageFloatBox SAME_PIXELS(0.1004, 0.1004, 0.2994, 0.2994);
+        const ImageFloatBox WHOLE(0, 0, 1, 1);
+        const ImageFloatBox PAST_EDGE(0.90, 0.90, 0.30, 0.30);
+        const ImageFloatBox OFF_FRAME(1.10, 0.10, 0.10, 0.10);
+
+        const std::vector<std::vector<ImageFloatBox>> CASES{
+            {},
+            {WHOLE},
+            {LEFT},
+            {LEFT, INNER},
+            {INNER, LEFT},
+            {LEFT, RIGHT},
+            {LEFT, SAME_PIXELS},
+            {LEFT, LEFT},
+            {PAST_EDGE, OFF_FRAME},
+            {LEFT, RIGHT, INNER, WHOLE},
+        };
+        const std::vector<ImageFloatBox> REQUESTS{
+            LEFT, RIGHT, INNER, SAME_PIXELS, WHOLE, PAST_EDGE,
+            ImageFloatBox(0.09, 0.10, 0.31, 0.30),
+            ImageFloatBox(0.32, 0.22, 0.05, 0.05),
+        };
+        for (const std::vector<ImageFloatBox>& regions : CASES){
+            for (size_t width : {64, 99}){
+                for (size_t height : {48, 37}){
+                    std::string error = check_region_rectangles(width, height, regions, REQUESTS);
+                    if (!error.empty()){
+                        return error;
+                    }
+                }
+            }
+        }
+
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<double> position(0, 1.0);
+        std::uniform_real_distribution<double> size(0, 0.5);
+        auto random_box = [&]{
+            return ImageFloatBox(position(rng), position(rng), size(rng), size(rng));
+        };
+        for (size_t trial = 0; trial < 500; trial++){
+            size_t width = 16 + rng() % 64;
+            size_t height = 16 + rng() % 64;
+            std::vector<ImageFloatBox> regions;
+            for (size_t c = rng() % 6; c > 0; c--){
+                regions.emplace_back(random_box());
+            }
+            std::vector<ImageFloatBox> requests = regions;
+            for (size_t c = 0; c < 8; c++){
+                requests.emplace_back(random_box());
+            }
+            std::string error = check_region_rectangles(width, height, regions, requests);
+            if (!error.empty()){
+                return error;
+            }
+        }
+
+        return true;
+    }
+};
+
+
+
+void add_tests_VideoSnapshot(UnitTestDatabase& database){
+    database.add<Test_VideoSnapshotCovers>();
+    database.add<Test_SnapshotRegionRectangles>();
+}
+
+
+
+}
@@ -0,0 +1,21 @@
+/*  Video Snapshot Tests
+ *
+ *  From: https://github.com/PokemonAutomation/
+ *
+ */
+
+#ifndef PokemonAutomation_Tests_VideoSnapshot_Tests_H
+#define PokemonAutomation_Tests_VideoSnapshot_Tests_H
+
+#include "Common/Cpp/TestRunners/UnitTest.h"
+
+namespace PokemonAutomation{
+
+
+
+void add_tests_VideoSnapshot(UnitTestDatabase& database);
+
+
+
+}
+#endif
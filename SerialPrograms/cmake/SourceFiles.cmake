@@ -35,6 +35,8 @@ file(GLOB LIBRARY_SOURCES
     ../Common/Cpp/Concurrency/Backends/Thread_StdThreadDetach.tpp
     ../Common/Cpp/Concurrency/Backends/ThreadPool_Default.cpp
     ../Common/Cpp/Concurrency/Backends/ThreadPool_Default.h
+    ../Common/Cpp/Concurrency/Backends/ThreadPool_WorkStealing.cpp
+    ../Common/Cpp/Concurrency/Backends/ThreadPool_WorkStealing.h
     ../Common/Cpp/Concurrency/BusyPeriodicRunner.cpp
     ../Common/Cpp/Concurrency/BusyPeriodicRunner.h
     ../Common/Cpp/Concurrency/ConditionVariable.h
@@ -208,8 +210,11 @@ file(GLOB LIBRARY_SOURCES
     ../Common/Cpp/SerialConnection/SerialConnection.h
     ../Common/Cpp/SerialConnection/SerialConnectionPOSIX.h
     ../Common/Cpp/SerialConnection/SerialConnectionWinAPI.h
+    ../Common/Cpp/SerialConnection/SerialLatencyHistogram.h
     ../Common/Cpp/StreamConnections/MockDevice.cpp
     ../Common/Cpp/StreamConnections/MockDevice.h
+    ../Common/Cpp/StreamConnections/PtyDevice.cpp
+    ../Common/Cpp/StreamConnections/PtyDevice.h
     ../Common/Cpp/StreamConnections/PollingStreamConnections.h
     ../Common/Cpp/StreamConnections/PushingStreamConnections.h
     ../Common/Cpp/StreamConnections/StreamInterface.h
@@ -415,6 +420,8 @@ file(GLOB LIBRARY_SOURCES
     Source/CommonFramework/ImageTools/FloatPixel.h
     Source/CommonFramework/ImageTools/ImageBoxes.cpp
     Source/CommonFramework/ImageTools/ImageBoxes.h
+    Source/CommonFramework/ImageTools/ImageDerivedCache.cpp
+    Source/CommonFramework/ImageTools/ImageDerivedCache.h
     Source/CommonFramework/ImageTools/ImageDiff.cpp
     Source/CommonFramework/ImageTools/ImageDiff.h
     Source/CommonFramework/ImageTools/ImageStats.cpp
@@ -425,6 +432,8 @@ file(GLOB LIBRARY_SOURCES
     Source/CommonFramework/ImageTypes/ImageHSV32.h
     Source/CommonFramework/ImageTypes/ImageRGB32.cpp
     Source/CommonFramework/ImageTypes/ImageRGB32.h
+    Source/CommonFramework/ImageTypes/ImageRGB32Pool.cpp
+    Source/CommonFramework/ImageTypes/ImageRGB32Pool.h
     Source/CommonFramework/ImageTypes/ImageRGB32_OpenCV.cpp
     Source/CommonFramework/ImageTypes/ImageRGB32_OpenCV.h
     Source/CommonFramework/ImageTypes/ImageRGB32_Qt.cpp
@@ -584,6 +593,7 @@ file(GLOB LIBRARY_SOURCES
     Source/CommonFramework/VideoPipeline/Backends/QVideoFrameCache.h
     Source/CommonFramework/VideoPipeline/Backends/SnapshotManager.cpp
     Source/CommonFramework/VideoPipeline/Backends/SnapshotManager.h
+    Source/CommonFramework/VideoPipeline/Backends/SnapshotRegionRectangles.h
     Source/CommonFramework/VideoPipeline/Backends/VideoFrameQt.cpp
     Source/CommonFramework/VideoPipeline/Backends/VideoFrameQt.h
     Source/CommonFramework/VideoPipeline/CameraInfo.h
@@ -650,6 +660,8 @@ file(GLOB LIBRARY_SOURCES
     Source/CommonTools/Audio/AudioTemplateCache.h
     Source/CommonTools/Audio/SpectrogramMatcher.cpp
     Source/CommonTools/Audio/SpectrogramMatcher.h
+    Source/CommonTools/Audio/SpectrogramMatchingEngine.cpp
+    Source/CommonTools/Audio/SpectrogramMatchingEngine.h
     Source/CommonTools/DetectedBoxes.cpp
     Source/CommonTools/DetectedBoxes.h
     Source/CommonTools/DetectionDebouncer.h
@@ -722,6 +734,8 @@ file(GLOB LIBRARY_SOURCES
     Source/CommonTools/OCR/OCR_StringMatchResult.h
     Source/CommonTools/OCR/OCR_StringNormalization.cpp
     Source/CommonTools/OCR/OCR_StringNormalization.h
+    Source/CommonTools/OCR/OCR_SubstringMatchIndex.cpp
+    Source/CommonTools/OCR/OCR_SubstringMatchIndex.h
     Source/CommonTools/OCR/OCR_Tests.cpp
     Source/CommonTools/OCR/OCR_Tests.h
     Source/CommonTools/OCR/OCR_TextMatcher.cpp
@@ -744,6 +758,8 @@ file(GLOB LIBRARY_SOURCES
     Source/CommonTools/Options/TrainOCRModeOption.h
     Source/CommonTools/Random.cpp
     Source/CommonTools/Random.h
+    Source/CommonTools/Resources/ResourceCache.cpp
+    Source/CommonTools/Resources/ResourceCache.h
     Source/CommonTools/Resources/SpriteDatabase.cpp
     Source/CommonTools/Resources/SpriteDatabase.h
     Source/CommonTools/StartupChecks/StartProgramChecks.cpp
@@ -826,6 +842,8 @@ file(GLOB LIBRARY_SOURCES
     Source/Controllers/PABotBase2/PABotBase2_Connection.h
     Source/Controllers/PABotBase2/PABotBase2_DeviceHandle.cpp
     Source/Controllers/PABotBase2/PABotBase2_DeviceHandle.h
+    Source/Controllers/PABotBase2/PABotBase2_LoopbackBenchmark.cpp
+    Source/Controllers/PABotBase2/PABotBase2_LoopbackBenchmark.h
     Source/Controllers/PABotBase2/PABotBase2_MessageHandler.cpp
     Source/Controllers/PABotBase2/PABotBase2_MessageHandler.h
     Source/Controllers/PABotBase2/SerialPABotBase2_Connection.cpp
@@ -973,6 +991,22 @@ file(GLOB LIBRARY_SOURCES
     Source/Kernels/BinaryMatrix/Kernels_PackedBinaryMatrixCore.tpp
     Source/Kernels/BinaryMatrix/Kernels_SparseBinaryMatrixCore.h
     Source/Kernels/BinaryMatrix/Kernels_SparseBinaryMatrixCore.tpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat.h
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat_Default.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat_Routines.h
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat_Tests.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat_Tests.h
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat_x64_AVX2.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_PlanarFloat_x64_SSE41.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_YUV.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_YUV.h
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_YUV_Default.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_YUV_Routines.h
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_YUV_Tests.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_YUV_Tests.h
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_YUV_x64_AVX2.cpp
+    Source/Kernels/ImageConvert/Kernels_ImageConvert_YUV_x64_SSE41.cpp
     Source/Kernels/ImageFilters/Kernels_ImageFilter_Basic.cpp
     Source/Kernels/ImageFilters/Kernels_ImageFilter_Basic.h
     Source/Kernels/ImageFilters/Kernels_ImageFilter_Basic_ARM64_NEON.cpp
@@ -1002,6 +1036,14 @@ file(GLOB LIBRARY_SOURCES
     Source/Kernels/ImageFilters/RGB32_EuclideanDistance/Kernels_ImageFilter_RGB32_Euclidean_x64_AVX2.cpp
     Source/Kernels/ImageFilters/RGB32_EuclideanDistance/Kernels_ImageFilter_RGB32_Euclidean_x64_AVX512.cpp
     Source/Kernels/ImageFilters/RGB32_EuclideanDistance/Kernels_ImageFilter_RGB32_Euclidean_x64_SSE42.cpp
+    Source/Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32.cpp
+    Source/Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32.h
+    Source/Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32_ARM64_NEON.cpp
+    Source/Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32_Default.cpp
+    Source/Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32_Routines.h
+    Source/Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32_x64_AVX2.cpp
+    Source/Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32_x64_AVX512.cpp
+    Source/Kernels/ImageFilters/RGB32_HSV32/Kernels_ImageFilter_RGB32_HSV32_x64_SSE41.cpp
     Source/Kernels/ImageFilters/RGB32_Range/Kernels_ImageFilter_RGB32_Range.cpp
     Source/Kernels/ImageFilters/RGB32_Range/Kernels_ImageFilter_RGB32_Range.h
     Source/Kernels/ImageFilters/RGB32_Range/Kernels_ImageFilter_RGB32_Range_ARM64_NEON.cpp
@@ -1009,6 +1051,14 @@ file(GLOB LIBRARY_SOURCES
     Source/Kernels/ImageFilters/RGB32_Range/Kernels_ImageFilter_RGB32_Range_x64_AVX2.cpp
     Source/Kernels/ImageFilters/RGB32_Range/Kernels_ImageFilter_RGB32_Range_x64_AVX512.cpp
     Source/Kernels/ImageFilters/RGB32_Range/Kernels_ImageFilter_RGB32_Range_x64_SSE42.cpp
+    Source/Kernels/ImageResample/Kernels_ImageResample.cpp
+    Source/Kernels/ImageResample/Kernels_ImageResample.h
+    Source/Kernels/ImageResample/Kernels_ImageResample_Default.cpp
+    Source/Kernels/ImageResample/Kernels_ImageResample_Tests.cpp
+    Source/Kernels/ImageResample/Kernels_ImageResample_Tests.h
+    Source/Kernels/ImageResample/Kernels_ImageResample_arm64_NEON.cpp
+    Source/Kernels/ImageResample/Kernels_ImageResample_x64_AVX2.cpp
+    Source/Kernels/ImageResample/Kernels_ImageResample_x64_SSE41.cpp
     Source/Kernels/ImageScaleBrightness/Kernels_ImageScaleBrightness.cpp
     Source/Kernels/ImageScaleBrightness/Kernels_ImageScaleBrightness.h
     Source/Kernels/ImageScaleBrightness/Kernels_ImageScaleBrightness_Tests.cpp
@@ -1022,6 +1072,8 @@ file(GLOB LIBRARY_SOURCES
     Source/Kernels/ImageStats/Kernels_ImagePixelSumSqr.h
     Source/Kernels/ImageStats/Kernels_ImagePixelSumSqrDev.cpp
     Source/Kernels/ImageStats/Kernels_ImagePixelSumSqrDev.h
+    Source/Kernels/ImageStats/Kernels_ImagePixelSumSqrDev_Tests.cpp
+    Source/Kernels/ImageStats/Kernels_ImagePixelSumSqrDev_Tests.h
     Source/Kernels/ImageStats/Kernels_ImagePixelSumSqrDev_Default.cpp
     Source/Kernels/ImageStats/Kernels_ImagePixelSumSqrDev_x64_AVX2.cpp
     Source/Kernels/ImageStats/Kernels_ImagePixelSumSqrDev_x64_AVX512.cpp
@@ -2990,12 +3042,30 @@ file(GLOB LIBRARY_SOURCES
     Source/PokemonSwSh/ShinyHuntTracker.h
     Source/StaticRegistration.h
     Source/StaticRegistrationQt.cpp
+    Source/Tests/CommandLineBenchmark.cpp
+    Source/Tests/CommandLineBenchmark.h
     Source/Tests/CommandLineTests.cpp
     Source/Tests/CommandLineTests.h
+    Source/Tests/ImageMatch_Tests.cpp
+    Source/Tests/ImageMatch_Tests.h
+    Source/Tests/Json_Tests.cpp
+    Source/Tests/Json_Tests.h
+    Source/Tests/PABotBase2_CommandQueue_Tests.cpp
+    Source/Tests/PABotBase2_CommandQueue_Tests.h
+    Source/Tests/Pokemon_Rng_Tests.cpp
+    Source/Tests/Pokemon_Rng_Tests.h
+    Source/Tests/SerialConnection_Tests.cpp
+    Source/Tests/SerialConnection_Tests.h
+    Source/Tests/StatsDatabase_Tests.cpp
+    Source/Tests/StatsDatabase_Tests.h
     Source/Tests/TestMap.cpp
     Source/Tests/TestMap.h
     Source/Tests/TestUtils.cpp
     Source/Tests/TestUtils.h
+    Source/Tests/ThreadPool_Tests.cpp
+    Source/Tests/ThreadPool_Tests.h
+    Source/Tests/VideoSnapshot_Tests.cpp
+    Source/Tests/VideoSnapshot_Tests.h
     Source/ZeldaTotK/Programs/ZeldaTotK_BowItemDuper.cpp
     Source/ZeldaTotK/Programs/ZeldaTotK_BowItemDuper.h
     Source/ZeldaTotK/Programs/ZeldaTotK_MineruItemDuper.cpp